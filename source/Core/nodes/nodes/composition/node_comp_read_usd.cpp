@@ -2,6 +2,7 @@
 #include "Nodes/node_declare.hpp"
 #include "Nodes/node_register.h"
 #include "comp_node_base.h"
+#include "stage/stage_cache.hpp"
 
 namespace USTC_CG::node_comp_read_usd {
 static void node_declare(NodeDeclarationBuilder& b)
@@ -13,7 +14,7 @@ static void node_declare(NodeDeclarationBuilder& b)
 static void node_exec(ExeParams params)
 {
     auto file_name = params.get_input<std::string>("File Name");
-    auto stage = pxr::UsdStage::Open(file_name.c_str());
+    auto stage = open_cached_stage(file_name);
     if (!stage) {
         throw std::runtime_error("Stage not found.");
     }
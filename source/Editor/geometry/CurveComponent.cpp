@@ -1,5 +1,6 @@
 #include "GCore/Components/CurveComponent.h"
 
+#include "GCore/Algorithms/transform.h"
 #include "global_stage.hpp"
 #include "stage/stage.hpp"
 
@@ -13,6 +14,60 @@ std::string CurveComponent::to_string() const
     return out.str();
 }
 
+void CurveComponent::apply_transform(const pxr::GfMatrix4d& transform)
+{
+#if USE_USD_SCRATCH_BUFFER
+    auto vertices = get_vertices();
+    transform_points(vertices, transform);
+    set_vertices(vertices);
+
+    auto normals = get_curve_normals();
+    if (!normals.empty()) {
+        transform_normals(normals, transform);
+        set_curve_normals(normals);
+    }
+#else
+    transform_points(vertices, transform);
+    transform_normals(curve_normals, transform);
+    hash_cache.vertices.invalidate();
+    hash_cache.curve_normals.invalidate();
+#endif
+}
+
+uint64_t CurveComponent::topology_hash() const
+{
+    static const uint64_t type_seed = hash_string("CurveComponent");
+    uint64_t hash = hash_combine(type_seed, get_vertices().size());
+    hash = hash_combine(hash, get_periodic());
+    hash = hash_combine(hash, hash_cache.vert_count.get([&] {
+        return hash_array(get_vert_count());
+    }));
+    return hash;
+}
+
+uint64_t CurveComponent::positions_hash() const
+{
+    static const uint64_t type_seed = hash_string("CurveComponent");
+    return hash_combine(type_seed, hash_cache.vertices.get([&] {
+        return hash_array(get_vertices());
+    }));
+}
+
+uint64_t CurveComponent::content_hash() const
+{
+    uint64_t hash = hash_combine(topology_hash(), positions_hash());
+    hash = hash_combine(hash, hash_cache.width.get([&] {
+        return hash_array(get_width());
+    }));
+    hash = hash_combine(hash, hash_cache.display_color.get([&] {
+        return hash_array(get_display_color());
+    }));
+    hash = hash_combine(hash, hash_cache.curve_normals.get([&] {
+        return hash_array(get_curve_normals());
+    }));
+    return hash;
+}
+
 GeometryComponentHandle CurveComponent::copy(Geometry* operand) const
 {
     auto ret = std::make_shared<CurveComponent>(operand);
@@ -27,6 +82,7 @@ GeometryComponentHandle CurveComponent::copy(Geometry* operand) const
     ret->set_periodic(this->get_periodic());
     ret->set_curve_normals(this->get_curve_normals());
 #endif
+    ret->hash_cache = hash_cache;
     return ret;
 }
 
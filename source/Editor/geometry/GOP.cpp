@@ -1,8 +1,10 @@
 #include "GCore/GOP.h"
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components.h"
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/Components/XformComponent.h"
+#include "GCore/IO/geometry_cache.h"
 #include "Logger/Logger.h"
 #include "global_stage.hpp"
 #include "pxr/usd/usdGeom/xform.h"
@@ -66,6 +68,16 @@ Geometry Geometry::CreateMesh()
     return std::move(geometry);
 }
 
+void Geometry::save_cache(const std::filesystem::path& path) const
+{
+    write_geometry_cache(*this, path);
+}
+
+Geometry Geometry::load_cache(const std::filesystem::path& path)
+{
+    return read_geometry_cache(path);
+}
+
 std::string Geometry::to_string() const
 {
     std::ostringstream out;
@@ -78,6 +90,39 @@ std::string Geometry::to_string() const
     return out.str();
 }
 
+uint64_t Geometry::content_hash() const
+{
+    uint64_t hash = hash_combine(0, components_.size());
+    for (auto&& component : components_) {
+        if (component) {
+            hash = hash_combine(hash, component->content_hash());
+        }
+    }
+    return hash;
+}
+
+uint64_t Geometry::topology_hash() const
+{
+    uint64_t hash = hash_combine(0, components_.size());
+    for (auto&& component : components_) {
+        if (component) {
+            hash = hash_combine(hash, component->topology_hash());
+        }
+    }
+    return hash;
+}
+
+uint64_t Geometry::positions_hash() const
+{
+    uint64_t hash = hash_combine(0, components_.size());
+    for (auto&& component : components_) {
+        if (component) {
+            hash = hash_combine(hash, component->positions_hash());
+        }
+    }
+    return hash;
+}
+
 void Geometry::attach_component(const GeometryComponentHandle& component)
 {
     if (component->get_attached_operand() != this) {
@@ -1,5 +1,8 @@
 #include "GCore/Components/MeshOperand.h"
 
+#include "GCore/Algorithms/bvh.h"
+#include "GCore/Algorithms/point_index.h"
+#include "GCore/Algorithms/transform.h"
 #include "GCore/GOP.h"
 #include "global_stage.hpp"
 #include "stage/stage.hpp"
@@ -23,6 +26,75 @@ MeshComponent::~MeshComponent()
 {
 }
 
+void MeshComponent::apply_transform(const pxr::GfMatrix4d& transform)
+{
+#if USE_USD_SCRATCH_BUFFER
+    auto vertices = get_vertices();
+    transform_points(vertices, transform);
+    set_vertices(vertices);
+
+    auto normals = get_normals();
+    if (!normals.empty()) {
+        transform_normals(normals, transform);
+        set_normals(normals);
+    }
+#else
+    // Work on the local buffers directly, VtArray only detaches (copies) when
+    // the buffer is still shared with another geometry.
+    transform_points(vertices, transform);
+    transform_normals(normals, transform);
+    hash_cache.vertices.invalidate();
+    hash_cache.normals.invalidate();
+#endif
+}
+
+uint64_t MeshComponent::topology_hash() const
+{
+    static const uint64_t type_seed = hash_string("MeshComponent");
+    uint64_t hash = hash_combine(type_seed, get_vertices().size());
+    hash = hash_combine(hash, hash_cache.face_vertex_counts.get([&] {
+        return hash_array(get_face_vertex_counts());
+    }));
+    hash = hash_combine(hash, hash_cache.face_vertex_indices.get([&] {
+        return hash_array(get_face_vertex_indices());
+    }));
+    return hash;
+}
+
+uint64_t MeshComponent::positions_hash() const
+{
+    static const uint64_t type_seed = hash_string("MeshComponent");
+    return hash_combine(type_seed, hash_cache.vertices.get([&] {
+        return hash_array(get_vertices());
+    }));
+}
+
+uint64_t MeshComponent::content_hash() const
+{
+    uint64_t hash = hash_combine(topology_hash(), positions_hash());
+    hash = hash_combine(hash, hash_cache.normals.get([&] {
+        return hash_array(get_normals());
+    }));
+    hash = hash_combine(hash, hash_cache.display_color.get([&] {
+        return hash_array(get_display_color());
+    }));
+    hash = hash_combine(hash, hash_cache.texcoords.get([&] {
+        return hash_array(get_texcoords_array());
+    }));
+    hash = hash_combine(hash, hash_cache.quantities.get([&] {
+        uint64_t h = hash_quantities(vertex_scalar_quantities);
+        h = hash_quantities(face_scalar_quantities, h);
+        h = hash_quantities(vertex_color_quantities, h);
+        h = hash_quantities(face_color_quantities, h);
+        h = hash_quantities(vertex_vector_quantities, h);
+        h = hash_quantities(face_vector_quantities, h);
+        h = hash_quantities(face_corner_parameterization_quantities, h);
+        h = hash_quantities(vertex_parameterization_quantities, h);
+        return h;
+    }));
+    return hash;
+}
+
 std::string MeshComponent::to_string() const
 {
     std::ostringstream out;
@@ -91,6 +163,7 @@ GeometryComponentHandle MeshComponent::copy(Geometry* operand) const
     ret->set_face_vertex_indices(this->faceVertexIndices);
     ret->set_normals(this->normals);
     ret->set_display_color(this->displayColor);
+    ret->set_texcoords_array(this->texcoordsArray);
 #endif
     ret->set_vertex_scalar_quantities(this->vertex_scalar_quantities);
     ret->set_face_scalar_quantities(this->face_scalar_quantities);
@@ -102,14 +175,32 @@ GeometryComponentHandle MeshComponent::copy(Geometry* operand) const
         this->face_corner_parameterization_quantities);
     ret->set_vertex_parameterization_quantities(
         this->vertex_parameterization_quantities);
+    ret->hash_cache = hash_cache;
+    ret->bvh_cache = bvh_cache;
+    ret->kdtree_cache = kdtree_cache;
     return ret;
 }
 
+std::shared_ptr<const MeshBVH> MeshComponent::get_bvh() const
+{
+    bvh_cache = MeshBVH::update(bvh_cache, *this);
+    return bvh_cache;
+}
+
+std::shared_ptr<const PointKDTree> MeshComponent::get_kdtree() const
+{
+    kdtree_cache =
+        PointKDTree::update(kdtree_cache, get_vertices(), positions_hash());
+    return kdtree_cache;
+}
+
 #if USE_USD_SCRATCH_BUFFER
 void MeshComponent::set_mesh_geom(const pxr::UsdGeomMesh& usdgeom)
 {
     copy_prim(usdgeom.GetPrim(), mesh.GetPrim());
     pxr::UsdGeomImageable(mesh).MakeInvisible();
+    // Every array may have changed.
+    hash_cache = {};
 }
 
 pxr::UsdGeomMesh MeshComponent::get_usd_mesh() const
@@ -2,6 +2,8 @@
 
 #include "GCore/Components/PointsComponent.h"
 
+#include "GCore/Algorithms/point_index.h"
+#include "GCore/Algorithms/transform.h"
 #include "GCore/GOP.h"
 #include "global_stage.hpp"
 #include "stage/stage.hpp"
@@ -31,6 +33,44 @@ std::string PointsComponent::to_string() const
     return out.str();
 }
 
+void PointsComponent::apply_transform(const pxr::GfMatrix4d& transform)
+{
+#if USE_USD_SCRATCH_BUFFER
+    auto vertices = get_vertices();
+    transform_points(vertices, transform);
+    set_vertices(vertices);
+#else
+    transform_points(vertices, transform);
+    hash_cache.vertices.invalidate();
+#endif
+}
+
+uint64_t PointsComponent::topology_hash() const
+{
+    static const uint64_t type_seed = hash_string("PointsComponent");
+    return hash_combine(type_seed, get_vertices().size());
+}
+
+uint64_t PointsComponent::positions_hash() const
+{
+    static const uint64_t type_seed = hash_string("PointsComponent");
+    return hash_combine(type_seed, hash_cache.vertices.get([&] {
+        return hash_array(get_vertices());
+    }));
+}
+
+uint64_t PointsComponent::content_hash() const
+{
+    uint64_t hash = hash_combine(topology_hash(), positions_hash());
+    hash = hash_combine(hash, hash_cache.display_color.get([&] {
+        return hash_array(get_display_color());
+    }));
+    hash = hash_combine(hash, hash_cache.width.get([&] {
+        return hash_array(get_width());
+    }));
+    return hash;
+}
+
 GeometryComponentHandle PointsComponent::copy(Geometry* operand) const
 {
     auto ret = std::make_shared<PointsComponent>(operand);
@@ -42,8 +82,17 @@ GeometryComponentHandle PointsComponent::copy(Geometry* operand) const
     ret->set_display_color(this->get_display_color());
     ret->set_width(this->get_width());
 #endif
+    ret->hash_cache = hash_cache;
+    ret->kdtree_cache = kdtree_cache;
 
     return ret;
 }
 
+std::shared_ptr<const PointKDTree> PointsComponent::get_kdtree() const
+{
+    kdtree_cache =
+        PointKDTree::update(kdtree_cache, get_vertices(), positions_hash());
+    return kdtree_cache;
+}
+
 USTC_CG_NAMESPACE_CLOSE_SCOPE
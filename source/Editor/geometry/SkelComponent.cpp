@@ -2,6 +2,7 @@
 
 #include "GCore/Components/SkelComponent.h"
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/GOP.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
@@ -15,6 +16,48 @@ std::string SkelComponent::to_string() const
     return out.str();
 }
 
+void SkelComponent::apply_transform(const pxr::GfMatrix4d& transform)
+{
+    // Bind transforms are in world space, so the whole rest pose moves. Local
+    // transforms are relative to the parent joint, only the roots carry the
+    // placement of the skeleton.
+    for (auto& bind : bindTransforms) {
+        bind = bind * transform;
+    }
+
+    const pxr::GfMatrix4f transform_f(transform);
+    for (size_t i = 0; i < localTransforms.size(); ++i) {
+        if (i < topology.GetNumJoints() && topology.GetParent(i) >= 0) {
+            continue;
+        }
+        localTransforms[i] = localTransforms[i] * transform_f;
+    }
+}
+
+uint64_t SkelComponent::topology_hash() const
+{
+    static const uint64_t type_seed = hash_string("SkelComponent");
+    uint64_t hash = hash_combine(type_seed, jointOrder.size());
+    for (const auto& joint : jointOrder) {
+        hash = hash_combine(hash, hash_string(joint.GetString()));
+    }
+    return hash_combine(hash, hash_array(topology.GetParentIndices()));
+}
+
+uint64_t SkelComponent::positions_hash() const
+{
+    static const uint64_t type_seed = hash_string("SkelComponent");
+    uint64_t hash = hash_combine(type_seed, hash_array(localTransforms));
+    return hash_combine(hash, hash_array(bindTransforms));
+}
+
+uint64_t SkelComponent::content_hash() const
+{
+    uint64_t hash = hash_combine(topology_hash(), positions_hash());
+    hash = hash_combine(hash, hash_array(jointWeight));
+    return hash_combine(hash, hash_array(jointIndices));
+}
+
 GeometryComponentHandle SkelComponent::copy(Geometry* operand) const
 {
     auto ret = std::make_shared<SkelComponent>(operand);
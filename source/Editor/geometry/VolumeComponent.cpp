@@ -1,5 +1,7 @@
 #include "GCore/Components/VolumeComponent.h"
 
+#include "GCore/Algorithms/hash.h"
+
 USTC_CG_NAMESPACE_OPEN_SCOPE
 GeometryComponentHandle VolumeComponet::copy(Geometry* operand) const
 {
@@ -11,4 +13,10 @@ std::string VolumeComponet::to_string() const
 {
     return std::string("VolumeComponet");
 }
+
+uint64_t VolumeComponet::content_hash() const
+{
+    // No grid data is stored on the component yet.
+    return hash_string("VolumeComponet");
+}
 USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -3,6 +3,7 @@
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/basisCurves.h>
 
+#include "GCore/Algorithms/hash.h"
 #include "pxr/base/gf/rotation.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
@@ -24,6 +25,19 @@ std::string XformComponent::to_string() const
     return std::string("XformComponent");
 }
 
+uint64_t XformComponent::positions_hash() const
+{
+    static const uint64_t type_seed = hash_string("XformComponent");
+    uint64_t hash = hash_combine(type_seed, hash_array(translation));
+    hash = hash_combine(hash, hash_array(scale));
+    return hash_combine(hash, hash_array(rotation));
+}
+
+uint64_t XformComponent::content_hash() const
+{
+    return positions_hash();
+}
+
 pxr::GfMatrix4d XformComponent::get_transform() const
 {
     assert(translation.size() == rotation.size());
@@ -0,0 +1,617 @@
+#include "GCore/Algorithms/arap.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "GCore/Algorithms/laplacian.h"
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+
+Eigen::Vector3d to_eigen(const pxr::GfVec3f& v)
+{
+    return Eigen::Vector3d(v[0], v[1], v[2]);
+}
+
+// Rotation R maximizing tr(R^T a), i.e. U V^T for the SVD a = U S V^T
+// with U and V proper rotations and the smallest singular value signed.
+// V comes from the closed form eigen decomposition of a^T a, U from the
+// images of its columns, so no iterative SVD is needed. Keeps `r` when a
+// vanishes.
+void closest_rotation(const Eigen::Matrix3d& a, Eigen::Matrix3d& r)
+{
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen;
+    eigen.computeDirect(a.transpose() * a);
+    // Eigenvalues ascend; order the singular vectors descending.
+    Eigen::Matrix3d v;
+    v << eigen.eigenvectors().col(2), eigen.eigenvectors().col(1),
+        eigen.eigenvectors().col(0);
+    if (v.determinant() < 0.0) {
+        v.col(2) = -v.col(2);
+    }
+
+    Eigen::Matrix3d u;
+    const Eigen::Vector3d u0 = a * v.col(0);
+    const double s0 = u0.norm();
+    if (s0 < 1e-12) {
+        return;
+    }
+    u.col(0) = u0 / s0;
+    Eigen::Vector3d u1 = a * v.col(1);
+    u1 -= u.col(0).dot(u1) * u.col(0);
+    if (u1.norm() < 1e-6 * s0) {
+        // Collinear edges: any direction normal to the first will do.
+        u1 = u.col(0).unitOrthogonal();
+    }
+    u.col(1) = u1.normalized();
+    u.col(2) = u.col(0).cross(u.col(1));
+    r = u * v.transpose();
+}
+
+template<int Columns>
+using Rows = Eigen::Matrix<double, Eigen::Dynamic, Columns, Eigen::RowMajor>;
+
+// ldlt.solve(b) for all columns at once: every triangular sweep reads the
+// factor once for all of them instead of once per column, with the
+// coordinates of a row next to each other.
+template<int Columns>
+void solve_rows(
+    const Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>& ldlt,
+    const Rows<Columns>& b,
+    Rows<Columns>& x)
+{
+    using Row = Eigen::Matrix<double, 1, Columns>;
+    const Eigen::SparseMatrix<double>& factor =
+        ldlt.matrixL().nestedExpression();
+    const Eigen::VectorXd& diagonal = ldlt.vectorD();
+    const auto& permutation = ldlt.permutationP().indices();
+    const Eigen::Index n = b.rows();
+    const bool permuted = permutation.size() == n;
+
+    Rows<Columns> y(n, Columns);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        y.row(permuted ? permutation[i] : i) = b.row(i);
+    }
+    // L is unit lower triangular with only the strict part stored.
+    for (Eigen::Index j = 0; j < n; ++j) {
+        const Row yj = y.row(j);
+        for (Eigen::SparseMatrix<double>::InnerIterator it(factor, j); it;
+             ++it) {
+            y.row(it.row()) -= it.value() * yj;
+        }
+    }
+    for (Eigen::Index j = 0; j < n; ++j) {
+        y.row(j) /= diagonal[j];
+    }
+    for (Eigen::Index j = n - 1; j >= 0; --j) {
+        Row yj = y.row(j);
+        for (Eigen::SparseMatrix<double>::InnerIterator it(factor, j); it;
+             ++it) {
+            yj -= it.value() * y.row(it.row());
+        }
+        y.row(j) = yj;
+    }
+    x.resize(n, Columns);
+    for (Eigen::Index i = 0; i < n; ++i) {
+        x.row(i) = y.row(permuted ? permutation[i] : i);
+    }
+}
+
+uint32_t find_root(std::vector<uint32_t>& parent, uint32_t v)
+{
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+}  // namespace
+
+ArapDeformation::ArapDeformation(
+    std::shared_ptr<const MeshAdjacency> adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& rest,
+    std::vector<uint32_t> controls)
+    : adjacency_(std::move(adjacency)),
+      rest_(rest),
+      controls_(std::move(controls))
+{
+    laplacian_ = cotangent_laplacian(*adjacency_, rest_);
+    const size_t n = adjacency_->vertex_count();
+    if (controls_.empty()) {
+        throw std::invalid_argument(
+            "ArapDeformation: need at least one control vertex.");
+    }
+    free_index_.assign(n, 0);
+    for (uint32_t c : controls_) {
+        if (c >= n) {
+            throw std::invalid_argument(
+                "ArapDeformation: control index out of range.");
+        }
+        if (free_index_[c] < 0) {
+            throw std::invalid_argument(
+                "ArapDeformation: repeated control vertex.");
+        }
+        free_index_[c] = -1;
+    }
+    const NeighborLists& vertex_faces = adjacency_->vertex_faces();
+    for (size_t v = 0; v < n; ++v) {
+        if (free_index_[v] == 0 && vertex_faces.count(v) > 0) {
+            free_index_[v] = static_cast<int>(free_vertices_.size());
+            free_vertices_.push_back(static_cast<uint32_t>(v));
+        }
+        else {
+            free_index_[v] = -1;
+        }
+    }
+    const size_t free_count = free_vertices_.size();
+    if (free_count == 0) {
+        return;
+    }
+
+    // Block of the free vertices, one parallel pass to size its columns
+    // and one to fill them. Free indices grow with the vertex index, so
+    // the columns stay sorted.
+    const int* outer = laplacian_.outerIndexPtr();
+    const int* inner = laplacian_.innerIndexPtr();
+    const double* values = laplacian_.valuePtr();
+    std::vector<int> block_outer(free_count + 1, 0);
+    pxr::WorkParallelForN(
+        free_count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t v = free_vertices_[i];
+                int count = 0;
+                for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                    count += free_index_[inner[k]] >= 0;
+                }
+                block_outer[i + 1] = count;
+            }
+        },
+        grain_size);
+    std::partial_sum(
+        block_outer.begin(), block_outer.end(), block_outer.begin());
+
+    Eigen::SparseMatrix<double> block(free_count, free_count);
+    block.resizeNonZeros(block_outer.back());
+    std::copy(block_outer.begin(), block_outer.end(), block.outerIndexPtr());
+    pxr::WorkParallelForN(
+        free_count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t v = free_vertices_[i];
+                int write = block_outer[i];
+                for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                    const int j = free_index_[inner[k]];
+                    if (j >= 0) {
+                        block.innerIndexPtr()[write] = j;
+                        block.valuePtr()[write++] = values[k];
+                    }
+                }
+            }
+        },
+        grain_size);
+
+    cholesky_.compute(block);
+    if (cholesky_.info() != Eigen::Success) {
+        throw std::runtime_error("ArapDeformation: factorization failed.");
+    }
+}
+
+std::shared_ptr<const ArapDeformation> ArapDeformation::update(
+    const std::shared_ptr<const ArapDeformation>& previous,
+    const MeshComponent& mesh,
+    const std::vector<uint32_t>& controls)
+{
+    auto adjacency = MeshAdjacency::update(
+        previous ? previous->adjacency_ : nullptr, mesh);
+    const uint64_t positions = mesh.positions_hash();
+    if (previous && previous->adjacency_ == adjacency &&
+        previous->positions_hash_ == positions &&
+        previous->controls_ == controls) {
+        return previous;
+    }
+    auto deformation = std::make_shared<ArapDeformation>(
+        std::move(adjacency), mesh.get_vertices(), controls);
+    deformation->positions_hash_ = positions;
+    return deformation;
+}
+
+void ArapDeformation::deform(
+    const std::vector<pxr::GfVec3f>& targets,
+    ArapState& state,
+    int iterations) const
+{
+    if (targets.size() != controls_.size()) {
+        throw std::invalid_argument(
+            "ArapDeformation: need one target per control vertex.");
+    }
+    const size_t n = adjacency_->vertex_count();
+    // A fresh pose first takes a global step with identity rotations: the
+    // rest shape with only the controls moved is far too spiky to fit
+    // rotations to, and ARAP would settle in a folded local minimum.
+    const bool fresh =
+        state.positions.size() != n || state.rotations.size() != n;
+    if (fresh) {
+        state.positions = rest_;
+        state.rotations.assign(n, Eigen::Matrix3d::Identity());
+    }
+    for (size_t k = 0; k < controls_.size(); ++k) {
+        state.positions[controls_[k]] = targets[k];
+    }
+
+    // Detach once here rather than from the parallel loops.
+    pxr::GfVec3f* positions = state.positions.data();
+    const pxr::GfVec3f* rest = rest_.cdata();
+    const int* outer = laplacian_.outerIndexPtr();
+    const int* inner = laplacian_.innerIndexPtr();
+    const double* values = laplacian_.valuePtr();
+    const size_t free_count = free_vertices_.size();
+    std::vector<Eigen::Matrix3d>& rotations = state.rotations;
+    Rows<3> rhs(free_count, 3), solution;
+    for (int iteration = 0; iteration < iterations && free_count > 0;
+         ++iteration) {
+        // Local step: R_v is the rotation closest to
+        // sum_j w_vj (p_v - p_j) (p0_v - p0_j)^T.
+        pxr::WorkParallelForN(
+            fresh && iteration == 0 ? 0 : n,
+            [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    const Eigen::Vector3d p = to_eigen(positions[v]);
+                    const Eigen::Vector3d p0 = to_eigen(rest[v]);
+                    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+                    for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                        const int j = inner[k];
+                        if (j != static_cast<int>(v)) {
+                            covariance -=
+                                values[k] *
+                                (p - to_eigen(positions[j])) *
+                                (p0 - to_eigen(rest[j])).transpose();
+                        }
+                    }
+                    closest_rotation(covariance, rotations[v]);
+                }
+            },
+            grain_size);
+
+        // Global step: L_FF p_F = sum_j w_vj (R_v + R_j) (p0_v - p0_j) / 2
+        // with the controlled neighbors moved to the right hand side.
+        pxr::WorkParallelForN(
+            free_count,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t v = free_vertices_[i];
+                    const Eigen::Vector3d p0 = to_eigen(rest[v]);
+                    Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+                    for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                        const int j = inner[k];
+                        if (j == static_cast<int>(v)) {
+                            continue;
+                        }
+                        const double w = -values[k];
+                        sum += 0.5 * w * (rotations[v] + rotations[j]) *
+                               (p0 - to_eigen(rest[j]));
+                        if (free_index_[j] < 0) {
+                            sum += w * to_eigen(positions[j]);
+                        }
+                    }
+                    rhs.row(i) = sum.transpose();
+                }
+            },
+            grain_size);
+        solve_rows(cholesky_, rhs, solution);
+        pxr::WorkParallelForN(
+            free_count,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    positions[free_vertices_[i]] = pxr::GfVec3f(
+                        solution(i, 0), solution(i, 1), solution(i, 2));
+                }
+            },
+            grain_size);
+    }
+}
+
+ArapParameterization::ArapParameterization(
+    std::shared_ptr<const MeshAdjacency> adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    ArapFit fit)
+    : adjacency_(std::move(adjacency)),
+      fit_(fit)
+{
+    // Also rejects meshes that are not triangle meshes.
+    laplacian_ = cotangent_laplacian(*adjacency_, vertices);
+    const size_t n = adjacency_->vertex_count();
+    const size_t triangles = adjacency_->face_count();
+    const uint32_t* corners = adjacency_->corner_vertices().data();
+    const pxr::GfVec3f* x = vertices.cdata();
+
+    for (int k = 0; k < 3; ++k) {
+        edge_x_[k].resize(triangles);
+        edge_y_[k].resize(triangles);
+        weights_[k].resize(triangles);
+    }
+    norms_.resize(triangles);
+    pxr::WorkParallelForN(
+        triangles,
+        [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                const uint32_t* c = corners + 3 * t;
+                const pxr::GfVec3d p0(x[c[0]]);
+                const pxr::GfVec3d a = pxr::GfVec3d(x[c[1]]) - p0;
+                const pxr::GfVec3d b = pxr::GfVec3d(x[c[2]]) - p0;
+                // Corner 0 at the origin and corner 1 on the x axis.
+                const double length = a.GetLength();
+                const double double_area = pxr::GfCross(a, b).GetLength();
+                double q[3][2] = { { 0.0, 0.0 }, { length, 0.0 }, {} };
+                if (length > 0.0) {
+                    q[2][0] = pxr::GfDot(a, b) / length;
+                    q[2][1] = double_area / length;
+                }
+                double norm = 0.0;
+                for (int k = 0; k < 3; ++k) {
+                    const int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+                    const double ex = q[k][0] - q[k1][0];
+                    const double ey = q[k][1] - q[k1][1];
+                    // Cotangent of the angle at the opposite corner k2.
+                    const double w =
+                        double_area > 0.0
+                            ? ((q[k][0] - q[k2][0]) * (q[k1][0] - q[k2][0]) +
+                               (q[k][1] - q[k2][1]) * (q[k1][1] - q[k2][1])) /
+                                  double_area
+                            : 0.0;
+                    edge_x_[k][t] = ex;
+                    edge_y_[k][t] = ey;
+                    weights_[k][t] = w;
+                    norm += w * (ex * ex + ey * ey);
+                }
+                norms_[t] = norm;
+            }
+        },
+        grain_size);
+
+    // Pin the lowest vertex of every connected component, for similarity
+    // fits also the vertex farthest from it, and every vertex outside the
+    // triangles.
+    std::vector<uint32_t> parent(n);
+    std::iota(parent.begin(), parent.end(), 0u);
+    for (size_t t = 0; t < triangles; ++t) {
+        const uint32_t* c = corners + 3 * t;
+        const uint32_t r0 = find_root(parent, c[0]);
+        for (int k = 1; k < 3; ++k) {
+            const uint32_t r = find_root(parent, c[k]);
+            parent[std::max(r, r0)] = std::min(r, r0);
+        }
+    }
+    const NeighborLists& vertex_faces = adjacency_->vertex_faces();
+    std::vector<uint32_t> farthest(n, ~0u);
+    std::vector<double> distance(n, 0.0);
+    for (size_t v = 0; v < n; ++v) {
+        if (vertex_faces.count(v) == 0) {
+            pinned_.push_back(static_cast<uint32_t>(v));
+            continue;
+        }
+        const uint32_t root = find_root(parent, static_cast<uint32_t>(v));
+        if (root == v) {
+            pinned_.push_back(root);
+        }
+        const double d = (x[v] - x[root]).GetLength();
+        if (d > distance[root]) {
+            distance[root] = d;
+            farthest[root] = static_cast<uint32_t>(v);
+        }
+    }
+    if (fit_ == ArapFit::similarity) {
+        for (size_t v = 0; v < n; ++v) {
+            if (farthest[v] != ~0u) {
+                pinned_.push_back(farthest[v]);
+            }
+        }
+    }
+
+    // Pinned vertices get identity rows, their coupling to the free ones
+    // moves to the right hand side of every solve.
+    std::vector<uint8_t> is_pinned(n, 0);
+    for (uint32_t v : pinned_) {
+        is_pinned[v] = 1;
+    }
+    Eigen::SparseMatrix<double> system = laplacian_;
+    system.prune([&](Eigen::Index row, Eigen::Index col, const double&) {
+        return !is_pinned[row] && !is_pinned[col];
+    });
+    std::vector<Eigen::Triplet<double>> ones;
+    ones.reserve(pinned_.size());
+    for (uint32_t v : pinned_) {
+        ones.emplace_back(v, v, 1.0);
+    }
+    Eigen::SparseMatrix<double> identity(n, n);
+    identity.setFromTriplets(ones.begin(), ones.end());
+    cholesky_.compute(system + identity);
+    if (cholesky_.info() != Eigen::Success) {
+        throw std::runtime_error(
+            "ArapParameterization: factorization failed.");
+    }
+}
+
+std::shared_ptr<const ArapParameterization> ArapParameterization::update(
+    const std::shared_ptr<const ArapParameterization>& previous,
+    const MeshComponent& mesh,
+    ArapFit fit)
+{
+    auto adjacency = MeshAdjacency::update(
+        previous ? previous->adjacency_ : nullptr, mesh);
+    const uint64_t positions = mesh.positions_hash();
+    if (previous && previous->adjacency_ == adjacency &&
+        previous->positions_hash_ == positions && previous->fit_ == fit) {
+        return previous;
+    }
+    auto parameterization = std::make_shared<ArapParameterization>(
+        std::move(adjacency), mesh.get_vertices(), fit);
+    parameterization->positions_hash_ = positions;
+    return parameterization;
+}
+
+std::vector<double> ArapParameterization::solve(
+    pxr::VtArray<pxr::GfVec2f>& uv,
+    const ArapParameterizationOptions& options) const
+{
+    const size_t n = adjacency_->vertex_count();
+    if (uv.size() != n) {
+        throw std::invalid_argument(
+            "ArapParameterization: need one UV per vertex.");
+    }
+    std::vector<double> energies;
+    const size_t triangles = adjacency_->face_count();
+    if (triangles == 0) {
+        return energies;
+    }
+
+    // Detach once here rather than from the parallel loops.
+    pxr::GfVec2f* u = uv.data();
+    const uint32_t* corners = adjacency_->corner_vertices().data();
+    const NeighborLists& vertex_faces = adjacency_->vertex_faces();
+    // Edges of the current UVs, laid out like the frame edges, and the map
+    // [[c, -s], [s, c]] fitted to each triangle with its energy.
+    std::array<std::vector<double>, 3> du_x, du_y;
+    for (int k = 0; k < 3; ++k) {
+        du_x[k].resize(triangles);
+        du_y[k].resize(triangles);
+    }
+    std::vector<double> map_c(triangles), map_s(triangles);
+    std::vector<double> energy(triangles);
+
+    // With S = sum_k w_k du_k e_k^T, a = tr S and b = S_10 - S_01, the
+    // rotation maximizing tr(L^T S) has (c, s) = (a, b) / |(a, b)| and the
+    // best similarity (c, s) = (a, b) / sum_k w_k |e_k|^2. The energy
+    // follows from the same sums, without revisiting the edges. Only the
+    // gather of the UV edges is scalar; the fit runs on Eigen arrays over
+    // the structure of arrays, so it compiles to packet code.
+    const bool rigid = fit_ == ArapFit::rigid;
+    auto local_step = [&]() {
+        pxr::WorkParallelForN(
+            triangles,
+            [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    const uint32_t* c = corners + 3 * t;
+                    for (int k = 0; k < 3; ++k) {
+                        const pxr::GfVec2f d = u[c[k]] - u[c[(k + 1) % 3]];
+                        du_x[k][t] = d[0];
+                        du_y[k][t] = d[1];
+                    }
+                }
+                const Eigen::Index count = end - begin;
+                auto range = [&](const std::vector<double>& values) {
+                    return Eigen::Map<const Eigen::ArrayXd>(
+                        values.data() + begin, count);
+                };
+                Eigen::ArrayXd a = Eigen::ArrayXd::Zero(count);
+                Eigen::ArrayXd b = Eigen::ArrayXd::Zero(count);
+                Eigen::ArrayXd d = Eigen::ArrayXd::Zero(count);
+                for (int k = 0; k < 3; ++k) {
+                    const auto w = range(weights_[k]);
+                    const auto ex = range(edge_x_[k]), ey = range(edge_y_[k]);
+                    const auto ux = range(du_x[k]), uy = range(du_y[k]);
+                    a += w * (ux * ex + uy * ey);
+                    b += w * (uy * ex - ux * ey);
+                    d += w * (ux.square() + uy.square());
+                }
+                const auto norm = range(norms_);
+                const Eigen::ArrayXd r2 = a.square() + b.square();
+                Eigen::Map<Eigen::ArrayXd> c(map_c.data() + begin, count);
+                Eigen::Map<Eigen::ArrayXd> s(map_s.data() + begin, count);
+                Eigen::Map<Eigen::ArrayXd> e(energy.data() + begin, count);
+                // Degenerate triangles, and vanishing S for rotations, keep
+                // the identity.
+                if (rigid) {
+                    const Eigen::ArrayXd r = r2.sqrt();
+                    c = (r > 0.0).select(a / r, 1.0);
+                    s = (r > 0.0).select(b / r, 0.0);
+                    e = 0.5 * (d - 2.0 * r + norm);
+                }
+                else {
+                    c = (norm > 0.0).select(a / norm, 1.0);
+                    s = (norm > 0.0).select(b / norm, 0.0);
+                    e = 0.5 * (d - (norm > 0.0).select(r2 / norm, 0.0));
+                }
+                // Rounding may leave nearly flat triangles slightly below 0.
+                e = e.max(0.0);
+            },
+            grain_size);
+        return std::accumulate(energy.begin(), energy.end(), 0.0);
+    };
+
+    // C u = 1/2 sum_t sum_k w_k L_t e_k, gathered per vertex from the two
+    // edges of each triangle around it.
+    Rows<2> rhs(n, 2), solution;
+    auto global_step = [&]() {
+        pxr::WorkParallelForN(
+            n,
+            [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    double sx = 0.0, sy = 0.0;
+                    for (const uint32_t* f = vertex_faces.begin(v);
+                         f != vertex_faces.end(v);
+                         ++f) {
+                        const uint32_t* c = corners + 3 * *f;
+                        const int out = c[0] == v ? 0 : c[1] == v ? 1 : 2;
+                        const int in = (out + 2) % 3;
+                        const double cos = map_c[*f], sin = map_s[*f];
+                        const double wo = 0.5 * weights_[out][*f];
+                        const double wi = 0.5 * weights_[in][*f];
+                        const double ex = wo * edge_x_[out][*f] -
+                                          wi * edge_x_[in][*f];
+                        const double ey = wo * edge_y_[out][*f] -
+                                          wi * edge_y_[in][*f];
+                        sx += cos * ex - sin * ey;
+                        sy += sin * ex + cos * ey;
+                    }
+                    rhs(v, 0) = sx;
+                    rhs(v, 1) = sy;
+                }
+            },
+            grain_size);
+        for (uint32_t p : pinned_) {
+            const Eigen::RowVector2d up(u[p][0], u[p][1]);
+            for (Eigen::SparseMatrix<double>::InnerIterator it(laplacian_, p);
+                 it;
+                 ++it) {
+                rhs.row(it.row()) -= it.value() * up;
+            }
+        }
+        for (uint32_t p : pinned_) {
+            rhs.row(p) = Eigen::RowVector2d(u[p][0], u[p][1]);
+        }
+        solve_rows(cholesky_, rhs, solution);
+        pxr::WorkParallelForN(
+            n,
+            [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    u[v] = pxr::GfVec2f(solution(v, 0), solution(v, 1));
+                }
+            },
+            grain_size);
+    };
+
+    double previous = local_step();
+    for (int iteration = 0; iteration < options.max_iterations; ++iteration) {
+        global_step();
+        const double current = local_step();
+        energies.push_back(current);
+        if (previous - current <= options.tolerance * previous) {
+            break;
+        }
+        previous = current;
+    }
+    return energies;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,236 @@
+#include "GCore/Algorithms/bilateral_filter.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+
+// Newell normal (unit), area and vertex average centroid of every face.
+void face_geometry(
+    const MeshAdjacency& adjacency,
+    const pxr::GfVec3f* positions,
+    pxr::GfVec3f* normals,
+    float* areas,
+    pxr::GfVec3f* centroids)
+{
+    const uint32_t* offsets = adjacency.face_offsets().data();
+    const uint32_t* corners = adjacency.corner_vertices().data();
+    pxr::WorkParallelForN(
+        adjacency.face_count(),
+        [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                const uint32_t first = offsets[f];
+                const uint32_t n = offsets[f + 1] - first;
+                pxr::GfVec3f centroid(0.0f);
+                pxr::GfVec3f normal(0.0f);
+                for (uint32_t k = 0; k < n; ++k) {
+                    const pxr::GfVec3f& a = positions[corners[first + k]];
+                    const pxr::GfVec3f& b =
+                        positions[corners[first + (k + 1) % n]];
+                    centroid += a;
+                    normal += pxr::GfCross(a, b);
+                }
+                centroids[f] = n ? centroid / float(n) : centroid;
+                if (normals) {
+                    const float length = normal.GetLength();
+                    normals[f] = length > 0.0f ? normal / length : normal;
+                    areas[f] = 0.5f * length;
+                }
+            }
+        },
+        grain_size);
+}
+
+// Sum of f(begin, end) over fixed chunks, so that the result does not depend
+// on the thread count.
+template<typename F>
+double parallel_sum(size_t count, const F& f)
+{
+    const size_t chunk_count = (count + grain_size - 1) / grain_size;
+    std::vector<double> partial(chunk_count, 0.0);
+    pxr::WorkParallelForN(chunk_count, [&](size_t begin, size_t end) {
+        for (size_t chunk = begin; chunk < end; ++chunk) {
+            partial[chunk] = f(
+                chunk * grain_size, std::min(count, (chunk + 1) * grain_size));
+        }
+    });
+    double sum = 0.0;
+    for (double p : partial) {
+        sum += p;
+    }
+    return sum;
+}
+}  // namespace
+
+pxr::VtArray<pxr::GfVec3f> filter_face_normals(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const BilateralFilterSettings& settings)
+{
+    if (!(settings.sigma_s > 0.0f) || !(settings.multiple_sigma_c > 0.0f)) {
+        throw std::invalid_argument(
+            "filter_face_normals: sigma_s and multiple_sigma_c must be "
+            "positive.");
+    }
+    const size_t face_count = adjacency.face_count();
+    pxr::VtArray<pxr::GfVec3f> current(face_count);
+    pxr::VtArray<pxr::GfVec3f> next(face_count);
+    std::vector<float> areas(face_count);
+    std::vector<pxr::GfVec3f> centroids(face_count);
+    face_geometry(
+        adjacency,
+        vertices.cdata(),
+        current.data(),
+        areas.data(),
+        centroids.data());
+    if (settings.normal_iterations <= 0 || face_count == 0) {
+        return current;
+    }
+
+    const NeighborLists& edge_neighbors =
+        adjacency.face_neighbors(FaceNeighborhood::edge);
+    const double distance_sum =
+        parallel_sum(face_count, [&](size_t begin, size_t end) {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                for (const uint32_t* j = edge_neighbors.begin(i);
+                     j != edge_neighbors.end(i);
+                     ++j) {
+                    sum += (centroids[i] - centroids[*j]).GetLength();
+                }
+            }
+            return sum;
+        });
+    const size_t pair_count = edge_neighbors.indices.size();
+    // Neighbors with coinciding centroids weigh the same for any sigma_c.
+    const float sigma_c =
+        distance_sum > 0.0
+            ? settings.multiple_sigma_c * distance_sum / pair_count
+            : 1.0f;
+    const float inv_two_sigma_c2 = 1.0f / (2.0f * sigma_c * sigma_c);
+    // |ni - nj|^2 / (2 sigma_s^2) = (1 - ni.nj) / sigma_s^2 for unit normals.
+    const float inv_sigma_s2 = 1.0f / (settings.sigma_s * settings.sigma_s);
+
+    // Centroids do not move while filtering normals, so the area and
+    // spatial weights of every pair are fixed.
+    const NeighborLists& neighbors =
+        adjacency.face_neighbors(settings.neighborhood);
+    const uint32_t* offsets = neighbors.offsets.data();
+    const uint32_t* indices = neighbors.indices.data();
+    std::vector<float> spatial(neighbors.indices.size());
+    pxr::WorkParallelForN(
+        face_count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                for (uint32_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    const uint32_t j = indices[k];
+                    const pxr::GfVec3f d = centroids[i] - centroids[j];
+                    spatial[k] = areas[j] *
+                                 std::exp(-pxr::GfDot(d, d) * inv_two_sigma_c2);
+                }
+            }
+        },
+        grain_size);
+
+    for (int iteration = 0; iteration < settings.normal_iterations;
+         ++iteration) {
+        const pxr::GfVec3f* in = current.cdata();
+        pxr::GfVec3f* out = next.data();
+        const float* weights = spatial.data();
+        pxr::WorkParallelForN(
+            face_count,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const pxr::GfVec3f ni = in[i];
+                    float x = 0.0f, y = 0.0f, z = 0.0f;
+                    for (uint32_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                        const pxr::GfVec3f& nj = in[indices[k]];
+                        const float dot =
+                            ni[0] * nj[0] + ni[1] * nj[1] + ni[2] * nj[2];
+                        const float w = weights[k] *
+                                        std::exp((dot - 1.0f) * inv_sigma_s2);
+                        x += w * nj[0];
+                        y += w * nj[1];
+                        z += w * nj[2];
+                    }
+                    const float length = std::sqrt(x * x + y * y + z * z);
+                    out[i] = length > 0.0f
+                                 ? pxr::GfVec3f(x, y, z) / length
+                                 : ni;
+                }
+            },
+            grain_size);
+        std::swap(current, next);
+    }
+    return current;
+}
+
+pxr::VtArray<pxr::GfVec3f> fit_vertices_to_normals(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const pxr::VtArray<pxr::GfVec3f>& normals,
+    int iterations,
+    bool fixed_boundary)
+{
+    pxr::VtArray<pxr::GfVec3f> current = vertices;
+    pxr::VtArray<pxr::GfVec3f> next(vertices.size());
+    std::vector<pxr::GfVec3f> centroids(adjacency.face_count());
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    const uint8_t* boundary = adjacency.boundary_vertices().data();
+    const pxr::GfVec3f* face_normals = normals.cdata();
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        const pxr::GfVec3f* in = current.cdata();
+        pxr::GfVec3f* out = next.data();
+        face_geometry(adjacency, in, nullptr, nullptr, centroids.data());
+
+        // Each face pulls the vertex onto its plane through the centroid.
+        pxr::WorkParallelForN(
+            vertices.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    const pxr::GfVec3f p = in[v];
+                    const uint32_t count = vertex_faces.count(v);
+                    if ((fixed_boundary && boundary[v]) || count == 0) {
+                        out[v] = p;
+                        continue;
+                    }
+                    pxr::GfVec3f sum(0.0f);
+                    for (const uint32_t* f = vertex_faces.begin(v);
+                         f != vertex_faces.end(v);
+                         ++f) {
+                        const pxr::GfVec3f& n = face_normals[*f];
+                        sum += n * pxr::GfDot(n, centroids[*f] - p);
+                    }
+                    out[v] = p + sum / float(count);
+                }
+            },
+            grain_size);
+        std::swap(current, next);
+    }
+    return current;
+}
+
+pxr::VtArray<pxr::GfVec3f> bilateral_normal_filter(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const BilateralFilterSettings& settings)
+{
+    const auto normals = filter_face_normals(adjacency, vertices, settings);
+    return fit_vertices_to_normals(
+        adjacency,
+        vertices,
+        normals,
+        settings.vertex_iterations,
+        settings.fixed_boundary);
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,977 @@
+#include "GCore/Algorithms/bvh.h"
+
+#include <pxr/base/work/dispatcher.h>
+#include <pxr/base/work/loops.h>
+
+#include <atomic>
+#include <cmath>
+
+#include "GCore/Components/MeshOperand.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GCORE_BVH_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GCORE_BVH_NEON 1
+#include <arm_neon.h>
+#endif
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+using Node = MeshBVH::Node;
+using TrianglePacket = MeshBVH::TrianglePacket;
+
+constexpr uint32_t bin_count = 16;
+constexpr uint32_t max_leaf_triangles = 16;
+constexpr uint32_t parallel_build_threshold = 4096;
+// Past this depth the SAH split is replaced by an object median, which bounds
+// the tree depth on degenerate inputs.
+constexpr uint32_t max_sah_depth = 48;
+constexpr uint32_t stack_size = 128;
+
+uint32_t packet_count(uint32_t triangles)
+{
+    return (triangles + MeshBVH::packet_width - 1) / MeshBVH::packet_width;
+}
+
+// Four-wide float vector used by the packet tests.
+#if GCORE_BVH_SSE
+struct F4 {
+    __m128 v;
+};
+struct M4 {
+    __m128 v;
+};
+inline F4 load4(const float* p)
+{
+    return { _mm_loadu_ps(p) };
+}
+inline F4 set4(float x)
+{
+    return { _mm_set1_ps(x) };
+}
+inline F4 operator+(F4 a, F4 b)
+{
+    return { _mm_add_ps(a.v, b.v) };
+}
+inline F4 operator-(F4 a, F4 b)
+{
+    return { _mm_sub_ps(a.v, b.v) };
+}
+inline F4 operator*(F4 a, F4 b)
+{
+    return { _mm_mul_ps(a.v, b.v) };
+}
+inline F4 operator/(F4 a, F4 b)
+{
+    return { _mm_div_ps(a.v, b.v) };
+}
+inline M4 operator>=(F4 a, F4 b)
+{
+    return { _mm_cmpge_ps(a.v, b.v) };
+}
+inline M4 operator<=(F4 a, F4 b)
+{
+    return { _mm_cmple_ps(a.v, b.v) };
+}
+inline M4 operator<(F4 a, F4 b)
+{
+    return { _mm_cmplt_ps(a.v, b.v) };
+}
+inline M4 operator!=(F4 a, F4 b)
+{
+    return { _mm_cmpneq_ps(a.v, b.v) };
+}
+inline M4 operator&(M4 a, M4 b)
+{
+    return { _mm_and_ps(a.v, b.v) };
+}
+inline int bits(M4 m)
+{
+    return _mm_movemask_ps(m.v);
+}
+inline void store4(float* p, F4 a)
+{
+    _mm_storeu_ps(p, a.v);
+}
+#elif GCORE_BVH_NEON
+struct F4 {
+    float32x4_t v;
+};
+struct M4 {
+    uint32x4_t v;
+};
+inline F4 load4(const float* p)
+{
+    return { vld1q_f32(p) };
+}
+inline F4 set4(float x)
+{
+    return { vdupq_n_f32(x) };
+}
+inline F4 operator+(F4 a, F4 b)
+{
+    return { vaddq_f32(a.v, b.v) };
+}
+inline F4 operator-(F4 a, F4 b)
+{
+    return { vsubq_f32(a.v, b.v) };
+}
+inline F4 operator*(F4 a, F4 b)
+{
+    return { vmulq_f32(a.v, b.v) };
+}
+inline F4 operator/(F4 a, F4 b)
+{
+    return { vdivq_f32(a.v, b.v) };
+}
+inline M4 operator>=(F4 a, F4 b)
+{
+    return { vcgeq_f32(a.v, b.v) };
+}
+inline M4 operator<=(F4 a, F4 b)
+{
+    return { vcleq_f32(a.v, b.v) };
+}
+inline M4 operator<(F4 a, F4 b)
+{
+    return { vcltq_f32(a.v, b.v) };
+}
+inline M4 operator!=(F4 a, F4 b)
+{
+    return { vmvnq_u32(vceqq_f32(a.v, b.v)) };
+}
+inline M4 operator&(M4 a, M4 b)
+{
+    return { vandq_u32(a.v, b.v) };
+}
+inline int bits(M4 m)
+{
+    static const uint32_t weights[4] = { 1, 2, 4, 8 };
+    return int(vaddvq_u32(vandq_u32(m.v, vld1q_u32(weights))));
+}
+inline void store4(float* p, F4 a)
+{
+    vst1q_f32(p, a.v);
+}
+#else
+struct F4 {
+    float v[4];
+};
+struct M4 {
+    bool v[4];
+};
+inline F4 load4(const float* p)
+{
+    return { { p[0], p[1], p[2], p[3] } };
+}
+inline F4 set4(float x)
+{
+    return { { x, x, x, x } };
+}
+#define GCORE_BVH_F4_OP(op, R)               \
+    inline R operator op(F4 a, F4 b)         \
+    {                                        \
+        R r;                                 \
+        for (int i = 0; i < 4; ++i)          \
+            r.v[i] = a.v[i] op b.v[i];       \
+        return r;                            \
+    }
+GCORE_BVH_F4_OP(+, F4)
+GCORE_BVH_F4_OP(-, F4)
+GCORE_BVH_F4_OP(*, F4)
+GCORE_BVH_F4_OP(/, F4)
+GCORE_BVH_F4_OP(>=, M4)
+GCORE_BVH_F4_OP(<=, M4)
+GCORE_BVH_F4_OP(<, M4)
+GCORE_BVH_F4_OP(!=, M4)
+#undef GCORE_BVH_F4_OP
+inline M4 operator&(M4 a, M4 b)
+{
+    M4 r;
+    for (int i = 0; i < 4; ++i) {
+        r.v[i] = a.v[i] && b.v[i];
+    }
+    return r;
+}
+inline int bits(M4 m)
+{
+    return int(m.v[0]) | int(m.v[1]) << 1 | int(m.v[2]) << 2 |
+           int(m.v[3]) << 3;
+}
+inline void store4(float* p, F4 a)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = a.v[i];
+    }
+}
+#endif
+
+void set_bounds(Node& node, const BoundingBox& box)
+{
+    for (int i = 0; i < 3; ++i) {
+        node.min[i] = box.min[i];
+        node.max[i] = box.max[i];
+    }
+}
+
+BoundingBox node_bounds(const Node& node)
+{
+    BoundingBox box;
+    box.min = pxr::GfVec3f(node.min[0], node.min[1], node.min[2]);
+    box.max = pxr::GfVec3f(node.max[0], node.max[1], node.max[2]);
+    return box;
+}
+
+// Entry distance of the ray into the node box, infinity on a miss.
+inline float intersect_box(
+    const Node& node,
+    const pxr::GfVec3f& origin,
+    const pxr::GfVec3f& inv_direction,
+    float max_distance)
+{
+    float t_near = 0.0f;
+    float t_far = max_distance;
+    for (int i = 0; i < 3; ++i) {
+        const float t0 = (node.min[i] - origin[i]) * inv_direction[i];
+        const float t1 = (node.max[i] - origin[i]) * inv_direction[i];
+        t_near = std::max(t_near, std::min(t0, t1));
+        t_far = std::min(t_far, std::max(t0, t1));
+    }
+    return t_near <= t_far ? t_near : std::numeric_limits<float>::infinity();
+}
+
+// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection,
+// 5.1.5). Writes the barycentric weights of a, b and c.
+pxr::GfVec3f closest_on_triangle(
+    const pxr::GfVec3f& p,
+    const pxr::GfVec3f& a,
+    const pxr::GfVec3f& b,
+    const pxr::GfVec3f& c,
+    pxr::GfVec3f& barycentric)
+{
+    const pxr::GfVec3f ab = b - a;
+    const pxr::GfVec3f ac = c - a;
+    const pxr::GfVec3f ap = p - a;
+    const float d1 = pxr::GfDot(ab, ap);
+    const float d2 = pxr::GfDot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        barycentric = pxr::GfVec3f(1, 0, 0);
+        return a;
+    }
+
+    const pxr::GfVec3f bp = p - b;
+    const float d3 = pxr::GfDot(ab, bp);
+    const float d4 = pxr::GfDot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        barycentric = pxr::GfVec3f(0, 1, 0);
+        return b;
+    }
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        const float v = d1 / (d1 - d3);
+        barycentric = pxr::GfVec3f(1 - v, v, 0);
+        return a + ab * v;
+    }
+
+    const pxr::GfVec3f cp = p - c;
+    const float d5 = pxr::GfDot(ab, cp);
+    const float d6 = pxr::GfDot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        barycentric = pxr::GfVec3f(0, 0, 1);
+        return c;
+    }
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        const float w = d2 / (d2 - d6);
+        barycentric = pxr::GfVec3f(1 - w, 0, w);
+        return a + ac * w;
+    }
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        barycentric = pxr::GfVec3f(0, 1 - w, w);
+        return b + (c - b) * w;
+    }
+
+    const float denom = 1.0f / (va + vb + vc);
+    const float v = vb * denom;
+    const float w = vc * denom;
+    barycentric = pxr::GfVec3f(1 - v - w, v, w);
+    return a + ab * v + ac * w;
+}
+
+void packet_triangle(
+    const TrianglePacket& packet,
+    int lane,
+    pxr::GfVec3f& a,
+    pxr::GfVec3f& b,
+    pxr::GfVec3f& c)
+{
+    for (int k = 0; k < 3; ++k) {
+        a[k] = packet.v0[k][lane];
+        b[k] = packet.v0[k][lane] + packet.e1[k][lane];
+        c[k] = packet.v0[k][lane] + packet.e2[k][lane];
+    }
+}
+
+// Padding lanes repeat the previous triangle and are skipped when results
+// are enumerated.
+inline bool is_padding(const TrianglePacket& packet, int lane)
+{
+    return lane > 0 && packet.triangle[lane] == packet.triangle[lane - 1];
+}
+
+struct BuildContext {
+    const std::vector<BoundingBox>& boxes;
+    const std::vector<pxr::GfVec3f>& centroids;
+    std::vector<uint32_t>& order;
+    std::vector<Node>& nodes;
+    std::atomic<uint32_t> node_count{ 1 };
+    pxr::WorkDispatcher dispatcher{};
+};
+
+void build_node(
+    BuildContext& ctx,
+    uint32_t node_index,
+    uint32_t begin,
+    uint32_t end,
+    uint32_t depth)
+{
+    BoundingBox bounds;
+    BoundingBox centroid_bounds;
+    for (uint32_t i = begin; i < end; ++i) {
+        bounds.extend(ctx.boxes[ctx.order[i]]);
+        centroid_bounds.extend(ctx.centroids[ctx.order[i]]);
+    }
+
+    Node& node = ctx.nodes[node_index];
+    set_bounds(node, bounds);
+    const uint32_t count = end - begin;
+
+    auto make_leaf = [&] {
+        // Triangle range for now, converted to packets after the build.
+        node.first = begin;
+        node.count = count;
+    };
+
+    if (count <= MeshBVH::packet_width) {
+        make_leaf();
+        return;
+    }
+
+    int best_axis = -1;
+    uint32_t best_split = 0;
+    float best_cost = std::numeric_limits<float>::max();
+
+    if (depth < max_sah_depth) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent =
+                centroid_bounds.max[axis] - centroid_bounds.min[axis];
+            if (!(extent > 0.0f)) {
+                continue;
+            }
+            const float scale = bin_count / extent;
+
+            BoundingBox bin_bounds[bin_count];
+            uint32_t bin_counts[bin_count] = {};
+            for (uint32_t i = begin; i < end; ++i) {
+                const uint32_t t = ctx.order[i];
+                const uint32_t b = std::min(
+                    bin_count - 1,
+                    uint32_t(
+                        (ctx.centroids[t][axis] - centroid_bounds.min[axis]) *
+                        scale));
+                bin_counts[b]++;
+                bin_bounds[b].extend(ctx.boxes[t]);
+            }
+
+            float right_area[bin_count];
+            uint32_t right_count[bin_count];
+            BoundingBox accumulated;
+            uint32_t accumulated_count = 0;
+            for (uint32_t b = bin_count - 1; b > 0; --b) {
+                accumulated.extend(bin_bounds[b]);
+                accumulated_count += bin_counts[b];
+                right_area[b] = accumulated.surface_area();
+                right_count[b] = accumulated_count;
+            }
+
+            // Costs count packets, since that is the unit a leaf is tested in.
+            accumulated = BoundingBox();
+            accumulated_count = 0;
+            for (uint32_t b = 0; b + 1 < bin_count; ++b) {
+                accumulated.extend(bin_bounds[b]);
+                accumulated_count += bin_counts[b];
+                if (accumulated_count == 0 || right_count[b + 1] == 0) {
+                    continue;
+                }
+                const float cost =
+                    accumulated.surface_area() *
+                        packet_count(accumulated_count) +
+                    right_area[b + 1] * packet_count(right_count[b + 1]);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = b + 1;
+                }
+            }
+        }
+    }
+
+    const float leaf_cost = bounds.surface_area() * packet_count(count);
+    const float traversal_cost = bounds.surface_area();
+    if (best_axis >= 0 && best_cost + traversal_cost >= leaf_cost &&
+        count <= max_leaf_triangles) {
+        make_leaf();
+        return;
+    }
+
+    uint32_t mid = begin + count / 2;
+    if (best_axis >= 0) {
+        const float scale =
+            bin_count /
+            (centroid_bounds.max[best_axis] - centroid_bounds.min[best_axis]);
+        const float min = centroid_bounds.min[best_axis];
+        auto* split = std::partition(
+            ctx.order.data() + begin,
+            ctx.order.data() + end,
+            [&](uint32_t t) {
+                const uint32_t b = std::min(
+                    bin_count - 1,
+                    uint32_t((ctx.centroids[t][best_axis] - min) * scale));
+                return b < best_split;
+            });
+        mid = uint32_t(split - ctx.order.data());
+    }
+    else if (count <= max_leaf_triangles) {
+        // All centroids coincide or the depth limit was hit on a small node.
+        make_leaf();
+        return;
+    }
+    else {
+        int axis = 0;
+        const pxr::GfVec3f extent = centroid_bounds.max - centroid_bounds.min;
+        if (extent[1] > extent[axis]) {
+            axis = 1;
+        }
+        if (extent[2] > extent[axis]) {
+            axis = 2;
+        }
+        std::nth_element(
+            ctx.order.data() + begin,
+            ctx.order.data() + mid,
+            ctx.order.data() + end,
+            [&](uint32_t a, uint32_t b) {
+                return ctx.centroids[a][axis] < ctx.centroids[b][axis];
+            });
+    }
+
+    const uint32_t children = ctx.node_count.fetch_add(2);
+    node.first = children;
+    node.count = 0;
+
+    if (count > parallel_build_threshold) {
+        ctx.dispatcher.Run([&ctx, children, begin, mid, depth] {
+            build_node(ctx, children, begin, mid, depth + 1);
+        });
+    }
+    else {
+        build_node(ctx, children, begin, mid, depth + 1);
+    }
+    build_node(ctx, children + 1, mid, end, depth + 1);
+}
+
+}  // namespace
+
+MeshBVH::MeshBVH(
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const pxr::VtArray<int>& face_vertex_counts,
+    const pxr::VtArray<int>& face_vertex_indices)
+{
+    const int vertex_count = int(vertices.size());
+    size_t offset = 0;
+    for (size_t face = 0; face < face_vertex_counts.size(); ++face) {
+        const int n = face_vertex_counts[face];
+        if (n < 0 || offset + n > face_vertex_indices.size()) {
+            break;
+        }
+        for (int k = 1; k + 1 < n; ++k) {
+            const pxr::GfVec3i tri(
+                face_vertex_indices[offset],
+                face_vertex_indices[offset + k],
+                face_vertex_indices[offset + k + 1]);
+            bool valid = true;
+            for (int c = 0; c < 3; ++c) {
+                valid &= tri[c] >= 0 && tri[c] < vertex_count;
+            }
+            if (valid) {
+                triangles_.push_back(tri);
+                triangle_faces_.push_back(int(face));
+            }
+        }
+        offset += n;
+    }
+
+    build(vertices);
+}
+
+void MeshBVH::build(const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    const uint32_t n = uint32_t(triangles_.size());
+    nodes_.clear();
+    packets_.clear();
+    if (n == 0) {
+        return;
+    }
+
+    std::vector<BoundingBox> boxes(n);
+    std::vector<pxr::GfVec3f> centroids(n);
+    std::vector<uint32_t> order(n);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                BoundingBox box;
+                for (int c = 0; c < 3; ++c) {
+                    box.extend(vertices[triangles_[t][c]]);
+                }
+                boxes[t] = box;
+                centroids[t] = (box.min + box.max) * 0.5f;
+                order[t] = uint32_t(t);
+            }
+        },
+        1024);
+
+    nodes_.resize(2 * size_t(n));
+    {
+        BuildContext ctx{ boxes, centroids, order, nodes_ };
+        build_node(ctx, 0, 0, n, 0);
+        ctx.dispatcher.Wait();
+        nodes_.resize(ctx.node_count.load());
+    }
+
+    // Turn the triangle ranges of the leaves into packet ranges.
+    uint32_t packet_offset = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> leaf_ranges;
+    for (auto& node : nodes_) {
+        if (node.is_leaf()) {
+            leaf_ranges.emplace_back(node.first, node.count);
+            node.first = packet_offset;
+            node.count = packet_count(leaf_ranges.back().second);
+            packet_offset += node.count;
+        }
+    }
+
+    packets_.resize(packet_offset);
+    packet_offset = 0;
+    for (const auto& [first, count] : leaf_ranges) {
+        for (uint32_t i = 0; i < packet_count(count) * packet_width; ++i) {
+            packets_[packet_offset + i / packet_width]
+                .triangle[i % packet_width] =
+                order[first + std::min(i, count - 1)];
+        }
+        packet_offset += packet_count(count);
+    }
+
+    fill_packets(vertices);
+}
+
+void MeshBVH::fill_packets(const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    pxr::WorkParallelForN(
+        packets_.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                TrianglePacket& packet = packets_[p];
+                for (uint32_t lane = 0; lane < packet_width; ++lane) {
+                    const pxr::GfVec3i& tri = triangles_[packet.triangle[lane]];
+                    const pxr::GfVec3f& a = vertices[tri[0]];
+                    const pxr::GfVec3f e1 = vertices[tri[1]] - a;
+                    const pxr::GfVec3f e2 = vertices[tri[2]] - a;
+                    for (int k = 0; k < 3; ++k) {
+                        packet.v0[k][lane] = a[k];
+                        packet.e1[k][lane] = e1[k];
+                        packet.e2[k][lane] = e2[k];
+                    }
+                }
+            }
+        },
+        256);
+}
+
+void MeshBVH::refit(const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    if (nodes_.empty()) {
+        return;
+    }
+    fill_packets(vertices);
+
+    pxr::WorkParallelForN(
+        nodes_.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Node& node = nodes_[i];
+                if (!node.is_leaf()) {
+                    continue;
+                }
+                BoundingBox box;
+                for (uint32_t p = node.first; p < node.first + node.count;
+                     ++p) {
+                    for (uint32_t lane = 0; lane < packet_width; ++lane) {
+                        const pxr::GfVec3i& tri =
+                            triangles_[packets_[p].triangle[lane]];
+                        for (int c = 0; c < 3; ++c) {
+                            box.extend(vertices[tri[c]]);
+                        }
+                    }
+                }
+                set_bounds(node, box);
+            }
+        },
+        1024);
+
+    // Interior bounds, children before parents.
+    auto refit_interior = [&](auto&& self, uint32_t index) -> BoundingBox {
+        Node& node = nodes_[index];
+        if (node.is_leaf()) {
+            return node_bounds(node);
+        }
+        BoundingBox box = self(self, node.first);
+        box.extend(self(self, node.first + 1));
+        set_bounds(node, box);
+        return box;
+    };
+    refit_interior(refit_interior, 0);
+}
+
+std::shared_ptr<const MeshBVH> MeshBVH::update(
+    const std::shared_ptr<const MeshBVH>& previous,
+    const MeshComponent& mesh)
+{
+    const uint64_t topology = mesh.topology_hash();
+    const uint64_t positions = mesh.positions_hash();
+
+    if (previous && previous->topology_hash_ == topology) {
+        if (previous->positions_hash_ == positions) {
+            return previous;
+        }
+        auto refitted = std::make_shared<MeshBVH>(*previous);
+        refitted->refit(mesh.get_vertices());
+        refitted->positions_hash_ = positions;
+        return refitted;
+    }
+
+    auto bvh = std::make_shared<MeshBVH>(
+        mesh.get_vertices(),
+        mesh.get_face_vertex_counts(),
+        mesh.get_face_vertex_indices());
+    bvh->topology_hash_ = topology;
+    bvh->positions_hash_ = positions;
+    return bvh;
+}
+
+BoundingBox MeshBVH::bounds() const
+{
+    if (nodes_.empty()) {
+        return {};
+    }
+    return node_bounds(nodes_[0]);
+}
+
+RayHit MeshBVH::intersect_ray(
+    const pxr::GfVec3f& origin,
+    const pxr::GfVec3f& direction,
+    float max_distance) const
+{
+    RayHit hit;
+    if (nodes_.empty()) {
+        return hit;
+    }
+
+    const pxr::GfVec3f inv_direction(
+        1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]);
+    const F4 ox = set4(origin[0]), oy = set4(origin[1]), oz = set4(origin[2]);
+    const F4 dx = set4(direction[0]), dy = set4(direction[1]),
+             dz = set4(direction[2]);
+    const F4 zero = set4(0.0f), one = set4(1.0f);
+
+    float best = max_distance;
+    uint32_t stack[stack_size];
+    uint32_t stack_top = 0;
+    if (intersect_box(nodes_[0], origin, inv_direction, best) < best) {
+        stack[stack_top++] = 0;
+    }
+
+    while (stack_top > 0) {
+        const Node& node = nodes_[stack[--stack_top]];
+        if (node.is_leaf()) {
+            for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+                const TrianglePacket& packet = packets_[p];
+                const F4 e1x = load4(packet.e1[0]), e1y = load4(packet.e1[1]),
+                         e1z = load4(packet.e1[2]);
+                const F4 e2x = load4(packet.e2[0]), e2y = load4(packet.e2[1]),
+                         e2z = load4(packet.e2[2]);
+
+                // Moller-Trumbore on four triangles.
+                const F4 px = dy * e2z - dz * e2y;
+                const F4 py = dz * e2x - dx * e2z;
+                const F4 pz = dx * e2y - dy * e2x;
+                const F4 det = e1x * px + e1y * py + e1z * pz;
+                const F4 inv_det = one / det;
+
+                const F4 tx = ox - load4(packet.v0[0]);
+                const F4 ty = oy - load4(packet.v0[1]);
+                const F4 tz = oz - load4(packet.v0[2]);
+                const F4 u = (tx * px + ty * py + tz * pz) * inv_det;
+
+                const F4 qx = ty * e1z - tz * e1y;
+                const F4 qy = tz * e1x - tx * e1z;
+                const F4 qz = tx * e1y - ty * e1x;
+                const F4 v = (dx * qx + dy * qy + dz * qz) * inv_det;
+                const F4 t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+                const int mask =
+                    bits((det != zero) & (u >= zero) & (v >= zero) &
+                         (u + v <= one) & (t >= zero) & (t < set4(best)));
+                if (!mask) {
+                    continue;
+                }
+
+                float ts[4], us[4], vs[4];
+                store4(ts, t);
+                store4(us, u);
+                store4(vs, v);
+                for (int lane = 0; lane < 4; ++lane) {
+                    if ((mask & (1 << lane)) && ts[lane] < best) {
+                        best = ts[lane];
+                        hit.distance = ts[lane];
+                        hit.triangle = packet.triangle[lane];
+                        hit.u = us[lane];
+                        hit.v = vs[lane];
+                    }
+                }
+            }
+            continue;
+        }
+
+        const float t_left =
+            intersect_box(nodes_[node.first], origin, inv_direction, best);
+        const float t_right =
+            intersect_box(nodes_[node.first + 1], origin, inv_direction, best);
+        const bool hit_left = t_left < best;
+        const bool hit_right = t_right < best;
+        // Push the far child first so the near one is visited next.
+        if (hit_left && hit_right) {
+            const bool left_first = t_left <= t_right;
+            stack[stack_top++] = node.first + (left_first ? 1 : 0);
+            stack[stack_top++] = node.first + (left_first ? 0 : 1);
+        }
+        else if (hit_left) {
+            stack[stack_top++] = node.first;
+        }
+        else if (hit_right) {
+            stack[stack_top++] = node.first + 1;
+        }
+    }
+
+    if (hit.triangle != ~0u) {
+        hit.face = triangle_faces_[hit.triangle];
+    }
+    return hit;
+}
+
+ClosestPoint MeshBVH::closest_point(
+    const pxr::GfVec3f& query,
+    float max_distance) const
+{
+    ClosestPoint result;
+    if (nodes_.empty()) {
+        return result;
+    }
+
+    float best = max_distance < std::numeric_limits<float>::infinity()
+                     ? max_distance * max_distance
+                     : std::numeric_limits<float>::infinity();
+
+    struct Entry {
+        uint32_t node;
+        float distance_squared;
+    };
+    Entry stack[stack_size];
+    uint32_t stack_top = 0;
+    stack[stack_top++] = { 0, node_bounds(nodes_[0]).distance_squared(query) };
+
+    while (stack_top > 0) {
+        const Entry entry = stack[--stack_top];
+        if (entry.distance_squared > best) {
+            continue;
+        }
+        const Node& node = nodes_[entry.node];
+        if (node.is_leaf()) {
+            for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+                const TrianglePacket& packet = packets_[p];
+                for (int lane = 0; lane < int(packet_width); ++lane) {
+                    if (is_padding(packet, lane)) {
+                        continue;
+                    }
+                    pxr::GfVec3f a, b, c, barycentric;
+                    packet_triangle(packet, lane, a, b, c);
+                    const pxr::GfVec3f point =
+                        closest_on_triangle(query, a, b, c, barycentric);
+                    const pxr::GfVec3f d = point - query;
+                    const float d2 = pxr::GfDot(d, d);
+                    if (d2 <= best) {
+                        best = d2;
+                        result.point = point;
+                        result.distance_squared = d2;
+                        result.triangle = packet.triangle[lane];
+                        result.barycentric = barycentric;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const float d_left =
+            node_bounds(nodes_[node.first]).distance_squared(query);
+        const float d_right =
+            node_bounds(nodes_[node.first + 1]).distance_squared(query);
+        if (d_left <= d_right) {
+            stack[stack_top++] = { node.first + 1, d_right };
+            stack[stack_top++] = { node.first, d_left };
+        }
+        else {
+            stack[stack_top++] = { node.first, d_left };
+            stack[stack_top++] = { node.first + 1, d_right };
+        }
+    }
+
+    if (result.triangle != ~0u) {
+        result.face = triangle_faces_[result.triangle];
+    }
+    return result;
+}
+
+void MeshBVH::query_radius(
+    const pxr::GfVec3f& center,
+    float radius,
+    std::vector<uint32_t>& triangles) const
+{
+    if (nodes_.empty()) {
+        return;
+    }
+    const float radius2 = radius * radius;
+
+    uint32_t stack[stack_size];
+    uint32_t stack_top = 0;
+    stack[stack_top++] = 0;
+    while (stack_top > 0) {
+        const Node& node = nodes_[stack[--stack_top]];
+        if (node_bounds(node).distance_squared(center) > radius2) {
+            continue;
+        }
+        if (!node.is_leaf()) {
+            stack[stack_top++] = node.first + 1;
+            stack[stack_top++] = node.first;
+            continue;
+        }
+        for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+            const TrianglePacket& packet = packets_[p];
+            for (int lane = 0; lane < int(packet_width); ++lane) {
+                if (is_padding(packet, lane)) {
+                    continue;
+                }
+                pxr::GfVec3f a, b, c, barycentric;
+                packet_triangle(packet, lane, a, b, c);
+                const pxr::GfVec3f d =
+                    closest_on_triangle(center, a, b, c, barycentric) - center;
+                if (pxr::GfDot(d, d) <= radius2) {
+                    triangles.push_back(packet.triangle[lane]);
+                }
+            }
+        }
+    }
+}
+
+void MeshBVH::query_box(
+    const BoundingBox& box,
+    std::vector<uint32_t>& triangles) const
+{
+    if (nodes_.empty()) {
+        return;
+    }
+
+    uint32_t stack[stack_size];
+    uint32_t stack_top = 0;
+    stack[stack_top++] = 0;
+    while (stack_top > 0) {
+        const Node& node = nodes_[stack[--stack_top]];
+        if (!node_bounds(node).overlaps(box)) {
+            continue;
+        }
+        if (!node.is_leaf()) {
+            stack[stack_top++] = node.first + 1;
+            stack[stack_top++] = node.first;
+            continue;
+        }
+        for (uint32_t p = node.first; p < node.first + node.count; ++p) {
+            const TrianglePacket& packet = packets_[p];
+            for (int lane = 0; lane < int(packet_width); ++lane) {
+                if (is_padding(packet, lane)) {
+                    continue;
+                }
+                pxr::GfVec3f a, b, c;
+                packet_triangle(packet, lane, a, b, c);
+                BoundingBox triangle_box;
+                triangle_box.extend(a);
+                triangle_box.extend(b);
+                triangle_box.extend(c);
+                if (triangle_box.overlaps(box)) {
+                    triangles.push_back(packet.triangle[lane]);
+                }
+            }
+        }
+    }
+}
+
+void MeshBVH::intersect_rays(
+    const pxr::GfVec3f* origins,
+    const pxr::GfVec3f* directions,
+    size_t count,
+    RayHit* hits,
+    float max_distance) const
+{
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                hits[i] =
+                    intersect_ray(origins[i], directions[i], max_distance);
+            }
+        },
+        64);
+}
+
+void MeshBVH::closest_points(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    ClosestPoint* results,
+    float max_distance) const
+{
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = closest_point(queries[i], max_distance);
+            }
+        },
+        64);
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,354 @@
+#include "GCore/Algorithms/cross_field.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseCore>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+using Complex = std::complex<double>;
+
+constexpr size_t grain_size = 1024;
+constexpr double pi = 3.14159265358979323846;
+
+bool same_options(const CrossFieldOptions& a, const CrossFieldOptions& b)
+{
+    return a.symmetry == b.symmetry && a.solve == b.solve &&
+           a.boundary_weight == b.boundary_weight &&
+           a.tolerance == b.tolerance && a.max_iterations == b.max_iterations;
+}
+
+struct Frame {
+    pxr::GfVec3d centroid = pxr::GfVec3d(0.0);
+    pxr::GfVec3d normal = pxr::GfVec3d(0.0);
+    pxr::GfVec3d x = pxr::GfVec3d(0.0);
+    pxr::GfVec3d y = pxr::GfVec3d(0.0);
+    double area = 0.0;
+};
+
+// Newell normal of the polygon, and x along its first edge that is not
+// parallel to it.
+Frame face_frame(const pxr::GfVec3f* x, const uint32_t* c, uint32_t m)
+{
+    Frame frame;
+    pxr::GfVec3d normal(0.0);
+    for (uint32_t k = 0; k < m; ++k) {
+        const pxr::GfVec3d p(x[c[k]]);
+        const pxr::GfVec3d q(x[c[(k + 1) % m]]);
+        frame.centroid += p;
+        normal += pxr::GfCross(p, q);
+    }
+    frame.centroid /= m;
+    frame.area = 0.5 * normal.Normalize();
+    if (frame.area <= 0.0) {
+        normal = pxr::GfVec3d(0, 0, 1);
+    }
+    frame.normal = normal;
+    for (uint32_t k = 0; k < m; ++k) {
+        pxr::GfVec3d edge =
+            pxr::GfVec3d(x[c[(k + 1) % m]]) - pxr::GfVec3d(x[c[k]]);
+        edge -= pxr::GfDot(edge, normal) * normal;
+        if (edge.Normalize() > 0.0) {
+            frame.x = edge;
+            break;
+        }
+    }
+    if (frame.x == pxr::GfVec3d(0.0)) {
+        const pxr::GfVec3d axis = std::abs(normal[0]) < 0.9
+                                      ? pxr::GfVec3d(1, 0, 0)
+                                      : pxr::GfVec3d(0, 1, 0);
+        frame.x = pxr::GfCross(normal, axis).GetNormalized();
+    }
+    frame.y = pxr::GfCross(normal, frame.x);
+    return frame;
+}
+
+// The N-th power of the direction of v in the tangent frame, 1 when v has
+// no tangential part.
+Complex power(const Frame& frame, const pxr::GfVec3d& v, int n)
+{
+    const Complex z(pxr::GfDot(v, frame.x), pxr::GfDot(v, frame.y));
+    return z == 0.0 ? Complex(1.0) : std::polar(1.0, n * std::arg(z));
+}
+
+// Calls visit(g) for every face g other than f that has a and b as
+// consecutive corners. Both vertex face lists are sorted.
+template<typename Visit>
+void for_each_edge_face(
+    const MeshAdjacency& adjacency,
+    uint32_t f,
+    uint32_t a,
+    uint32_t b,
+    const Visit& visit)
+{
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    const std::vector<uint32_t>& corners = adjacency.corner_vertices();
+    const uint32_t* i = vertex_faces.begin(a);
+    const uint32_t* j = vertex_faces.begin(b);
+    while (i != vertex_faces.end(a) && j != vertex_faces.end(b)) {
+        if (*i < *j) {
+            ++i;
+            continue;
+        }
+        if (*j < *i) {
+            ++j;
+            continue;
+        }
+        const uint32_t g = *i;
+        ++i;
+        ++j;
+        if (g == f) {
+            continue;
+        }
+        const uint32_t* c = corners.data() + offsets[g];
+        const uint32_t m = offsets[g + 1] - offsets[g];
+        for (uint32_t k = 0; k < m; ++k) {
+            const uint32_t p = c[k];
+            const uint32_t q = c[(k + 1) % m];
+            if ((p == a && q == b) || (p == b && q == a)) {
+                visit(g);
+                break;
+            }
+        }
+    }
+}
+}  // namespace
+
+CrossField::CrossField(
+    std::shared_ptr<const MeshAdjacency> adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const CrossFieldOptions& options)
+    : adjacency_(std::move(adjacency)),
+      options_(options)
+{
+    if (vertices.size() != adjacency_->vertex_count()) {
+        throw std::invalid_argument(
+            "CrossField: vertex count does not match the adjacency.");
+    }
+    if (options_.symmetry < 1) {
+        throw std::invalid_argument("CrossField: symmetry must be positive.");
+    }
+    const size_t n = adjacency_->face_count();
+    const int symmetry = options_.symmetry;
+    const std::vector<uint32_t>& offsets = adjacency_->face_offsets();
+    const std::vector<uint32_t>& corners = adjacency_->corner_vertices();
+    const pxr::GfVec3f* x = vertices.cdata();
+    frames_.symmetry = symmetry;
+    if (n == 0) {
+        return;
+    }
+
+    // 1. Tangent frames.
+    std::vector<Frame> frames(n);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                frames[f] = face_frame(
+                    x,
+                    corners.data() + offsets[f],
+                    offsets[f + 1] - offsets[f]);
+            }
+        },
+        grain_size);
+
+    // 2. One row per interior edge, written by the face with the smaller
+    // index, and one per boundary edge unless no constraints are wanted.
+    // The rows of a face are counted in a first pass and written in a
+    // second one.
+    const bool constrained =
+        options_.solve == CrossFieldSolve::boundary_aligned;
+    const double weight = options_.boundary_weight;
+    auto rows = [&](uint32_t f, const auto& smooth, const auto& boundary) {
+        const uint32_t* c = corners.data() + offsets[f];
+        const uint32_t m = offsets[f + 1] - offsets[f];
+        for (uint32_t k = 0; k < m; ++k) {
+            const uint32_t a = c[k];
+            const uint32_t b = c[(k + 1) % m];
+            const pxr::GfVec3d edge =
+                pxr::GfVec3d(x[b]) - pxr::GfVec3d(x[a]);
+            bool shared = false;
+            for_each_edge_face(*adjacency_, f, a, b, [&](uint32_t g) {
+                shared = true;
+                if (g > f) {
+                    smooth(g, edge);
+                }
+            });
+            if (!shared && constrained) {
+                boundary(pxr::GfCross(edge, frames[f].normal));
+            }
+        }
+    };
+    std::vector<uint32_t> row_counts(n + 1, 0);
+    std::vector<uint32_t> entry_counts(n + 1, 0);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                uint32_t row_count = 0, entry_count = 0;
+                rows(
+                    f,
+                    [&](uint32_t, const pxr::GfVec3d&) {
+                        ++row_count;
+                        entry_count += 2;
+                    },
+                    [&](const pxr::GfVec3d&) {
+                        ++row_count;
+                        ++entry_count;
+                    });
+                row_counts[f + 1] = row_count;
+                entry_counts[f + 1] = entry_count;
+            }
+        },
+        grain_size);
+    for (size_t f = 0; f < n; ++f) {
+        row_counts[f + 1] += row_counts[f];
+        entry_counts[f + 1] += entry_counts[f];
+    }
+    const uint32_t row_total = row_counts[n];
+    // Interior rows have two entries, boundary rows one.
+    const size_t boundary_rows = 2 * size_t(row_total) - entry_counts[n];
+
+    using RowMatrix = Eigen::SparseMatrix<Complex, Eigen::RowMajor>;
+    RowMatrix matrix(row_total, n);
+    matrix.resizeNonZeros(entry_counts[n]);
+    int* outer = matrix.outerIndexPtr();
+    int* inner = matrix.innerIndexPtr();
+    Complex* values = matrix.valuePtr();
+    outer[row_total] = static_cast<int>(entry_counts[n]);
+    Eigen::VectorXcd rhs = Eigen::VectorXcd::Zero(row_total);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                uint32_t row = row_counts[f];
+                uint32_t entry = entry_counts[f];
+                rows(
+                    f,
+                    [&](uint32_t g, const pxr::GfVec3d& edge) {
+                        outer[row++] = static_cast<int>(entry);
+                        inner[entry] = static_cast<int>(f);
+                        values[entry++] =
+                            std::conj(power(frames[f], edge, symmetry));
+                        inner[entry] = static_cast<int>(g);
+                        values[entry++] =
+                            -std::conj(power(frames[g], edge, symmetry));
+                    },
+                    [&](const pxr::GfVec3d& across) {
+                        rhs[row] = weight * power(frames[f], across, symmetry);
+                        outer[row++] = static_cast<int>(entry);
+                        inner[entry] = static_cast<int>(f);
+                        values[entry++] = weight;
+                    });
+            }
+        },
+        grain_size);
+
+    // 3. u = z^N per face.
+    Eigen::SparseMatrix<Complex> normal = matrix.adjoint() * matrix;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<Complex>> solver;
+    Eigen::VectorXcd u;
+    if (constrained && boundary_rows > 0) {
+        solver.compute(normal);
+        if (solver.info() != Eigen::Success) {
+            throw std::runtime_error("CrossField: factorization failed.");
+        }
+        u = solver.solve(matrix.adjoint() * rhs);
+    }
+    else {
+        // Inverse iteration on (A^H A + shift M) u = M u_previous with the
+        // face areas M; the small shift makes the matrix definite when the
+        // energy has a null space, e.g. a constant field on a plane.
+        Eigen::VectorXd mass(n);
+        double total_area = 0.0;
+        for (size_t f = 0; f < n; ++f) {
+            mass[f] = frames[f].area > 0.0 ? frames[f].area : 1e-12;
+            total_area += mass[f];
+        }
+        mass /= total_area / n;
+        const double trace = normal.diagonal().real().sum();
+        const double shift = trace > 0.0 ? 1e-8 * trace / n : 1.0;
+        normal.diagonal() += (shift * mass).cast<Complex>();
+        solver.compute(normal);
+        if (solver.info() != Eigen::Success) {
+            throw std::runtime_error("CrossField: factorization failed.");
+        }
+        // Spread start phases, so no eigenvector is missed by symmetry.
+        u.resize(n);
+        for (size_t f = 0; f < n; ++f) {
+            u[f] = std::polar(1.0, 2.399963229728653 * f);
+        }
+        auto mass_norm = [&](const Eigen::VectorXcd& v) {
+            return std::sqrt((v.cwiseAbs2().cwiseProduct(mass)).sum());
+        };
+        u /= mass_norm(u);
+        const Eigen::VectorXcd weights = mass.cast<Complex>();
+        for (iterations_ = 0; iterations_ < options_.max_iterations;) {
+            Eigen::VectorXcd next = solver.solve(weights.cwiseProduct(u));
+            next /= mass_norm(next);
+            ++iterations_;
+            const double alignment =
+                std::abs(u.dot(weights.cwiseProduct(next)));
+            u = std::move(next);
+            if (1.0 - alignment < options_.tolerance) {
+                break;
+            }
+        }
+    }
+
+    // 4. The N directions from the N-th root.
+    frames_.centroids.resize(n);
+    frames_.normals.resize(n);
+    frames_.directions.resize(n * symmetry);
+    pxr::GfVec3f* centroids = frames_.centroids.data();
+    pxr::GfVec3f* normals = frames_.normals.data();
+    pxr::GfVec3f* directions = frames_.directions.data();
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                const Frame& frame = frames[f];
+                centroids[f] = pxr::GfVec3f(frame.centroid);
+                normals[f] = pxr::GfVec3f(frame.normal);
+                const double angle =
+                    u[f] == 0.0 ? 0.0 : std::arg(u[f]) / symmetry;
+                for (int k = 0; k < symmetry; ++k) {
+                    const double phi = angle + 2 * pi * k / symmetry;
+                    directions[f * symmetry + k] = pxr::GfVec3f(
+                        std::cos(phi) * frame.x + std::sin(phi) * frame.y);
+                }
+            }
+        },
+        grain_size);
+}
+
+std::shared_ptr<const CrossField> CrossField::update(
+    const std::shared_ptr<const CrossField>& previous,
+    const MeshComponent& mesh,
+    const CrossFieldOptions& options)
+{
+    auto adjacency = MeshAdjacency::update(
+        previous ? previous->adjacency_ : nullptr, mesh);
+    const uint64_t positions = mesh.positions_hash();
+    if (previous && previous->adjacency_ == adjacency &&
+        previous->positions_hash_ == positions &&
+        same_options(previous->options_, options)) {
+        return previous;
+    }
+    auto field = std::make_shared<CrossField>(
+        std::move(adjacency), mesh.get_vertices(), options);
+    field->positions_hash_ = positions;
+    return field;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
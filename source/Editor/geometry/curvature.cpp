@@ -0,0 +1,221 @@
+#include "GCore/Algorithms/curvature.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+constexpr float pi = 3.14159265358979f;
+
+// The three corners of triangle f, starting at vertex v.
+struct Corner {
+    uint32_t p, q, r;
+};
+
+Corner corner_of(const MeshAdjacency& adjacency, uint32_t f, uint32_t v)
+{
+    const uint32_t* c =
+        adjacency.corner_vertices().data() + adjacency.face_offsets()[f];
+    if (c[0] == v) {
+        return { c[0], c[1], c[2] };
+    }
+    if (c[1] == v) {
+        return { c[1], c[2], c[0] };
+    }
+    return { c[2], c[0], c[1] };
+}
+
+// Unit vector orthogonal to n.
+pxr::GfVec3f any_tangent(const pxr::GfVec3f& n)
+{
+    const pxr::GfVec3f axis = std::abs(n[0]) < 0.6f ? pxr::GfVec3f(1, 0, 0)
+                              : std::abs(n[1]) < 0.6f ? pxr::GfVec3f(0, 1, 0)
+                                                      : pxr::GfVec3f(0, 0, 1);
+    return pxr::GfCross(n, axis).GetNormalized();
+}
+
+// Direction of the larger eigenvalue of the shape operator fitted to the
+// normal curvatures along the edges from v, in the tangent frame (t1, t2).
+// The trace is fixed to 2h as in Meyer et al., leaving B = [[a, b], [b, 2h -
+// a]]; an edge in direction (c, s) gives a(c^2 - s^2) + b(2cs) = kappa -
+// 2h s^2, solved in the least squares sense.
+pxr::GfVec3f fit_max_direction(
+    const MeshAdjacency& adjacency,
+    const NeighborLists& vertex_faces,
+    const pxr::GfVec3f* positions,
+    uint32_t v,
+    bool boundary,
+    float h,
+    const pxr::GfVec3f& n,
+    const pxr::GfVec3f& t1,
+    const pxr::GfVec3f& t2)
+{
+    float m00 = 0.0f, m01 = 0.0f, m11 = 0.0f, r0 = 0.0f, r1 = 0.0f;
+    auto add_edge = [&](const pxr::GfVec3f& d) {
+        const float u = pxr::GfDot(d, t1);
+        const float w = pxr::GfDot(d, t2);
+        const float tangent2 = u * u + w * w;
+        if (tangent2 <= 0.0f) {
+            return;
+        }
+        const float kappa = -2.0f * pxr::GfDot(d, n) / pxr::GfDot(d, d);
+        const float x = (u * u - w * w) / tangent2;
+        const float y = 2.0f * u * w / tangent2;
+        const float rhs = kappa - 2.0f * h * w * w / tangent2;
+        m00 += x * x;
+        m01 += x * y;
+        m11 += y * y;
+        r0 += x * rhs;
+        r1 += y * rhs;
+    };
+    // Around an interior vertex the edges to the next corner cover the one
+    // ring once; a boundary vertex also needs the edge to the previous one.
+    for (const uint32_t* f = vertex_faces.begin(v); f != vertex_faces.end(v);
+         ++f) {
+        const Corner c = corner_of(adjacency, *f, v);
+        add_edge(positions[c.q] - positions[c.p]);
+        if (boundary) {
+            add_edge(positions[c.r] - positions[c.p]);
+        }
+    }
+
+    const float det = m00 * m11 - m01 * m01;
+    if (det <= 1e-6f * m00 * m11) {
+        return t1;
+    }
+    const float a = (r0 * m11 - r1 * m01) / det;
+    const float b = (r1 * m00 - r0 * m01) / det;
+    // Eigenvector of [[a, b], [b, 2h - a]] for the larger eigenvalue.
+    const float angle = 0.5f * std::atan2(2.0f * b, 2.0f * a - 2.0f * h);
+    return std::cos(angle) * t1 + std::sin(angle) * t2;
+}
+}  // namespace
+
+MeshCurvature compute_curvature(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    bool principal_directions)
+{
+    const size_t vertex_count = adjacency.vertex_count();
+    if (vertices.size() != vertex_count) {
+        throw std::invalid_argument(
+            "compute_curvature: vertex count does not match the adjacency.");
+    }
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    for (size_t f = 0; f < adjacency.face_count(); ++f) {
+        if (offsets[f + 1] - offsets[f] != 3) {
+            throw std::invalid_argument(
+                "compute_curvature: only triangle meshes are supported.");
+        }
+    }
+
+    MeshCurvature result;
+    result.mean.resize(vertex_count);
+    result.gaussian.resize(vertex_count);
+    result.max.resize(vertex_count);
+    result.min.resize(vertex_count);
+    if (principal_directions) {
+        result.max_direction.resize(vertex_count);
+        result.min_direction.resize(vertex_count);
+    }
+
+    const pxr::GfVec3f* positions = vertices.cdata();
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    const uint8_t* boundary = adjacency.boundary_vertices().data();
+    float* mean = result.mean.data();
+    float* gaussian = result.gaussian.data();
+    float* max = result.max.data();
+    float* min = result.min.data();
+    pxr::GfVec3f* max_direction = result.max_direction.data();
+    pxr::GfVec3f* min_direction = result.min_direction.data();
+
+    pxr::WorkParallelForN(
+        vertex_count,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                float area = 0.0f;
+                float angle_sum = 0.0f;
+                pxr::GfVec3f laplacian(0.0f);
+                pxr::GfVec3f normal(0.0f);
+                for (const uint32_t* f = vertex_faces.begin(v);
+                     f != vertex_faces.end(v);
+                     ++f) {
+                    const Corner c = corner_of(adjacency, *f, v);
+                    const pxr::GfVec3f eq = positions[c.q] - positions[c.p];
+                    const pxr::GfVec3f er = positions[c.r] - positions[c.p];
+                    const pxr::GfVec3f eqr = positions[c.r] - positions[c.q];
+                    const pxr::GfVec3f cross = pxr::GfCross(eq, er);
+                    const float double_area = cross.GetLength();
+                    if (double_area <= 0.0f) {
+                        continue;
+                    }
+                    const float dot_p = pxr::GfDot(eq, er);
+                    const float dot_q = -pxr::GfDot(eq, eqr);
+                    const float dot_r = pxr::GfDot(er, eqr);
+                    const float cot_q = dot_q / double_area;
+                    const float cot_r = dot_r / double_area;
+
+                    // Mixed area: the Voronoi region for non obtuse
+                    // triangles, a fixed share of the triangle otherwise.
+                    if (dot_p < 0.0f) {
+                        area += 0.25f * double_area;
+                    }
+                    else if (dot_q < 0.0f || dot_r < 0.0f) {
+                        area += 0.125f * double_area;
+                    }
+                    else {
+                        area += 0.125f * (pxr::GfDot(er, er) * cot_q +
+                                          pxr::GfDot(eq, eq) * cot_r);
+                    }
+                    angle_sum += std::atan2(double_area, dot_p);
+                    laplacian += cot_r * eq + cot_q * er;
+                    normal += cross;
+                }
+
+                const float normal_length = normal.GetLength();
+                if (area <= 0.0f || normal_length <= 0.0f) {
+                    mean[v] = gaussian[v] = max[v] = min[v] = 0.0f;
+                    if (principal_directions) {
+                        max_direction[v] = min_direction[v] =
+                            pxr::GfVec3f(0.0f);
+                    }
+                    continue;
+                }
+                const pxr::GfVec3f n = normal / normal_length;
+                const float h = -pxr::GfDot(laplacian, n) / (4.0f * area);
+                const float k =
+                    ((boundary[v] ? pi : 2.0f * pi) - angle_sum) / area;
+                const float spread = std::sqrt(std::max(h * h - k, 0.0f));
+                mean[v] = h;
+                gaussian[v] = k;
+                max[v] = h + spread;
+                min[v] = h - spread;
+
+                if (principal_directions) {
+                    const pxr::GfVec3f t1 = any_tangent(n);
+                    const pxr::GfVec3f t2 = pxr::GfCross(n, t1);
+                    const pxr::GfVec3f d = fit_max_direction(
+                        adjacency,
+                        vertex_faces,
+                        positions,
+                        v,
+                        boundary[v],
+                        h,
+                        n,
+                        t1,
+                        t2);
+                    max_direction[v] = d;
+                    min_direction[v] = pxr::GfCross(n, d);
+                }
+            }
+        },
+        grain_size);
+    return result;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
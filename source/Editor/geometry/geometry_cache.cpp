@@ -0,0 +1,648 @@
+#include "GCore/IO/geometry_cache.h"
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "GCore/Components/CurveComponent.h"
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/Components/PointsComponent.h"
+#include "GCore/Components/XformComponent.h"
+#include "GCore/IO/binary_stream.h"
+#include "GCore/IO/mapped_file.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+constexpr char magic[8] = { 'G', 'C', 'C', 'A', 'C', 'H', 'E', '\0' };
+constexpr uint32_t byte_order_mark = 0x01020304u;
+constexpr size_t alignment = 64;
+
+enum ElementType : uint16_t {
+    element_none = 0,
+    element_int = 1,
+    element_float = 2,
+    element_vec2f = 3,
+    element_vec3f = 4,
+};
+
+template<typename T>
+constexpr ElementType element_type_of();
+template<>
+constexpr ElementType element_type_of<int>()
+{
+    return element_int;
+}
+template<>
+constexpr ElementType element_type_of<float>()
+{
+    return element_float;
+}
+template<>
+constexpr ElementType element_type_of<pxr::GfVec2f>()
+{
+    return element_vec2f;
+}
+template<>
+constexpr ElementType element_type_of<pxr::GfVec3f>()
+{
+    return element_vec3f;
+}
+
+size_t align_up(size_t offset)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+[[noreturn]] void fail(const std::string& message)
+{
+    throw std::runtime_error("Geometry cache: " + message);
+}
+
+// Collects the entries and keeps the arrays alive until they are written.
+class CacheBuilder {
+   public:
+    void begin_component(uint32_t component, const char* kind)
+    {
+        component_ = component;
+        kind_ = name(kind);
+        add_entry("component", nullptr, element_none, 0, nullptr, 0);
+    }
+
+    template<typename T>
+    void add(const char* attribute, const pxr::VtArray<T>& array)
+    {
+        add(attribute, nullptr, array);
+    }
+
+    template<typename T>
+    void add(
+        const char* attribute,
+        const std::string* quantity,
+        const pxr::VtArray<T>& array)
+    {
+        if (array.empty()) {
+            return;
+        }
+        auto held = std::make_shared<pxr::VtArray<T>>(array);
+        arrays_.push_back(held);
+        add_entry(
+            attribute,
+            quantity,
+            element_type_of<T>(),
+            sizeof(T),
+            held->cdata(),
+            held->size());
+    }
+
+    template<typename T>
+    void add_quantities(
+        const char* attribute,
+        const std::vector<std::string>& names,
+        const std::function<pxr::VtArray<T>(const std::string&)>& get)
+    {
+        for (const auto& quantity : names) {
+            add(attribute, &quantity, get(quantity));
+        }
+    }
+
+    void write(const std::filesystem::path& path, uint32_t component_count)
+    {
+        GeometryCacheHeader header = {};
+        std::memcpy(header.magic, magic, sizeof(magic));
+        header.version = geometry_cache_version;
+        header.byte_order = byte_order_mark;
+        header.component_count = component_count;
+        header.entry_count = uint32_t(entries_.size());
+        header.names_offset =
+            sizeof(header) + entries_.size() * sizeof(GeometryCacheEntry);
+        header.names_size = names_.size();
+        size_t offset = align_up(header.names_offset + names_.size());
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            entries_[i].data_offset = offset;
+            const size_t bytes = entries_[i].count * entries_[i].element_size;
+            offset = align_up(offset + bytes);
+        }
+        header.file_size = offset;
+
+        BinaryWriter out(path);
+        out.write_bytes(&header, sizeof(header));
+        out.write_bytes(
+            entries_.data(), entries_.size() * sizeof(GeometryCacheEntry));
+        out.write_bytes(names_.data(), names_.size());
+        size_t written = header.names_offset + names_.size();
+        static const char zeros[alignment] = {};
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const size_t bytes = entries_[i].count * entries_[i].element_size;
+            if (bytes == 0) {
+                continue;
+            }
+            out.write_bytes(zeros, entries_[i].data_offset - written);
+            out.write_bytes(data_[i], bytes);
+            written = entries_[i].data_offset + bytes;
+        }
+        out.write_bytes(zeros, header.file_size - written);
+        out.finish();
+    }
+
+   private:
+    uint32_t name(const std::string& text)
+    {
+        auto it = name_offsets_.find(text);
+        if (it != name_offsets_.end()) {
+            return it->second;
+        }
+        const uint32_t offset = uint32_t(names_.size());
+        names_.append(text).push_back('\0');
+        name_offsets_.emplace(text, offset);
+        return offset;
+    }
+
+    void add_entry(
+        const char* attribute,
+        const std::string* quantity,
+        ElementType type,
+        size_t element_size,
+        const void* data,
+        size_t count)
+    {
+        GeometryCacheEntry entry = {};
+        entry.component = component_;
+        entry.element_type = type;
+        entry.element_size = uint16_t(element_size);
+        entry.kind_offset = kind_;
+        entry.attribute_offset = name(attribute);
+        entry.name_offset = quantity ? name(*quantity) : geometry_cache_no_name;
+        entry.count = count;
+        entries_.push_back(entry);
+        data_.push_back(data);
+    }
+
+    uint32_t component_ = 0;
+    uint32_t kind_ = 0;
+    std::vector<GeometryCacheEntry> entries_;
+    std::vector<const void*> data_;
+    std::vector<std::shared_ptr<const void>> arrays_;
+    std::string names_;
+    std::map<std::string, uint32_t> name_offsets_;
+};
+
+template<typename T>
+pxr::VtArray<T> to_array(const std::vector<T>& values)
+{
+    return pxr::VtArray<T>(values.begin(), values.end());
+}
+
+void add_mesh(CacheBuilder& builder, const MeshComponent& mesh)
+{
+    builder.add("vertices", mesh.get_vertices());
+    builder.add("face_vertex_counts", mesh.get_face_vertex_counts());
+    builder.add("face_vertex_indices", mesh.get_face_vertex_indices());
+    builder.add("normals", mesh.get_normals());
+    builder.add("display_color", mesh.get_display_color());
+    builder.add("texcoords", mesh.get_texcoords_array());
+
+    builder.add_quantities<float>(
+        "vertex_scalar_quantities",
+        mesh.get_vertex_scalar_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_vertex_scalar_quantity(name);
+        });
+    builder.add_quantities<float>(
+        "face_scalar_quantities",
+        mesh.get_face_scalar_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_face_scalar_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec3f>(
+        "vertex_color_quantities",
+        mesh.get_vertex_color_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_vertex_color_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec3f>(
+        "face_color_quantities",
+        mesh.get_face_color_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_face_color_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec3f>(
+        "vertex_vector_quantities",
+        mesh.get_vertex_vector_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_vertex_vector_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec3f>(
+        "face_vector_quantities",
+        mesh.get_face_vector_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_face_vector_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec2f>(
+        "face_corner_parameterization_quantities",
+        mesh.get_face_corner_parameterization_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_face_corner_parameterization_quantity(name);
+        });
+    builder.add_quantities<pxr::GfVec2f>(
+        "vertex_parameterization_quantities",
+        mesh.get_vertex_parameterization_quantity_names(),
+        [&](const std::string& name) {
+            return mesh.get_vertex_parameterization_quantity(name);
+        });
+}
+
+void add_points(CacheBuilder& builder, const PointsComponent& points)
+{
+    builder.add("vertices", points.get_vertices());
+    builder.add("display_color", points.get_display_color());
+    builder.add("width", points.get_width());
+}
+
+void add_curve(CacheBuilder& builder, const CurveComponent& curve)
+{
+    builder.add("vertices", curve.get_vertices());
+    builder.add("width", curve.get_width());
+    builder.add("vert_count", curve.get_vert_count());
+    builder.add("display_color", curve.get_display_color());
+    builder.add("curve_normals", curve.get_curve_normals());
+    builder.add("periodic", pxr::VtArray<int>(1, curve.get_periodic()));
+}
+
+void add_xform(CacheBuilder& builder, const XformComponent& xform)
+{
+    builder.add("translation", to_array(xform.translation));
+    builder.add("scale", to_array(xform.scale));
+    builder.add("rotation", to_array(xform.rotation));
+}
+
+// Foreign data source that owns the mapping. VtArray reference counts it
+// and calls detached() once the last array pointing into the file is gone.
+class MappedArraySource : public pxr::Vt_ArrayForeignDataSource {
+   public:
+    explicit MappedArraySource(MappedFile file)
+        : pxr::Vt_ArrayForeignDataSource(detached),
+          file_(std::move(file))
+    {
+    }
+
+    const MappedFile& file() const
+    {
+        return file_;
+    }
+
+   private:
+    static void detached(pxr::Vt_ArrayForeignDataSource* self)
+    {
+        delete static_cast<MappedArraySource*>(self);
+    }
+
+    MappedFile file_;
+};
+
+class CacheReader {
+   public:
+    explicit CacheReader(MappedFile file)
+    {
+        const char* data = file.data();
+        const size_t size = file.size();
+        if (size < sizeof(GeometryCacheHeader)) {
+            fail("file too small");
+        }
+        std::memcpy(&header_, data, sizeof(header_));
+        if (std::memcmp(header_.magic, magic, sizeof(magic)) != 0) {
+            fail("not a geometry cache");
+        }
+        if (header_.version != geometry_cache_version) {
+            fail("unsupported version " + std::to_string(header_.version));
+        }
+        if (header_.byte_order != byte_order_mark) {
+            fail("written on a machine with different byte order");
+        }
+        const size_t directory_end =
+            sizeof(header_) +
+            size_t(header_.entry_count) * sizeof(GeometryCacheEntry);
+        if (header_.file_size != size ||
+            header_.names_offset != directory_end ||
+            header_.names_offset + header_.names_size > size) {
+            fail("truncated or corrupt");
+        }
+        entries_.resize(header_.entry_count);
+        std::memcpy(
+            entries_.data(),
+            data + sizeof(header_),
+            entries_.size() * sizeof(GeometryCacheEntry));
+        names_ = std::string_view(
+            data + header_.names_offset, header_.names_size);
+        for (const auto& entry : entries_) {
+            const size_t element_size = std::max<size_t>(entry.element_size, 1);
+            if (entry.data_offset % alignment != 0 ||
+                entry.data_offset > size ||
+                entry.count > (size - entry.data_offset) / element_size ||
+                entry.component >= header_.component_count) {
+                fail("truncated or corrupt");
+            }
+        }
+        // Owned by the arrays from here on, see MappedArraySource.
+        source_ = new MappedArraySource(std::move(file));
+    }
+
+    const GeometryCacheHeader& header() const
+    {
+        return header_;
+    }
+
+    const std::vector<GeometryCacheEntry>& entries() const
+    {
+        return entries_;
+    }
+
+    std::string name(uint32_t offset) const
+    {
+        if (offset == geometry_cache_no_name) {
+            return {};
+        }
+        const size_t end = names_.find('\0', offset);
+        if (offset >= names_.size() || end == std::string_view::npos) {
+            fail("bad name offset");
+        }
+        return std::string(names_.substr(offset, end - offset));
+    }
+
+    template<typename T>
+    pxr::VtArray<T> array(const GeometryCacheEntry& entry) const
+    {
+        if (entry.element_type != element_type_of<T>() ||
+            entry.element_size != sizeof(T)) {
+            fail(
+                "unexpected element type for " +
+                name(entry.attribute_offset));
+        }
+        T* data = reinterpret_cast<T*>(
+            const_cast<char*>(source_->file().data()) + entry.data_offset);
+        return pxr::VtArray<T>(source_, data, entry.count);
+    }
+
+    // Keeps the source alive while the Geometry is assembled, even when no
+    // or only copied arrays (xform vectors) have been created yet.
+    pxr::VtArray<char> keep_alive() const
+    {
+        return pxr::VtArray<char>(
+            source_, const_cast<char*>(source_->file().data()), 1);
+    }
+
+   private:
+    GeometryCacheHeader header_;
+    std::vector<GeometryCacheEntry> entries_;
+    std::string_view names_;
+    MappedArraySource* source_ = nullptr;
+};
+
+template<typename T>
+std::vector<T> to_vector(const pxr::VtArray<T>& array)
+{
+    return std::vector<T>(array.begin(), array.end());
+}
+
+struct MeshQuantities {
+    std::map<std::string, pxr::VtArray<float>> vertex_scalar;
+    std::map<std::string, pxr::VtArray<float>> face_scalar;
+    std::map<std::string, pxr::VtArray<pxr::GfVec3f>> vertex_color;
+    std::map<std::string, pxr::VtArray<pxr::GfVec3f>> face_color;
+    std::map<std::string, pxr::VtArray<pxr::GfVec3f>> vertex_vector;
+    std::map<std::string, pxr::VtArray<pxr::GfVec3f>> face_vector;
+    std::map<std::string, pxr::VtArray<pxr::GfVec2f>> face_corner_uv;
+    std::map<std::string, pxr::VtArray<pxr::GfVec2f>> vertex_uv;
+
+    void apply(MeshComponent& mesh) const
+    {
+        mesh.set_vertex_scalar_quantities(vertex_scalar);
+        mesh.set_face_scalar_quantities(face_scalar);
+        mesh.set_vertex_color_quantities(vertex_color);
+        mesh.set_face_color_quantities(face_color);
+        mesh.set_vertex_vector_quantities(vertex_vector);
+        mesh.set_face_vector_quantities(face_vector);
+        mesh.set_face_corner_parameterization_quantities(face_corner_uv);
+        mesh.set_vertex_parameterization_quantities(vertex_uv);
+    }
+};
+
+void read_mesh_entry(
+    const CacheReader& reader,
+    const GeometryCacheEntry& entry,
+    MeshComponent& mesh,
+    MeshQuantities& quantities)
+{
+    const std::string attribute = reader.name(entry.attribute_offset);
+    const std::string quantity = reader.name(entry.name_offset);
+    if (attribute == "vertices") {
+        mesh.set_vertices(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "face_vertex_counts") {
+        mesh.set_face_vertex_counts(reader.array<int>(entry));
+    }
+    else if (attribute == "face_vertex_indices") {
+        mesh.set_face_vertex_indices(reader.array<int>(entry));
+    }
+    else if (attribute == "normals") {
+        mesh.set_normals(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "display_color") {
+        mesh.set_display_color(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "texcoords") {
+        mesh.set_texcoords_array(reader.array<pxr::GfVec2f>(entry));
+    }
+    else if (attribute == "vertex_scalar_quantities") {
+        quantities.vertex_scalar[quantity] = reader.array<float>(entry);
+    }
+    else if (attribute == "face_scalar_quantities") {
+        quantities.face_scalar[quantity] = reader.array<float>(entry);
+    }
+    else if (attribute == "vertex_color_quantities") {
+        quantities.vertex_color[quantity] = reader.array<pxr::GfVec3f>(entry);
+    }
+    else if (attribute == "face_color_quantities") {
+        quantities.face_color[quantity] = reader.array<pxr::GfVec3f>(entry);
+    }
+    else if (attribute == "vertex_vector_quantities") {
+        quantities.vertex_vector[quantity] =
+            reader.array<pxr::GfVec3f>(entry);
+    }
+    else if (attribute == "face_vector_quantities") {
+        quantities.face_vector[quantity] = reader.array<pxr::GfVec3f>(entry);
+    }
+    else if (attribute == "face_corner_parameterization_quantities") {
+        quantities.face_corner_uv[quantity] =
+            reader.array<pxr::GfVec2f>(entry);
+    }
+    else if (attribute == "vertex_parameterization_quantities") {
+        quantities.vertex_uv[quantity] = reader.array<pxr::GfVec2f>(entry);
+    }
+}
+
+void read_points_entry(
+    const CacheReader& reader,
+    const GeometryCacheEntry& entry,
+    PointsComponent& points)
+{
+    const std::string attribute = reader.name(entry.attribute_offset);
+    if (attribute == "vertices") {
+        points.set_vertices(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "display_color") {
+        points.set_display_color(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "width") {
+        points.set_width(reader.array<float>(entry));
+    }
+}
+
+void read_curve_entry(
+    const CacheReader& reader,
+    const GeometryCacheEntry& entry,
+    CurveComponent& curve)
+{
+    const std::string attribute = reader.name(entry.attribute_offset);
+    if (attribute == "vertices") {
+        curve.set_vertices(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "width") {
+        curve.set_width(reader.array<float>(entry));
+    }
+    else if (attribute == "vert_count") {
+        curve.set_vert_count(reader.array<int>(entry));
+    }
+    else if (attribute == "display_color") {
+        curve.set_display_color(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "curve_normals") {
+        curve.set_curve_normals(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "periodic") {
+        const auto flag = reader.array<int>(entry);
+        curve.set_periodic(!flag.empty() && flag[0] != 0);
+    }
+}
+
+void read_xform_entry(
+    const CacheReader& reader,
+    const GeometryCacheEntry& entry,
+    XformComponent& xform)
+{
+    const std::string attribute = reader.name(entry.attribute_offset);
+    if (attribute == "translation") {
+        xform.translation = to_vector(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "scale") {
+        xform.scale = to_vector(reader.array<pxr::GfVec3f>(entry));
+    }
+    else if (attribute == "rotation") {
+        xform.rotation = to_vector(reader.array<pxr::GfVec3f>(entry));
+    }
+}
+
+}  // namespace
+
+void write_geometry_cache(
+    const Geometry& geometry,
+    const std::filesystem::path& path)
+{
+    CacheBuilder builder;
+    uint32_t component_count = 0;
+    for (const auto& component : geometry.get_components()) {
+        if (auto mesh = std::dynamic_pointer_cast<MeshComponent>(component)) {
+            builder.begin_component(component_count++, "mesh");
+            add_mesh(builder, *mesh);
+        }
+        else if (
+            auto points =
+                std::dynamic_pointer_cast<PointsComponent>(component)) {
+            builder.begin_component(component_count++, "points");
+            add_points(builder, *points);
+        }
+        else if (
+            auto curve = std::dynamic_pointer_cast<CurveComponent>(component)) {
+            builder.begin_component(component_count++, "curve");
+            add_curve(builder, *curve);
+        }
+        else if (
+            auto xform = std::dynamic_pointer_cast<XformComponent>(component)) {
+            builder.begin_component(component_count++, "xform");
+            add_xform(builder, *xform);
+        }
+    }
+    builder.write(path, component_count);
+}
+
+Geometry read_geometry_cache(const std::filesystem::path& path)
+{
+    CacheReader reader{ MappedFile(path) };
+    const auto keep_alive = reader.keep_alive();
+
+    Geometry geometry;
+    std::vector<GeometryComponentHandle> components(
+        reader.header().component_count);
+    std::vector<MeshQuantities> quantities(components.size());
+    for (const auto& entry : reader.entries()) {
+        const std::string kind = reader.name(entry.kind_offset);
+        auto& component = components[entry.component];
+        if (!component) {
+            if (kind == "mesh") {
+                component = std::make_shared<MeshComponent>(&geometry);
+            }
+            else if (kind == "points") {
+                component = std::make_shared<PointsComponent>(&geometry);
+            }
+            else if (kind == "curve") {
+                component = std::make_shared<CurveComponent>(&geometry);
+            }
+            else if (kind == "xform") {
+                component = std::make_shared<XformComponent>(&geometry);
+            }
+            else {
+                // Written by a newer version; skip what we do not know.
+                continue;
+            }
+        }
+        if (auto mesh = std::dynamic_pointer_cast<MeshComponent>(component)) {
+            read_mesh_entry(reader, entry, *mesh, quantities[entry.component]);
+        }
+        else if (
+            auto points =
+                std::dynamic_pointer_cast<PointsComponent>(component)) {
+            read_points_entry(reader, entry, *points);
+        }
+        else if (
+            auto curve = std::dynamic_pointer_cast<CurveComponent>(component)) {
+            read_curve_entry(reader, entry, *curve);
+        }
+        else if (
+            auto xform = std::dynamic_pointer_cast<XformComponent>(component)) {
+            read_xform_entry(reader, entry, *xform);
+        }
+    }
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (!components[i]) {
+            continue;
+        }
+        auto mesh = std::dynamic_pointer_cast<MeshComponent>(components[i]);
+        if (mesh) {
+            quantities[i].apply(*mesh);
+        }
+        geometry.attach_component(components[i]);
+    }
+    return geometry;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
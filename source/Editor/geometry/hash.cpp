@@ -0,0 +1,198 @@
+#include "GCore/Algorithms/hash.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+constexpr uint64_t prime32_1 = 0x9E3779B1u;
+constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t prime64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t prime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t prime64_5 = 0x27D4EB2F165667C5ull;
+
+constexpr size_t stripe_size = 64;
+constexpr size_t stripes_per_block = 16;
+constexpr size_t secret_count = 24;
+
+// Arbitrary constants, the key material of the hash. Changing them changes
+// every hash value.
+constexpr uint64_t secret[secret_count] = {
+    0xBE4BA423396CFEB8ull, 0x1CAD21F72C81017Cull, 0xDB979083E96DD4DEull,
+    0x1F67B3B7A4A44072ull, 0x78E5C0CC4EE679CBull, 0x2172FFCC7DD05A82ull,
+    0x8E2443F7744608B8ull, 0x4C263A81E69035E0ull, 0xCB00C391BB52283Cull,
+    0xA32E531B8B65D088ull, 0x4EF90DA297486471ull, 0xD8ACDEA946EF1938ull,
+    0x3F349CE33F76FAA8ull, 0x1D4F0BC7C7BBDCF9ull, 0x3159B4CD4BE0518Aull,
+    0x647378D9C97E9FC8ull, 0xC3EBD33483ACC5EAull, 0xEB6313FAFFA081C5ull,
+    0x49DAF0B751DD0D17ull, 0x9E68D429265516D3ull, 0xFCA1477D58BE162Bull,
+    0xCE31D07AD1B8F88Full, 0x280416958F3ACB45ull, 0x7E404BBBCAFBD7AFull,
+};
+
+inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t mul_fold64(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    return uint64_t(product) ^ uint64_t(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t high;
+    const uint64_t low = _umul128(a, b, &high);
+    return low ^ high;
+#else
+    const uint64_t a_lo = a & 0xFFFFFFFFull, a_hi = a >> 32;
+    const uint64_t b_lo = b & 0xFFFFFFFFull, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo;
+    const uint64_t hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi;
+    const uint64_t hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFull) + lo_hi;
+    const uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const uint64_t lower = (cross << 32) | (lo_lo & 0xFFFFFFFFull);
+    return lower ^ upper;
+#endif
+}
+
+inline uint64_t avalanche(uint64_t h)
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+// Inputs up to one stripe: fold 16 byte pairs against the secret.
+uint64_t hash_short(const uint8_t* p, size_t size, uint64_t seed)
+{
+    uint64_t acc = seed ^ (size * prime64_1);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const size_t k = i / 8;
+        acc += mul_fold64(
+            read64(p + i) ^ (secret[k] + seed),
+            read64(p + i + 8) ^ (secret[k + 1] - seed));
+    }
+    if (i < size) {
+        uint8_t tail[16] = {};
+        std::memcpy(tail, p + i, size - i);
+        const size_t k = i / 8;
+        acc += mul_fold64(
+            read64(tail) ^ (secret[k] + seed),
+            read64(tail + 8) ^ (secret[k + 1] - seed));
+    }
+    return avalanche(acc);
+}
+
+inline void
+accumulate_stripe(uint64_t* acc, const uint8_t* p, const uint64_t* key)
+{
+    // Written as a plain loop over the eight lanes, compilers turn this into
+    // 256-bit integer code on AVX2 targets.
+    for (int i = 0; i < 8; ++i) {
+        const uint64_t value = read64(p + 8 * i);
+        const uint64_t keyed = value ^ key[i];
+        acc[i ^ 1] += value;
+        acc[i] += (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+    }
+}
+
+inline void scramble(uint64_t* acc, const uint64_t* key)
+{
+    for (int i = 0; i < 8; ++i) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= key[i];
+        acc[i] = a * prime32_1;
+    }
+}
+
+uint64_t hash_long(const uint8_t* p, size_t size, uint64_t seed)
+{
+    uint64_t acc[8] = { prime32_1, prime64_1, prime64_2, prime64_3,
+                        prime64_4, prime32_1 ^ seed, prime64_5, prime32_1 };
+
+    // Per-stripe keys slide along the secret as in XXH3, seeded copies are
+    // derived once.
+    uint64_t keys[stripes_per_block + 1][8];
+    for (size_t s = 0; s <= stripes_per_block; ++s) {
+        for (int i = 0; i < 8; ++i) {
+            const uint64_t k = secret[(s + i) % secret_count];
+            keys[s][i] = (i & 1) ? k - seed : k + seed;
+        }
+    }
+
+    const size_t stripe_count = (size - 1) / stripe_size;
+    const size_t block_count = stripe_count / stripes_per_block;
+    for (size_t b = 0; b < block_count; ++b) {
+        const uint8_t* block = p + b * stripes_per_block * stripe_size;
+        for (size_t s = 0; s < stripes_per_block; ++s) {
+            accumulate_stripe(acc, block + s * stripe_size, keys[s]);
+        }
+        scramble(acc, keys[stripes_per_block]);
+    }
+
+    const size_t done = block_count * stripes_per_block;
+    for (size_t s = 0; s < stripe_count - done; ++s) {
+        accumulate_stripe(acc, p + (done + s) * stripe_size, keys[s]);
+    }
+    // The last stripe always ends at the last byte and may overlap the
+    // previous one, which keeps the tail handling branch free.
+    accumulate_stripe(acc, p + size - stripe_size, keys[stripes_per_block]);
+
+    uint64_t result = size * prime64_1 + seed;
+    for (int i = 0; i < 4; ++i) {
+        result += mul_fold64(
+            acc[2 * i] ^ secret[8 + 2 * i], acc[2 * i + 1] ^ secret[9 + 2 * i]);
+    }
+    return avalanche(result);
+}
+
+uint64_t hash_serial(const uint8_t* p, size_t size, uint64_t seed)
+{
+    if (size <= stripe_size) {
+        return hash_short(p, size, seed);
+    }
+    return hash_long(p, size, seed);
+}
+
+}  // namespace
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    if (size <= hash_chunk_size) {
+        return hash_serial(p, size, seed);
+    }
+
+    const size_t chunk_count = (size + hash_chunk_size - 1) / hash_chunk_size;
+    std::vector<uint64_t> chunk_hashes(chunk_count);
+    pxr::WorkParallelForN(chunk_count, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            const size_t offset = c * hash_chunk_size;
+            const size_t length = std::min(hash_chunk_size, size - offset);
+            chunk_hashes[c] = hash_serial(p + offset, length, seed + c);
+        }
+    });
+
+    return hash_serial(
+        reinterpret_cast<const uint8_t*>(chunk_hashes.data()),
+        chunk_count * sizeof(uint64_t),
+        hash_combine(seed, size));
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,196 @@
+#include "GCore/Algorithms/heat_geodesic.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "GCore/Algorithms/laplacian.h"
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+
+double mean_edge_length(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    const std::vector<uint32_t>& corners = adjacency.corner_vertices();
+    double sum = 0.0;
+    for (size_t c = 0; c < corners.size(); c += 3) {
+        for (int k = 0; k < 3; ++k) {
+            sum += (vertices[corners[c + k]] -
+                    vertices[corners[c + (k + 1) % 3]])
+                       .GetLength();
+        }
+    }
+    return corners.empty() ? 0.0 : sum / corners.size();
+}
+
+template<typename Solver>
+void factorize(Solver& solver, const Eigen::SparseMatrix<double>& matrix)
+{
+    solver.compute(matrix);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error("HeatGeodesic: factorization failed.");
+    }
+}
+}  // namespace
+
+HeatGeodesic::HeatGeodesic(
+    std::shared_ptr<const MeshAdjacency> adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    double time_scale)
+    : adjacency_(std::move(adjacency)),
+      vertices_(vertices),
+      time_scale_(time_scale)
+{
+    const Eigen::SparseMatrix<double> stiffness =
+        cotangent_laplacian(*adjacency_, vertices_);
+    Eigen::VectorXd mass = barycentric_mass(*adjacency_, vertices_);
+    const double h = mean_edge_length(*adjacency_, vertices_);
+    time_ = time_scale_ * h * h;
+
+    // Vertices outside every triangle would leave both systems singular;
+    // give them an identity row, their distance is meaningless anyway.
+    Eigen::VectorXd isolated = (mass.array() <= 0.0).cast<double>();
+
+    Eigen::SparseMatrix<double> heat = time_ * stiffness;
+    heat.diagonal() += mass + isolated;
+    factorize(heat_, heat);
+
+    // C is only semidefinite. A mass term far below the stiffness picks
+    // one solution among those differing by a constant, which the source
+    // shift below removes again.
+    const double epsilon = h > 0.0 ? 1e-8 / (h * h) : 1e-8;
+    Eigen::SparseMatrix<double> poisson = stiffness;
+    poisson.diagonal() += epsilon * mass + isolated;
+    factorize(poisson_, poisson);
+}
+
+std::shared_ptr<const HeatGeodesic> HeatGeodesic::update(
+    const std::shared_ptr<const HeatGeodesic>& previous,
+    const MeshComponent& mesh,
+    double time_scale)
+{
+    auto adjacency = MeshAdjacency::update(
+        previous ? previous->adjacency_ : nullptr, mesh);
+    const uint64_t positions = mesh.positions_hash();
+    if (previous && previous->adjacency_ == adjacency &&
+        previous->positions_hash_ == positions &&
+        previous->time_scale_ == time_scale) {
+        return previous;
+    }
+    auto geodesic = std::make_shared<HeatGeodesic>(
+        std::move(adjacency), mesh.get_vertices(), time_scale);
+    geodesic->positions_hash_ = positions;
+    return geodesic;
+}
+
+std::vector<pxr::VtArray<float>> HeatGeodesic::distances(
+    const std::vector<std::vector<uint32_t>>& source_sets) const
+{
+    const size_t n = vertex_count();
+    std::vector<size_t> columns;
+    for (size_t set = 0; set < source_sets.size(); ++set) {
+        for (uint32_t s : source_sets[set]) {
+            if (s >= n) {
+                throw std::invalid_argument(
+                    "HeatGeodesic: source index out of range.");
+            }
+        }
+        if (!source_sets[set].empty()) {
+            columns.push_back(set);
+        }
+    }
+    std::vector<pxr::VtArray<float>> result(source_sets.size());
+    if (columns.empty()) {
+        return result;
+    }
+    const Eigen::Index k = static_cast<Eigen::Index>(columns.size());
+
+    // 1. Heat flow from unit impulses at the sources.
+    Eigen::MatrixXd impulses = Eigen::MatrixXd::Zero(n, k);
+    for (Eigen::Index c = 0; c < k; ++c) {
+        for (uint32_t s : source_sets[columns[c]]) {
+            impulses(s, c) = 1.0;
+        }
+    }
+    const Eigen::MatrixXd heat = heat_.solve(impulses);
+
+    // 2. Integrated divergence of the normalized, negated heat gradient X:
+    // sum over the triangles around v of area * dot(X, grad phi_v), where
+    // area * grad phi_v = N x (x_r - x_q) / 2 for the corners (v, q, r).
+    const NeighborLists& vertex_faces = adjacency_->vertex_faces();
+    const std::vector<uint32_t>& offsets = adjacency_->face_offsets();
+    const std::vector<uint32_t>& corners = adjacency_->corner_vertices();
+    Eigen::MatrixXd divergence(n, k);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            Eigen::VectorXd sum(k);
+            for (size_t v = begin; v < end; ++v) {
+                sum.setZero();
+                for (const uint32_t* f = vertex_faces.begin(v);
+                     f != vertex_faces.end(v);
+                     ++f) {
+                    const uint32_t* c = corners.data() + offsets[*f];
+                    const int at = c[0] == v ? 0 : c[1] == v ? 1 : 2;
+                    const uint32_t q = c[(at + 1) % 3];
+                    const uint32_t r = c[(at + 2) % 3];
+                    const pxr::GfVec3d xv(vertices_[v]);
+                    const pxr::GfVec3d xq(vertices_[q]);
+                    const pxr::GfVec3d xr(vertices_[r]);
+                    pxr::GfVec3d normal = pxr::GfCross(xq - xv, xr - xv);
+                    if (normal.Normalize() <= 0.0) {
+                        continue;
+                    }
+                    const pxr::GfVec3d ev = pxr::GfCross(normal, xr - xq);
+                    const pxr::GfVec3d eq = pxr::GfCross(normal, xv - xr);
+                    const pxr::GfVec3d er = pxr::GfCross(normal, xq - xv);
+                    for (Eigen::Index col = 0; col < k; ++col) {
+                        // Proportional to the heat gradient; only its
+                        // direction is used.
+                        const pxr::GfVec3d gradient = heat(v, col) * ev +
+                                                      heat(q, col) * eq +
+                                                      heat(r, col) * er;
+                        const double length = gradient.GetLength();
+                        if (length > 0.0) {
+                            sum[col] -=
+                                0.5 * pxr::GfDot(gradient, ev) / length;
+                        }
+                    }
+                }
+                divergence.row(v) = sum.transpose();
+            }
+        },
+        grain_size);
+
+    // 3. The distance whose gradient best matches X, shifted to be zero at
+    // the closest source.
+    const Eigen::MatrixXd phi = poisson_.solve(divergence);
+    for (Eigen::Index c = 0; c < k; ++c) {
+        double shift = std::numeric_limits<double>::infinity();
+        for (uint32_t s : source_sets[columns[c]]) {
+            shift = std::min(shift, phi(s, c));
+        }
+        pxr::VtArray<float> values(n);
+        for (size_t v = 0; v < n; ++v) {
+            values[v] = static_cast<float>(phi(v, c) - shift);
+        }
+        result[columns[c]] = std::move(values);
+    }
+    return result;
+}
+
+pxr::VtArray<float> HeatGeodesic::distance(
+    const std::vector<uint32_t>& sources) const
+{
+    return distances({ sources }).front();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCholesky>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// Pose of an as-rigid-as-possible deformation, kept by the caller between
+// calls to ArapDeformation::deform so that every call continues from the
+// previous one. Default constructed, it starts from the rest shape.
+struct ArapState {
+    pxr::VtArray<pxr::GfVec3f> positions;
+    std::vector<Eigen::Matrix3d> rotations;
+};
+
+// As-rigid-as-possible surface deformation (Sorkine and Alexa 2007) of a
+// triangle mesh with some vertices moved to targets. Alternates a local
+// step, fitting a rotation to the cotangent weighted edges around every
+// vertex, with a global step, solving the cotangent Laplacian of the free
+// vertices for the positions closest to the rotated rest edges.
+//
+// The Laplacian only depends on the rest shape and on which vertices are
+// controlled, so it is factored once on construction and every iteration
+// costs one parallel pass over the edges plus one triangular solve for the
+// three coordinates together. The rotations come from a closed form 3x3
+// SVD instead of an iterative one.
+class GEOMETRY_API ArapDeformation {
+   public:
+    // Throws std::invalid_argument for meshes that are not triangle meshes,
+    // for an empty control set and for control indices that are out of
+    // range or repeated, and std::runtime_error when the factorization
+    // fails, e.g. for a component without controls.
+    ArapDeformation(
+        std::shared_ptr<const MeshAdjacency> adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& rest,
+        std::vector<uint32_t> controls);
+
+    // Returns `previous` when it was built for the same topology, rest
+    // positions and controls, and a new factorization otherwise. The
+    // adjacency of `previous` is reused when the topology did not change.
+    static std::shared_ptr<const ArapDeformation> update(
+        const std::shared_ptr<const ArapDeformation>& previous,
+        const MeshComponent& mesh,
+        const std::vector<uint32_t>& controls);
+
+    // Runs `iterations` local-global iterations with control k at
+    // targets[k], starting from `state` (the rest shape when it does not
+    // match the mesh). Vertices outside every triangle stay at rest.
+    // Throws std::invalid_argument when the target count does not match.
+    void deform(
+        const std::vector<pxr::GfVec3f>& targets,
+        ArapState& state,
+        int iterations = 4) const;
+
+    [[nodiscard]] const std::vector<uint32_t>& controls() const
+    {
+        return controls_;
+    }
+
+   private:
+    std::shared_ptr<const MeshAdjacency> adjacency_;
+    pxr::VtArray<pxr::GfVec3f> rest_;
+    std::vector<uint32_t> controls_;
+    // Cotangent Laplacian of the whole mesh; its columns give the edge
+    // weights around each vertex.
+    Eigen::SparseMatrix<double> laplacian_;
+    // Index of each vertex among the free vertices, -1 when it is a control
+    // or outside every triangle.
+    std::vector<int> free_index_;
+    std::vector<uint32_t> free_vertices_;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> cholesky_;
+    uint64_t positions_hash_ = 0;
+};
+
+// Linear maps fitted to every triangle of a parameterization.
+enum class ArapFit {
+    rigid,       // Rotations (ARAP).
+    similarity,  // Rotations with a uniform scale (ASAP).
+};
+
+struct ArapParameterizationOptions {
+    int max_iterations = 100;
+    // Iterations stop once one lowers the energy by less than this fraction.
+    double tolerance = 1e-6;
+};
+
+// Local-global parameterization of a triangle mesh (Liu et al. 2008).
+// Every triangle gets an isometric 2D frame; the local step fits the
+// rotation (or similarity) closest to the map from that frame to the
+// current UVs, the global step solves the cotangent Laplacian for the UVs
+// closest to the fitted maps. The energy is
+// sum_t area_t |J_t - L_t|_F^2, J_t the Jacobian of triangle t.
+//
+// The frames, cotangent weights and the factored Laplacian only depend on
+// the surface, so they are built once on construction. Frames and weights
+// are kept as structure of arrays and the 2x2 fits have a closed form
+// without trigonometry or an SVD, so the local step is a few SIMD array
+// operations per block of triangles. The global step solves both
+// coordinates with one triangular sweep.
+//
+// One vertex per connected component is pinned to its initial UV for
+// rigid fits; similarity fits pin two, as their energy also vanishes when
+// a component shrinks to a point.
+class GEOMETRY_API ArapParameterization {
+   public:
+    // Throws std::invalid_argument for meshes that are not triangle meshes
+    // and std::runtime_error when the factorization fails.
+    ArapParameterization(
+        std::shared_ptr<const MeshAdjacency> adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        ArapFit fit = ArapFit::rigid);
+
+    // Returns `previous` when it was built for the same topology, positions
+    // and fit, and a new factorization otherwise. The adjacency of
+    // `previous` is reused when the topology did not change.
+    static std::shared_ptr<const ArapParameterization> update(
+        const std::shared_ptr<const ArapParameterization>& previous,
+        const MeshComponent& mesh,
+        ArapFit fit);
+
+    // Runs local-global iterations from the flat UVs `uv`, e.g. a Tutte
+    // embedding, until the energy converges, and returns the energy after
+    // each iteration. Vertices outside every triangle keep their UV. Throws
+    // std::invalid_argument when `uv` does not have one entry per vertex.
+    std::vector<double> solve(
+        pxr::VtArray<pxr::GfVec2f>& uv,
+        const ArapParameterizationOptions& options = {}) const;
+
+    [[nodiscard]] ArapFit fit() const
+    {
+        return fit_;
+    }
+
+    [[nodiscard]] const std::vector<uint32_t>& pinned() const
+    {
+        return pinned_;
+    }
+
+   private:
+    std::shared_ptr<const MeshAdjacency> adjacency_;
+    ArapFit fit_;
+    // Edge k of triangle t runs from corner k to corner k + 1; edge_x_[k][t]
+    // and edge_y_[k][t] are its coordinates in the frame of the triangle and
+    // weights_[k][t] the cotangent of the angle opposite to it.
+    std::array<std::vector<double>, 3> edge_x_, edge_y_, weights_;
+    // sum_k weights_[k][t] |e_k|^2, four times the area of the triangle.
+    std::vector<double> norms_;
+    // Cotangent Laplacian of the whole mesh; its pinned columns move to the
+    // right hand side.
+    Eigen::SparseMatrix<double> laplacian_;
+    // Pinned vertices, including those outside every triangle.
+    std::vector<uint32_t> pinned_;
+    // Laplacian with the pinned rows and columns replaced by identity.
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> cholesky_;
+    uint64_t positions_hash_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
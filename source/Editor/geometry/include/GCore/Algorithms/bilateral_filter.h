@@ -0,0 +1,55 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Bilateral normal filtering for mesh denoising (Zheng et al. 2011, local
+// iterative scheme): face normals are smoothed with weights that fall off
+// with the distance between face centroids (sigma_c) and with the difference
+// between normals (sigma_s), then vertices are moved to fit the filtered
+// normals. Works on any polygon mesh; faces use their Newell normal and
+// vertex average centroid.
+//
+// Spatial weights are computed once, each normal iteration is a parallel,
+// double buffered pass over the face neighborhoods and each vertex iteration
+// a parallel gather over the faces around every vertex.
+struct BilateralFilterSettings {
+    FaceNeighborhood neighborhood = FaceNeighborhood::edge;
+    // Normal range, on the distance between unit normals.
+    float sigma_s = 0.1f;
+    // sigma_c is this times the average distance between the centroids of
+    // faces sharing an edge.
+    float multiple_sigma_c = 1.0f;
+    int normal_iterations = 1;
+    int vertex_iterations = 10;
+    bool fixed_boundary = true;
+};
+
+// Filtered unit normal of every face. Throws std::invalid_argument unless
+// sigma_s and multiple_sigma_c are positive.
+GEOMETRY_API pxr::VtArray<pxr::GfVec3f> filter_face_normals(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const BilateralFilterSettings& settings);
+
+// Moves the vertices so that the faces match `normals`.
+GEOMETRY_API pxr::VtArray<pxr::GfVec3f> fit_vertices_to_normals(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const pxr::VtArray<pxr::GfVec3f>& normals,
+    int iterations,
+    bool fixed_boundary);
+
+// Both steps; returns the new vertex positions. Throws like
+// filter_face_normals.
+GEOMETRY_API pxr::VtArray<pxr::GfVec3f> bilateral_normal_filter(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const BilateralFilterSettings& settings);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
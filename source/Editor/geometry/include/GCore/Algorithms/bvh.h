@@ -0,0 +1,237 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec3i.h>
+#include <pxr/base/vt/array.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+struct BoundingBox {
+    pxr::GfVec3f min = pxr::GfVec3f(std::numeric_limits<float>::max());
+    pxr::GfVec3f max = pxr::GfVec3f(-std::numeric_limits<float>::max());
+
+    void extend(const pxr::GfVec3f& p)
+    {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], p[i]);
+            max[i] = std::max(max[i], p[i]);
+        }
+    }
+
+    void extend(const BoundingBox& box)
+    {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], box.min[i]);
+            max[i] = std::max(max[i], box.max[i]);
+        }
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return min[0] > max[0] || min[1] > max[1] || min[2] > max[2];
+    }
+
+    [[nodiscard]] bool overlaps(const BoundingBox& box) const
+    {
+        return min[0] <= box.max[0] && box.min[0] <= max[0] &&
+               min[1] <= box.max[1] && box.min[1] <= max[1] &&
+               min[2] <= box.max[2] && box.min[2] <= max[2];
+    }
+
+    [[nodiscard]] float surface_area() const
+    {
+        if (empty()) {
+            return 0.0f;
+        }
+        const pxr::GfVec3f d = max - min;
+        return 2.0f * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    [[nodiscard]] float distance_squared(const pxr::GfVec3f& p) const
+    {
+        float result = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            const float d = std::max({ min[i] - p[i], 0.0f, p[i] - max[i] });
+            result += d * d;
+        }
+        return result;
+    }
+};
+
+struct RayHit {
+    float distance = std::numeric_limits<float>::infinity();
+    uint32_t triangle = ~0u;
+    // Face of the source mesh, -1 when nothing was hit.
+    int face = -1;
+    // Barycentric coordinates of the hit with respect to the second and
+    // third triangle vertex.
+    float u = 0.0f;
+    float v = 0.0f;
+
+    explicit operator bool() const
+    {
+        return face >= 0;
+    }
+};
+
+struct ClosestPoint {
+    pxr::GfVec3f point = pxr::GfVec3f(0.0f);
+    float distance_squared = std::numeric_limits<float>::infinity();
+    uint32_t triangle = ~0u;
+    int face = -1;
+    pxr::GfVec3f barycentric = pxr::GfVec3f(0.0f);
+
+    explicit operator bool() const
+    {
+        return face >= 0;
+    }
+};
+
+// Bounding volume hierarchy over the triangles of a polygon mesh (faces are
+// fan triangulated).
+//
+// Built top-down with a binned SAH, with subtrees above a size threshold built
+// in parallel. Nodes are 32 bytes and the two children of an interior node
+// are stored next to each other, so a node only needs one child index. Leaf
+// triangles are stored in packets of four in SoA layout, ray and distance
+// tests run on a whole packet at once (SSE on x86-64, NEON on aarch64).
+//
+// A MeshBVH is immutable once built and safe to query from many threads.
+// Use MeshBVH::update (or MeshComponent::get_bvh) to get a tree for new
+// positions: with unchanged topology the old tree is copied and refit instead
+// of rebuilt.
+class GEOMETRY_API MeshBVH {
+   public:
+    static constexpr uint32_t packet_width = 4;
+
+    struct Node {
+        float min[3];
+        // Interior: index of the left child, the right child follows it.
+        // Leaf: index of the first triangle packet.
+        uint32_t first;
+        float max[3];
+        // Number of triangle packets, 0 for interior nodes.
+        uint32_t count;
+
+        [[nodiscard]] bool is_leaf() const
+        {
+            return count != 0;
+        }
+    };
+    static_assert(sizeof(Node) == 32);
+
+    struct TrianglePacket {
+        float v0[3][packet_width];
+        float e1[3][packet_width];
+        float e2[3][packet_width];
+        // Short leaves are padded by repeating their last triangle.
+        uint32_t triangle[packet_width];
+    };
+
+    MeshBVH(
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const pxr::VtArray<int>& face_vertex_counts,
+        const pxr::VtArray<int>& face_vertex_indices);
+
+    // Returns `previous` when it was built for the same data, a refit copy of
+    // it when only the positions changed, and a new tree otherwise.
+    static std::shared_ptr<const MeshBVH> update(
+        const std::shared_ptr<const MeshBVH>& previous,
+        const MeshComponent& mesh);
+
+    // Recomputes packet positions and node bounds for new vertex positions.
+    // The tree structure is kept, so quality degrades under large motion.
+    void refit(const pxr::VtArray<pxr::GfVec3f>& vertices);
+
+    [[nodiscard]] RayHit intersect_ray(
+        const pxr::GfVec3f& origin,
+        const pxr::GfVec3f& direction,
+        float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    [[nodiscard]] ClosestPoint closest_point(
+        const pxr::GfVec3f& query,
+        float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    // Appends the triangles within `radius` of `center`.
+    void query_radius(
+        const pxr::GfVec3f& center,
+        float radius,
+        std::vector<uint32_t>& triangles) const;
+
+    // Appends the triangles whose bounding box overlaps `box`.
+    void query_box(const BoundingBox& box, std::vector<uint32_t>& triangles)
+        const;
+
+    // Batched queries, parallel over the queries.
+    void intersect_rays(
+        const pxr::GfVec3f* origins,
+        const pxr::GfVec3f* directions,
+        size_t count,
+        RayHit* hits,
+        float max_distance = std::numeric_limits<float>::infinity()) const;
+    void closest_points(
+        const pxr::GfVec3f* queries,
+        size_t count,
+        ClosestPoint* results,
+        float max_distance = std::numeric_limits<float>::infinity()) const;
+
+    [[nodiscard]] size_t triangle_count() const
+    {
+        return triangles_.size();
+    }
+
+    [[nodiscard]] const pxr::GfVec3i& triangle(uint32_t index) const
+    {
+        return triangles_[index];
+    }
+
+    [[nodiscard]] int face_of_triangle(uint32_t index) const
+    {
+        return triangle_faces_[index];
+    }
+
+    [[nodiscard]] BoundingBox bounds() const;
+
+    [[nodiscard]] const std::vector<Node>& nodes() const
+    {
+        return nodes_;
+    }
+
+    // Hashes of the mesh data the tree currently represents, see
+    // GeometryComponent::topology_hash and positions_hash.
+    [[nodiscard]] uint64_t topology_hash() const
+    {
+        return topology_hash_;
+    }
+
+    [[nodiscard]] uint64_t positions_hash() const
+    {
+        return positions_hash_;
+    }
+
+   private:
+    void build(const pxr::VtArray<pxr::GfVec3f>& vertices);
+    void fill_packets(const pxr::VtArray<pxr::GfVec3f>& vertices);
+
+    std::vector<pxr::GfVec3i> triangles_;
+    std::vector<int> triangle_faces_;
+    std::vector<Node> nodes_;
+    std::vector<TrianglePacket> packets_;
+
+    uint64_t topology_hash_ = 0;
+    uint64_t positions_hash_ = 0;
+};
+
+using MeshBVHHandle = std::shared_ptr<const MeshBVH>;
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
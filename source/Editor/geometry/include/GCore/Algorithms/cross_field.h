@@ -0,0 +1,102 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+enum class CrossFieldSolve {
+    // Least squares smoothness with the field pulled perpendicular to the
+    // boundary edges. Meshes without boundary get the smoothest field.
+    boundary_aligned,
+    // The smoothest field without constraints (Knöppel et al. 2013): the
+    // eigenvector of the smallest eigenvalue of the smoothness energy over
+    // the face areas, found by inverse iteration.
+    smoothest,
+};
+
+struct CrossFieldOptions {
+    // Directions per face, 4 for a cross field.
+    int symmetry = 4;
+    CrossFieldSolve solve = CrossFieldSolve::boundary_aligned;
+    // Weight of the boundary rows against the smoothness rows, which have
+    // weight 1.
+    double boundary_weight = 10.0;
+    // Inverse iteration stops when an iterate is this close to parallel to
+    // the previous one.
+    double tolerance = 1e-10;
+    int max_iterations = 200;
+};
+
+// A field of `symmetry` directions on the faces of a mesh, as parallel
+// arrays: centroids and unit normals per face, and the unit tangent
+// directions of face f at directions[f * symmetry .. f * symmetry +
+// symmetry - 1], counterclockwise around the normal.
+struct FaceFrames {
+    int symmetry = 4;
+    pxr::VtArray<pxr::GfVec3f> centroids;
+    pxr::VtArray<pxr::GfVec3f> normals;
+    pxr::VtArray<pxr::GfVec3f> directions;
+};
+
+// N-symmetry direction field on a polygon mesh in the complex power
+// representation: with an orthonormal tangent frame per face, the field at
+// face f is a unit complex z_f and is stored as u_f = z_f^N, which is the
+// same for all N directions. Across every edge shared by faces f and g, with
+// e_f and e_g the edge direction in either frame, smoothness asks for
+// u_f conj(e_f)^N = u_g conj(e_g)^N, i.e. the same angle to the edge on
+// both sides (Ray et al. 2008).
+//
+// The frames come from one parallel pass over the faces, and the rows of
+// the edge (and boundary) equations are written straight into a row major
+// complex sparse matrix A in a second one. A^H A is factored once with a
+// sparse Cholesky (LDLT) factorization, which gives the least squares field
+// in one solve and serves every step of the inverse iteration. Faces with a
+// zero field, e.g. at singularities, keep the direction of their first
+// edge.
+class GEOMETRY_API CrossField {
+   public:
+    // Throws std::invalid_argument when the vertex count does not match or
+    // the symmetry is not positive, and std::runtime_error when the
+    // factorization fails.
+    CrossField(
+        std::shared_ptr<const MeshAdjacency> adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const CrossFieldOptions& options = {});
+
+    // Returns `previous` when it was built for the same topology, positions
+    // and options, and a new field otherwise. The adjacency of `previous` is
+    // reused when only the positions changed.
+    static std::shared_ptr<const CrossField> update(
+        const std::shared_ptr<const CrossField>& previous,
+        const MeshComponent& mesh,
+        const CrossFieldOptions& options = {});
+
+    [[nodiscard]] const FaceFrames& frames() const
+    {
+        return frames_;
+    }
+
+    // Inverse iteration steps taken, 0 for the least squares solve.
+    [[nodiscard]] int iterations() const
+    {
+        return iterations_;
+    }
+
+   private:
+    std::shared_ptr<const MeshAdjacency> adjacency_;
+    CrossFieldOptions options_;
+    FaceFrames frames_;
+    int iterations_ = 0;
+    uint64_t positions_hash_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
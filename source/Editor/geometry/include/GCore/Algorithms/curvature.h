@@ -0,0 +1,39 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Discrete curvature of a triangle mesh at its vertices (Meyer et al. 2003):
+// mean curvature from the cotangent Laplacian, Gaussian curvature from the
+// angle deficit, both over mixed Voronoi areas. Principal curvatures follow
+// from the two; principal directions come from a least squares fit of the
+// shape operator to the normal curvatures along the edges around the vertex.
+//
+// Mean curvature is positive where the surface bends away from its normal
+// (e.g. 1/r on a sphere with outward facing triangles). On boundary vertices
+// the angle deficit is measured against pi instead of 2 pi.
+struct MeshCurvature {
+    pxr::VtArray<float> mean;
+    pxr::VtArray<float> gaussian;
+    // max >= min at every vertex.
+    pxr::VtArray<float> max;
+    pxr::VtArray<float> min;
+    // Unit tangent directions of max and min; empty unless requested.
+    pxr::VtArray<pxr::GfVec3f> max_direction;
+    pxr::VtArray<pxr::GfVec3f> min_direction;
+};
+
+// All quantities in one parallel pass over the vertices, each gathering
+// from its incident triangles. Throws std::invalid_argument when a face is
+// not a triangle or the vertex count does not match.
+GEOMETRY_API MeshCurvature compute_curvature(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    bool principal_directions = true);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
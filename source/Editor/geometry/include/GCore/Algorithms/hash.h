@@ -0,0 +1,110 @@
+#pragma once
+
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Stable 64-bit content hashing for geometry data.
+//
+// hash_bytes follows the structure of XXH3 (64 byte stripes accumulated into
+// eight 64-bit lanes with 32x32->64 multiplies, periodic scrambling and a
+// 128-bit multiply fold at the end) but is not bit compatible with it. Large
+// buffers are cut into fixed size chunks that are hashed in parallel and then
+// hashed again as an array of chunk hashes, so the result only depends on the
+// bytes and never on the thread count. Values are stable across runs and
+// processes; they assume a little-endian host.
+
+constexpr size_t hash_chunk_size = 256 * 1024;
+
+GEOMETRY_API uint64_t
+hash_bytes(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    // Murmur3 finalizer over an asymmetric mix, order sensitive.
+    uint64_t h = seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) +
+                         (seed >> 2));
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t hash_string(std::string_view str, uint64_t seed = 0)
+{
+    return hash_bytes(str.data(), str.size(), seed);
+}
+
+template<typename T>
+uint64_t hash_array(const T* data, size_t count, uint64_t seed = 0)
+{
+    static_assert(
+        std::is_trivially_copyable_v<T>,
+        "hash_array hashes the raw bytes of the elements");
+    return hash_bytes(data, count * sizeof(T), hash_combine(seed, count));
+}
+
+template<typename T>
+uint64_t hash_array(const pxr::VtArray<T>& array, uint64_t seed = 0)
+{
+    return hash_array(array.cdata(), array.size(), seed);
+}
+
+template<typename T>
+uint64_t hash_array(const std::vector<T>& array, uint64_t seed = 0)
+{
+    return hash_array(array.data(), array.size(), seed);
+}
+
+// Named quantity maps as stored by MeshComponent. std::map iterates in key
+// order, so the result does not depend on insertion order.
+template<typename T>
+uint64_t hash_quantities(
+    const std::map<std::string, pxr::VtArray<T>>& quantities,
+    uint64_t seed = 0)
+{
+    uint64_t h = hash_combine(seed, quantities.size());
+    for (const auto& [name, values] : quantities) {
+        h = hash_combine(h, hash_string(name));
+        h = hash_combine(h, hash_array(values));
+    }
+    return h;
+}
+
+// A lazily computed hash for one member array. The owner calls invalidate()
+// whenever the array is replaced or written in place; until then get() returns
+// the cached value. Not synchronized, like the rest of the component API.
+class CachedHash {
+   public:
+    template<typename Fn>
+    uint64_t get(Fn&& compute) const
+    {
+        if (!valid_) {
+            value_ = compute();
+            valid_ = true;
+        }
+        return value_;
+    }
+
+    void invalidate()
+    {
+        valid_ = false;
+    }
+
+   private:
+    mutable uint64_t value_ = 0;
+    mutable bool valid_ = false;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <Eigen/SparseCholesky>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// Geodesic distance on a triangle mesh with the heat method (Crane et al.
+// 2013): diffuse heat from the sources for a short time t, normalize its
+// gradient and recover the distance whose gradient best matches it.
+//
+// Both linear systems, (M + tC) for the heat flow and C for the Poisson
+// problem (see cotangent_laplacian), are factored once on construction, so
+// every query costs two pairs of triangular solves plus two parallel passes
+// over the mesh. Several source sets are solved together as the columns of
+// one right hand side.
+class GEOMETRY_API HeatGeodesic {
+   public:
+    // t is time_scale times the squared mean edge length. Throws
+    // std::invalid_argument for meshes that are not triangle meshes and
+    // std::runtime_error when a factorization fails.
+    HeatGeodesic(
+        std::shared_ptr<const MeshAdjacency> adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        double time_scale = 1.0);
+
+    // Returns `previous` when it was built for the same topology, positions
+    // and time scale, and new factorizations otherwise. The adjacency of
+    // `previous` is reused when only the positions changed.
+    static std::shared_ptr<const HeatGeodesic> update(
+        const std::shared_ptr<const HeatGeodesic>& previous,
+        const MeshComponent& mesh,
+        double time_scale = 1.0);
+
+    // Distance to the nearest source of each set, one array per set. Sources
+    // must be valid vertex indices (std::invalid_argument otherwise); an
+    // empty set gives an empty array. Safe to call from several threads.
+    [[nodiscard]] std::vector<pxr::VtArray<float>> distances(
+        const std::vector<std::vector<uint32_t>>& source_sets) const;
+
+    [[nodiscard]] pxr::VtArray<float> distance(
+        const std::vector<uint32_t>& sources) const;
+
+    [[nodiscard]] size_t vertex_count() const
+    {
+        return adjacency_->vertex_count();
+    }
+
+    [[nodiscard]] double time() const
+    {
+        return time_;
+    }
+
+   private:
+    std::shared_ptr<const MeshAdjacency> adjacency_;
+    pxr::VtArray<pxr::GfVec3f> vertices_;
+    double time_scale_;
+    double time_ = 0.0;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> heat_;
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> poisson_;
+    uint64_t positions_hash_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Discrete Laplace operators of a triangle mesh, assembled straight into
+// compressed sparse form: every row is gathered in parallel from the
+// triangles around its vertex, so no triplet list is built or sorted.
+//
+// All functions throw std::invalid_argument when a face is not a triangle
+// or the vertex count does not match the adjacency.
+
+// Cotangent stiffness matrix C: C_ij = -(cot a_ij + cot b_ij) / 2 for an
+// edge ij with opposite angles a_ij and b_ij, C_ii = -sum_j C_ij. C is
+// symmetric positive semidefinite, u^T C u is the Dirichlet energy of the
+// piecewise linear function u and constants span its null space (per
+// connected component).
+GEOMETRY_API Eigen::SparseMatrix<double> cotangent_laplacian(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices);
+
+enum class LaplacianWeights {
+    uniform,     // 1 per edge; Tutte's barycentric mapping.
+    cotangent,   // As in cotangent_laplacian.
+    mean_value,  // Floater's mean value weights, positive but not symmetric.
+};
+
+// Weighted graph Laplacian L: L_vj = -w_vj for an edge vj, L_vv = sum_j w_vj.
+// Row v holds the weights of the neighbors of v; the matrix is row major
+// because mean value weights make it non-symmetric.
+GEOMETRY_API Eigen::SparseMatrix<double, Eigen::RowMajor> weighted_laplacian(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    LaplacianWeights weights);
+
+// Lumped mass matrix diagonal: a third of the area of the triangles around
+// each vertex.
+GEOMETRY_API Eigen::VectorXd barycentric_mass(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
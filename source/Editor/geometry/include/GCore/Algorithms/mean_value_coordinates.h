@@ -0,0 +1,78 @@
+#pragma once
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/vt/array.h>
+
+#include <Eigen/Core>
+#include <memory>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Mean value coordinates (Floater 2003) with respect to a closed polygon in
+// the plane, evaluated for many points at once. They are smooth inside the
+// polygon, reproduce linear functions, and with the signed angles of
+// Hormann and Floater (2006) stay well defined for concave polygons and for
+// points outside. Points on an edge get the linear interpolation of its two
+// vertices, points on a vertex that vertex alone.
+//
+// The vertices and edge lengths are kept as structure of arrays. Points go
+// through in blocks: for each edge, Eigen array operations over the block
+// compute the half-angle tangents of all points together, so the inner
+// loops are SIMD over points; blocks are spread over threads. The weights
+// of a block are only written out once they are normalized, so evaluating
+// a million points allocates a few blocks, not a million vectors.
+class GEOMETRY_API MeanValueCoordinates {
+   public:
+    using Weights =
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+    // Vertices in order around the polygon. Throws std::invalid_argument for
+    // fewer than three vertices.
+    explicit MeanValueCoordinates(const pxr::VtArray<pxr::GfVec2f>& polygon);
+
+    // Number of polygon vertices, i.e. coordinates per point.
+    [[nodiscard]] size_t size() const
+    {
+        return x_.size();
+    }
+
+    // Writes the coordinates of points[p] to weights[p * size() + i], a
+    // row-major count x size() matrix.
+    void evaluate(const pxr::GfVec2f* points, size_t count, float* weights)
+        const;
+
+    [[nodiscard]] Weights evaluate(
+        const pxr::VtArray<pxr::GfVec2f>& points) const;
+
+    // out[p] = sum_i w_i(points[p]) values[i] with one value per polygon
+    // vertex, without storing the weights. With the vertices of a deformed
+    // cage as values this is cage based deformation.
+    void interpolate(
+        const pxr::GfVec2f* points,
+        size_t count,
+        const pxr::GfVec2f* values,
+        pxr::GfVec2f* out) const;
+
+   private:
+    using Block = Eigen::Array<float, Eigen::Dynamic, Eigen::Dynamic>;
+
+    // Coordinates of `count` points into the columns of `weights`, one row
+    // per point.
+    void evaluate_block(
+        const pxr::GfVec2f* points,
+        Eigen::Index count,
+        Block& weights) const;
+
+    std::vector<float> x_, y_;
+    // Length of the edge from vertex i to vertex i + 1.
+    std::vector<float> edge_lengths_;
+    // Points closer than this to a vertex or an edge are on it.
+    float epsilon_ = 0.0f;
+};
+
+using MeanValueCoordinatesHandle = std::shared_ptr<const MeanValueCoordinates>;
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
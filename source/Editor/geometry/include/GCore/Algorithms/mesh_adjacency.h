@@ -0,0 +1,95 @@
+#pragma once
+
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "GCore/Algorithms/point_index.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+enum class FaceNeighborhood {
+    edge,    // Faces sharing an edge.
+    vertex,  // Faces sharing at least one vertex.
+};
+
+// Incidence and neighborhood tables of a polygon mesh in CSR layout (see
+// NeighborLists), built once from the flat USD face arrays so that per
+// element loops are plain parallel gathers. Every list is sorted. Only the
+// topology is stored; positions are passed to the algorithms using it.
+//
+// Vertex based face neighborhoods are several times larger than edge based
+// ones and are only built on first use.
+class GEOMETRY_API MeshAdjacency {
+   public:
+    // Throws std::invalid_argument when the counts do not add up to the
+    // number of indices or an index is out of range.
+    MeshAdjacency(
+        const pxr::VtArray<int>& face_vertex_counts,
+        const pxr::VtArray<int>& face_vertex_indices,
+        size_t vertex_count);
+
+    // Returns `previous` when it was built for the same topology and new
+    // tables otherwise. See GeometryComponent::topology_hash.
+    static std::shared_ptr<const MeshAdjacency> update(
+        const std::shared_ptr<const MeshAdjacency>& previous,
+        const MeshComponent& mesh);
+
+    [[nodiscard]] size_t vertex_count() const
+    {
+        return vertex_faces_.size();
+    }
+
+    [[nodiscard]] size_t face_count() const
+    {
+        return face_offsets_.size() - 1;
+    }
+
+    // The vertices of face f are
+    // corner_vertices()[face_offsets()[f] .. face_offsets()[f + 1] - 1].
+    [[nodiscard]] const std::vector<uint32_t>& face_offsets() const
+    {
+        return face_offsets_;
+    }
+
+    [[nodiscard]] const std::vector<uint32_t>& corner_vertices() const
+    {
+        return corner_vertices_;
+    }
+
+    // Faces around each vertex.
+    [[nodiscard]] const NeighborLists& vertex_faces() const
+    {
+        return vertex_faces_;
+    }
+
+    // Neighbor faces of each face, not including the face itself.
+    [[nodiscard]] const NeighborLists& face_neighbors(
+        FaceNeighborhood neighborhood) const;
+
+    // 1 for vertices on an edge used by a single face.
+    [[nodiscard]] const std::vector<uint8_t>& boundary_vertices() const
+    {
+        return boundary_vertices_;
+    }
+
+   private:
+    std::vector<uint32_t> face_offsets_;
+    std::vector<uint32_t> corner_vertices_;
+    NeighborLists vertex_faces_;
+    NeighborLists edge_neighbors_;
+    std::vector<uint8_t> boundary_vertices_;
+
+    mutable std::once_flag vertex_neighbors_once_;
+    mutable NeighborLists vertex_neighbors_;
+
+    uint64_t topology_hash_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
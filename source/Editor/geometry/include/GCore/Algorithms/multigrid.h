@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Smoothed aggregation algebraic multigrid (Vanek, Mandel and Brezina 1996)
+// for the sparse systems of mesh Laplacians, applied as a preconditioner:
+// one V-cycle with a Gauss-Seidel sweep before (forward) and after
+// (backward) each coarse correction, which keeps it symmetric for symmetric
+// matrices. Unlike incomplete factorizations its iteration count barely
+// grows with the mesh size.
+//
+// Follows the preconditioner interface of Eigen's iterative solvers, e.g.
+//   Eigen::ConjugateGradient<
+//       Eigen::SparseMatrix<double>,
+//       Eigen::Lower | Eigen::Upper,
+//       AggregationMultigrid>
+// and also works for non-symmetric M-matrices with Eigen::BiCGSTAB.
+class GEOMETRY_API AggregationMultigrid {
+   public:
+    using Scalar = double;
+    using RealScalar = double;
+    using StorageIndex = int;
+    enum {
+        ColsAtCompileTime = Eigen::Dynamic,
+        MaxColsAtCompileTime = Eigen::Dynamic,
+    };
+
+    AggregationMultigrid() = default;
+
+    template<typename MatrixType>
+    explicit AggregationMultigrid(const MatrixType& matrix)
+    {
+        compute(matrix);
+    }
+
+    template<typename MatrixType>
+    AggregationMultigrid& analyzePattern(const MatrixType&)
+    {
+        return *this;
+    }
+
+    template<typename MatrixType>
+    AggregationMultigrid& factorize(const MatrixType& matrix)
+    {
+        build(Eigen::SparseMatrix<double, Eigen::RowMajor>(matrix));
+        return *this;
+    }
+
+    template<typename MatrixType>
+    AggregationMultigrid& compute(const MatrixType& matrix)
+    {
+        return factorize(matrix);
+    }
+
+    template<typename Rhs, typename Dest>
+    void _solve_impl(const Rhs& b, Dest& x) const
+    {
+        Eigen::VectorXd result;
+        cycle(0, b, result);
+        x = result;
+    }
+
+    template<typename Rhs>
+    const Eigen::Solve<AggregationMultigrid, Rhs> solve(
+        const Eigen::MatrixBase<Rhs>& b) const
+    {
+        return Eigen::Solve<AggregationMultigrid, Rhs>(*this, b.derived());
+    }
+
+    [[nodiscard]] Eigen::ComputationInfo info() const
+    {
+        return info_;
+    }
+
+    [[nodiscard]] Eigen::Index rows() const
+    {
+        return size_;
+    }
+
+    [[nodiscard]] Eigen::Index cols() const
+    {
+        return size_;
+    }
+
+    // Number of levels, the directly solved coarsest one included.
+    [[nodiscard]] size_t levels() const
+    {
+        return levels_.size() + 1;
+    }
+
+   private:
+    using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+    struct Level {
+        RowMatrix matrix;
+        Eigen::VectorXd inverse_diagonal;
+        // Fine by coarse.
+        RowMatrix prolongation;
+    };
+
+    void build(RowMatrix matrix);
+    void cycle(size_t level, const Eigen::VectorXd& b, Eigen::VectorXd& x)
+        const;
+
+    std::vector<Level> levels_;
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> coarsest_;
+    Eigen::Index size_ = 0;
+    Eigen::ComputationInfo info_ = Eigen::InvalidInput;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
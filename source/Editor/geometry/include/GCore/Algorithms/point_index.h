@@ -0,0 +1,267 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec3i.h>
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Spatial indices over point sets (point clouds and mesh vertices) for
+// nearest neighbor and radius queries.
+//
+// Both indices keep a copy of the points reordered so that points close in
+// space are close in memory, and report results as indices into the original
+// array. They are immutable after construction and safe to query from many
+// threads. The batched queries are parallel over the query points.
+
+// Results of a radius query over many points, in CSR layout: the neighbors of
+// query i are indices[offsets[i]] .. indices[offsets[i + 1] - 1].
+struct NeighborLists {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> indices;
+
+    [[nodiscard]] size_t size() const
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    [[nodiscard]] uint32_t count(size_t query) const
+    {
+        return offsets[query + 1] - offsets[query];
+    }
+
+    [[nodiscard]] const uint32_t* begin(size_t query) const
+    {
+        return indices.data() + offsets[query];
+    }
+
+    [[nodiscard]] const uint32_t* end(size_t query) const
+    {
+        return indices.data() + offsets[query + 1];
+    }
+};
+
+// Missing neighbors of a kNN query (fewer than k points in the index) are
+// reported with this index and an infinite distance.
+constexpr uint32_t invalid_point = ~0u;
+
+// Balanced KD-tree with bucketed leaves.
+//
+// The tree is implicit: it is complete down to a fixed depth, node i has its
+// children at 2i+1 and 2i+2, and the point range of a node follows from
+// halving the range of its parent, so a node only stores its split plane.
+// Subtrees are built in parallel.
+class GEOMETRY_API PointKDTree {
+   public:
+    static constexpr uint32_t bucket_size = 32;
+
+    PointKDTree(const pxr::GfVec3f* points, size_t count);
+    explicit PointKDTree(const pxr::VtArray<pxr::GfVec3f>& points);
+
+    // Returns `previous` when it was built for points with the same hash and
+    // a new tree otherwise. See GeometryComponent::positions_hash.
+    static std::shared_ptr<const PointKDTree> update(
+        const std::shared_ptr<const PointKDTree>& previous,
+        const pxr::VtArray<pxr::GfVec3f>& points,
+        uint64_t positions_hash);
+
+    // Nearest point, invalid_point for an empty tree or when nothing lies
+    // within max_distance.
+    [[nodiscard]] uint32_t nearest(
+        const pxr::GfVec3f& query,
+        float max_distance = std::numeric_limits<float>::infinity(),
+        float* distance_squared = nullptr) const;
+
+    // The k nearest points sorted by distance. Writes k entries to indices
+    // and, when not null, to distances_squared.
+    void knn(
+        const pxr::GfVec3f& query,
+        uint32_t k,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+
+    // Appends the points within `radius` of `query`, in no particular order.
+    void radius(
+        const pxr::GfVec3f& query,
+        float radius,
+        std::vector<uint32_t>& indices) const;
+
+    // Batched queries. knn writes count * k entries, query-major.
+    void nearest_batch(
+        const pxr::GfVec3f* queries,
+        size_t count,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+    void knn_batch(
+        const pxr::GfVec3f* queries,
+        size_t count,
+        uint32_t k,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+    [[nodiscard]] NeighborLists
+    radius_batch(const pxr::GfVec3f* queries, size_t count, float radius)
+        const;
+
+    // kNN of every indexed point (each point is its own first neighbor),
+    // written at its original index. Queries run in tree order, so
+    // consecutive queries touch the same leaves.
+    void knn_all(
+        uint32_t k,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+
+    // Same traversal as knn_all, handing each point's neighbors (sorted, k
+    // entries) to `fn` instead of storing them, for per-point reductions
+    // over clouds too large to hold N * k results. Called concurrently.
+    using NeighborCallback = std::function<void(
+        uint32_t point,
+        const uint32_t* neighbors,
+        const float* distances_squared)>;
+    void for_each_knn(uint32_t k, const NeighborCallback& fn) const;
+
+    [[nodiscard]] size_t size() const
+    {
+        return points_.size();
+    }
+
+    [[nodiscard]] uint64_t positions_hash() const
+    {
+        return positions_hash_;
+    }
+
+   private:
+    struct Node {
+        float split;
+        uint32_t axis;
+    };
+
+    template<typename Visitor>
+    void traverse(const pxr::GfVec3f& query, Visitor& visitor) const;
+
+    // knn with caller provided heap storage of k entries, so the batched
+    // queries do not allocate per query.
+    void knn_into(
+        const pxr::GfVec3f& query,
+        uint32_t k,
+        std::pair<float, uint32_t>* heap,
+        uint32_t* indices,
+        float* distances_squared) const;
+
+    uint32_t depth_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<pxr::GfVec3f> points_;
+    std::vector<uint32_t> indices_;
+    uint64_t positions_hash_ = 0;
+};
+
+// Uniform grid hashed on integer cell coordinates.
+//
+// Points are sorted by cell, and an open addressing table maps each occupied
+// cell to its range of points. Construction is a parallel sort and is cheaper
+// than the KD-tree; queries are fastest when the query radius is close to the
+// cell size.
+class GEOMETRY_API PointHashGrid {
+   public:
+    PointHashGrid(const pxr::GfVec3f* points, size_t count, float cell_size);
+    PointHashGrid(const pxr::VtArray<pxr::GfVec3f>& points, float cell_size);
+
+    [[nodiscard]] uint32_t nearest(
+        const pxr::GfVec3f& query,
+        float max_distance = std::numeric_limits<float>::infinity(),
+        float* distance_squared = nullptr) const;
+    void knn(
+        const pxr::GfVec3f& query,
+        uint32_t k,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+    void radius(
+        const pxr::GfVec3f& query,
+        float radius,
+        std::vector<uint32_t>& indices) const;
+
+    void knn_batch(
+        const pxr::GfVec3f* queries,
+        size_t count,
+        uint32_t k,
+        uint32_t* indices,
+        float* distances_squared = nullptr) const;
+    [[nodiscard]] NeighborLists
+    radius_batch(const pxr::GfVec3f* queries, size_t count, float radius)
+        const;
+
+    [[nodiscard]] pxr::GfVec3i cell_of(const pxr::GfVec3f& p) const;
+
+    // Occupied cells and the original indices of their points, for per-cell
+    // reductions such as voxel downsampling.
+    [[nodiscard]] size_t cell_count() const
+    {
+        return cell_begin_.size() - 1;
+    }
+
+    [[nodiscard]] const uint32_t* cell_begin(size_t cell) const
+    {
+        return indices_.data() + cell_begin_[cell];
+    }
+
+    [[nodiscard]] const uint32_t* cell_end(size_t cell) const
+    {
+        return indices_.data() + cell_begin_[cell + 1];
+    }
+
+    [[nodiscard]] float cell_size() const
+    {
+        return cell_size_;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return points_.size();
+    }
+
+   private:
+    void knn_into(
+        const pxr::GfVec3f& query,
+        uint32_t k,
+        std::pair<float, uint32_t>* heap,
+        uint32_t* indices,
+        float* distances_squared) const;
+
+    [[nodiscard]] float cell_distance_squared(
+        const pxr::GfVec3i& cell,
+        const pxr::GfVec3f& p) const;
+
+    // Range of sorted points in a cell, empty for unoccupied cells.
+    [[nodiscard]] std::pair<uint32_t, uint32_t> find_cell(
+        const pxr::GfVec3i& cell) const;
+
+    float cell_size_;
+    float inv_cell_size_;
+    pxr::GfVec3i min_cell_;
+    pxr::GfVec3i max_cell_;
+    std::vector<pxr::GfVec3f> points_;
+    std::vector<uint32_t> indices_;
+    std::vector<uint32_t> cell_begin_;
+    std::vector<pxr::GfVec3i> cell_keys_;
+    // Open addressing table, sized to a power of two at most half full. A
+    // slot holds the cell key and its point range so a probe touches one
+    // cache line; empty slots have an empty range.
+    struct CellSlot {
+        pxr::GfVec3i cell;
+        uint32_t begin;
+        uint32_t end;
+    };
+    std::vector<CellSlot> table_;
+};
+
+using PointKDTreeHandle = std::shared_ptr<const PointKDTree>;
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
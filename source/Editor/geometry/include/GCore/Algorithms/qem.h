@@ -0,0 +1,128 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+enum class QemSchedule {
+    // One contraction at a time, always the cheapest left.
+    serial,
+    // Rounds of contractions that are each the cheapest in their
+    // neighborhood, applied in parallel. Non-edge pairs are not used.
+    parallel,
+};
+
+struct QemOptions {
+    // Faces to keep, as a fraction of the input faces.
+    float ratio = 0.5f;
+    // Vertices of different connected components closer than this are
+    // also contracted (non-edge pairs), which merges nearby parts; 0 turns
+    // them off.
+    float distance_threshold = 0.0f;
+    // Weight of the planes through open boundary edges, perpendicular to
+    // their face, that keep the boundary in place.
+    double boundary_weight = 100.0;
+    QemSchedule schedule = QemSchedule::serial;
+};
+
+struct SimplifiedMesh {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> face_vertex_counts;
+    pxr::VtArray<int> face_vertex_indices;
+};
+
+// One contraction of a QEM run. Read backwards, it is the vertex split that
+// brings `removed` back and returns `kept` to where it was before.
+// Trivially copyable and packed into 28 bytes, so a sequence can be written
+// and read as a plain array.
+struct QemCollapse {
+    uint32_t kept;
+    uint32_t removed;
+    // Where `kept` moved.
+    pxr::GfVec3f position;
+    // The largest quadric error of this and all earlier contractions, so it
+    // never decreases along the sequence.
+    float error;
+    // Faces left after this contraction.
+    uint32_t face_count;
+};
+static_assert(sizeof(QemCollapse) == 28);
+static_assert(std::is_trivially_copyable_v<QemCollapse>);
+
+// Quadric error metric simplification (Garland and Heckbert 1997) of a
+// triangle mesh by pair contractions, each moving the kept vertex to the
+// point minimizing the summed quadrics of the pair.
+//
+// Face quadrics and their per-vertex sums are gathered in parallel. The
+// contractions run from a binary heap without decrease-key: a pair is
+// pushed again whenever one of its vertices changes and entries older than
+// the last change of either vertex are skipped when popped. Faces around a
+// vertex are linked lists through the face corners, so contractions splice
+// lists instead of allocating. A contraction is rejected when it would
+// break the link condition, pinch two boundaries together or flip a face
+// normal. Non-edge pairs come from a hash grid query per vertex, at most a
+// few nearest ones per vertex.
+//
+// The parallel schedule scales with the cores at a small cost in quality:
+// in each round every vertex proposes its cheapest edge, and the proposals
+// among the cheapest tenth that are the cheapest within the neighborhood
+// they touch contract together, as in multiple choice decimation (Wu and
+// Kobbelt 2002) with the choices made locally instead of at random.
+//
+// Vertices that end up unused are dropped; the remaining ones and the faces
+// keep their relative order. Throws std::invalid_argument when a face is
+// not a triangle or the vertex count does not match.
+//
+// When `collapses` is not null, every contraction is appended to it in the
+// order applied.
+GEOMETRY_API SimplifiedMesh qem_simplify(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const QemOptions& options = {},
+    std::vector<QemCollapse>* collapses = nullptr);
+
+// A progressive mesh: the input triangles and the contractions of one QEM
+// run down to options.ratio. Any level of detail between the two is
+// extracted in time linear in the mesh size, without simplifying again.
+class GEOMETRY_API ProgressiveMesh {
+   public:
+    // Runs qem_simplify and records every contraction. Throws like it.
+    ProgressiveMesh(
+        const MeshAdjacency& adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const QemOptions& options = {});
+
+    [[nodiscard]] const std::vector<QemCollapse>& collapses() const
+    {
+        return collapses_;
+    }
+
+    // Contractions to apply for the finest level with at most `faces`
+    // faces, or for the coarsest one whose error stays within `error`.
+    // Both are binary searches.
+    [[nodiscard]] size_t collapses_for_face_count(size_t faces) const;
+    [[nodiscard]] size_t collapses_for_error(float error) const;
+
+    // The mesh after the first `count` contractions, laid out like the
+    // result of qem_simplify.
+    [[nodiscard]] SimplifiedMesh extract(size_t count) const;
+
+   private:
+    pxr::VtArray<pxr::GfVec3f> vertices_;
+    std::vector<uint32_t> triangles_;
+    size_t face_count_ = 0;
+    std::vector<QemCollapse> collapses_;
+};
+
+using ProgressiveMeshHandle = std::shared_ptr<const ProgressiveMesh>;
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
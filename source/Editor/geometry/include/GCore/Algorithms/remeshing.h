@@ -0,0 +1,76 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct RemeshingOptions {
+    // Used everywhere unless `sizing` is given.
+    float target_edge_length = 0.1f;
+    int iterations = 10;
+    // Step of the tangential relaxation towards the area weighted centroid
+    // of the neighbors, 1 moves all the way.
+    float lambda = 1.0f;
+    // Target length at each input vertex for adaptive remeshing, e.g. from
+    // curvature_sizing or a vertex scalar quantity. It is first lowered
+    // until it grows by at most `gradation` times the distance along any
+    // edge, then carried to new vertices: interpolated at splits and
+    // collapses, and from the closest point of the input after every
+    // relaxation. An edge aims at the mean of the lengths at its ends.
+    pxr::VtArray<float> sizing;
+    float gradation = 0.5f;
+};
+
+struct SizingOptions {
+    // Largest distance between the remeshed surface and the input.
+    float error = 1e-3f;
+    float min_length = 1e-3f;
+    float max_length = 0.1f;
+};
+
+struct RemeshedMesh {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> face_vertex_counts;
+    pxr::VtArray<int> face_vertex_indices;
+};
+
+// Target edge lengths for which triangles of the sphere with the largest
+// absolute principal curvature at each vertex stay within `error` of it,
+// sqrt(6 error / k - 3 error^2) (Dunyach et al. 2013), clamped to the
+// bounds. Throws like compute_curvature.
+GEOMETRY_API pxr::VtArray<float> curvature_sizing(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const SizingOptions& options = {});
+
+// Isotropic remeshing of a triangle mesh (Botsch and Kobbelt 2004). Every
+// iteration splits the edges longer than 4/3 of the target length at their
+// midpoint, collapses those shorter than 4/5 of it, flips edges to bring
+// the valences towards 6 (4 on the boundary), then moves the vertices
+// towards the area weighted centroid of their neighbors within the tangent
+// plane and back onto the input surface.
+//
+// The mesh is kept as halfedges packed three per triangle, so a face and
+// its halfedges share an index and splits only append. Splits, collapses
+// and flips run from worklists seeded with the edges that need them and
+// refilled with the edges each operation changes, not from repeated sweeps.
+// Relaxation is a parallel Jacobi pass, and the projection onto the input
+// a batch of closest point queries on a MeshBVH of it.
+//
+// A collapse is skipped when it would break the link condition, create an
+// edge longer than the split threshold or flip a face normal; boundary
+// vertices stay in place and boundary edges are only split, so the outline
+// is kept. Throws std::invalid_argument when a face is not a triangle, the
+// vertex or sizing count does not match, a target length is not positive,
+// the gradation of a sizing is negative or not finite, or the mesh is not
+// manifold.
+GEOMETRY_API RemeshedMesh isotropic_remeshing(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const RemeshingOptions& options = {});
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "GCore/Algorithms/point_index.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// Vertex graph of a polygon mesh: two vertices are adjacent when they are
+// consecutive corners of a face. Neighbors are stored in CSR layout (see
+// NeighborLists), sorted and without duplicates. Edge lengths are not stored
+// and come from the positions passed to each search, so the graph stays
+// valid while the mesh deforms.
+class GEOMETRY_API EdgeGraph {
+   public:
+    // Throws std::invalid_argument when the counts do not add up to the
+    // number of indices or an index is out of range.
+    EdgeGraph(
+        const pxr::VtArray<int>& face_vertex_counts,
+        const pxr::VtArray<int>& face_vertex_indices,
+        size_t vertex_count);
+
+    // Returns `previous` when it was built for the same topology and a new
+    // graph otherwise. See GeometryComponent::topology_hash.
+    static std::shared_ptr<const EdgeGraph> update(
+        const std::shared_ptr<const EdgeGraph>& previous,
+        const MeshComponent& mesh);
+
+    [[nodiscard]] size_t vertex_count() const
+    {
+        return neighbors_.size();
+    }
+
+    [[nodiscard]] const NeighborLists& neighbors() const
+    {
+        return neighbors_;
+    }
+
+   private:
+    NeighborLists neighbors_;
+    uint64_t topology_hash_ = 0;
+};
+
+enum class PathSearch {
+    dijkstra,
+    // Dijkstra guided by the straight line distance to the target, which
+    // never overestimates the length of a path along the edges.
+    a_star,
+    // Dijkstra from both ends, stopping once the two searches meet.
+    bidirectional,
+};
+
+// Shortest paths along the edges of an EdgeGraph, one query at a time.
+//
+// The per vertex search state (distance, parent, heap slot) is kept between
+// queries and tagged with the query it belongs to, so a query only touches
+// the vertices it reaches: repeated picks on a large mesh do not clear or
+// reallocate anything. An instance is not safe to use from several threads
+// at once.
+class GEOMETRY_API ShortestPathSearch {
+   public:
+    // Fills `path` with the vertices from source to target (both included)
+    // and `distance` with its length. Returns false, leaving `path` empty,
+    // when the target cannot be reached. Throws std::invalid_argument when a
+    // vertex is out of range or the positions do not match the graph.
+    bool find(
+        const EdgeGraph& graph,
+        const pxr::VtArray<pxr::GfVec3f>& positions,
+        uint32_t source,
+        uint32_t target,
+        std::vector<uint32_t>& path,
+        float& distance,
+        PathSearch method = PathSearch::a_star);
+
+    // Vertices whose distance was finalized by the last query.
+    [[nodiscard]] size_t settled_count() const
+    {
+        return settled_;
+    }
+
+   private:
+    // Search state of one direction: tentative distances, parents and an
+    // indexed 4-ary min-heap over the reached vertices. The state of a
+    // vertex is kept together so that visiting it touches one cache line.
+    struct Frontier {
+        struct Vertex {
+            float g;
+            uint32_t parent;
+            uint32_t slot;
+            uint32_t stamp;
+        };
+        std::vector<Vertex> vertices;
+        std::vector<std::pair<float, uint32_t>> heap;
+        uint32_t current = 0;
+
+        void reset(size_t vertex_count);
+        [[nodiscard]] bool reached(uint32_t v) const
+        {
+            return vertices[v].stamp == current;
+        }
+        [[nodiscard]] float g(uint32_t v) const
+        {
+            return vertices[v].g;
+        }
+        [[nodiscard]] uint32_t parent(uint32_t v) const
+        {
+            return vertices[v].parent;
+        }
+        [[nodiscard]] bool settled(uint32_t v) const;
+        void relax(uint32_t v, float g_value, float key, uint32_t from);
+        uint32_t pop();
+
+       private:
+        void place(size_t i, std::pair<float, uint32_t> entry);
+        void sift_up(size_t i);
+        void sift_down(size_t i);
+    };
+
+    bool find_one_way(
+        const EdgeGraph& graph,
+        const pxr::GfVec3f* positions,
+        uint32_t source,
+        uint32_t target,
+        bool guided,
+        float& distance);
+    bool find_bidirectional(
+        const EdgeGraph& graph,
+        const pxr::GfVec3f* positions,
+        uint32_t source,
+        uint32_t target,
+        float& distance);
+
+    Frontier forward_;
+    Frontier backward_;
+    uint32_t meet_from_ = 0;
+    uint32_t meet_to_ = 0;
+    size_t settled_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
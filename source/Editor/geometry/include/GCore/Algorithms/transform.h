@@ -0,0 +1,61 @@
+#pragma once
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Batched transform kernels over contiguous GfVec3f arrays.
+//
+// USD uses the row vector convention, so a point p is mapped to p * M. Affine
+// matrices (last column is (0, 0, 0, 1)) go through the SIMD path (AVX2 + FMA
+// selected at runtime on x86-64, NEON on aarch64), projective ones fall back
+// to a scalar loop with the homogeneous divide. Arrays larger than
+// transform_parallel_threshold are split over the work pool.
+//
+// GfMatrix4d overloads evaluate in double precision and round the result to
+// float, matching GfMatrix4d::Transform. GfMatrix4f overloads evaluate in
+// single precision and are roughly twice as fast.
+
+constexpr size_t transform_parallel_threshold = 1 << 15;
+
+GEOMETRY_API void transform_points(
+    pxr::GfVec3f* points,
+    size_t count,
+    const pxr::GfMatrix4d& transform);
+GEOMETRY_API void transform_points(
+    pxr::GfVec3f* points,
+    size_t count,
+    const pxr::GfMatrix4f& transform);
+
+GEOMETRY_API void transform_points(
+    pxr::VtArray<pxr::GfVec3f>& points,
+    const pxr::GfMatrix4d& transform);
+GEOMETRY_API void transform_points(
+    pxr::VtArray<pxr::GfVec3f>& points,
+    const pxr::GfMatrix4f& transform);
+
+// Transforms normals by the inverse-transpose of the upper 3x3 block and
+// renormalizes them. Zero-length normals stay zero. If the matrix is singular
+// the normals are left untouched.
+GEOMETRY_API void transform_normals(
+    pxr::GfVec3f* normals,
+    size_t count,
+    const pxr::GfMatrix4d& transform);
+GEOMETRY_API void transform_normals(
+    pxr::GfVec3f* normals,
+    size_t count,
+    const pxr::GfMatrix4f& transform);
+
+GEOMETRY_API void transform_normals(
+    pxr::VtArray<pxr::GfVec3f>& normals,
+    const pxr::GfMatrix4d& transform);
+GEOMETRY_API void transform_normals(
+    pxr::VtArray<pxr::GfVec3f>& normals,
+    const pxr::GfMatrix4f& transform);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
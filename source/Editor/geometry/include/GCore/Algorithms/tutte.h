@@ -0,0 +1,126 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GCore/Algorithms/laplacian.h"
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/Algorithms/multigrid.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// Vertices of the boundary loop with the most vertices, in the order of the
+// faces using its edges. Empty for meshes without boundary.
+GEOMETRY_API std::vector<uint32_t> boundary_loop(
+    const MeshAdjacency& adjacency);
+
+enum class TutteBoundary {
+    // The boundary keeps its positions and the interior becomes the discrete
+    // harmonic (minimal) surface spanned by it.
+    fixed,
+    // The boundary is spread over the unit circle in the XY plane by arc
+    // length, giving a disk parameterization.
+    circle,
+};
+
+struct TutteOptions {
+    LaplacianWeights weights = LaplacianWeights::uniform;
+    TutteBoundary boundary = TutteBoundary::circle;
+    // Above this many free vertices the system is solved iteratively with
+    // a multigrid preconditioner (see AggregationMultigrid) instead of a
+    // sparse factorization, whose fill-in grows faster than the mesh.
+    size_t max_factored_vertices = 100000;
+    // Relative residual of the iterative solver.
+    double tolerance = 1e-8;
+};
+
+// Tutte / harmonic embedding of a triangle mesh: the vertices of the
+// longest boundary loop are fixed and every other vertex is placed at the
+// weighted average of its neighbors, i.e. L_II x_I = -L_IB x_B for the
+// interior rows of weighted_laplacian. Vertices outside every triangle keep
+// their input position (the origin for TutteBoundary::circle).
+//
+// The interior system is assembled and factored once on construction
+// (Cholesky for the symmetric weights, LU for mean value weights) and all
+// coordinates are solved together as the columns of one right hand side.
+// Larger systems get a multigrid hierarchy for preconditioned CG
+// (BiCGSTAB for mean value weights) instead.
+// Uniform weights only depend on the topology, so the same object embeds
+// any positions of the boundary.
+class GEOMETRY_API TutteEmbedding {
+   public:
+    // Throws std::invalid_argument for meshes that are not triangle meshes
+    // or have no boundary, and std::runtime_error when the factorization
+    // fails, e.g. for a closed component.
+    TutteEmbedding(
+        std::shared_ptr<const MeshAdjacency> adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const TutteOptions& options = {});
+
+    // The solvers keep a reference to the interior matrix.
+    TutteEmbedding(const TutteEmbedding&) = delete;
+    TutteEmbedding& operator=(const TutteEmbedding&) = delete;
+
+    // Returns `previous` when it was built for the same topology, options
+    // and, unless the weights are uniform, positions, and a new system
+    // otherwise. The adjacency of `previous` is reused when only the
+    // positions changed.
+    static std::shared_ptr<const TutteEmbedding> update(
+        const std::shared_ptr<const TutteEmbedding>& previous,
+        const MeshComponent& mesh,
+        const TutteOptions& options = {});
+
+    // Embedded positions. `vertices` gives the fixed boundary and the
+    // initial guess of the iterative solver. Throws std::runtime_error when
+    // the iterative solver does not converge.
+    [[nodiscard]] pxr::VtArray<pxr::GfVec3f> embed(
+        const pxr::VtArray<pxr::GfVec3f>& vertices) const;
+
+    [[nodiscard]] const std::vector<uint32_t>& boundary() const
+    {
+        return boundary_;
+    }
+
+    [[nodiscard]] bool factored() const
+    {
+        return free_count_ <= options_.max_factored_vertices;
+    }
+
+   private:
+    using Matrix = Eigen::SparseMatrix<double>;
+    using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+    std::shared_ptr<const MeshAdjacency> adjacency_;
+    TutteOptions options_;
+    std::vector<uint32_t> boundary_;
+    // Index of each vertex among the free vertices, -1 when fixed.
+    std::vector<int> free_index_;
+    size_t free_count_ = 0;
+    Matrix interior_;
+    // Couplings of the free rows to the fixed vertices, columns indexed by
+    // vertex.
+    RowMatrix coupling_;
+
+    Eigen::SimplicialLDLT<Matrix> cholesky_;
+    Eigen::SparseLU<Matrix> lu_;
+    Eigen::ConjugateGradient<
+        Matrix,
+        Eigen::Lower | Eigen::Upper,
+        AggregationMultigrid>
+        cg_;
+    Eigen::BiCGSTAB<Matrix, AggregationMultigrid> bicgstab_;
+
+    uint64_t positions_hash_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "GCore/api.h"
 #include "GOP.h"
 
@@ -16,6 +18,20 @@ struct GEOMETRY_API GeometryComponent {
 
     virtual void apply_transform(const pxr::GfMatrix4d& transform) = 0;
 
+    // Stable hashes of the component data (see GCore/Algorithms/hash.h).
+    // topology_hash covers connectivity and element counts, positions_hash the
+    // point coordinates, content_hash everything including attributes and
+    // quantities. Components without topology or positions return 0.
+    virtual uint64_t content_hash() const = 0;
+    virtual uint64_t topology_hash() const
+    {
+        return 0;
+    }
+    virtual uint64_t positions_hash() const
+    {
+        return 0;
+    }
+
    protected:
     Geometry* attached_operand;
 #if USE_USD_SCRATCH_BUFFER
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 #include "pxr/usd/usdGeom/basisCurves.h"
@@ -13,14 +14,11 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     std::string to_string() const override;
 
-    void apply_transform(const pxr::GfMatrix4d& transform) override
-    {
-        auto vertices = get_vertices();
-        for (auto& vertex : vertices) {
-            vertex = pxr::GfVec3f(transform.Transform(vertex));
-        }
-        set_vertices(vertices);
-    }
+    void apply_transform(const pxr::GfMatrix4d& transform) override;
+
+    uint64_t content_hash() const override;
+    uint64_t topology_hash() const override;
+    uint64_t positions_hash() const override;
 
     [[nodiscard]] pxr::VtArray<pxr::GfVec3f> get_vertices() const
     {
@@ -36,6 +34,7 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     void set_vertices(const pxr::VtArray<pxr::GfVec3f>& vertices)
     {
+        hash_cache.vertices.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         curves.CreatePointsAttr().Set(vertices);
 #else
@@ -57,6 +56,7 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     void set_width(const pxr::VtArray<float>& width)
     {
+        hash_cache.width.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         curves.CreateWidthsAttr().Set(width);
 #else
@@ -78,6 +78,7 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     void set_vert_count(const pxr::VtArray<int>& vert_count)
     {
+        hash_cache.vert_count.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         curves.CreateCurveVertexCountsAttr().Set(vert_count);
 #else
@@ -99,6 +100,7 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     void set_display_color(const pxr::VtArray<pxr::GfVec3f>& display_color)
     {
+        hash_cache.display_color.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         curves.CreateDisplayColorAttr().Set(display_color);
 #else
@@ -150,6 +152,7 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
 
     void set_curve_normals(const pxr::VtArray<pxr::GfVec3f>& normals)
     {
+        hash_cache.curve_normals.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         curves.CreateNormalsAttr().Set(normals);
 #else
@@ -172,6 +175,15 @@ struct GEOMETRY_API CurveComponent : public GeometryComponent {
     pxr::VtArray<pxr::GfVec3f> curve_normals;
 
 #endif
+
+    struct HashCache {
+        CachedHash vertices;
+        CachedHash width;
+        CachedHash vert_count;
+        CachedHash display_color;
+        CachedHash curve_normals;
+    };
+    HashCache hash_cache;
 };
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 
@@ -30,6 +31,16 @@ struct GEOMETRY_API MaterialComponent : public GeometryComponent {
         return {};
     }
 
+    uint64_t content_hash() const override
+    {
+        static const uint64_t type_seed = hash_string("MaterialComponent");
+        uint64_t hash = hash_combine(type_seed, textures.size());
+        for (const auto& texture : textures) {
+            hash = hash_combine(hash, hash_string(texture));
+        }
+        return hash;
+    }
+
     std::vector<std::string> textures;
 };
 
@@ -3,31 +3,41 @@
 #include <pxr/base/vt/array.h>
 #include <pxr/usd/usdGeom/mesh.h>
 
+#include <memory>
 #include <string>
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 #include "pxr/usd/usdGeom/primvarsAPI.h"
 #include "pxr/usd/usdGeom/xform.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
+class MeshBVH;
+class PointKDTree;
+
 struct GEOMETRY_API MeshComponent : public GeometryComponent {
     explicit MeshComponent(Geometry* attached_operand);
 
     ~MeshComponent() override;
 
-    void apply_transform(const pxr::GfMatrix4d& transform) override
-    {
-        auto vertices = get_vertices();
-        for (auto& vertex : vertices) {
-            vertex = pxr::GfVec3f(transform.Transform(vertex));
-        }
-        set_vertices(vertices);
-    }
+    void apply_transform(const pxr::GfMatrix4d& transform) override;
 
     std::string to_string() const override;
     GeometryComponentHandle copy(Geometry* operand) const override;
 
+    uint64_t content_hash() const override;
+    uint64_t topology_hash() const override;
+    uint64_t positions_hash() const override;
+
+    // Spatial index over the current triangles. Cached on the component and
+    // refit or rebuilt on access when positions or topology changed. Node
+    // inputs are fresh copies on every execution, so nodes keep the index in
+    // their storage with MeshBVH::update instead of relying on this cache.
+    std::shared_ptr<const MeshBVH> get_bvh() const;
+    // Neighbor index over the vertices, cached like get_bvh.
+    std::shared_ptr<const PointKDTree> get_kdtree() const;
+
     [[nodiscard]] pxr::VtArray<pxr::GfVec3f> get_vertices() const
     {
 #if USE_USD_SCRATCH_BUFFER
@@ -263,6 +273,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_vertices(const pxr::VtArray<pxr::GfVec3f>& vertices)
     {
+        hash_cache.vertices.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         mesh.CreatePointsAttr().Set(vertices);
 #else
@@ -272,6 +283,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_face_vertex_counts(const pxr::VtArray<int>& face_vertex_counts)
     {
+        hash_cache.face_vertex_counts.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         mesh.CreateFaceVertexCountsAttr().Set(face_vertex_counts);
 #else
@@ -281,6 +293,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_face_vertex_indices(const pxr::VtArray<int>& face_vertex_indices)
     {
+        hash_cache.face_vertex_indices.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         mesh.CreateFaceVertexIndicesAttr().Set(face_vertex_indices);
 #else
@@ -290,6 +303,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_normals(const pxr::VtArray<pxr::GfVec3f>& normals)
     {
+        hash_cache.normals.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         mesh.CreateNormalsAttr().Set(normals);
 #else
@@ -299,6 +313,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_texcoords_array(const pxr::VtArray<pxr::GfVec2f>& texcoords_array)
     {
+        hash_cache.texcoords.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         auto PrimVarAPI = pxr::UsdGeomPrimvarsAPI(mesh);
         auto primvar = PrimVarAPI.CreatePrimvar(
@@ -318,6 +333,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
 
     void set_display_color(const pxr::VtArray<pxr::GfVec3f>& display_color)
     {
+        hash_cache.display_color.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         auto PrimVarAPI = pxr::UsdGeomPrimvarsAPI(mesh);
         pxr::UsdGeomPrimvar colorPrimvar = PrimVarAPI.CreatePrimvar(
@@ -332,36 +348,42 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
     void set_vertex_scalar_quantities(
         const std::map<std::string, pxr::VtArray<float>>& scalar)
     {
+        hash_cache.quantities.invalidate();
         vertex_scalar_quantities = scalar;
     }
 
     void set_face_scalar_quantities(
         const std::map<std::string, pxr::VtArray<float>>& scalar)
     {
+        hash_cache.quantities.invalidate();
         face_scalar_quantities = scalar;
     }
 
     void set_vertex_color_quantities(
         const std::map<std::string, pxr::VtArray<pxr::GfVec3f>>& color)
     {
+        hash_cache.quantities.invalidate();
         vertex_color_quantities = color;
     }
 
     void set_face_color_quantities(
         const std::map<std::string, pxr::VtArray<pxr::GfVec3f>>& color)
     {
+        hash_cache.quantities.invalidate();
         face_color_quantities = color;
     }
 
     void set_vertex_vector_quantities(
         const std::map<std::string, pxr::VtArray<pxr::GfVec3f>>& vector)
     {
+        hash_cache.quantities.invalidate();
         vertex_vector_quantities = vector;
     }
 
     void set_face_vector_quantities(
         const std::map<std::string, pxr::VtArray<pxr::GfVec3f>>& vector)
     {
+        hash_cache.quantities.invalidate();
         face_vector_quantities = vector;
     }
 
@@ -369,6 +391,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::map<std::string, pxr::VtArray<pxr::GfVec2f>>&
             parameterization)
     {
+        hash_cache.quantities.invalidate();
         face_corner_parameterization_quantities = parameterization;
     }
 
@@ -376,6 +399,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::map<std::string, pxr::VtArray<pxr::GfVec2f>>&
             parameterization)
     {
+        hash_cache.quantities.invalidate();
         vertex_parameterization_quantities = parameterization;
     }
 
@@ -383,6 +407,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<float>& scalar)
     {
+        hash_cache.quantities.invalidate();
         vertex_scalar_quantities[name] = scalar;
     }
 
@@ -390,6 +415,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<float>& scalar)
     {
+        hash_cache.quantities.invalidate();
         face_scalar_quantities[name] = scalar;
     }
 
@@ -397,6 +423,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec3f>& color)
     {
+        hash_cache.quantities.invalidate();
         vertex_color_quantities[name] = color;
     }
 
@@ -404,6 +431,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec3f>& color)
     {
+        hash_cache.quantities.invalidate();
         face_color_quantities[name] = color;
     }
 
@@ -411,6 +439,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec3f>& vector)
     {
+        hash_cache.quantities.invalidate();
         vertex_vector_quantities[name] = vector;
     }
 
@@ -418,6 +447,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec3f>& vector)
     {
+        hash_cache.quantities.invalidate();
         face_vector_quantities[name] = vector;
     }
 
@@ -425,6 +455,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec2f>& parameterization)
     {
+        hash_cache.quantities.invalidate();
         face_corner_parameterization_quantities[name] = parameterization;
     }
 
@@ -432,6 +463,7 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         const std::string& name,
         const pxr::VtArray<pxr::GfVec2f>& parameterization)
     {
+        hash_cache.quantities.invalidate();
         vertex_parameterization_quantities[name] = parameterization;
     }
 
@@ -473,6 +505,22 @@ struct GEOMETRY_API MeshComponent : public GeometryComponent {
         vertex_parameterization_quantities;
     // pxr::VtArray<pxr::VtArray<pxr::GfVec3f>> misc_quantities_nodes;
     // pxr::VtArray<pxr::VtArray<pxr::GfVec2i>> misc_quantities_edges;
+
+    // Per-array hashes, invalidated by the setters above. copy() carries
+    // them over since the copied arrays share their buffers.
+    struct HashCache {
+        CachedHash vertices;
+        CachedHash face_vertex_counts;
+        CachedHash face_vertex_indices;
+        CachedHash normals;
+        CachedHash display_color;
+        CachedHash texcoords;
+        CachedHash quantities;
+    };
+    HashCache hash_cache;
+
+    mutable std::shared_ptr<const MeshBVH> bvh_cache;
+    mutable std::shared_ptr<const PointKDTree> kdtree_cache;
 };
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
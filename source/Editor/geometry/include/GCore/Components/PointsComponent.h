@@ -1,28 +1,34 @@
 #pragma once
+#include <memory>
 #include <string>
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components.h"
 #include "GCore/GOP.h"
 #include "pxr/usd/usdGeom/points.h"
 #include "pxr/usd/usdGeom/xform.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
+class PointKDTree;
+
 struct GEOMETRY_API PointsComponent : public GeometryComponent {
     explicit PointsComponent(Geometry* attached_operand);
 
     std::string to_string() const override;
 
-    void apply_transform(const pxr::GfMatrix4d& transform) override
-    {
-        auto vertices = get_vertices();
-        for (auto& vertex : vertices) {
-            vertex = pxr::GfVec3f(transform.Transform(vertex));
-        }
-        set_vertices(vertices);
-    }
+    void apply_transform(const pxr::GfMatrix4d& transform) override;
 
     GeometryComponentHandle copy(Geometry* operand) const override;
 
+    uint64_t content_hash() const override;
+    uint64_t topology_hash() const override;
+    uint64_t positions_hash() const override;
+
+    // Neighbor index over the points, cached and rebuilt on access when the
+    // positions changed. Nodes keep it in their storage with
+    // PointKDTree::update instead, see MeshComponent::get_bvh.
+    std::shared_ptr<const PointKDTree> get_kdtree() const;
+
     [[nodiscard]] pxr::VtArray<pxr::GfVec3f> get_vertices() const
     {
 #if USE_USD_SCRATCH_BUFFER
@@ -55,6 +61,7 @@ struct GEOMETRY_API PointsComponent : public GeometryComponent {
 
     void set_vertices(const pxr::VtArray<pxr::GfVec3f>& vertices)
     {
+        hash_cache.vertices.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         points.CreatePointsAttr().Set(vertices);
 #else
@@ -64,6 +71,7 @@ struct GEOMETRY_API PointsComponent : public GeometryComponent {
 
     void set_display_color(const pxr::VtArray<pxr::GfVec3f>& display_color)
     {
+        hash_cache.display_color.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         points.CreateDisplayColorAttr().Set(display_color);
 #else
@@ -73,6 +81,7 @@ struct GEOMETRY_API PointsComponent : public GeometryComponent {
 
     void set_width(const pxr::VtArray<float>& width)
     {
+        hash_cache.width.invalidate();
 #if USE_USD_SCRATCH_BUFFER
         points.CreateWidthsAttr().Set(width);
 #else
@@ -95,6 +104,15 @@ struct GEOMETRY_API PointsComponent : public GeometryComponent {
     pxr::VtArray<pxr::GfVec3f> displayColor;
     pxr::VtArray<float> width;
 #endif
+
+    struct HashCache {
+        CachedHash vertices;
+        CachedHash display_color;
+        CachedHash width;
+    };
+    HashCache hash_cache;
+
+    mutable std::shared_ptr<const PointKDTree> kdtree_cache;
 };
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
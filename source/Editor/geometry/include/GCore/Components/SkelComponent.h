@@ -15,13 +15,16 @@ struct GEOMETRY_API SkelComponent : public GeometryComponent {
     {
     }
 
-    void apply_transform(const pxr::GfMatrix4d& transform) override
-    {
-        throw std::runtime_error("Not implemented");
-    }
+    void apply_transform(const pxr::GfMatrix4d& transform) override;
 
     std::string to_string() const override;
 
+    // The members are public and can be written directly, so these hashes are
+    // recomputed on every call. Skeletons are small.
+    uint64_t content_hash() const override;
+    uint64_t topology_hash() const override;
+    uint64_t positions_hash() const override;
+
     pxr::VtTokenArray jointOrder;
     pxr::UsdSkelTopology topology;
     pxr::VtArray<pxr::GfMatrix4f> localTransforms;
@@ -13,5 +13,6 @@ class GEOMETRY_API VolumeComponet : public GeometryComponent {
 
     GeometryComponentHandle copy(Geometry* operand) const override;
     std::string to_string() const override;
+    uint64_t content_hash() const override;
 };
 USTC_CG_NAMESPACE_CLOSE_SCOPE
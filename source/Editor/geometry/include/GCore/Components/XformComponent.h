@@ -23,6 +23,11 @@ class GEOMETRY_API XformComponent : public GeometryComponent {
 
     pxr::GfMatrix4d get_transform() const;
 
+    // The transform moves every point of the geometry, so it counts as
+    // position data.
+    uint64_t content_hash() const override;
+    uint64_t positions_hash() const override;
+
     std::vector<pxr::GfVec3f> translation;
     std::vector<pxr::GfVec3f> scale;
     std::vector<pxr::GfVec3f> rotation;
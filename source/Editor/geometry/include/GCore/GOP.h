@@ -3,6 +3,8 @@
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/stage.h>
 
+#include <cstdint>
+#include <filesystem>
 #include <memory>
 #include <string>
 
@@ -46,6 +48,18 @@ class GEOMETRY_API Geometry {
 
     virtual std::string to_string() const;
 
+    // Combined hashes over all components, see GeometryComponent. Equal
+    // topology_hash with a different positions_hash means the points moved
+    // but the connectivity is unchanged.
+    uint64_t content_hash() const;
+    uint64_t topology_hash() const;
+    uint64_t positions_hash() const;
+
+    // Binary snapshot that maps back without parsing, see
+    // GCore/IO/geometry_cache.h.
+    void save_cache(const std::filesystem::path& path) const;
+    static Geometry load_cache(const std::filesystem::path& path);
+
     template<typename OperandType>
     std::shared_ptr<OperandType> get_component(size_t idx = 0) const;
     void attach_component(const GeometryComponentHandle& component);
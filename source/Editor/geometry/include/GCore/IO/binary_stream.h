@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+template<typename T>
+T byte_swap(T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+// Reads a value of the given byte order from unaligned memory.
+template<typename T>
+T load_unaligned(const void* p, bool little_endian = true)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    if (little_endian != (std::endian::native == std::endian::little)) {
+        value = byte_swap(value);
+    }
+    return value;
+}
+
+// Buffered binary and text output to a file. Data is encoded into a fixed
+// size buffer that is handed to the stream whenever it fills up, which keeps
+// the per value cost at a memcpy. Throws std::runtime_error on I/O failure.
+class BinaryWriter {
+   public:
+    explicit BinaryWriter(
+        const std::filesystem::path& path,
+        bool little_endian = true,
+        size_t buffer_size = size_t(1) << 20)
+        : out_(path, std::ios::binary),
+          path_(path),
+          swap_(little_endian != (std::endian::native == std::endian::little))
+    {
+        if (!out_) {
+            throw std::runtime_error("Failed to open " + path.string());
+        }
+        buffer_.resize(buffer_size);
+    }
+
+    ~BinaryWriter()
+    {
+        // Errors are only reported through finish().
+        if (used_ && out_) {
+            out_.write(buffer_.data(), std::streamsize(used_));
+        }
+    }
+
+    void write_bytes(const void* data, size_t size)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0) {
+            if (used_ == buffer_.size()) {
+                flush();
+            }
+            const size_t n = std::min(size, buffer_.size() - used_);
+            std::memcpy(buffer_.data() + used_, p, n);
+            used_ += n;
+            p += n;
+            size -= n;
+        }
+    }
+
+    template<typename T>
+    void write(T value)
+    {
+        static_assert(std::is_arithmetic_v<T>);
+        if (swap_) {
+            value = byte_swap(value);
+        }
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_text(const std::string& text)
+    {
+        write_bytes(text.data(), text.size());
+    }
+
+    // Flushes everything to disk and checks that it was written.
+    void finish()
+    {
+        flush();
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Failed to write " + path_.string());
+        }
+    }
+
+   private:
+    void flush()
+    {
+        out_.write(buffer_.data(), std::streamsize(used_));
+        used_ = 0;
+        if (!out_) {
+            throw std::runtime_error("Failed to write " + path_.string());
+        }
+    }
+
+    std::ofstream out_;
+    std::filesystem::path path_;
+    bool swap_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
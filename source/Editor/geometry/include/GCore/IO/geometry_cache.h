@@ -0,0 +1,70 @@
+#pragma once
+
+#include <filesystem>
+
+#include "GCore/GOP.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Binary snapshot of a Geometry, meant to be memory mapped back without any
+// parsing.
+//
+// Layout (native little endian):
+//   header      GeometryCacheHeader, 64 bytes
+//   directory   one GeometryCacheEntry per stored array
+//   names       string table for component kinds, attribute and quantity
+//               names
+//   arrays      raw element data, every array starting at a multiple of 64
+//
+// Mesh, points, curve and xform components are stored with all their arrays
+// and quantity maps. Material, skeleton and volume components are not.
+constexpr uint32_t geometry_cache_version = 1;
+
+struct GeometryCacheHeader {
+    char magic[8];  // "GCCACHE\0"
+    uint32_t version;
+    uint32_t byte_order;  // 0x01020304 as written by the producer
+    uint32_t component_count;
+    uint32_t entry_count;
+    uint64_t names_offset;
+    uint64_t names_size;
+    uint64_t file_size;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(GeometryCacheHeader) == 64);
+
+struct GeometryCacheEntry {
+    uint32_t component;  // Index of the component in the Geometry.
+    uint16_t element_type;
+    uint16_t element_size;
+    // Null terminated names in the string table: the component kind
+    // ("mesh", "points", ...), the attribute ("vertices",
+    // "vertex_scalar_quantities", ...) and, for quantity maps, the quantity
+    // name (geometry_cache_no_name otherwise). Every component starts with
+    // an empty "component" entry, so that components without arrays survive
+    // the round trip.
+    uint32_t kind_offset;
+    uint32_t attribute_offset;
+    uint32_t name_offset;
+    uint32_t reserved;
+    uint64_t data_offset;
+    uint64_t count;
+};
+static_assert(sizeof(GeometryCacheEntry) == 40);
+
+constexpr uint32_t geometry_cache_no_name = 0xffffffffu;
+
+// Writes the snapshot. Throws std::runtime_error when the file cannot be
+// written.
+GEOMETRY_API void write_geometry_cache(
+    const Geometry& geometry,
+    const std::filesystem::path& path);
+
+// Maps the file and returns a Geometry whose arrays point straight into the
+// mapping. The mapping lives as long as any of these arrays; modifying an
+// array copies it first, like any other shared VtArray. Throws
+// std::runtime_error when the file is not a valid cache.
+GEOMETRY_API Geometry read_geometry_cache(const std::filesystem::path& path);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
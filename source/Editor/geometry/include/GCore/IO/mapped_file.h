@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Read-only memory mapping of a whole file. Throws std::runtime_error when
+// the file cannot be opened or mapped. Empty files map to a null pointer
+// with size 0.
+class GEOMETRY_API MappedFile {
+   public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] const char* data() const
+    {
+        return data_;
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return size_;
+    }
+
+   private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <filesystem>
+
+#include "GCore/GOP.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Wavefront OBJ geometry in the flat layout of MeshComponent.
+//
+// Texture coordinates and normals are per vertex when every face corner uses
+// the same index for its position and attribute (and the counts agree), and
+// per face corner otherwise, which is how write_usd and polyscope tell vertex
+// from faceVarying data. They are empty when the file has none.
+struct ObjData {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> face_vertex_counts;
+    pxr::VtArray<int> face_vertex_indices;
+    pxr::VtArray<pxr::GfVec2f> texcoords;
+    pxr::VtArray<pxr::GfVec3f> normals;
+};
+
+// Parses OBJ text. The buffer is cut into line aligned chunks that are parsed
+// in parallel and then concatenated, so the result does not depend on the
+// thread count. Supports v, vt, vn and f (with negative indices); other
+// statements are skipped. Throws std::runtime_error on malformed data.
+GEOMETRY_API ObjData parse_obj(const char* data, size_t size);
+
+// Memory maps the file and parses it with parse_obj.
+GEOMETRY_API ObjData read_obj(const std::filesystem::path& path);
+
+// A Geometry with one MeshComponent holding the data.
+GEOMETRY_API Geometry obj_to_geometry(ObjData data);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
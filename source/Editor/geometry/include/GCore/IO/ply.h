@@ -0,0 +1,59 @@
+#pragma once
+
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include "GCore/GOP.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// Stanford PLY polygon mesh in the flat layout of MeshComponent.
+//
+// The standard vertex properties are recognized by name: x/y/z, nx/ny/nz,
+// u/v (or s/t, texture_u/texture_v) and red/green/blue, with 8 bit colors
+// scaled to [0, 1]. Every other scalar vertex or face property is kept under
+// its own name. Arrays are empty when the file does not have them.
+struct PlyData {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> face_vertex_counts;
+    pxr::VtArray<int> face_vertex_indices;
+    pxr::VtArray<pxr::GfVec3f> normals;
+    pxr::VtArray<pxr::GfVec2f> texcoords;
+    pxr::VtArray<pxr::GfVec3f> colors;
+    std::map<std::string, pxr::VtArray<float>> vertex_scalars;
+    std::map<std::string, pxr::VtArray<float>> face_scalars;
+};
+
+enum class PlyFormat { ascii, binary_little_endian, binary_big_endian };
+
+// Parses ASCII and binary PLY. Vertex records of binary files have a fixed
+// layout and are decoded in parallel straight from the buffer. Elements other
+// than vertex and face are skipped. Throws std::runtime_error on malformed
+// data.
+GEOMETRY_API PlyData parse_ply(const char* data, size_t size);
+
+// Memory maps the file and parses it with parse_ply.
+GEOMETRY_API PlyData read_ply(const std::filesystem::path& path);
+
+// A Geometry with one MeshComponent holding the data. Colors become the
+// display color and the extra properties scalar quantities.
+GEOMETRY_API Geometry ply_to_geometry(PlyData data);
+
+// Writes the mesh with its per vertex normals, texture coordinates, display
+// color and scalar quantities. Records are encoded into a fixed size buffer
+// and streamed to disk, so no copy of the file is built in memory. Throws
+// std::runtime_error when the file cannot be written.
+GEOMETRY_API void write_ply(
+    const std::filesystem::path& path,
+    const MeshComponent& mesh,
+    PlyFormat format = PlyFormat::binary_little_endian);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
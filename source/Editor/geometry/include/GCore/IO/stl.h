@@ -0,0 +1,51 @@
+#pragma once
+
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <filesystem>
+
+#include "GCore/GOP.h"
+#include "GCore/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+struct MeshComponent;
+
+// STL triangle soup: three corners per triangle and one facet normal each.
+struct StlData {
+    pxr::VtArray<pxr::GfVec3f> corners;
+    pxr::VtArray<pxr::GfVec3f> facet_normals;
+};
+
+// Parses binary STL (decoded in parallel from its fixed 50 byte records) or
+// ASCII STL. Throws std::runtime_error on malformed data.
+GEOMETRY_API StlData parse_stl(const char* data, size_t size);
+
+// Memory maps the file and parses it with parse_stl.
+GEOMETRY_API StlData read_stl(const std::filesystem::path& path);
+
+// Shared vertices of a triangle soup.
+struct WeldResult {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    // One entry per corner.
+    pxr::VtArray<int> indices;
+};
+
+// Merges corners with equal positions, or with positions falling in the same
+// cell of a grid of the given spacing when tolerance > 0. Vertices keep the
+// order of their first corner, so the result does not depend on the thread
+// count. Corners are hashed into partitions that are welded in parallel.
+GEOMETRY_API WeldResult
+weld_vertices(const pxr::VtArray<pxr::GfVec3f>& corners, float tolerance = 0);
+
+// A Geometry with one triangle MeshComponent built from the welded soup.
+GEOMETRY_API Geometry stl_to_geometry(const StlData& data, float tolerance = 0);
+
+// Writes binary STL, fan triangulating polygons. Streams fixed size buffers
+// to disk. Throws std::runtime_error when the file cannot be written.
+GEOMETRY_API void write_stl(
+    const std::filesystem::path& path,
+    const MeshComponent& mesh);
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
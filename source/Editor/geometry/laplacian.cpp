@@ -0,0 +1,240 @@
+#include "GCore/Algorithms/laplacian.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+
+void check_triangle_mesh(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const char* name)
+{
+    if (vertices.size() != adjacency.vertex_count()) {
+        throw std::invalid_argument(
+            std::string(name) +
+            ": vertex count does not match the adjacency.");
+    }
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    for (size_t f = 0; f < adjacency.face_count(); ++f) {
+        if (offsets[f + 1] - offsets[f] != 3) {
+            throw std::invalid_argument(
+                std::string(name) + ": only triangle meshes are supported.");
+        }
+    }
+}
+
+// Corners of triangle f starting at v: v, the next corner and the previous.
+void corners_from(
+    const MeshAdjacency& adjacency,
+    uint32_t f,
+    uint32_t v,
+    uint32_t& q,
+    uint32_t& r)
+{
+    const uint32_t* c =
+        adjacency.corner_vertices().data() + adjacency.face_offsets()[f];
+    const int k = c[0] == v ? 0 : c[1] == v ? 1 : 2;
+    q = c[(k + 1) % 3];
+    r = c[(k + 2) % 3];
+}
+
+// Sorts (column, value) entries and merges those in the same column.
+void merge_entries(std::vector<std::pair<uint32_t, double>>& entries)
+{
+    std::sort(
+        entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+    size_t write = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (write > 0 && entries[write - 1].first == entries[i].first) {
+            entries[write - 1].second += entries[i].second;
+        }
+        else {
+            entries[write++] = entries[i];
+        }
+    }
+    entries.resize(write);
+}
+
+// Writes the rows produced by row(v, out) straight into the compressed
+// arrays of a sparse matrix, in two parallel passes: one to size the rows,
+// one to fill them. For a column major matrix the rows must be those of a
+// symmetric matrix, which are also its columns.
+template<typename Matrix, typename Row>
+Matrix assemble(size_t n, const Row& row)
+{
+    std::vector<int> outer(n + 1, 0);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            std::vector<std::pair<uint32_t, double>> scratch;
+            for (size_t v = begin; v < end; ++v) {
+                row(v, scratch);
+                outer[v + 1] = static_cast<int>(scratch.size());
+            }
+        },
+        grain_size);
+    for (size_t v = 0; v < n; ++v) {
+        outer[v + 1] += outer[v];
+    }
+
+    Matrix matrix(n, n);
+    matrix.resizeNonZeros(outer[n]);
+    std::copy(outer.begin(), outer.end(), matrix.outerIndexPtr());
+    int* inner = matrix.innerIndexPtr();
+    double* values = matrix.valuePtr();
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            std::vector<std::pair<uint32_t, double>> scratch;
+            for (size_t v = begin; v < end; ++v) {
+                row(v, scratch);
+                for (size_t k = 0; k < scratch.size(); ++k) {
+                    inner[outer[v] + k] = static_cast<int>(scratch[k].first);
+                    values[outer[v] + k] = scratch[k].second;
+                }
+            }
+        },
+        grain_size);
+    return matrix;
+}
+
+// Row v of the Laplacian for the given weights, diagonal included. Each
+// triangle (v, q, r) contributes to the edges vq and vr.
+void laplacian_row(
+    const MeshAdjacency& adjacency,
+    const pxr::GfVec3f* x,
+    LaplacianWeights weights,
+    uint32_t v,
+    std::vector<std::pair<uint32_t, double>>& out)
+{
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    out.clear();
+    for (const uint32_t* f = vertex_faces.begin(v); f != vertex_faces.end(v);
+         ++f) {
+        uint32_t q, r;
+        corners_from(adjacency, *f, v, q, r);
+        const pxr::GfVec3d a(x[v]), b(x[q]), c(x[r]);
+        double w_q = 0.0, w_r = 0.0;
+        switch (weights) {
+            case LaplacianWeights::uniform:
+                // Counted once per edge below.
+                break;
+            case LaplacianWeights::cotangent: {
+                const double double_area =
+                    pxr::GfCross(b - a, c - a).GetLength();
+                if (double_area > 0.0) {
+                    // Angles at q and r, opposite the edges vr and vq.
+                    w_q = 0.5 * pxr::GfDot(a - c, b - c) / double_area;
+                    w_r = 0.5 * pxr::GfDot(a - b, c - b) / double_area;
+                }
+                break;
+            }
+            case LaplacianWeights::mean_value: {
+                // tan(theta / 2) of the angle at v, divided by the length of
+                // each edge.
+                const pxr::GfVec3d e_q = b - a, e_r = c - a;
+                const double l_q = e_q.GetLength(), l_r = e_r.GetLength();
+                const double denominator =
+                    l_q * l_r + pxr::GfDot(e_q, e_r);
+                if (l_q > 0.0 && l_r > 0.0 && denominator > 0.0) {
+                    const double half_tan =
+                        pxr::GfCross(e_q, e_r).GetLength() / denominator;
+                    w_q = half_tan / l_q;
+                    w_r = half_tan / l_r;
+                }
+                break;
+            }
+        }
+        out.emplace_back(q, -w_q);
+        out.emplace_back(r, -w_r);
+    }
+    merge_entries(out);
+    double diagonal = 0.0;
+    for (auto& entry : out) {
+        if (weights == LaplacianWeights::uniform) {
+            entry.second = -1.0;
+        }
+        diagonal -= entry.second;
+    }
+    // v itself never appears among its neighbors, so the row stays sorted
+    // after inserting the diagonal in place.
+    auto at = std::lower_bound(
+        out.begin(),
+        out.end(),
+        v,
+        [](const auto& entry, uint32_t column) {
+            return entry.first < column;
+        });
+    out.insert(at, { v, diagonal });
+}
+}  // namespace
+
+Eigen::SparseMatrix<double> cotangent_laplacian(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    check_triangle_mesh(adjacency, vertices, "cotangent_laplacian");
+    const pxr::GfVec3f* x = vertices.cdata();
+    // C is symmetric, so its rows are also its columns.
+    return assemble<Eigen::SparseMatrix<double>>(
+        adjacency.vertex_count(),
+        [&](uint32_t v, std::vector<std::pair<uint32_t, double>>& out) {
+            laplacian_row(adjacency, x, LaplacianWeights::cotangent, v, out);
+        });
+}
+
+Eigen::SparseMatrix<double, Eigen::RowMajor> weighted_laplacian(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    LaplacianWeights weights)
+{
+    check_triangle_mesh(adjacency, vertices, "weighted_laplacian");
+    const pxr::GfVec3f* x = vertices.cdata();
+    return assemble<Eigen::SparseMatrix<double, Eigen::RowMajor>>(
+        adjacency.vertex_count(),
+        [&](uint32_t v, std::vector<std::pair<uint32_t, double>>& out) {
+            laplacian_row(adjacency, x, weights, v, out);
+        });
+}
+
+Eigen::VectorXd barycentric_mass(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    check_triangle_mesh(adjacency, vertices, "barycentric_mass");
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    const pxr::GfVec3f* x = vertices.cdata();
+    Eigen::VectorXd mass(adjacency.vertex_count());
+    pxr::WorkParallelForN(
+        adjacency.vertex_count(),
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (const uint32_t* f = vertex_faces.begin(v);
+                     f != vertex_faces.end(v);
+                     ++f) {
+                    uint32_t q, r;
+                    corners_from(adjacency, *f, v, q, r);
+                    const pxr::GfVec3d a(x[v]), b(x[q]), c(x[r]);
+                    sum += pxr::GfCross(b - a, c - a).GetLength();
+                }
+                mass[v] = sum / 6.0;
+            }
+        },
+        grain_size);
+    return mass;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
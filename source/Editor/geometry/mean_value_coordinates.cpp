@@ -0,0 +1,169 @@
+#include "GCore/Algorithms/mean_value_coordinates.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+// Points per block of array operations: large enough to amortize the loop
+// over the edges, small enough for the block to stay in cache.
+constexpr size_t block_size = 256;
+}  // namespace
+
+MeanValueCoordinates::MeanValueCoordinates(
+    const pxr::VtArray<pxr::GfVec2f>& polygon)
+{
+    const size_t n = polygon.size();
+    if (n < 3) {
+        throw std::invalid_argument(
+            "MeanValueCoordinates: need a polygon with at least 3 vertices.");
+    }
+    x_.resize(n);
+    y_.resize(n);
+    edge_lengths_.resize(n);
+    pxr::GfVec2f min = polygon[0], max = polygon[0];
+    for (size_t i = 0; i < n; ++i) {
+        x_[i] = polygon[i][0];
+        y_[i] = polygon[i][1];
+        edge_lengths_[i] = (polygon[(i + 1) % n] - polygon[i]).GetLength();
+        for (int k = 0; k < 2; ++k) {
+            min[k] = std::min(min[k], polygon[i][k]);
+            max[k] = std::max(max[k], polygon[i][k]);
+        }
+    }
+    epsilon_ = 1e-6f * (max - min).GetLength();
+}
+
+void MeanValueCoordinates::evaluate_block(
+    const pxr::GfVec2f* points,
+    Eigen::Index count,
+    Block& weights) const
+{
+    const Eigen::Index n = static_cast<Eigen::Index>(size());
+    Eigen::ArrayXf px(count), py(count);
+    for (Eigen::Index j = 0; j < count; ++j) {
+        px[j] = points[j][0];
+        py[j] = points[j][1];
+    }
+
+    // w_i = (tan(alpha_{i-1} / 2) + tan(alpha_i / 2)) / r_i with alpha_i the
+    // signed angle at the point between vertices i and i + 1. Each edge adds
+    // its tangent to both of its vertices.
+    weights.setZero(count, n);
+    Eigen::Array<bool, Eigen::Dynamic, 1> on_boundary =
+        Eigen::Array<bool, Eigen::Dynamic, 1>::Constant(count, false);
+    Eigen::ArrayXf sx = x_[0] - px, sy = y_[0] - py;
+    Eigen::ArrayXf r = (sx.square() + sy.square()).sqrt();
+    Eigen::ArrayXf nx, ny, nr, cross, dot, tangent;
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const Eigen::Index next = i + 1 == n ? 0 : i + 1;
+        nx = x_[next] - px;
+        ny = y_[next] - py;
+        nr = (nx.square() + ny.square()).sqrt();
+        cross = sx * ny - sy * nx;
+        dot = sx * nx + sy * ny;
+        // sin / (1 + cos) for acute angles and (1 - cos) / sin otherwise,
+        // whichever does not cancel.
+        tangent = (dot >= 0.0f).select(
+            cross / (r * nr + dot), (r * nr - dot) / cross);
+        weights.col(i) += tangent / r;
+        weights.col(next) += tangent / nr;
+        const float tolerance = epsilon_ * edge_lengths_[i];
+        on_boundary = on_boundary || r <= epsilon_ ||
+                      (dot < 0.0f && cross.abs() <= tolerance);
+        sx.swap(nx);
+        sy.swap(ny);
+        r.swap(nr);
+    }
+    const Eigen::ArrayXf sum = weights.rowwise().sum();
+    weights.colwise() /= sum;
+
+    // The few points on a vertex or an edge divided by zero above.
+    for (Eigen::Index j = 0; j < count; ++j) {
+        if (!on_boundary[j]) {
+            continue;
+        }
+        weights.row(j).setZero();
+        const float x = px[j], y = py[j];
+        Eigen::Index vertex = -1, edge = -1;
+        float t = 0.0f;
+        for (Eigen::Index i = 0; i < n && vertex < 0 && edge < 0; ++i) {
+            const Eigen::Index next = i + 1 == n ? 0 : i + 1;
+            const float ax = x_[i] - x, ay = y_[i] - y;
+            const float bx = x_[next] - x, by = y_[next] - y;
+            const float ra = std::sqrt(ax * ax + ay * ay);
+            const float rb = std::sqrt(bx * bx + by * by);
+            if (ra <= epsilon_) {
+                vertex = i;
+            }
+            else if (
+                ax * bx + ay * by < 0.0f &&
+                std::abs(ax * by - ay * bx) <= epsilon_ * edge_lengths_[i]) {
+                edge = i;
+                t = ra / (ra + rb);
+            }
+        }
+        if (vertex >= 0) {
+            weights(j, vertex) = 1.0f;
+        }
+        else if (edge >= 0) {
+            weights(j, edge) = 1.0f - t;
+            weights(j, edge + 1 == n ? 0 : edge + 1) = t;
+        }
+    }
+}
+
+void MeanValueCoordinates::evaluate(
+    const pxr::GfVec2f* points,
+    size_t count,
+    float* weights) const
+{
+    const Eigen::Index n = static_cast<Eigen::Index>(size());
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            Block block;
+            for (size_t b = begin; b < end; b += block_size) {
+                const Eigen::Index m = std::min(block_size, end - b);
+                evaluate_block(points + b, m, block);
+                Eigen::Map<Weights>(weights + b * n, m, n) = block.matrix();
+            }
+        },
+        grain_size);
+}
+
+MeanValueCoordinates::Weights MeanValueCoordinates::evaluate(
+    const pxr::VtArray<pxr::GfVec2f>& points) const
+{
+    Weights weights(points.size(), size());
+    evaluate(points.cdata(), points.size(), weights.data());
+    return weights;
+}
+
+void MeanValueCoordinates::interpolate(
+    const pxr::GfVec2f* points,
+    size_t count,
+    const pxr::GfVec2f* values,
+    pxr::GfVec2f* out) const
+{
+    using Rows = Eigen::Matrix<float, Eigen::Dynamic, 2, Eigen::RowMajor>;
+    const Eigen::Map<const Rows> cage(values->data(), size(), 2);
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            Block block;
+            for (size_t b = begin; b < end; b += block_size) {
+                const Eigen::Index m = std::min(block_size, end - b);
+                evaluate_block(points + b, m, block);
+                Eigen::Map<Rows>(out[b].data(), m, 2) = block.matrix() * cage;
+            }
+        },
+        grain_size);
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,252 @@
+#include "GCore/Algorithms/mesh_adjacency.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+
+// Fills CSR lists in two parallel passes over the elements: one to size the
+// lists, one to write them. collect(i, out) replaces out with the list of
+// element i.
+template<typename Collect>
+NeighborLists build_lists(size_t count, const Collect& collect)
+{
+    NeighborLists lists;
+    lists.offsets.assign(count + 1, 0);
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> scratch;
+            for (size_t i = begin; i < end; ++i) {
+                collect(i, scratch);
+                lists.offsets[i + 1] = static_cast<uint32_t>(scratch.size());
+            }
+        },
+        grain_size);
+    std::partial_sum(
+        lists.offsets.begin(), lists.offsets.end(), lists.offsets.begin());
+
+    lists.indices.resize(lists.offsets.back());
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> scratch;
+            for (size_t i = begin; i < end; ++i) {
+                collect(i, scratch);
+                std::copy(
+                    scratch.begin(),
+                    scratch.end(),
+                    lists.indices.begin() + lists.offsets[i]);
+            }
+        },
+        grain_size);
+    return lists;
+}
+
+// Number of faces around both a and b, stopping at `limit`.
+size_t count_shared(
+    const NeighborLists& vertex_faces,
+    uint32_t a,
+    uint32_t b,
+    size_t limit)
+{
+    const uint32_t* i = vertex_faces.begin(a);
+    const uint32_t* j = vertex_faces.begin(b);
+    size_t count = 0;
+    while (i != vertex_faces.end(a) && j != vertex_faces.end(b) &&
+           count < limit) {
+        if (*i < *j) {
+            ++i;
+        }
+        else if (*j < *i) {
+            ++j;
+        }
+        else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+}  // namespace
+
+MeshAdjacency::MeshAdjacency(
+    const pxr::VtArray<int>& face_vertex_counts,
+    const pxr::VtArray<int>& face_vertex_indices,
+    size_t vertex_count)
+{
+    const size_t face_count = face_vertex_counts.size();
+    face_offsets_.resize(face_count + 1);
+    face_offsets_[0] = 0;
+    for (size_t f = 0; f < face_count; ++f) {
+        if (face_vertex_counts[f] < 0) {
+            throw std::invalid_argument(
+                "MeshAdjacency: negative face vertex count.");
+        }
+        face_offsets_[f + 1] = face_offsets_[f] + face_vertex_counts[f];
+    }
+    if (face_offsets_.back() != face_vertex_indices.size()) {
+        throw std::invalid_argument(
+            "MeshAdjacency: face vertex counts do not match the indices.");
+    }
+
+    corner_vertices_.resize(face_vertex_indices.size());
+    vertex_faces_.offsets.assign(vertex_count + 1, 0);
+    for (size_t c = 0; c < face_vertex_indices.size(); ++c) {
+        const int v = face_vertex_indices[c];
+        if (v < 0 || static_cast<size_t>(v) >= vertex_count) {
+            throw std::invalid_argument(
+                "MeshAdjacency: face vertex index out of range.");
+        }
+        corner_vertices_[c] = v;
+        ++vertex_faces_.offsets[v + 1];
+    }
+    std::partial_sum(
+        vertex_faces_.offsets.begin(),
+        vertex_faces_.offsets.end(),
+        vertex_faces_.offsets.begin());
+
+    // Faces are visited in order, so every list comes out sorted. A vertex
+    // used twice by a face lists it once.
+    vertex_faces_.indices.resize(corner_vertices_.size());
+    std::vector<uint32_t> cursor(
+        vertex_faces_.offsets.begin(), vertex_faces_.offsets.end() - 1);
+    for (uint32_t f = 0; f < face_count; ++f) {
+        for (uint32_t c = face_offsets_[f]; c < face_offsets_[f + 1]; ++c) {
+            const uint32_t v = corner_vertices_[c];
+            if (cursor[v] == vertex_faces_.offsets[v] ||
+                vertex_faces_.indices[cursor[v] - 1] != f) {
+                vertex_faces_.indices[cursor[v]++] = f;
+            }
+        }
+    }
+    // Compact the lists shortened by repeated vertices.
+    uint32_t write = 0;
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const uint32_t begin = vertex_faces_.offsets[v];
+        vertex_faces_.offsets[v] = write;
+        for (uint32_t i = begin; i < cursor[v]; ++i) {
+            vertex_faces_.indices[write++] = vertex_faces_.indices[i];
+        }
+    }
+    vertex_faces_.offsets[vertex_count] = write;
+    vertex_faces_.indices.resize(write);
+
+    edge_neighbors_ =
+        build_lists(face_count, [&](size_t f, std::vector<uint32_t>& out) {
+            out.clear();
+            const uint32_t begin = face_offsets_[f];
+            const uint32_t n = face_offsets_[f + 1] - begin;
+            for (uint32_t k = 0; k < n; ++k) {
+                const uint32_t a = corner_vertices_[begin + k];
+                const uint32_t b = corner_vertices_[begin + (k + 1) % n];
+                const uint32_t* i = vertex_faces_.begin(a);
+                const uint32_t* j = vertex_faces_.begin(b);
+                while (i != vertex_faces_.end(a) &&
+                       j != vertex_faces_.end(b)) {
+                    if (*i < *j) {
+                        ++i;
+                    }
+                    else if (*j < *i) {
+                        ++j;
+                    }
+                    else {
+                        if (*i != f) {
+                            out.push_back(*i);
+                        }
+                        ++i;
+                        ++j;
+                    }
+                }
+            }
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        });
+
+    boundary_vertices_.resize(vertex_count);
+    pxr::WorkParallelForN(
+        vertex_count,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                uint8_t boundary = 0;
+                for (const uint32_t* f = vertex_faces_.begin(v);
+                     f != vertex_faces_.end(v) && !boundary;
+                     ++f) {
+                    const uint32_t first = face_offsets_[*f];
+                    const uint32_t n = face_offsets_[*f + 1] - first;
+                    for (uint32_t k = 0; k < n; ++k) {
+                        if (corner_vertices_[first + k] != v) {
+                            continue;
+                        }
+                        const uint32_t next =
+                            corner_vertices_[first + (k + 1) % n];
+                        const uint32_t prev =
+                            corner_vertices_[first + (k + n - 1) % n];
+                        if (count_shared(vertex_faces_, v, next, 2) < 2 ||
+                            count_shared(vertex_faces_, v, prev, 2) < 2) {
+                            boundary = 1;
+                        }
+                        break;
+                    }
+                }
+                boundary_vertices_[v] = boundary;
+            }
+        },
+        grain_size);
+}
+
+std::shared_ptr<const MeshAdjacency> MeshAdjacency::update(
+    const std::shared_ptr<const MeshAdjacency>& previous,
+    const MeshComponent& mesh)
+{
+    const uint64_t topology = mesh.topology_hash();
+    if (previous && previous->topology_hash_ == topology &&
+        previous->vertex_count() == mesh.get_vertices().size()) {
+        return previous;
+    }
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        mesh.get_face_vertex_counts(),
+        mesh.get_face_vertex_indices(),
+        mesh.get_vertices().size());
+    adjacency->topology_hash_ = topology;
+    return adjacency;
+}
+
+const NeighborLists& MeshAdjacency::face_neighbors(
+    FaceNeighborhood neighborhood) const
+{
+    if (neighborhood == FaceNeighborhood::edge) {
+        return edge_neighbors_;
+    }
+    std::call_once(vertex_neighbors_once_, [&] {
+        vertex_neighbors_ = build_lists(
+            face_count(), [&](size_t f, std::vector<uint32_t>& out) {
+                out.clear();
+                for (uint32_t c = face_offsets_[f]; c < face_offsets_[f + 1];
+                     ++c) {
+                    const uint32_t v = corner_vertices_[c];
+                    for (const uint32_t* g = vertex_faces_.begin(v);
+                         g != vertex_faces_.end(v);
+                         ++g) {
+                        if (*g != f) {
+                            out.push_back(*g);
+                        }
+                    }
+                }
+                std::sort(out.begin(), out.end());
+                out.erase(std::unique(out.begin(), out.end()), out.end());
+            });
+    });
+    return vertex_neighbors_;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
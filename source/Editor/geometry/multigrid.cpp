@@ -0,0 +1,192 @@
+#include "GCore/Algorithms/multigrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+// Levels stop once they are small enough to factor directly.
+constexpr Eigen::Index coarsest_size = 2000;
+constexpr size_t max_levels = 20;
+// Off-diagonal entries below this fraction of the geometric mean of the
+// two diagonal entries do not pull vertices into the same aggregate.
+constexpr double strength_threshold = 0.05;
+
+using RowMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+bool strong(const Eigen::VectorXd& diagonal, int i, int j, double value)
+{
+    const double scale = std::sqrt(std::abs(diagonal[i] * diagonal[j]));
+    return j != i && std::abs(value) > strength_threshold * scale;
+}
+
+// Greedy aggregation in three passes: whole neighborhoods that are still
+// free become aggregates, the remaining vertices join the aggregate they
+// are most strongly connected to, and whatever is left forms aggregates
+// with its free neighbors. Returns the number of aggregates.
+int aggregate(
+    const RowMatrix& a,
+    const Eigen::VectorXd& diagonal,
+    std::vector<int>& aggregate_of)
+{
+    const int n = static_cast<int>(a.rows());
+    aggregate_of.assign(n, -1);
+    int count = 0;
+
+    for (int i = 0; i < n; ++i) {
+        bool free = aggregate_of[i] < 0;
+        bool connected = false;
+        for (RowMatrix::InnerIterator it(a, i); it && free; ++it) {
+            if (strong(diagonal, i, it.col(), it.value())) {
+                connected = true;
+                free = aggregate_of[it.col()] < 0;
+            }
+        }
+        if (!free || !connected) {
+            continue;
+        }
+        aggregate_of[i] = count;
+        for (RowMatrix::InnerIterator it(a, i); it; ++it) {
+            if (strong(diagonal, i, it.col(), it.value())) {
+                aggregate_of[it.col()] = count;
+            }
+        }
+        ++count;
+    }
+
+    // Joining only aggregates from the first pass keeps them compact.
+    std::vector<int> first_pass = aggregate_of;
+    for (int i = 0; i < n; ++i) {
+        if (aggregate_of[i] >= 0) {
+            continue;
+        }
+        double best = 0.0;
+        for (RowMatrix::InnerIterator it(a, i); it; ++it) {
+            const int j = static_cast<int>(it.col());
+            if (strong(diagonal, i, j, it.value()) && first_pass[j] >= 0 &&
+                std::abs(it.value()) > best) {
+                best = std::abs(it.value());
+                aggregate_of[i] = first_pass[j];
+            }
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        if (aggregate_of[i] >= 0) {
+            continue;
+        }
+        aggregate_of[i] = count;
+        for (RowMatrix::InnerIterator it(a, i); it; ++it) {
+            const int j = static_cast<int>(it.col());
+            if (strong(diagonal, i, j, it.value()) && aggregate_of[j] < 0) {
+                aggregate_of[j] = count;
+            }
+        }
+        ++count;
+    }
+    return count;
+}
+
+void gauss_seidel(
+    const RowMatrix& a,
+    const Eigen::VectorXd& inverse_diagonal,
+    const Eigen::VectorXd& b,
+    Eigen::VectorXd& x,
+    bool forward)
+{
+    const Eigen::Index n = a.rows();
+    const int* outer = a.outerIndexPtr();
+    const int* inner = a.innerIndexPtr();
+    const double* values = a.valuePtr();
+    for (Eigen::Index k = 0; k < n; ++k) {
+        const Eigen::Index i = forward ? k : n - 1 - k;
+        double sum = b[i];
+        for (int e = outer[i]; e < outer[i + 1]; ++e) {
+            if (inner[e] != i) {
+                sum -= values[e] * x[inner[e]];
+            }
+        }
+        x[i] = sum * inverse_diagonal[i];
+    }
+}
+}  // namespace
+
+void AggregationMultigrid::build(RowMatrix matrix)
+{
+    levels_.clear();
+    size_ = matrix.rows();
+    info_ = Eigen::Success;
+    matrix.makeCompressed();
+
+    std::vector<int> aggregate_of;
+    while (matrix.rows() > coarsest_size && levels_.size() < max_levels) {
+        const Eigen::Index n = matrix.rows();
+        const Eigen::VectorXd diagonal = matrix.diagonal();
+        if ((diagonal.array() == 0.0).any()) {
+            info_ = Eigen::NumericalIssue;
+            return;
+        }
+        const int coarse = aggregate(matrix, diagonal, aggregate_of);
+        if (coarse >= 0.8 * n) {
+            break;
+        }
+
+        // Smooth the piecewise constant tentative prolongation with one
+        // damped Jacobi step, P = (I - omega D^-1 A) P0, omega = 4 / (3 rho)
+        // with the Gershgorin bound rho of the spectral radius of D^-1 A.
+        double rho = 0.0;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            double sum = 0.0;
+            for (RowMatrix::InnerIterator it(matrix, i); it; ++it) {
+                sum += std::abs(it.value());
+            }
+            rho = std::max(rho, sum / std::abs(diagonal[i]));
+        }
+        const double omega = 4.0 / (3.0 * rho);
+
+        RowMatrix tentative(n, coarse);
+        tentative.reserve(Eigen::VectorXi::Ones(n));
+        for (Eigen::Index i = 0; i < n; ++i) {
+            tentative.insert(i, aggregate_of[i]) = 1.0;
+        }
+        Level level;
+        level.inverse_diagonal = diagonal.cwiseInverse();
+        level.prolongation =
+            tentative - RowMatrix(
+                            (omega * level.inverse_diagonal).asDiagonal() *
+                            RowMatrix(matrix * tentative));
+        level.prolongation.prune(0.0);
+        RowMatrix next =
+            RowMatrix(level.prolongation.transpose()) *
+            RowMatrix(matrix * level.prolongation);
+        next.makeCompressed();
+        level.matrix = std::move(matrix);
+        levels_.push_back(std::move(level));
+        matrix = std::move(next);
+    }
+
+    coarsest_.compute(Eigen::SparseMatrix<double>(matrix));
+    info_ = coarsest_.info();
+}
+
+void AggregationMultigrid::cycle(
+    size_t level,
+    const Eigen::VectorXd& b,
+    Eigen::VectorXd& x) const
+{
+    if (level == levels_.size()) {
+        x = coarsest_.solve(b);
+        return;
+    }
+    const Level& l = levels_[level];
+    x.setZero(b.size());
+    gauss_seidel(l.matrix, l.inverse_diagonal, b, x, true);
+    const Eigen::VectorXd residual = b - l.matrix * x;
+    Eigen::VectorXd correction;
+    cycle(level + 1, l.prolongation.transpose() * residual, correction);
+    x += l.prolongation * correction;
+    gauss_seidel(l.matrix, l.inverse_diagonal, b, x, false);
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
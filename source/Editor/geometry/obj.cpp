@@ -0,0 +1,462 @@
+#include "GCore/IO/obj.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/mapped_file.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+// Small enough to keep every core busy on moderately sized files, large
+// enough that per chunk bookkeeping does not matter.
+constexpr size_t chunk_size = size_t(4) << 20;
+
+// Flags marking negative (relative) OBJ indices, which are stored relative to
+// the start of the chunk until the counts of earlier chunks are known.
+enum : uint8_t {
+    relative_v = 1,
+    relative_vt = 2,
+    relative_vn = 4,
+};
+
+// Marks a corner without texture coordinate or normal.
+constexpr int absent = INT_MIN;
+
+struct Corner {
+    int v;
+    int vt;
+    int vn;
+    uint8_t relative;
+};
+
+struct Chunk {
+    std::vector<pxr::GfVec3f> vertices;
+    std::vector<pxr::GfVec2f> texcoords;
+    std::vector<pxr::GfVec3f> normals;
+    std::vector<int> counts;
+    std::vector<Corner> corners;
+    bool any_texcoord = false;
+    bool any_normal = false;
+
+    // Offset of the first error in the whole buffer, SIZE_MAX if none.
+    size_t error_offset = SIZE_MAX;
+    const char* error = nullptr;
+};
+
+inline bool is_blank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+inline bool is_line_end(char c)
+{
+    return c == '\n' || c == '\r' || c == '#';
+}
+
+inline const char* skip_blank(const char* p, const char* end)
+{
+    while (p < end && is_blank(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* skip_line(const char* p, const char* end)
+{
+    const void* newline = std::memchr(p, '\n', end - p);
+    return newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+const char* parse_float(const char* p, const char* end, float& value)
+{
+    p = skip_blank(p, end);
+    if (p < end && *p == '+') {
+        ++p;
+    }
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+    const auto [next, ec] = std::from_chars(p, end, value);
+    if (ec == std::errc::result_out_of_range) {
+        // Denormals and overflow: fall back to strtof for the saturated
+        // value, the token itself was valid.
+        value = std::strtof(std::string(p, next).c_str(), nullptr);
+        return next;
+    }
+    return ec == std::errc() ? next : nullptr;
+#else
+    // Only used by standard libraries without floating point from_chars.
+    char buffer[64];
+    const size_t length = std::min<size_t>(end - p, sizeof(buffer) - 1);
+    std::copy(p, p + length, buffer);
+    buffer[length] = '\0';
+    char* next = nullptr;
+    value = std::strtof(buffer, &next);
+    return next == buffer ? nullptr : p + (next - buffer);
+#endif
+}
+
+inline const char* parse_int(const char* p, const char* end, int& value)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    const char* begin = p;
+    int64_t result = 0;
+    while (p < end && unsigned(*p - '0') < 10) {
+        result = result * 10 + (*p - '0');
+        if (result > INT32_MAX) {
+            return nullptr;
+        }
+        ++p;
+    }
+    if (p == begin) {
+        return nullptr;
+    }
+    value = int(negative ? -result : result);
+    return p;
+}
+
+// Resolves an OBJ index (1-based, or negative counting back from the most
+// recent element) against the number of elements seen so far in the chunk.
+inline bool
+resolve_index(int raw, int local_count, uint8_t flag, int& out, uint8_t& flags)
+{
+    if (raw > 0) {
+        out = raw - 1;
+        return true;
+    }
+    if (raw < 0) {
+        out = local_count + raw;
+        flags |= flag;
+        return true;
+    }
+    return false;
+}
+
+void parse_chunk(
+    const char* data,
+    const char* p,
+    const char* end,
+    Chunk& chunk)
+{
+    auto fail = [&](const char* where, const char* message) {
+        chunk.error_offset = size_t(where - data);
+        chunk.error = message;
+    };
+
+    while (p < end) {
+        p = skip_blank(p, end);
+        if (p == end) {
+            break;
+        }
+        const char* line = p;
+        const char c = *p;
+
+        if (c == 'v' && p + 1 < end) {
+            const char kind = p[1];
+            if (is_blank(kind)) {
+                pxr::GfVec3f v;
+                p += 1;
+                for (int k = 0; k < 3 && p; ++k) {
+                    p = parse_float(p, end, v[k]);
+                }
+                if (!p) {
+                    return fail(line, "malformed vertex");
+                }
+                chunk.vertices.push_back(v);
+            }
+            else if (kind == 't' && p + 2 < end && is_blank(p[2])) {
+                // v is optional and defaults to 0.
+                pxr::GfVec2f vt(0.0f);
+                p = parse_float(p + 2, end, vt[0]);
+                if (p) {
+                    p = skip_blank(p, end);
+                    if (p < end && !is_line_end(*p)) {
+                        p = parse_float(p, end, vt[1]);
+                    }
+                }
+                if (!p) {
+                    return fail(line, "malformed texture coordinate");
+                }
+                chunk.texcoords.push_back(vt);
+            }
+            else if (kind == 'n' && p + 2 < end && is_blank(p[2])) {
+                pxr::GfVec3f vn;
+                p += 2;
+                for (int k = 0; k < 3 && p; ++k) {
+                    p = parse_float(p, end, vn[k]);
+                }
+                if (!p) {
+                    return fail(line, "malformed normal");
+                }
+                chunk.normals.push_back(vn);
+            }
+        }
+        else if (c == 'f' && p + 1 < end && is_blank(p[1])) {
+            p += 1;
+            int count = 0;
+            while (true) {
+                p = skip_blank(p, end);
+                if (p == end || is_line_end(*p)) {
+                    break;
+                }
+                Corner corner{ 0, absent, absent, 0 };
+                int raw;
+                p = parse_int(p, end, raw);
+                if (!p || !resolve_index(
+                              raw,
+                              int(chunk.vertices.size()),
+                              relative_v,
+                              corner.v,
+                              corner.relative)) {
+                    return fail(line, "malformed face");
+                }
+                if (p < end && *p == '/') {
+                    ++p;
+                    if (p < end && *p != '/') {
+                        p = parse_int(p, end, raw);
+                        if (!p || !resolve_index(
+                                      raw,
+                                      int(chunk.texcoords.size()),
+                                      relative_vt,
+                                      corner.vt,
+                                      corner.relative)) {
+                            return fail(line, "malformed face");
+                        }
+                        chunk.any_texcoord = true;
+                    }
+                    if (p < end && *p == '/') {
+                        ++p;
+                        p = parse_int(p, end, raw);
+                        if (!p || !resolve_index(
+                                      raw,
+                                      int(chunk.normals.size()),
+                                      relative_vn,
+                                      corner.vn,
+                                      corner.relative)) {
+                            return fail(line, "malformed face");
+                        }
+                        chunk.any_normal = true;
+                    }
+                }
+                if (p < end && !is_blank(*p) && !is_line_end(*p)) {
+                    return fail(line, "malformed face");
+                }
+                chunk.corners.push_back(corner);
+                ++count;
+            }
+            if (count < 3) {
+                return fail(line, "face with fewer than three corners");
+            }
+            chunk.counts.push_back(count);
+        }
+        p = skip_line(p, end);
+    }
+}
+
+}  // namespace
+
+ObjData parse_obj(const char* data, size_t size)
+{
+    // Line aligned chunk boundaries.
+    const size_t chunk_count = std::max<size_t>(1, size / chunk_size);
+    std::vector<const char*> bounds(chunk_count + 1);
+    bounds[0] = data;
+    bounds[chunk_count] = data + size;
+    for (size_t i = 1; i < chunk_count; ++i) {
+        const char* p =
+            std::max(data + i * (size / chunk_count), bounds[i - 1]);
+        bounds[i] = skip_line(p, data + size);
+    }
+
+    std::vector<Chunk> chunks(chunk_count);
+    pxr::WorkParallelForN(
+        chunk_count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                parse_chunk(data, bounds[i], bounds[i + 1], chunks[i]);
+            }
+        },
+        1);
+
+    for (const auto& chunk : chunks) {
+        if (chunk.error) {
+            throw std::runtime_error(
+                std::string("OBJ: ") + chunk.error + " at byte " +
+                std::to_string(chunk.error_offset));
+        }
+    }
+
+    // Offsets of each chunk in the concatenated arrays.
+    struct Offsets {
+        size_t v = 0, vt = 0, vn = 0, faces = 0, corners = 0;
+    };
+    std::vector<Offsets> offsets(chunk_count + 1);
+    bool any_texcoord = false;
+    bool any_normal = false;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        offsets[i + 1].v = offsets[i].v + chunks[i].vertices.size();
+        offsets[i + 1].vt = offsets[i].vt + chunks[i].texcoords.size();
+        offsets[i + 1].vn = offsets[i].vn + chunks[i].normals.size();
+        offsets[i + 1].faces = offsets[i].faces + chunks[i].counts.size();
+        offsets[i + 1].corners = offsets[i].corners + chunks[i].corners.size();
+        any_texcoord |= chunks[i].any_texcoord;
+        any_normal |= chunks[i].any_normal;
+    }
+    const Offsets& total = offsets[chunk_count];
+    if (total.v > size_t(INT32_MAX) || total.corners > size_t(INT32_MAX)) {
+        throw std::runtime_error("OBJ: too many elements");
+    }
+
+    ObjData result;
+    result.vertices.resize(total.v);
+    result.face_vertex_counts.resize(total.faces);
+    result.face_vertex_indices.resize(total.corners);
+    std::vector<int> corner_vt(any_texcoord ? total.corners : 0);
+    std::vector<int> corner_vn(any_normal ? total.corners : 0);
+    std::vector<pxr::GfVec2f> texcoords(total.vt);
+    std::vector<pxr::GfVec3f> normals(total.vn);
+
+    // Concatenate and resolve indices. Also track whether the attribute
+    // indices coincide with the position indices.
+    std::vector<char> bad_index(chunk_count, 0);
+    std::vector<char> texcoord_matches(chunk_count, 1);
+    std::vector<char> normal_matches(chunk_count, 1);
+    pxr::WorkParallelForN(
+        chunk_count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Chunk& chunk = chunks[i];
+                const Offsets& o = offsets[i];
+                std::copy(
+                    chunk.vertices.begin(),
+                    chunk.vertices.end(),
+                    result.vertices.begin() + o.v);
+                std::copy(
+                    chunk.texcoords.begin(),
+                    chunk.texcoords.end(),
+                    texcoords.begin() + o.vt);
+                std::copy(
+                    chunk.normals.begin(),
+                    chunk.normals.end(),
+                    normals.begin() + o.vn);
+                std::copy(
+                    chunk.counts.begin(),
+                    chunk.counts.end(),
+                    result.face_vertex_counts.begin() + o.faces);
+
+                for (size_t c = 0; c < chunk.corners.size(); ++c) {
+                    const Corner& corner = chunk.corners[c];
+                    const size_t out = o.corners + c;
+                    const int64_t v =
+                        corner.v +
+                        ((corner.relative & relative_v) ? int64_t(o.v) : 0);
+                    if (v < 0 || v >= int64_t(total.v)) {
+                        bad_index[i] = 1;
+                        continue;
+                    }
+                    result.face_vertex_indices[out] = int(v);
+
+                    // Resolves an attribute index, -1 for absent ones.
+                    auto resolve = [&](int index, uint8_t flag, size_t base,
+                                       size_t count) -> int64_t {
+                        if (index == absent) {
+                            return -1;
+                        }
+                        const int64_t resolved =
+                            index +
+                            ((corner.relative & flag) ? int64_t(base) : 0);
+                        if (resolved < 0 || resolved >= int64_t(count)) {
+                            bad_index[i] = 1;
+                            return -1;
+                        }
+                        return resolved;
+                    };
+                    if (any_texcoord) {
+                        const int64_t vt =
+                            resolve(corner.vt, relative_vt, o.vt, total.vt);
+                        corner_vt[out] = int(vt);
+                        texcoord_matches[i] &= vt == v;
+                    }
+                    if (any_normal) {
+                        const int64_t vn =
+                            resolve(corner.vn, relative_vn, o.vn, total.vn);
+                        corner_vn[out] = int(vn);
+                        normal_matches[i] &= vn == v;
+                    }
+                }
+            }
+        },
+        1);
+
+    if (std::find(bad_index.begin(), bad_index.end(), 1) != bad_index.end()) {
+        throw std::runtime_error("OBJ: face index out of range");
+    }
+
+    // Per vertex when the attribute indices follow the positions, per face
+    // corner otherwise. Corners without an attribute get zero.
+    auto expand = [&](const auto& values,
+                      const std::vector<int>& corner_index,
+                      const std::vector<char>& matches,
+                      auto& out) {
+        if (corner_index.empty()) {
+            return;
+        }
+        const bool per_vertex =
+            values.size() == total.v &&
+            std::find(matches.begin(), matches.end(), 0) == matches.end();
+        if (per_vertex) {
+            out.assign(values.begin(), values.end());
+            return;
+        }
+        out.resize(total.corners);
+        using Value = typename std::decay_t<decltype(out)>::value_type;
+        pxr::WorkParallelForN(total.corners, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                const int index = corner_index[c];
+                out[c] = index >= 0 ? values[index] : Value(0);
+            }
+        });
+    };
+    expand(texcoords, corner_vt, texcoord_matches, result.texcoords);
+    expand(normals, corner_vn, normal_matches, result.normals);
+
+    return result;
+}
+
+ObjData read_obj(const std::filesystem::path& path)
+{
+    MappedFile file(path);
+    return parse_obj(file.data(), file.size());
+}
+
+Geometry obj_to_geometry(ObjData data)
+{
+    Geometry geometry;
+    auto mesh = std::make_shared<MeshComponent>(&geometry);
+    geometry.attach_component(mesh);
+    mesh->set_vertices(data.vertices);
+    mesh->set_face_vertex_counts(data.face_vertex_counts);
+    mesh->set_face_vertex_indices(data.face_vertex_indices);
+    if (!data.texcoords.empty()) {
+        mesh->set_texcoords_array(data.texcoords);
+    }
+    if (!data.normals.empty()) {
+        mesh->set_normals(data.normals);
+    }
+    return geometry;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
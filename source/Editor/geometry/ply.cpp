@@ -0,0 +1,889 @@
+#include "GCore/IO/ply.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/binary_stream.h"
+#include "GCore/IO/mapped_file.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+enum class PlyType : uint8_t {
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    float32,
+    float64,
+};
+
+size_t type_size(PlyType type)
+{
+    switch (type) {
+        case PlyType::int8:
+        case PlyType::uint8: return 1;
+        case PlyType::int16:
+        case PlyType::uint16: return 2;
+        case PlyType::int32:
+        case PlyType::uint32:
+        case PlyType::float32: return 4;
+        case PlyType::float64: return 8;
+    }
+    return 0;
+}
+
+bool is_float(PlyType type)
+{
+    return type == PlyType::float32 || type == PlyType::float64;
+}
+
+bool parse_type(const std::string& name, PlyType& type)
+{
+    static const std::pair<const char*, PlyType> names[] = {
+        { "char", PlyType::int8 },      { "int8", PlyType::int8 },
+        { "uchar", PlyType::uint8 },    { "uint8", PlyType::uint8 },
+        { "short", PlyType::int16 },    { "int16", PlyType::int16 },
+        { "ushort", PlyType::uint16 },  { "uint16", PlyType::uint16 },
+        { "int", PlyType::int32 },      { "int32", PlyType::int32 },
+        { "uint", PlyType::uint32 },    { "uint32", PlyType::uint32 },
+        { "float", PlyType::float32 },  { "float32", PlyType::float32 },
+        { "double", PlyType::float64 }, { "float64", PlyType::float64 },
+    };
+    for (const auto& [n, t] : names) {
+        if (name == n) {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+double decode(const char* p, PlyType type, bool little_endian)
+{
+    switch (type) {
+        case PlyType::int8: return double(int8_t(*p));
+        case PlyType::uint8: return double(uint8_t(*p));
+        case PlyType::int16: return load_unaligned<int16_t>(p, little_endian);
+        case PlyType::uint16: return load_unaligned<uint16_t>(p, little_endian);
+        case PlyType::int32: return load_unaligned<int32_t>(p, little_endian);
+        case PlyType::uint32: return load_unaligned<uint32_t>(p, little_endian);
+        case PlyType::float32: return load_unaligned<float>(p, little_endian);
+        case PlyType::float64: return load_unaligned<double>(p, little_endian);
+    }
+    return 0;
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type = PlyType::float32;
+    bool is_list = false;
+    PlyType count_type = PlyType::uint8;
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count = 0;
+    std::vector<PlyProperty> properties;
+
+    // Record size in bytes when no property is a list, 0 otherwise.
+    size_t fixed_stride() const
+    {
+        size_t stride = 0;
+        for (const auto& property : properties) {
+            if (property.is_list) {
+                return 0;
+            }
+            stride += type_size(property.type);
+        }
+        return stride;
+    }
+
+    // Fewest bytes a record can take: every scalar and list count in binary,
+    // one character per property in ASCII.
+    size_t min_record_size(bool ascii) const
+    {
+        if (ascii) {
+            return properties.size();
+        }
+        size_t size = 0;
+        for (const auto& property : properties) {
+            size += type_size(
+                property.is_list ? property.count_type : property.type);
+        }
+        return size;
+    }
+};
+
+struct PlyHeader {
+    PlyFormat format = PlyFormat::ascii;
+    std::vector<PlyElement> elements;
+    size_t body_offset = 0;
+};
+
+[[noreturn]] void fail(const std::string& message)
+{
+    throw std::runtime_error("PLY: " + message);
+}
+
+PlyHeader parse_header(const char* data, size_t size)
+{
+    const std::string_view text(data, size);
+    if (text.substr(0, 3) != "ply") {
+        fail("missing magic number");
+    }
+    size_t end = text.find("end_header");
+    if (end == std::string_view::npos) {
+        fail("missing end_header");
+    }
+    PlyHeader header;
+    header.body_offset = text.find('\n', end);
+    if (header.body_offset == std::string_view::npos) {
+        fail("missing end_header");
+    }
+    header.body_offset += 1;
+
+    std::istringstream in{ std::string(text.substr(0, end)) };
+    std::string line;
+    bool has_format = false;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string keyword;
+        ss >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            ss >> format;
+            if (format == "ascii") {
+                header.format = PlyFormat::ascii;
+            }
+            else if (format == "binary_little_endian") {
+                header.format = PlyFormat::binary_little_endian;
+            }
+            else if (format == "binary_big_endian") {
+                header.format = PlyFormat::binary_big_endian;
+            }
+            else {
+                fail("unknown format " + format);
+            }
+            has_format = true;
+        }
+        else if (keyword == "element") {
+            PlyElement element;
+            if (!(ss >> element.name >> element.count)) {
+                fail("bad element line '" + line + "'");
+            }
+            header.elements.push_back(std::move(element));
+        }
+        else if (keyword == "property") {
+            if (header.elements.empty()) {
+                fail("property before element");
+            }
+            PlyProperty property;
+            std::string type;
+            ss >> type;
+            bool valid = true;
+            if (type == "list") {
+                std::string count_type, item_type;
+                ss >> count_type >> item_type;
+                property.is_list = true;
+                valid = parse_type(count_type, property.count_type) &&
+                        parse_type(item_type, property.type) &&
+                        !is_float(property.count_type);
+            }
+            else {
+                valid = parse_type(type, property.type);
+            }
+            if (!valid || !(ss >> property.name)) {
+                fail("bad property line '" + line + "'");
+            }
+            header.elements.back().properties.push_back(std::move(property));
+        }
+        // comment, obj_info and unknown keywords are ignored.
+    }
+    if (!has_format) {
+        fail("missing format");
+    }
+    return header;
+}
+
+// Sequential access to the body, in either encoding.
+class BinaryCursor {
+   public:
+    BinaryCursor(const char* begin, const char* end, bool little_endian)
+        : p_(begin),
+          end_(end),
+          little_endian_(little_endian)
+    {
+    }
+
+    double read(PlyType type)
+    {
+        const size_t n = type_size(type);
+        if (size_t(end_ - p_) < n) {
+            fail("unexpected end of data");
+        }
+        const double value = decode(p_, type, little_endian_);
+        p_ += n;
+        return value;
+    }
+
+    void skip(size_t bytes)
+    {
+        if (size_t(end_ - p_) < bytes) {
+            fail("unexpected end of data");
+        }
+        p_ += bytes;
+    }
+
+    const char* position() const
+    {
+        return p_;
+    }
+
+   private:
+    const char* p_;
+    const char* end_;
+    bool little_endian_;
+};
+
+class AsciiCursor {
+   public:
+    AsciiCursor(const char* begin, const char* end)
+        : p_(begin),
+          end_(end),
+          start_(begin)
+    {
+    }
+
+    double read(PlyType type)
+    {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' ||
+                             *p_ == '\n')) {
+            ++p_;
+        }
+        if (p_ == end_) {
+            fail("unexpected end of data");
+        }
+        const char* begin = p_;
+        double value = 0;
+        if (is_float(type)) {
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+            const auto [next, ec] = std::from_chars(p_, end_, value);
+            p_ = ec == std::errc() ? next : begin;
+#else
+            char* next = nullptr;
+            value = std::strtod(p_, &next);
+            p_ = next;
+#endif
+        }
+        else {
+            int64_t integer = 0;
+            const auto [next, ec] = std::from_chars(p_, end_, integer);
+            p_ = ec == std::errc() ? next : begin;
+            value = double(integer);
+        }
+        if (p_ == begin) {
+            fail(
+                "bad value at byte " + std::to_string(begin - start_) +
+                " of the body");
+        }
+        return value;
+    }
+
+    const char* position() const
+    {
+        return p_;
+    }
+
+   private:
+    const char* p_;
+    const char* end_;
+    const char* start_;
+};
+
+// Where the value of a vertex property goes.
+struct Target {
+    enum Kind : uint8_t {
+        none,
+        position,
+        normal,
+        texcoord,
+        color,
+        scalar,
+    } kind = none;
+    uint8_t component = 0;
+    // Divisor that maps integer colors to [0, 1].
+    float scale = 1;
+    float* scalar_data = nullptr;
+};
+
+Target target_for(const PlyProperty& property)
+{
+    static const std::pair<const char*, std::pair<Target::Kind, int>> names[] =
+        {
+            { "x", { Target::position, 0 } },
+            { "y", { Target::position, 1 } },
+            { "z", { Target::position, 2 } },
+            { "nx", { Target::normal, 0 } },
+            { "ny", { Target::normal, 1 } },
+            { "nz", { Target::normal, 2 } },
+            { "u", { Target::texcoord, 0 } },
+            { "v", { Target::texcoord, 1 } },
+            { "s", { Target::texcoord, 0 } },
+            { "t", { Target::texcoord, 1 } },
+            { "texture_u", { Target::texcoord, 0 } },
+            { "texture_v", { Target::texcoord, 1 } },
+            { "red", { Target::color, 0 } },
+            { "green", { Target::color, 1 } },
+            { "blue", { Target::color, 2 } },
+            { "diffuse_red", { Target::color, 0 } },
+            { "diffuse_green", { Target::color, 1 } },
+            { "diffuse_blue", { Target::color, 2 } },
+        };
+    Target target;
+    if (property.is_list) {
+        return target;
+    }
+    target.kind = Target::scalar;
+    for (const auto& [name, role] : names) {
+        if (property.name == name) {
+            target.kind = role.first;
+            target.component = uint8_t(role.second);
+        }
+    }
+    if (target.kind == Target::color || property.name == "alpha") {
+        if (property.type == PlyType::uint8) {
+            target.scale = 255.0f;
+        }
+        else if (property.type == PlyType::uint16) {
+            target.scale = 65535.0f;
+        }
+    }
+    return target;
+}
+
+// Destination arrays of the vertex element, with raw pointers taken once so
+// that parallel decoding does not go through VtArray's copy on write checks.
+struct VertexSink {
+    std::vector<Target> targets;
+    pxr::GfVec3f* positions = nullptr;
+    pxr::GfVec3f* normals = nullptr;
+    pxr::GfVec2f* texcoords = nullptr;
+    pxr::GfVec3f* colors = nullptr;
+
+    VertexSink(const PlyElement& element, PlyData& result)
+    {
+        bool has[Target::scalar + 1] = {};
+        for (const auto& property : element.properties) {
+            targets.push_back(target_for(property));
+            has[targets.back().kind] = true;
+        }
+        if (!has[Target::position]) {
+            fail("vertex element without positions");
+        }
+        const size_t n = element.count;
+        result.vertices.resize(n);
+        positions = result.vertices.data();
+        if (has[Target::normal]) {
+            result.normals.resize(n);
+            normals = result.normals.data();
+        }
+        if (has[Target::texcoord]) {
+            result.texcoords.resize(n);
+            texcoords = result.texcoords.data();
+        }
+        if (has[Target::color]) {
+            result.colors.resize(n);
+            colors = result.colors.data();
+        }
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (targets[i].kind == Target::scalar) {
+                auto& array =
+                    result.vertex_scalars[element.properties[i].name];
+                array.resize(n);
+                targets[i].scalar_data = array.data();
+            }
+        }
+    }
+
+    void store(size_t vertex, size_t property, double value) const
+    {
+        const Target& t = targets[property];
+        const float f = float(value) / t.scale;
+        switch (t.kind) {
+            case Target::position: positions[vertex][t.component] = f; break;
+            case Target::normal: normals[vertex][t.component] = f; break;
+            case Target::texcoord: texcoords[vertex][t.component] = f; break;
+            case Target::color: colors[vertex][t.component] = f; break;
+            case Target::scalar: t.scalar_data[vertex] = f; break;
+            case Target::none: break;
+        }
+    }
+};
+
+bool is_face_index_list(const PlyProperty& property)
+{
+    return property.is_list && !is_float(property.type) &&
+           (property.name == "vertex_indices" ||
+            property.name == "vertex_index");
+}
+
+// Reads one element record by record. Works for both encodings and for any
+// mix of list and scalar properties.
+template<typename Cursor>
+void read_element(
+    Cursor& cursor,
+    const PlyElement& element,
+    PlyData& result,
+    const VertexSink* vertices)
+{
+    const bool is_face = element.name == "face";
+    std::vector<float*> face_scalars(element.properties.size(), nullptr);
+    std::vector<int> indices;
+    if (is_face) {
+        result.face_vertex_counts.resize(element.count);
+        for (size_t i = 0; i < element.properties.size(); ++i) {
+            if (!element.properties[i].is_list) {
+                auto& array = result.face_scalars[element.properties[i].name];
+                array.resize(element.count);
+                face_scalars[i] = array.data();
+            }
+        }
+    }
+    for (size_t record = 0; record < element.count; ++record) {
+        bool has_indices = false;
+        for (size_t i = 0; i < element.properties.size(); ++i) {
+            const PlyProperty& property = element.properties[i];
+            if (!property.is_list) {
+                const double value = cursor.read(property.type);
+                if (vertices) {
+                    vertices->store(record, i, value);
+                }
+                else if (face_scalars[i]) {
+                    face_scalars[i][record] = float(value);
+                }
+                continue;
+            }
+            const double count = cursor.read(property.count_type);
+            if (count < 0) {
+                fail("negative list size");
+            }
+            const bool keep = is_face && !has_indices &&
+                              is_face_index_list(property);
+            for (size_t k = 0; k < size_t(count); ++k) {
+                const double value = cursor.read(property.type);
+                if (keep) {
+                    indices.push_back(int(value));
+                }
+            }
+            if (keep) {
+                result.face_vertex_counts[record] = int(count);
+                has_indices = true;
+            }
+        }
+        if (is_face && !has_indices) {
+            fail("face without vertex_indices");
+        }
+    }
+    if (is_face) {
+        result.face_vertex_indices.assign(indices.begin(), indices.end());
+    }
+}
+
+// Binary vertex records have a fixed layout, so every record can be decoded
+// independently straight from the mapped file.
+void read_vertices_parallel(
+    const char* body,
+    size_t stride,
+    const PlyElement& element,
+    const VertexSink& sink,
+    bool little_endian)
+{
+    std::vector<size_t> offsets;
+    size_t offset = 0;
+    for (const auto& property : element.properties) {
+        offsets.push_back(offset);
+        offset += type_size(property.type);
+    }
+    pxr::WorkParallelForN(element.count, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            const char* record = body + v * stride;
+            for (size_t i = 0; i < offsets.size(); ++i) {
+                sink.store(
+                    v,
+                    i,
+                    decode(
+                        record + offsets[i],
+                        element.properties[i].type,
+                        little_endian));
+            }
+        }
+    });
+}
+
+// Binary faces whose only property is the index list, the layout written by
+// scanners and by write_ply. The counts are gathered in one sequential sweep
+// that only touches the count fields, after which every face knows where its
+// record and its corners start and the indices are decoded in parallel.
+bool read_faces_parallel(
+    BinaryCursor& cursor,
+    const char* end,
+    const PlyElement& element,
+    PlyData& result,
+    bool little_endian)
+{
+    if (element.properties.size() != 1 ||
+        !is_face_index_list(element.properties[0])) {
+        return false;
+    }
+    const PlyProperty& property = element.properties[0];
+    const size_t count_size = type_size(property.count_type);
+    const size_t item_size = type_size(property.type);
+
+    const char* p = cursor.position();
+    std::vector<size_t> corner_offsets(element.count + 1, 0);
+    for (size_t f = 0; f < element.count; ++f) {
+        if (size_t(end - p) < count_size) {
+            fail("unexpected end of data");
+        }
+        const double count = decode(p, property.count_type, little_endian);
+        if (count < 0) {
+            fail("negative list size");
+        }
+        corner_offsets[f + 1] = corner_offsets[f] + size_t(count);
+        const size_t bytes = count_size + size_t(count) * item_size;
+        if (size_t(end - p) < bytes) {
+            fail("unexpected end of data");
+        }
+        p += bytes;
+    }
+    const char* body = cursor.position();
+    cursor.skip(p - body);
+
+    const size_t corner_count = corner_offsets.back();
+    if (corner_count > size_t(INT32_MAX)) {
+        fail("too many face corners");
+    }
+    result.face_vertex_counts.resize(element.count);
+    result.face_vertex_indices.resize(corner_count);
+    int* counts = result.face_vertex_counts.data();
+    int* indices = result.face_vertex_indices.data();
+    pxr::WorkParallelForN(element.count, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            const size_t first = corner_offsets[f];
+            const size_t n = corner_offsets[f + 1] - first;
+            const char* record = body + f * count_size + first * item_size;
+            counts[f] = int(n);
+            for (size_t k = 0; k < n; ++k) {
+                indices[first + k] = int(decode(
+                    record + count_size + k * item_size,
+                    property.type,
+                    little_endian));
+            }
+        }
+    });
+    return true;
+}
+
+void validate(const PlyData& data)
+{
+    const int vertex_count = int(data.vertices.size());
+    for (int index : data.face_vertex_indices) {
+        if (index < 0 || index >= vertex_count) {
+            fail("face index " + std::to_string(index) + " out of range");
+        }
+    }
+    for (int count : data.face_vertex_counts) {
+        if (count < 3) {
+            fail("face with fewer than 3 vertices");
+        }
+    }
+}
+
+const char* format_name(PlyFormat format)
+{
+    switch (format) {
+        case PlyFormat::ascii: return "ascii";
+        case PlyFormat::binary_little_endian: return "binary_little_endian";
+        case PlyFormat::binary_big_endian: return "binary_big_endian";
+    }
+    return "";
+}
+
+std::string property_name(const std::string& name)
+{
+    std::string result = name;
+    for (char& c : result) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+// Writes values as text or in binary depending on the format.
+class PlyWriter {
+   public:
+    PlyWriter(const std::filesystem::path& path, PlyFormat format)
+        : out_(path, format != PlyFormat::binary_big_endian),
+          ascii_(format == PlyFormat::ascii)
+    {
+    }
+
+    BinaryWriter& stream()
+    {
+        return out_;
+    }
+
+    template<typename T>
+    void value(T v)
+    {
+        if (!ascii_) {
+            out_.write(v);
+            return;
+        }
+        char buffer[32];
+        if (separate_) {
+            buffer[0] = ' ';
+        }
+        char* begin = buffer + (separate_ ? 1 : 0);
+        char* end = std::to_chars(begin, buffer + sizeof(buffer), v).ptr;
+        out_.write_bytes(buffer, end - buffer);
+        separate_ = true;
+    }
+
+    void end_record()
+    {
+        if (ascii_) {
+            out_.write_bytes("\n", 1);
+            separate_ = false;
+        }
+    }
+
+   private:
+    BinaryWriter out_;
+    bool ascii_;
+    bool separate_ = false;
+};
+
+}  // namespace
+
+PlyData parse_ply(const char* data, size_t size)
+{
+    const PlyHeader header = parse_header(data, size);
+    const char* body = data + header.body_offset;
+    const char* end = data + size;
+    const bool little_endian =
+        header.format != PlyFormat::binary_big_endian;
+
+    PlyData result;
+    BinaryCursor binary(body, end, little_endian);
+    AsciiCursor ascii(body, end);
+    bool has_vertices = false;
+    for (const auto& element : header.elements) {
+        const bool is_vertex = element.name == "vertex";
+        if (is_vertex && has_vertices) {
+            fail("more than one vertex element");
+        }
+        // The arrays are sized from the header count, which must not promise
+        // more records than the rest of the file can hold.
+        const bool is_ascii = header.format == PlyFormat::ascii;
+        const size_t record_size = element.min_record_size(is_ascii);
+        const size_t remaining =
+            size_t(end - (is_ascii ? ascii.position() : binary.position()));
+        if (record_size > 0 ? element.count > remaining / record_size
+                            : element.count > 0 && element.name == "face") {
+            fail("element " + element.name + " larger than the data");
+        }
+        std::unique_ptr<VertexSink> sink;
+        if (is_vertex) {
+            sink = std::make_unique<VertexSink>(element, result);
+            has_vertices = true;
+        }
+        if (is_ascii) {
+            read_element(ascii, element, result, sink.get());
+            continue;
+        }
+        const size_t stride = element.fixed_stride();
+        if (is_vertex && stride > 0) {
+            const size_t bytes = stride * element.count;
+            if (size_t(end - binary.position()) < bytes) {
+                fail("unexpected end of data");
+            }
+            read_vertices_parallel(
+                binary.position(), stride, element, *sink, little_endian);
+            binary.skip(bytes);
+        }
+        else if (!is_vertex && element.name != "face" && stride > 0) {
+            binary.skip(stride * element.count);
+        }
+        else if (
+            element.name != "face" ||
+            !read_faces_parallel(binary, end, element, result, little_endian)) {
+            read_element(binary, element, result, sink.get());
+        }
+    }
+    validate(result);
+    return result;
+}
+
+PlyData read_ply(const std::filesystem::path& path)
+{
+    const MappedFile file(path);
+    return parse_ply(file.data(), file.size());
+}
+
+Geometry ply_to_geometry(PlyData data)
+{
+    Geometry geometry;
+    auto mesh = std::make_shared<MeshComponent>(&geometry);
+    geometry.attach_component(mesh);
+    mesh->set_vertices(data.vertices);
+    mesh->set_face_vertex_counts(data.face_vertex_counts);
+    mesh->set_face_vertex_indices(data.face_vertex_indices);
+    if (!data.normals.empty()) {
+        mesh->set_normals(data.normals);
+    }
+    if (!data.texcoords.empty()) {
+        mesh->set_texcoords_array(data.texcoords);
+    }
+    if (!data.colors.empty()) {
+        mesh->set_display_color(data.colors);
+    }
+    if (!data.vertex_scalars.empty()) {
+        mesh->set_vertex_scalar_quantities(data.vertex_scalars);
+    }
+    if (!data.face_scalars.empty()) {
+        mesh->set_face_scalar_quantities(data.face_scalars);
+    }
+    return geometry;
+}
+
+void write_ply(
+    const std::filesystem::path& path,
+    const MeshComponent& mesh,
+    PlyFormat format)
+{
+    const auto vertices = mesh.get_vertices();
+    const auto counts = mesh.get_face_vertex_counts();
+    const auto indices = mesh.get_face_vertex_indices();
+    const size_t n = vertices.size();
+
+    // Only per vertex attributes fit in the vertex element.
+    auto normals = mesh.get_normals();
+    if (normals.size() != n) {
+        normals.clear();
+    }
+    auto texcoords = mesh.get_texcoords_array();
+    if (texcoords.size() != n) {
+        texcoords.clear();
+    }
+    auto colors = mesh.get_display_color();
+    if (colors.size() != n) {
+        colors.clear();
+    }
+    std::vector<std::pair<std::string, pxr::VtArray<float>>> vertex_scalars;
+    for (const auto& name : mesh.get_vertex_scalar_quantity_names()) {
+        auto values = mesh.get_vertex_scalar_quantity(name);
+        if (values.size() == n) {
+            vertex_scalars.emplace_back(property_name(name), values);
+        }
+    }
+    std::vector<std::pair<std::string, pxr::VtArray<float>>> face_scalars;
+    for (const auto& name : mesh.get_face_scalar_quantity_names()) {
+        auto values = mesh.get_face_scalar_quantity(name);
+        if (values.size() == counts.size()) {
+            face_scalars.emplace_back(property_name(name), values);
+        }
+    }
+    const bool wide_counts =
+        std::any_of(counts.begin(), counts.end(), [](int c) {
+            return c > 255;
+        });
+
+    std::ostringstream header;
+    header << "ply\nformat " << format_name(format) << " 1.0\n";
+    header << "element vertex " << n << "\n"
+           << "property float x\nproperty float y\nproperty float z\n";
+    if (!normals.empty()) {
+        header << "property float nx\nproperty float ny\nproperty float nz\n";
+    }
+    if (!texcoords.empty()) {
+        header << "property float u\nproperty float v\n";
+    }
+    if (!colors.empty()) {
+        header << "property uchar red\nproperty uchar green\n"
+                  "property uchar blue\n";
+    }
+    for (const auto& [name, values] : vertex_scalars) {
+        header << "property float " << name << "\n";
+    }
+    header << "element face " << counts.size() << "\n"
+           << "property list " << (wide_counts ? "int" : "uchar")
+           << " int vertex_indices\n";
+    for (const auto& [name, values] : face_scalars) {
+        header << "property float " << name << "\n";
+    }
+    header << "end_header\n";
+
+    PlyWriter out(path, format);
+    out.stream().write_text(header.str());
+    for (size_t v = 0; v < n; ++v) {
+        for (int k = 0; k < 3; ++k) {
+            out.value(vertices[v][k]);
+        }
+        if (!normals.empty()) {
+            for (int k = 0; k < 3; ++k) {
+                out.value(normals[v][k]);
+            }
+        }
+        if (!texcoords.empty()) {
+            out.value(texcoords[v][0]);
+            out.value(texcoords[v][1]);
+        }
+        if (!colors.empty()) {
+            for (int k = 0; k < 3; ++k) {
+                const float c = std::clamp(colors[v][k], 0.0f, 1.0f);
+                out.value(uint8_t(std::lround(c * 255.0f)));
+            }
+        }
+        for (const auto& [name, values] : vertex_scalars) {
+            out.value(values[v]);
+        }
+        out.end_record();
+    }
+    size_t corner = 0;
+    for (size_t f = 0; f < counts.size(); ++f) {
+        if (wide_counts) {
+            out.value(int32_t(counts[f]));
+        }
+        else {
+            out.value(uint8_t(counts[f]));
+        }
+        for (int k = 0; k < counts[f]; ++k) {
+            out.value(int32_t(indices[corner++]));
+        }
+        for (const auto& [name, values] : face_scalars) {
+            out.value(values[f]);
+        }
+        out.end_record();
+    }
+    out.stream().finish();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,836 @@
+#include "GCore/Algorithms/point_index.h"
+
+#include <pxr/base/work/dispatcher.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/sort.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+constexpr uint32_t parallel_build_threshold = 1 << 14;
+constexpr size_t query_grain = 256;
+
+inline float squared_distance(const pxr::GfVec3f& a, const pxr::GfVec3f& b)
+{
+    const pxr::GfVec3f d = a - b;
+    return pxr::GfDot(d, d);
+}
+
+// Bounded max-heap of the k best candidates, on caller provided storage.
+class KnnHeap {
+   public:
+    KnnHeap(std::pair<float, uint32_t>* data, uint32_t k) : data_(data), k_(k)
+    {
+    }
+
+    [[nodiscard]] float bound() const
+    {
+        return size_ < k_ ? std::numeric_limits<float>::infinity()
+                          : data_[0].first;
+    }
+
+    void push(float d2, uint32_t index)
+    {
+        if (size_ < k_) {
+            data_[size_++] = { d2, index };
+            std::push_heap(data_, data_ + size_);
+        }
+        else if (d2 < data_[0].first) {
+            std::pop_heap(data_, data_ + size_);
+            data_[size_ - 1] = { d2, index };
+            std::push_heap(data_, data_ + size_);
+        }
+    }
+
+    void write(uint32_t* indices, float* distances_squared) const
+    {
+        std::sort_heap(data_, data_ + size_);
+        for (uint32_t i = 0; i < k_; ++i) {
+            const bool found = i < size_;
+            indices[i] = found ? data_[i].second : invalid_point;
+            if (distances_squared) {
+                distances_squared[i] =
+                    found ? data_[i].first
+                          : std::numeric_limits<float>::infinity();
+            }
+        }
+    }
+
+   private:
+    std::pair<float, uint32_t>* data_;
+    uint32_t k_;
+    uint32_t size_ = 0;
+};
+
+// Radius queries over many points. Chunks of queries collect their neighbors
+// locally, then the chunks are concatenated into the CSR arrays.
+template<typename Query>
+NeighborLists radius_batch_impl(size_t count, Query&& query)
+{
+    constexpr size_t chunk_size = 1024;
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+
+    NeighborLists result;
+    result.offsets.assign(count + 1, 0);
+    std::vector<std::vector<uint32_t>> chunks(chunk_count);
+    pxr::WorkParallelForN(chunk_count, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            auto& neighbors = chunks[c];
+            const size_t last = std::min(count, (c + 1) * chunk_size);
+            for (size_t i = c * chunk_size; i < last; ++i) {
+                const size_t before = neighbors.size();
+                query(i, neighbors);
+                result.offsets[i + 1] = uint32_t(neighbors.size() - before);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        result.offsets[i + 1] += result.offsets[i];
+    }
+    result.indices.resize(result.offsets[count]);
+    pxr::WorkParallelForN(chunk_count, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            std::copy(
+                chunks[c].begin(),
+                chunks[c].end(),
+                result.indices.begin() + result.offsets[c * chunk_size]);
+        }
+    });
+    return result;
+}
+
+}  // namespace
+
+// PointKDTree
+
+PointKDTree::PointKDTree(const pxr::GfVec3f* points, size_t count)
+{
+    if (count >= invalid_point) {
+        throw std::length_error("PointKDTree: too many points.");
+    }
+    const uint32_t n = uint32_t(count);
+    if (n == 0) {
+        return;
+    }
+
+    const uint32_t leaves = (n + bucket_size - 1) / bucket_size;
+    while ((1u << depth_) < leaves) {
+        ++depth_;
+    }
+    nodes_.resize((size_t(1) << depth_) - 1);
+
+    // Points are partitioned together with their original index so the
+    // median selection streams through memory instead of gathering.
+    struct Entry {
+        pxr::GfVec3f p;
+        uint32_t index;
+    };
+    std::vector<Entry> entries(n);
+    pxr::WorkParallelForN(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            entries[i] = { points[i], uint32_t(i) };
+        }
+    });
+
+    pxr::WorkDispatcher dispatcher;
+    auto build = [&](auto&& self,
+                     uint32_t node,
+                     uint32_t begin,
+                     uint32_t end,
+                     uint32_t level) -> void {
+        if (level == depth_) {
+            return;
+        }
+
+        pxr::GfVec3f lo(std::numeric_limits<float>::max());
+        pxr::GfVec3f hi(-std::numeric_limits<float>::max());
+        for (uint32_t i = begin; i < end; ++i) {
+            const pxr::GfVec3f& p = entries[i].p;
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], p[k]);
+                hi[k] = std::max(hi[k], p[k]);
+            }
+        }
+        const pxr::GfVec3f extent = hi - lo;
+        uint32_t axis = 0;
+        if (extent[1] > extent[axis]) {
+            axis = 1;
+        }
+        if (extent[2] > extent[axis]) {
+            axis = 2;
+        }
+
+        const uint32_t mid = begin + (end - begin) / 2;
+        if (mid < end) {
+            std::nth_element(
+                entries.begin() + begin,
+                entries.begin() + mid,
+                entries.begin() + end,
+                [axis](const Entry& a, const Entry& b) {
+                    return a.p[axis] < b.p[axis];
+                });
+            nodes_[node] = { entries[mid].p[axis], axis };
+        }
+        else {
+            nodes_[node] = { 0.0f, axis };
+        }
+
+        if (end - begin > parallel_build_threshold) {
+            dispatcher.Run([&self, node, begin, mid, level] {
+                self(self, 2 * node + 1, begin, mid, level + 1);
+            });
+        }
+        else {
+            self(self, 2 * node + 1, begin, mid, level + 1);
+        }
+        self(self, 2 * node + 2, mid, end, level + 1);
+    };
+    build(build, 0, 0, n, 0);
+    dispatcher.Wait();
+
+    points_.resize(n);
+    indices_.resize(n);
+    pxr::WorkParallelForN(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            points_[i] = entries[i].p;
+            indices_[i] = entries[i].index;
+        }
+    });
+}
+
+PointKDTree::PointKDTree(const pxr::VtArray<pxr::GfVec3f>& points)
+    : PointKDTree(points.cdata(), points.size())
+{
+}
+
+std::shared_ptr<const PointKDTree> PointKDTree::update(
+    const std::shared_ptr<const PointKDTree>& previous,
+    const pxr::VtArray<pxr::GfVec3f>& points,
+    uint64_t positions_hash)
+{
+    if (previous && previous->positions_hash_ == positions_hash &&
+        previous->size() == points.size()) {
+        return previous;
+    }
+    auto tree = std::make_shared<PointKDTree>(points);
+    tree->positions_hash_ = positions_hash;
+    return tree;
+}
+
+// Depth first traversal, near child first. The visitor reports the current
+// squared search radius through bound() and scans leaves with visit().
+template<typename Visitor>
+void PointKDTree::traverse(const pxr::GfVec3f& query, Visitor& visitor) const
+{
+    if (points_.empty()) {
+        return;
+    }
+
+    struct Frame {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+        uint32_t level;
+        float distance_squared;
+    };
+    Frame stack[64];
+    uint32_t top = 0;
+    stack[top++] = { 0, 0, uint32_t(points_.size()), 0, 0.0f };
+
+    while (top > 0) {
+        Frame frame = stack[--top];
+        if (frame.distance_squared > visitor.bound()) {
+            continue;
+        }
+        while (frame.level < depth_) {
+            const Node& node = nodes_[frame.node];
+            const uint32_t mid = frame.begin + (frame.end - frame.begin) / 2;
+            const float d = query[node.axis] - node.split;
+            const Frame left = {
+                2 * frame.node + 1, frame.begin, mid, frame.level + 1, 0.0f
+            };
+            const Frame right = {
+                2 * frame.node + 2, mid, frame.end, frame.level + 1, 0.0f
+            };
+            Frame far = d < 0 ? right : left;
+            far.distance_squared = std::max(frame.distance_squared, d * d);
+            if (far.distance_squared <= visitor.bound()) {
+                stack[top++] = far;
+            }
+            const float near_distance = frame.distance_squared;
+            frame = d < 0 ? left : right;
+            frame.distance_squared = near_distance;
+        }
+        visitor.visit(frame.begin, frame.end);
+    }
+}
+
+uint32_t PointKDTree::nearest(
+    const pxr::GfVec3f& query,
+    float max_distance,
+    float* distance_squared) const
+{
+    struct Visitor {
+        const PointKDTree& tree;
+        const pxr::GfVec3f& query;
+        float best;
+        uint32_t index = invalid_point;
+
+        float bound() const
+        {
+            return best;
+        }
+
+        void visit(uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i) {
+                const float d2 = squared_distance(tree.points_[i], query);
+                if (d2 <= best) {
+                    best = d2;
+                    index = i;
+                }
+            }
+        }
+    };
+
+    Visitor visitor{ *this,
+                     query,
+                     std::isinf(max_distance) ? max_distance
+                                              : max_distance * max_distance };
+    traverse(query, visitor);
+    if (distance_squared) {
+        *distance_squared = visitor.index == invalid_point
+                                ? std::numeric_limits<float>::infinity()
+                                : visitor.best;
+    }
+    return visitor.index == invalid_point ? invalid_point
+                                          : indices_[visitor.index];
+}
+
+void PointKDTree::knn_into(
+    const pxr::GfVec3f& query,
+    uint32_t k,
+    std::pair<float, uint32_t>* heap,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    struct Visitor {
+        const PointKDTree& tree;
+        const pxr::GfVec3f& query;
+        KnnHeap heap;
+
+        float bound() const
+        {
+            return heap.bound();
+        }
+
+        void visit(uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i) {
+                heap.push(
+                    squared_distance(tree.points_[i], query),
+                    tree.indices_[i]);
+            }
+        }
+    };
+
+    if (k == 0) {
+        return;
+    }
+    Visitor visitor{ *this, query, KnnHeap(heap, k) };
+    traverse(query, visitor);
+    visitor.heap.write(indices, distances_squared);
+}
+
+void PointKDTree::knn(
+    const pxr::GfVec3f& query,
+    uint32_t k,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    if (k == 0) {
+        return;
+    }
+    std::vector<std::pair<float, uint32_t>> heap(k);
+    knn_into(query, k, heap.data(), indices, distances_squared);
+}
+
+void PointKDTree::radius(
+    const pxr::GfVec3f& query,
+    float radius,
+    std::vector<uint32_t>& indices) const
+{
+    struct Visitor {
+        const PointKDTree& tree;
+        const pxr::GfVec3f& query;
+        float radius2;
+        std::vector<uint32_t>& out;
+
+        float bound() const
+        {
+            return radius2;
+        }
+
+        void visit(uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i) {
+                if (squared_distance(tree.points_[i], query) <= radius2) {
+                    out.push_back(tree.indices_[i]);
+                }
+            }
+        }
+    };
+
+    Visitor visitor{ *this, query, radius * radius, indices };
+    traverse(query, visitor);
+}
+
+void PointKDTree::nearest_batch(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                indices[i] = nearest(
+                    queries[i],
+                    std::numeric_limits<float>::infinity(),
+                    distances_squared ? distances_squared + i : nullptr);
+            }
+        },
+        query_grain);
+}
+
+void PointKDTree::knn_batch(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    uint32_t k,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    if (k == 0) {
+        return;
+    }
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            std::vector<std::pair<float, uint32_t>> heap(k);
+            for (size_t i = begin; i < end; ++i) {
+                knn_into(
+                    queries[i],
+                    k,
+                    heap.data(),
+                    indices + i * k,
+                    distances_squared ? distances_squared + i * k : nullptr);
+            }
+        },
+        query_grain);
+}
+
+void PointKDTree::knn_all(
+    uint32_t k,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    if (k == 0) {
+        return;
+    }
+    for_each_knn(k, [&](uint32_t point, const uint32_t* n, const float* d) {
+        const size_t offset = size_t(point) * k;
+        std::copy(n, n + k, indices + offset);
+        if (distances_squared) {
+            std::copy(d, d + k, distances_squared + offset);
+        }
+    });
+}
+
+void PointKDTree::for_each_knn(uint32_t k, const NeighborCallback& fn) const
+{
+    if (k == 0) {
+        return;
+    }
+    pxr::WorkParallelForN(
+        points_.size(),
+        [&](size_t begin, size_t end) {
+            std::vector<std::pair<float, uint32_t>> heap(k);
+            std::vector<uint32_t> neighbors(k);
+            std::vector<float> distances(k);
+            for (size_t i = begin; i < end; ++i) {
+                knn_into(
+                    points_[i],
+                    k,
+                    heap.data(),
+                    neighbors.data(),
+                    distances.data());
+                fn(indices_[i], neighbors.data(), distances.data());
+            }
+        },
+        query_grain);
+}
+
+NeighborLists PointKDTree::radius_batch(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    float radius) const
+{
+    return radius_batch_impl(
+        count, [&](size_t i, std::vector<uint32_t>& neighbors) {
+            this->radius(queries[i], radius, neighbors);
+        });
+}
+
+// PointHashGrid
+
+namespace {
+
+// Cell coordinates relative to the grid minimum are packed in 21 bits each.
+constexpr int cell_bits = 21;
+
+inline uint64_t pack_cell(const pxr::GfVec3i& offset)
+{
+    return uint64_t(offset[0]) | uint64_t(offset[1]) << cell_bits |
+           uint64_t(offset[2]) << (2 * cell_bits);
+}
+
+inline uint32_t hash_cell(const pxr::GfVec3i& cell)
+{
+    return uint32_t(cell[0]) * 73856093u ^ uint32_t(cell[1]) * 19349663u ^
+           uint32_t(cell[2]) * 83492791u;
+}
+
+}  // namespace
+
+PointHashGrid::PointHashGrid(
+    const pxr::GfVec3f* points,
+    size_t count,
+    float cell_size)
+    : cell_size_(cell_size),
+      inv_cell_size_(1.0f / cell_size),
+      min_cell_(0),
+      max_cell_(-1)
+{
+    if (!(cell_size > 0.0f)) {
+        throw std::invalid_argument("PointHashGrid: cell size must be > 0.");
+    }
+    if (count >= invalid_point) {
+        throw std::length_error("PointHashGrid: too many points.");
+    }
+    cell_begin_.push_back(0);
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<pxr::GfVec3i> cells(count);
+    pxr::WorkParallelForN(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            cells[i] = cell_of(points[i]);
+        }
+    });
+    min_cell_ = max_cell_ = cells[0];
+    for (const auto& cell : cells) {
+        for (int k = 0; k < 3; ++k) {
+            min_cell_[k] = std::min(min_cell_[k], cell[k]);
+            max_cell_[k] = std::max(max_cell_[k], cell[k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        if (int64_t(max_cell_[k]) - min_cell_[k] >= (int64_t(1) << cell_bits)) {
+            throw std::invalid_argument(
+                "PointHashGrid: cell size too small for the point extent.");
+        }
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys(count);
+    pxr::WorkParallelForN(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            keys[i] = { pack_cell(cells[i] - min_cell_), uint32_t(i) };
+        }
+    });
+    pxr::WorkParallelSort(&keys);
+
+    points_.resize(count);
+    indices_.resize(count);
+    pxr::WorkParallelForN(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            indices_[i] = keys[i].second;
+            points_[i] = points[keys[i].second];
+        }
+    });
+
+    cell_begin_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (i == 0 || keys[i].first != keys[i - 1].first) {
+            cell_begin_.push_back(uint32_t(i));
+            cell_keys_.push_back(cells[keys[i].second]);
+        }
+    }
+    cell_begin_.push_back(uint32_t(count));
+
+    size_t table_size = 16;
+    while (table_size < 2 * cell_keys_.size()) {
+        table_size *= 2;
+    }
+    table_.assign(table_size, CellSlot{ pxr::GfVec3i(0), 0, 0 });
+    const size_t mask = table_size - 1;
+    for (uint32_t c = 0; c < cell_keys_.size(); ++c) {
+        size_t slot = hash_cell(cell_keys_[c]) & mask;
+        while (table_[slot].begin != table_[slot].end) {
+            slot = (slot + 1) & mask;
+        }
+        table_[slot] = { cell_keys_[c], cell_begin_[c], cell_begin_[c + 1] };
+    }
+}
+
+PointHashGrid::PointHashGrid(
+    const pxr::VtArray<pxr::GfVec3f>& points,
+    float cell_size)
+    : PointHashGrid(points.cdata(), points.size(), cell_size)
+{
+}
+
+pxr::GfVec3i PointHashGrid::cell_of(const pxr::GfVec3f& p) const
+{
+    return pxr::GfVec3i(
+        int(std::floor(p[0] * inv_cell_size_)),
+        int(std::floor(p[1] * inv_cell_size_)),
+        int(std::floor(p[2] * inv_cell_size_)));
+}
+
+float PointHashGrid::cell_distance_squared(
+    const pxr::GfVec3i& cell,
+    const pxr::GfVec3f& p) const
+{
+    float result = 0.0f;
+    for (int a = 0; a < 3; ++a) {
+        const float lo = cell[a] * cell_size_;
+        const float d = std::max({ lo - p[a], 0.0f, p[a] - lo - cell_size_ });
+        result += d * d;
+    }
+    return result;
+}
+
+std::pair<uint32_t, uint32_t> PointHashGrid::find_cell(
+    const pxr::GfVec3i& cell) const
+{
+    if (table_.empty()) {
+        return { 0, 0 };
+    }
+    const size_t mask = table_.size() - 1;
+    size_t slot = hash_cell(cell) & mask;
+    while (table_[slot].begin != table_[slot].end) {
+        if (table_[slot].cell == cell) {
+            return { table_[slot].begin, table_[slot].end };
+        }
+        slot = (slot + 1) & mask;
+    }
+    return { 0, 0 };
+}
+
+void PointHashGrid::radius(
+    const pxr::GfVec3f& query,
+    float radius,
+    std::vector<uint32_t>& indices) const
+{
+    if (points_.empty()) {
+        return;
+    }
+    const float radius2 = radius * radius;
+    const pxr::GfVec3i lo = cell_of(query - pxr::GfVec3f(radius));
+    const pxr::GfVec3i hi = cell_of(query + pxr::GfVec3f(radius));
+
+    auto scan = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (squared_distance(points_[i], query) <= radius2) {
+                indices.push_back(indices_[i]);
+            }
+        }
+    };
+
+    pxr::GfVec3i from, to;
+    double box_cells = 1.0;
+    for (int k = 0; k < 3; ++k) {
+        from[k] = std::max(lo[k], min_cell_[k]);
+        to[k] = std::min(hi[k], max_cell_[k]);
+        if (from[k] > to[k]) {
+            return;
+        }
+        box_cells *= double(to[k]) - from[k] + 1;
+    }
+
+    // Large radii: walking the occupied cells beats probing empty ones.
+    if (box_cells > double(cell_count())) {
+        for (size_t c = 0; c < cell_count(); ++c) {
+            const pxr::GfVec3i& cell = cell_keys_[c];
+            if (cell[0] >= from[0] && cell[0] <= to[0] && cell[1] >= from[1] &&
+                cell[1] <= to[1] && cell[2] >= from[2] && cell[2] <= to[2]) {
+                scan(cell_begin_[c], cell_begin_[c + 1]);
+            }
+        }
+        return;
+    }
+
+    for (int z = from[2]; z <= to[2]; ++z) {
+        for (int y = from[1]; y <= to[1]; ++y) {
+            for (int x = from[0]; x <= to[0]; ++x) {
+                const pxr::GfVec3i cell(x, y, z);
+                if (cell_distance_squared(cell, query) <= radius2) {
+                    const auto [begin, end] = find_cell(cell);
+                    scan(begin, end);
+                }
+            }
+        }
+    }
+}
+
+// Searches rings of cells around the query cell by growing Chebyshev
+// distance. Everything outside ring r is at least as far as the nearest face
+// of the block of rings 0..r, which bounds when the search can stop.
+void PointHashGrid::knn_into(
+    const pxr::GfVec3f& query,
+    uint32_t k,
+    std::pair<float, uint32_t>* heap_data,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    KnnHeap heap(heap_data, k);
+    if (points_.empty() || k == 0) {
+        heap.write(indices, distances_squared);
+        return;
+    }
+
+    // Rings before min_ring miss the occupied cells entirely, and each ring
+    // only walks its part inside them, so queries far from the points do
+    // not probe empty space.
+    const pxr::GfVec3i center = cell_of(query);
+    int min_ring = 0, max_ring = 0;
+    for (int a = 0; a < 3; ++a) {
+        min_ring = std::max(
+            { min_ring, min_cell_[a] - center[a], center[a] - max_cell_[a] });
+        max_ring = std::max(
+            { max_ring, center[a] - min_cell_[a], max_cell_[a] - center[a] });
+    }
+
+    auto visit = [&](int x, int y, int z) {
+        // Skip the probe for cells that cannot hold a closer point.
+        const pxr::GfVec3i cell(x, y, z);
+        if (cell_distance_squared(cell, query) > heap.bound()) {
+            return;
+        }
+        const auto [begin, end] = find_cell(cell);
+        for (uint32_t i = begin; i < end; ++i) {
+            heap.push(squared_distance(points_[i], query), indices_[i]);
+        }
+    };
+
+    for (int r = min_ring; r <= max_ring; ++r) {
+        pxr::GfVec3i from, to;
+        for (int a = 0; a < 3; ++a) {
+            from[a] = std::max(center[a] - r, min_cell_[a]);
+            to[a] = std::min(center[a] + r, max_cell_[a]);
+        }
+        for (int z = from[2]; z <= to[2]; ++z) {
+            for (int y = from[1]; y <= to[1]; ++y) {
+                const bool on_face = std::abs(z - center[2]) == r ||
+                                     std::abs(y - center[1]) == r;
+                if (on_face) {
+                    for (int x = from[0]; x <= to[0]; ++x) {
+                        visit(x, y, z);
+                    }
+                    continue;
+                }
+                // Only the two cells at x = +-r are on the ring.
+                if (center[0] - r >= from[0]) {
+                    visit(center[0] - r, y, z);
+                }
+                if (r > 0 && center[0] + r <= to[0]) {
+                    visit(center[0] + r, y, z);
+                }
+            }
+        }
+
+        float outside = std::numeric_limits<float>::max();
+        for (int a = 0; a < 3; ++a) {
+            const float lo = (center[a] - r) * cell_size_;
+            const float hi = (center[a] + r + 1) * cell_size_;
+            outside = std::min({ outside, query[a] - lo, hi - query[a] });
+        }
+        if (outside > 0.0f && outside * outside >= heap.bound()) {
+            break;
+        }
+    }
+    heap.write(indices, distances_squared);
+}
+
+void PointHashGrid::knn(
+    const pxr::GfVec3f& query,
+    uint32_t k,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    std::vector<std::pair<float, uint32_t>> heap(k);
+    knn_into(query, k, heap.data(), indices, distances_squared);
+}
+
+uint32_t PointHashGrid::nearest(
+    const pxr::GfVec3f& query,
+    float max_distance,
+    float* distance_squared) const
+{
+    std::pair<float, uint32_t> heap;
+    uint32_t index;
+    float d2;
+    knn_into(query, 1, &heap, &index, &d2);
+    if (index != invalid_point && d2 > max_distance * max_distance) {
+        index = invalid_point;
+        d2 = std::numeric_limits<float>::infinity();
+    }
+    if (distance_squared) {
+        *distance_squared = d2;
+    }
+    return index;
+}
+
+void PointHashGrid::knn_batch(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    uint32_t k,
+    uint32_t* indices,
+    float* distances_squared) const
+{
+    pxr::WorkParallelForN(
+        count,
+        [&](size_t begin, size_t end) {
+            std::vector<std::pair<float, uint32_t>> heap(k);
+            for (size_t i = begin; i < end; ++i) {
+                knn_into(
+                    queries[i],
+                    k,
+                    heap.data(),
+                    indices + i * k,
+                    distances_squared ? distances_squared + i * k : nullptr);
+            }
+        },
+        query_grain);
+}
+
+NeighborLists PointHashGrid::radius_batch(
+    const pxr::GfVec3f* queries,
+    size_t count,
+    float radius) const
+{
+    return radius_batch_impl(
+        count, [&](size_t i, std::vector<uint32_t>& neighbors) {
+            this->radius(queries[i], radius, neighbors);
+        });
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
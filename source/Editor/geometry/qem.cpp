@@ -0,0 +1,1219 @@
+#include "GCore/Algorithms/qem.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "GCore/Algorithms/point_index.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+// End of a corner list.
+constexpr uint32_t none = ~0u;
+// Non-edge pairs kept per vertex, the nearest ones.
+constexpr size_t max_partners = 4;
+// Parallel rounds let the vertices whose cheapest edge is in this lowest
+// fraction of all compete for a contraction.
+constexpr float round_quantile = 0.1f;
+// Vertices sampled to estimate that quantile.
+constexpr size_t quantile_samples = 1 << 14;
+// Stale heap entries are dropped once the heap holds this many entries per
+// live vertex.
+constexpr size_t purge_factor = 4;
+
+using Vector3 = Eigen::Vector3d;
+
+// Squared distances to a set of planes as p^T A p + 2 b.p + c, with the
+// upper triangle of the symmetric A stored row by row.
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+
+    // weight times the squared distance to the plane n.p + d = 0, unit n.
+    static Quadric plane(const Vector3& n, double d, double weight)
+    {
+        Quadric q;
+        q.a00 = weight * n[0] * n[0];
+        q.a01 = weight * n[0] * n[1];
+        q.a02 = weight * n[0] * n[2];
+        q.a11 = weight * n[1] * n[1];
+        q.a12 = weight * n[1] * n[2];
+        q.a22 = weight * n[2] * n[2];
+        q.b0 = weight * n[0] * d;
+        q.b1 = weight * n[1] * d;
+        q.b2 = weight * n[2] * d;
+        q.c = weight * d * d;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o)
+    {
+        a00 += o.a00;
+        a01 += o.a01;
+        a02 += o.a02;
+        a11 += o.a11;
+        a12 += o.a12;
+        a22 += o.a22;
+        b0 += o.b0;
+        b1 += o.b1;
+        b2 += o.b2;
+        c += o.c;
+        return *this;
+    }
+
+    [[nodiscard]] double evaluate(const Vector3& p) const
+    {
+        const double x = p[0], y = p[1], z = p[2];
+        return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z +
+               a11 * y * y + 2 * a12 * y * z + a22 * z * z +
+               2 * (b0 * x + b1 * y + b2 * z) + c;
+    }
+
+    // The minimizer, solving A p = -b by cofactors. False when A is close
+    // to singular (flat or cylindrical neighborhoods), where the minimum is
+    // a plane or a line and the solution would drift far off.
+    bool minimizer(Vector3& p) const
+    {
+        const double c00 = a11 * a22 - a12 * a12;
+        const double c01 = a02 * a12 - a01 * a22;
+        const double c02 = a01 * a12 - a02 * a11;
+        const double det = a00 * c00 + a01 * c01 + a02 * c02;
+        const double trace = a00 + a11 + a22;
+        if (!(det > 1e-9 * trace * trace * trace)) {
+            return false;
+        }
+        const double c11 = a00 * a22 - a02 * a02;
+        const double c12 = a01 * a02 - a00 * a12;
+        const double c22 = a00 * a11 - a01 * a01;
+        p[0] = -(c00 * b0 + c01 * b1 + c02 * b2) / det;
+        p[1] = -(c01 * b0 + c11 * b1 + c12 * b2) / det;
+        p[2] = -(c02 * b0 + c12 * b1 + c22 * b2) / det;
+        return true;
+    }
+};
+
+// A pair to contract, valid while neither vertex changed after `time`.
+struct Candidate {
+    float cost;
+    uint32_t u, v;
+    uint32_t time;
+};
+
+// Orders the heap with the smallest cost on top.
+bool costlier(const Candidate& a, const Candidate& b)
+{
+    return a.cost > b.cost;
+}
+
+pxr::GfVec3f to_float(const Vector3& p)
+{
+    return pxr::GfVec3f(
+        static_cast<float>(p[0]),
+        static_cast<float>(p[1]),
+        static_cast<float>(p[2]));
+}
+
+uint32_t find_root(std::vector<uint32_t>& parent, uint32_t v)
+{
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Stable parallel filter of `in` into `out`: per block counts, an exclusive
+// scan over the blocks, then every block writes its own range.
+template<typename Keep>
+void compact(
+    const std::vector<uint32_t>& in,
+    const Keep& keep,
+    std::vector<uint32_t>& out)
+{
+    const size_t block_size = 4 * grain_size;
+    const size_t block_count = (in.size() + block_size - 1) / block_size;
+    std::vector<size_t> offsets(block_count + 1, 0);
+    pxr::WorkParallelForN(
+        block_count,
+        [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const size_t last = std::min(in.size(), (b + 1) * block_size);
+                size_t count = 0;
+                for (size_t i = b * block_size; i < last; ++i) {
+                    count += keep(in[i]);
+                }
+                offsets[b + 1] = count;
+            }
+        },
+        1);
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    out.resize(offsets.back());
+    pxr::WorkParallelForN(
+        block_count,
+        [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const size_t last = std::min(in.size(), (b + 1) * block_size);
+                size_t next = offsets[b];
+                for (size_t i = b * block_size; i < last; ++i) {
+                    if (keep(in[i])) {
+                        out[next++] = in[i];
+                    }
+                }
+            }
+        },
+        1);
+}
+
+class Simplifier {
+   public:
+    Simplifier(
+        const MeshAdjacency& adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const QemOptions& options,
+        std::vector<QemCollapse>* collapses);
+
+    void run(size_t target_faces);
+    void run_parallel(size_t target_faces);
+    SimplifiedMesh result() const;
+
+   private:
+    void gather_quadrics(
+        const MeshAdjacency& adjacency,
+        double boundary_weight);
+    void link_corners(const MeshAdjacency& adjacency);
+    void find_partners(
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        float distance_threshold);
+    void push_initial_pairs(const MeshAdjacency& adjacency);
+
+    double pair_cost(uint32_t u, uint32_t v, Vector3& target) const;
+    // Uses marks `mark` and `mark + 1`.
+    bool can_collapse(
+        uint32_t u,
+        uint32_t v,
+        const Vector3& target,
+        uint64_t mark);
+    bool flips(uint32_t x, uint32_t other, const Vector3& target) const;
+    size_t contract(uint32_t u, uint32_t v, const Vector3& target);
+    void collapse(
+        uint32_t u,
+        uint32_t v,
+        const Vector3& target,
+        double cost);
+    void propose(uint32_t x);
+    template<typename Fn>
+    void for_each_around(uint32_t u, uint32_t v, const Fn& fn) const;
+    void push_pairs(uint32_t u);
+    bool stale(const Candidate& candidate) const;
+
+    bool face_alive(uint32_t f) const
+    {
+        return corners_[3 * f] != none;
+    }
+
+    std::vector<Vector3> positions_;
+    std::vector<Quadric> quadrics_;
+    size_t live_vertices_ = 0;
+    std::vector<uint8_t> boundary_;
+    // Time of the last change of each vertex, `none` once it is removed.
+    std::vector<uint32_t> stamps_;
+    uint32_t time_ = 0;
+
+    // Three corners per face, relabeled as vertices merge. The first is
+    // `none` for removed faces, so the corners read anyway tell whether the
+    // face is still there.
+    std::vector<uint32_t> corners_;
+    size_t live_faces_ = 0;
+    // Corners of each vertex as a linked list: head_[v], then next_[c].
+    std::vector<uint32_t> head_;
+    std::vector<uint32_t> next_;
+
+    // Nearby vertices of other components, and where removed vertices went.
+    std::vector<std::vector<uint32_t>> partners_;
+    std::vector<uint32_t> merged_into_;
+
+    std::vector<Candidate> heap_;
+    // Scratch marks for the link condition and for deduplicating rings.
+    // Every use takes fresh values, so they are never cleared.
+    std::vector<uint64_t> marks_;
+    uint64_t mark_ = 0;
+
+    // Parallel rounds: the cheapest edge of each vertex, recomputed when
+    // the vertex is dirty, and the smallest key claiming each vertex.
+    std::vector<float> proposal_costs_;
+    std::vector<uint32_t> proposals_;
+    std::vector<uint8_t> dirty_;
+    std::vector<std::atomic<uint64_t>> claims_;
+
+    // Contractions applied so far, when requested, and their largest cost.
+    std::vector<QemCollapse>* collapses_ = nullptr;
+    float max_error_ = 0.0f;
+};
+
+Simplifier::Simplifier(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const QemOptions& options,
+    std::vector<QemCollapse>* collapses)
+    : collapses_(collapses)
+{
+    const size_t n = vertices.size();
+    positions_.resize(n);
+    for (size_t v = 0; v < n; ++v) {
+        positions_[v] = Vector3(vertices[v][0], vertices[v][1], vertices[v][2]);
+    }
+    live_vertices_ = n;
+    stamps_.assign(n, 0);
+    marks_.assign(n, 0);
+    boundary_ = adjacency.boundary_vertices();
+
+    corners_ = adjacency.corner_vertices();
+    for (size_t f = 0; f < adjacency.face_count(); ++f) {
+        uint32_t* c = corners_.data() + 3 * f;
+        if (c[0] == c[1] || c[1] == c[2] || c[2] == c[0]) {
+            c[0] = none;
+        }
+        else {
+            ++live_faces_;
+        }
+    }
+
+    gather_quadrics(adjacency, options.boundary_weight);
+    link_corners(adjacency);
+    if (options.schedule == QemSchedule::serial) {
+        if (options.distance_threshold > 0.0f) {
+            find_partners(vertices, options.distance_threshold);
+        }
+        push_initial_pairs(adjacency);
+    }
+}
+
+// Each vertex sums the area weighted planes of its faces and, for its open
+// boundary edges, the planes through the edge perpendicular to the face.
+// Faces are visited once per corner, which recomputes their planes but
+// needs neither a face array nor atomics.
+void Simplifier::gather_quadrics(
+    const MeshAdjacency& adjacency,
+    double boundary_weight)
+{
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    quadrics_.resize(positions_.size());
+    pxr::WorkParallelForN(
+        positions_.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                Quadric q;
+                const uint32_t* first = vertex_faces.begin(v);
+                const uint32_t* last = vertex_faces.end(v);
+                for (const uint32_t* f = first; f != last; ++f) {
+                    if (!face_alive(*f)) {
+                        continue;
+                    }
+                    const uint32_t* c = corners_.data() + 3 * *f;
+                    const int k = c[0] == v ? 0 : c[1] == v ? 1 : 2;
+                    const uint32_t a = c[(k + 1) % 3], b = c[(k + 2) % 3];
+                    const Vector3& p = positions_[v];
+                    const Vector3 cross =
+                        (positions_[a] - p).cross(positions_[b] - p);
+                    const double length = cross.norm();
+                    if (length == 0.0) {
+                        continue;
+                    }
+                    const Vector3 normal = cross / length;
+                    q += Quadric::plane(
+                        normal, -normal.dot(p), 0.5 * length);
+                    if (!boundary_[v]) {
+                        continue;
+                    }
+                    // Edges v-a and b-v, open when no other face has both
+                    // ends.
+                    for (const uint32_t w : { a, b }) {
+                        bool shared = false;
+                        for (const uint32_t* g = first; g != last && !shared;
+                             ++g) {
+                            const uint32_t* d = corners_.data() + 3 * *g;
+                            shared = *g != *f &&
+                                     (d[0] == w || d[1] == w || d[2] == w);
+                        }
+                        if (shared) {
+                            continue;
+                        }
+                        const Vector3 edge = positions_[w] - p;
+                        const Vector3 side = edge.cross(normal);
+                        const double side_length = side.norm();
+                        if (side_length == 0.0) {
+                            continue;
+                        }
+                        q += Quadric::plane(
+                            side / side_length,
+                            -side.dot(p) / side_length,
+                            boundary_weight * edge.squaredNorm());
+                    }
+                }
+                quadrics_[v] = q;
+            }
+        },
+        grain_size);
+}
+
+// Every corner links to the next corner of the same vertex. Each vertex
+// writes only its own corners, in the order of its face list.
+void Simplifier::link_corners(const MeshAdjacency& adjacency)
+{
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    head_.assign(positions_.size(), none);
+    next_.assign(corners_.size(), none);
+    pxr::WorkParallelForN(
+        positions_.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t* link = &head_[v];
+                for (const uint32_t* f = vertex_faces.begin(v);
+                     f != vertex_faces.end(v);
+                     ++f) {
+                    if (!face_alive(*f)) {
+                        continue;
+                    }
+                    for (uint32_t c = 3 * *f; c < 3 * *f + 3; ++c) {
+                        if (corners_[c] == v) {
+                            *link = c;
+                            link = &next_[c];
+                            break;
+                        }
+                    }
+                }
+            }
+        },
+        grain_size);
+}
+
+// Non-edge pairs join vertices of different connected components only:
+// within a component the edges already connect nearby vertices, and pairs
+// across a thin part would fold it onto itself.
+void Simplifier::find_partners(
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    float distance_threshold)
+{
+    const size_t n = positions_.size();
+    std::vector<uint32_t> components(n);
+    for (size_t v = 0; v < n; ++v) {
+        components[v] = static_cast<uint32_t>(v);
+    }
+    size_t count = n;
+    for (size_t f = 0; f < corners_.size() / 3; ++f) {
+        if (!face_alive(f)) {
+            continue;
+        }
+        const uint32_t r0 = find_root(components, corners_[3 * f]);
+        for (int k = 1; k < 3; ++k) {
+            const uint32_t r = find_root(components, corners_[3 * f + k]);
+            if (r != r0) {
+                components[std::max(r, r0)] = std::min(r, r0);
+                --count;
+            }
+        }
+    }
+    if (count < 2) {
+        return;
+    }
+    for (size_t v = 0; v < n; ++v) {
+        components[v] = find_root(components, static_cast<uint32_t>(v));
+    }
+
+    const PointHashGrid grid(vertices, distance_threshold);
+    partners_.resize(n);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> found;
+            std::vector<std::pair<float, uint32_t>> nearest;
+            for (size_t v = begin; v < end; ++v) {
+                found.clear();
+                grid.radius(vertices[v], distance_threshold, found);
+                nearest.clear();
+                for (const uint32_t w : found) {
+                    if (components[w] != components[v]) {
+                        nearest.emplace_back(
+                            (vertices[w] - vertices[v]).GetLengthSq(), w);
+                    }
+                }
+                if (nearest.size() > max_partners) {
+                    std::partial_sort(
+                        nearest.begin(),
+                        nearest.begin() + max_partners,
+                        nearest.end());
+                    nearest.resize(max_partners);
+                }
+                for (const auto& [distance, w] : nearest) {
+                    partners_[v].push_back(w);
+                }
+            }
+        },
+        grain_size);
+
+    // The nearest partners of v need not have v among theirs; pairs are
+    // refreshed from either end, so make the lists symmetric.
+    std::vector<uint32_t> own(n);
+    for (size_t v = 0; v < n; ++v) {
+        own[v] = static_cast<uint32_t>(partners_[v].size());
+    }
+    for (size_t v = 0; v < n; ++v) {
+        for (uint32_t i = 0; i < own[v]; ++i) {
+            std::vector<uint32_t>& other = partners_[partners_[v][i]];
+            if (std::find(other.begin(), other.end(), v) == other.end()) {
+                other.push_back(static_cast<uint32_t>(v));
+            }
+        }
+    }
+    merged_into_ = std::vector<uint32_t>(n);
+    for (size_t v = 0; v < n; ++v) {
+        merged_into_[v] = static_cast<uint32_t>(v);
+    }
+}
+
+// The edges to higher numbered neighbors and the non-edge pairs of every
+// vertex, counted and then filled in parallel.
+void Simplifier::push_initial_pairs(const MeshAdjacency& adjacency)
+{
+    const size_t n = positions_.size();
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    auto for_each_pair = [&](uint32_t v,
+                             std::vector<uint32_t>& scratch,
+                             const auto& fn) {
+        scratch.clear();
+        for (const uint32_t* f = vertex_faces.begin(v);
+             f != vertex_faces.end(v);
+             ++f) {
+            if (!face_alive(*f)) {
+                continue;
+            }
+            for (uint32_t c = 3 * *f; c < 3 * *f + 3; ++c) {
+                if (corners_[c] > v) {
+                    scratch.push_back(corners_[c]);
+                }
+            }
+        }
+        if (!partners_.empty()) {
+            for (const uint32_t w : partners_[v]) {
+                if (w > v) {
+                    scratch.push_back(w);
+                }
+            }
+        }
+        std::sort(scratch.begin(), scratch.end());
+        scratch.erase(
+            std::unique(scratch.begin(), scratch.end()), scratch.end());
+        for (const uint32_t w : scratch) {
+            fn(w);
+        }
+    };
+
+    std::vector<size_t> offsets(n + 1, 0);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> scratch;
+            for (size_t v = begin; v < end; ++v) {
+                for_each_pair(
+                    v, scratch, [&](uint32_t) { ++offsets[v + 1]; });
+            }
+        },
+        grain_size);
+    for (size_t v = 0; v < n; ++v) {
+        offsets[v + 1] += offsets[v];
+    }
+    heap_.resize(offsets[n]);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> scratch;
+            Vector3 target;
+            for (size_t v = begin; v < end; ++v) {
+                Candidate* out = heap_.data() + offsets[v];
+                const uint32_t u = static_cast<uint32_t>(v);
+                for_each_pair(u, scratch, [&](uint32_t w) {
+                    const float cost =
+                        static_cast<float>(pair_cost(u, w, target));
+                    *out++ = { cost, u, w, 0 };
+                });
+            }
+        },
+        grain_size);
+    std::make_heap(heap_.begin(), heap_.end(), costlier);
+}
+
+// Error of the contracted vertex and where it goes: the minimizer of the
+// summed quadric, or the best of the two ends and the midpoint when there
+// is none.
+double Simplifier::pair_cost(uint32_t u, uint32_t v, Vector3& target) const
+{
+    Quadric q = quadrics_[u];
+    q += quadrics_[v];
+    if (!q.minimizer(target)) {
+        const Vector3 choices[3] = { positions_[u],
+                                     positions_[v],
+                                     0.5 * (positions_[u] + positions_[v]) };
+        double best = std::numeric_limits<double>::infinity();
+        for (const Vector3& p : choices) {
+            const double error = q.evaluate(p);
+            if (error < best) {
+                best = error;
+                target = p;
+            }
+        }
+    }
+    return std::max(q.evaluate(target), 0.0);
+}
+
+// Whether moving x to target turns any of its faces not shared with `other`
+// by 90 degrees or more, which includes flipping and collapsing it.
+bool Simplifier::flips(uint32_t x, uint32_t other, const Vector3& target)
+    const
+{
+    for (uint32_t c = head_[x]; c != none; c = next_[c]) {
+        const uint32_t f = c / 3;
+        if (!face_alive(f)) {
+            continue;
+        }
+        const uint32_t a = corners_[3 * f + (c + 1) % 3];
+        const uint32_t b = corners_[3 * f + (c + 2) % 3];
+        if (a == other || b == other) {
+            continue;
+        }
+        const Vector3& pa = positions_[a];
+        const Vector3& pb = positions_[b];
+        const Vector3 before = (pa - positions_[x]).cross(pb - positions_[x]);
+        const Vector3 after = (pa - target).cross(pb - target);
+        if (before.dot(after) <= 0.0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The link condition: the vertices adjacent to both ends must be exactly
+// the third corners of the faces on the edge (none for a non-edge pair),
+// otherwise the contraction pinches the surface into a non-manifold edge.
+// Interior edges between two boundary vertices are refused for the same
+// reason.
+bool Simplifier::can_collapse(
+    uint32_t u,
+    uint32_t v,
+    const Vector3& target,
+    uint64_t mark)
+{
+    const uint64_t neighbor = mark, common = mark + 1;
+    size_t shared = 0;
+    for (uint32_t c = head_[u]; c != none; c = next_[c]) {
+        const uint32_t f = c / 3;
+        if (!face_alive(f)) {
+            continue;
+        }
+        const uint32_t a = corners_[3 * f + (c + 1) % 3];
+        const uint32_t b = corners_[3 * f + (c + 2) % 3];
+        shared += a == v || b == v;
+        marks_[a] = neighbor;
+        marks_[b] = neighbor;
+    }
+    if (shared > 2 || (shared == 2 && boundary_[u] && boundary_[v])) {
+        return false;
+    }
+    size_t both = 0;
+    for (uint32_t c = head_[v]; c != none; c = next_[c]) {
+        const uint32_t f = c / 3;
+        if (!face_alive(f)) {
+            continue;
+        }
+        for (const uint32_t w : { corners_[3 * f + (c + 1) % 3],
+                                  corners_[3 * f + (c + 2) % 3] }) {
+            if (w != u && marks_[w] == neighbor) {
+                marks_[w] = common;
+                ++both;
+            }
+        }
+    }
+    return both == shared && !flips(u, v, target) && !flips(v, u, target);
+}
+
+// Moves u to the target, hands the faces of v over to u and removes those
+// of the edge. Writes only to u, v and the faces around them, so
+// contractions with disjoint neighborhoods can run concurrently. Returns
+// the number of faces removed.
+size_t Simplifier::contract(uint32_t u, uint32_t v, const Vector3& target)
+{
+    positions_[u] = target;
+    quadrics_[u] += quadrics_[v];
+    boundary_[u] |= boundary_[v];
+    stamps_[v] = none;
+    size_t removed = 0;
+
+    uint32_t tail = none;
+    for (uint32_t c = head_[v]; c != none; c = next_[c]) {
+        tail = c;
+        const uint32_t f = c / 3;
+        if (!face_alive(f)) {
+            continue;
+        }
+        const uint32_t* face = corners_.data() + 3 * f;
+        if (face[0] == u || face[1] == u || face[2] == u) {
+            corners_[3 * f] = none;
+            ++removed;
+        }
+        else {
+            corners_[c] = u;
+        }
+    }
+    if (tail != none) {
+        next_[tail] = head_[u];
+        head_[u] = head_[v];
+        head_[v] = none;
+    }
+    // Drop the removed faces from the merged list.
+    uint32_t* link = &head_[u];
+    while (*link != none) {
+        if (face_alive(*link / 3)) {
+            link = &next_[*link];
+        }
+        else {
+            *link = next_[*link];
+        }
+    }
+    return removed;
+}
+
+void Simplifier::collapse(
+    uint32_t u,
+    uint32_t v,
+    const Vector3& target,
+    double cost)
+{
+    live_faces_ -= contract(u, v, target);
+    --live_vertices_;
+    if (collapses_) {
+        max_error_ = std::max(max_error_, static_cast<float>(cost));
+        collapses_->push_back({ u,
+                                v,
+                                to_float(target),
+                                max_error_,
+                                static_cast<uint32_t>(live_faces_) });
+    }
+    if (!partners_.empty()) {
+        merged_into_[v] = u;
+        std::vector<uint32_t>& merged = partners_[u];
+        merged.insert(merged.end(), partners_[v].begin(), partners_[v].end());
+        partners_[v] = {};
+        for (uint32_t& w : merged) {
+            w = find_root(merged_into_, w);
+        }
+        std::sort(merged.begin(), merged.end());
+        merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+        merged.erase(
+            std::remove(merged.begin(), merged.end(), u), merged.end());
+    }
+
+    stamps_[u] = ++time_;
+    push_pairs(u);
+}
+
+// New costs for all pairs of u; the old entries are stale by its stamp.
+void Simplifier::push_pairs(uint32_t u)
+{
+    Vector3 target;
+    auto push = [&](uint32_t w) {
+        const float cost = static_cast<float>(pair_cost(u, w, target));
+        heap_.push_back({ cost, u, w, time_ });
+        std::push_heap(heap_.begin(), heap_.end(), costlier);
+    };
+    const uint64_t pushed = ++mark_;
+    for (uint32_t c = head_[u]; c != none; c = next_[c]) {
+        const uint32_t f = c / 3;
+        for (const uint32_t w : { corners_[3 * f + (c + 1) % 3],
+                                  corners_[3 * f + (c + 2) % 3] }) {
+            if (marks_[w] != pushed) {
+                marks_[w] = pushed;
+                push(w);
+            }
+        }
+    }
+    if (!partners_.empty()) {
+        for (const uint32_t w : partners_[u]) {
+            if (marks_[w] != pushed) {
+                marks_[w] = pushed;
+                push(w);
+            }
+        }
+    }
+}
+
+bool Simplifier::stale(const Candidate& candidate) const
+{
+    const uint32_t u = candidate.u, v = candidate.v;
+    return stamps_[u] > candidate.time || stamps_[v] > candidate.time;
+}
+
+void Simplifier::run(size_t target_faces)
+{
+    Vector3 target;
+    while (live_faces_ > target_faces && !heap_.empty()) {
+        // Each live pair has at most one current entry, about three per
+        // vertex. Most of the others are stale by now; dropping them in one
+        // pass is far cheaper than popping them one by one from a heap
+        // that does not fit in cache.
+        if (heap_.size() > purge_factor * live_vertices_) {
+            heap_.erase(
+                std::remove_if(
+                    heap_.begin(),
+                    heap_.end(),
+                    [&](const Candidate& c) { return stale(c); }),
+                heap_.end());
+            std::make_heap(heap_.begin(), heap_.end(), costlier);
+            continue;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), costlier);
+        const Candidate candidate = heap_.back();
+        heap_.pop_back();
+        if (stale(candidate)) {
+            continue;
+        }
+        const uint32_t u = candidate.u, v = candidate.v;
+        const double cost = pair_cost(u, v, target);
+        mark_ += 2;
+        if (can_collapse(u, v, target, mark_ - 1)) {
+            collapse(u, v, target, cost);
+        }
+    }
+}
+
+// Calls fn(w) for u, v and every vertex sharing a face with either, some of
+// them more than once: the vertices a contraction of u and v reads or
+// writes.
+template<typename Fn>
+void Simplifier::for_each_around(uint32_t u, uint32_t v, const Fn& fn) const
+{
+    for (const uint32_t x : { u, v }) {
+        fn(x);
+        for (uint32_t c = head_[x]; c != none; c = next_[c]) {
+            const uint32_t f = c / 3;
+            if (face_alive(f)) {
+                fn(corners_[3 * f + (c + 1) % 3]);
+                fn(corners_[3 * f + (c + 2) % 3]);
+            }
+        }
+    }
+}
+
+// The cheapest edge of x, or none for a vertex without faces.
+void Simplifier::propose(uint32_t x)
+{
+    float best = std::numeric_limits<float>::infinity();
+    uint32_t partner = none;
+    Vector3 target;
+    for (uint32_t c = head_[x]; c != none; c = next_[c]) {
+        const uint32_t f = c / 3;
+        if (!face_alive(f)) {
+            continue;
+        }
+        for (const uint32_t w : { corners_[3 * f + (c + 1) % 3],
+                                  corners_[3 * f + (c + 2) % 3] }) {
+            const float cost = static_cast<float>(pair_cost(x, w, target));
+            if (cost < best) {
+                best = cost;
+                partner = w;
+            }
+        }
+    }
+    proposal_costs_[x] = best;
+    proposals_[x] = partner;
+}
+
+// Multiple choice contractions in parallel rounds. Every vertex proposes its
+// cheapest edge; those in the cheapest quantile claim all vertices their
+// contraction would touch with an atomic minimum of (cost, vertex). A
+// proposal that holds all of its claims is the cheapest in its neighborhood
+// and no other winner touches its vertices, so the winners pass the same
+// checks as in the serial mode and are applied concurrently. Only vertices
+// around a contraction propose again in the next round.
+//
+// The rounds work on compacted lists in increasing vertex order: the live
+// vertices, the competing ones among them, and the winners among those, so
+// that the claims and checks cost in proportion to the competitors rather
+// than to the whole mesh.
+void Simplifier::run_parallel(size_t target_faces)
+{
+    const size_t n = positions_.size();
+    proposal_costs_.resize(n);
+    proposals_.resize(n);
+    dirty_.assign(n, 1);
+    claims_ = std::vector<std::atomic<uint64_t>>(n);
+    for (auto& claim : claims_) {
+        claim.store(~uint64_t(0), std::memory_order_relaxed);
+    }
+    enum : uint8_t { accepted = 1, refused = 2 };
+    std::vector<uint8_t> won(n, 0);
+    std::vector<uint32_t> live(n);
+    std::iota(live.begin(), live.end(), 0u);
+    std::vector<uint32_t> competitors;
+    std::vector<uint32_t> winners;
+    std::vector<uint32_t> scratch;
+    std::vector<float> samples;
+    float quantile = round_quantile;
+
+    while (live_faces_ > target_faces) {
+        pxr::WorkParallelForN(
+            live.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t x = live[i];
+                    if (dirty_[x]) {
+                        propose(x);
+                        dirty_[x] = 0;
+                    }
+                }
+            },
+            grain_size);
+
+        // Costs are non-negative, so their bits order like the floats.
+        samples.clear();
+        const size_t stride =
+            std::max<size_t>(1, live.size() / quantile_samples);
+        for (size_t i = 0; i < live.size(); i += stride) {
+            if (proposals_[live[i]] != none) {
+                samples.push_back(proposal_costs_[live[i]]);
+            }
+        }
+        if (samples.empty()) {
+            break;
+        }
+        const size_t k = static_cast<size_t>(quantile * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+        const float threshold = samples[k];
+        compact(
+            live,
+            [&](uint32_t x) {
+                return proposals_[x] != none && proposal_costs_[x] <= threshold;
+            },
+            competitors);
+        auto key_of = [&](uint32_t x) {
+            uint32_t bits;
+            std::memcpy(&bits, &proposal_costs_[x], sizeof(bits));
+            return (uint64_t(bits) << 32) | x;
+        };
+
+        pxr::WorkParallelForN(
+            competitors.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t x = competitors[i];
+                    const uint64_t key = key_of(x);
+                    for_each_around(x, proposals_[x], [&](uint32_t w) {
+                        uint64_t claim =
+                            claims_[w].load(std::memory_order_relaxed);
+                        while (key < claim &&
+                               !claims_[w].compare_exchange_weak(
+                                   claim, key, std::memory_order_relaxed)) {
+                        }
+                    });
+                }
+            },
+            grain_size);
+        const uint64_t marks = mark_;
+        pxr::WorkParallelForN(
+            competitors.size(),
+            [&](size_t begin, size_t end) {
+                Vector3 target;
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t x = competitors[i];
+                    const uint64_t key = key_of(x);
+                    const uint32_t y = proposals_[x];
+                    bool holds = true;
+                    for_each_around(x, y, [&](uint32_t w) {
+                        holds = holds && claims_[w].load(
+                                             std::memory_order_relaxed) == key;
+                    });
+                    if (holds) {
+                        pair_cost(x, y, target);
+                        won[x] = can_collapse(x, y, target, marks + 2 * x)
+                                     ? accepted
+                                     : refused;
+                    }
+                }
+            },
+            grain_size);
+        mark_ += 2 * n;
+        // A refused proposal would keep its neighborhood claimed; it is
+        // withdrawn until a contraction nearby makes the vertex dirty.
+        std::atomic<bool> withdrawn = false;
+        pxr::WorkParallelForN(
+            competitors.size(),
+            [&](size_t begin, size_t end) {
+                bool local = false;
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t x = competitors[i];
+                    for_each_around(x, proposals_[x], [&](uint32_t w) {
+                        claims_[w].store(
+                            ~uint64_t(0), std::memory_order_relaxed);
+                    });
+                    if (won[x] == refused) {
+                        proposals_[x] = none;
+                        won[x] = 0;
+                        local = true;
+                    }
+                }
+                if (local) {
+                    withdrawn.store(true, std::memory_order_relaxed);
+                }
+            },
+            grain_size);
+
+        compact(
+            competitors,
+            [&](uint32_t x) { return won[x] == accepted; },
+            winners);
+        for (const uint32_t x : winners) {
+            won[x] = 0;
+        }
+        if (winners.empty()) {
+            if (withdrawn) {
+                continue;
+            }
+            // Nothing competing can contract; let more compete.
+            if (quantile >= 1.0f) {
+                break;
+            }
+            quantile = std::min(1.0f, 2.0f * quantile);
+            continue;
+        }
+        quantile = round_quantile;
+        // Interior contractions remove two faces; keep the cheapest ones
+        // that reach the target.
+        const size_t budget = (live_faces_ - target_faces + 1) / 2;
+        if (winners.size() > budget) {
+            std::nth_element(
+                winners.begin(),
+                winners.begin() + budget,
+                winners.end(),
+                [&](uint32_t a, uint32_t b) {
+                    return proposal_costs_[a] < proposal_costs_[b];
+                });
+            winners.resize(budget);
+        }
+        // The winners are independent, so any order is a valid sequence;
+        // by cost keeps the recorded errors fine grained.
+        QemCollapse* records = nullptr;
+        if (collapses_) {
+            std::sort(
+                winners.begin(), winners.end(), [&](uint32_t a, uint32_t b) {
+                    return proposal_costs_[a] < proposal_costs_[b];
+                });
+            collapses_->resize(collapses_->size() + winners.size());
+            records = collapses_->data() + collapses_->size() - winners.size();
+        }
+
+        std::atomic<size_t> removed = 0;
+        pxr::WorkParallelForN(
+            winners.size(),
+            [&](size_t begin, size_t end) {
+                Vector3 target;
+                size_t local = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t u = winners[i], v = proposals_[u];
+                    pair_cost(u, v, target);
+                    const size_t faces = contract(u, v, target);
+                    local += faces;
+                    for_each_around(u, u, [&](uint32_t w) { dirty_[w] = 1; });
+                    if (records) {
+                        // The face count holds the faces removed until the
+                        // counts are summed below.
+                        records[i] = { u,
+                                       v,
+                                       to_float(target),
+                                       proposal_costs_[u],
+                                       static_cast<uint32_t>(faces) };
+                    }
+                }
+                removed += local;
+            },
+            64);
+        if (records) {
+            size_t faces = live_faces_;
+            for (size_t i = 0; i < winners.size(); ++i) {
+                faces -= records[i].face_count;
+                records[i].face_count = static_cast<uint32_t>(faces);
+                max_error_ = std::max(max_error_, records[i].error);
+                records[i].error = max_error_;
+            }
+        }
+        live_faces_ -= removed;
+        live_vertices_ -= winners.size();
+        compact(live, [&](uint32_t x) { return stamps_[x] != none; }, scratch);
+        live.swap(scratch);
+    }
+}
+
+SimplifiedMesh Simplifier::result() const
+{
+    SimplifiedMesh mesh;
+    std::vector<int> index(positions_.size(), -1);
+    int count = 0;
+    const size_t faces = corners_.size() / 3;
+    for (size_t f = 0; f < faces; ++f) {
+        if (!face_alive(f)) {
+            continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t v = corners_[3 * f + k];
+            if (index[v] < 0) {
+                index[v] = 0;
+                ++count;
+            }
+        }
+    }
+    mesh.vertices.reserve(count);
+    count = 0;
+    for (size_t v = 0; v < positions_.size(); ++v) {
+        if (index[v] >= 0) {
+            index[v] = count++;
+            mesh.vertices.push_back(to_float(positions_[v]));
+        }
+    }
+    mesh.face_vertex_counts.assign(live_faces_, 3);
+    mesh.face_vertex_indices.reserve(3 * live_faces_);
+    for (size_t f = 0; f < faces; ++f) {
+        if (face_alive(f)) {
+            for (int k = 0; k < 3; ++k) {
+                mesh.face_vertex_indices.push_back(index[corners_[3 * f + k]]);
+            }
+        }
+    }
+    return mesh;
+}
+}  // namespace
+
+SimplifiedMesh qem_simplify(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const QemOptions& options,
+    std::vector<QemCollapse>* collapses)
+{
+    if (vertices.size() != adjacency.vertex_count()) {
+        throw std::invalid_argument(
+            "qem_simplify: vertex count does not match the adjacency.");
+    }
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    for (size_t f = 0; f < adjacency.face_count(); ++f) {
+        if (offsets[f + 1] - offsets[f] != 3) {
+            throw std::invalid_argument(
+                "qem_simplify: only triangle meshes are supported.");
+        }
+    }
+    Simplifier simplifier(adjacency, vertices, options, collapses);
+    const double ratio = std::clamp(double(options.ratio), 0.0, 1.0);
+    const size_t target_faces = static_cast<size_t>(
+        std::ceil(ratio * static_cast<double>(adjacency.face_count())));
+    if (options.schedule == QemSchedule::serial) {
+        simplifier.run(target_faces);
+    }
+    else {
+        simplifier.run_parallel(target_faces);
+    }
+    return simplifier.result();
+}
+
+ProgressiveMesh::ProgressiveMesh(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const QemOptions& options)
+{
+    qem_simplify(adjacency, vertices, options, &collapses_);
+    vertices_ = vertices;
+    triangles_ = adjacency.corner_vertices();
+    for (size_t f = 0; f < triangles_.size(); f += 3) {
+        const uint32_t* c = triangles_.data() + f;
+        face_count_ += c[0] != c[1] && c[1] != c[2] && c[2] != c[0];
+    }
+}
+
+size_t ProgressiveMesh::collapses_for_face_count(size_t faces) const
+{
+    if (face_count_ <= faces) {
+        return 0;
+    }
+    const auto first = std::partition_point(
+        collapses_.begin(), collapses_.end(), [&](const QemCollapse& c) {
+            return c.face_count > faces;
+        });
+    return std::min<size_t>(first - collapses_.begin() + 1, collapses_.size());
+}
+
+size_t ProgressiveMesh::collapses_for_error(float error) const
+{
+    const auto end = std::partition_point(
+        collapses_.begin(), collapses_.end(), [&](const QemCollapse& c) {
+            return c.error <= error;
+        });
+    return end - collapses_.begin();
+}
+
+// Positions replay forwards; every removed vertex then maps to where its
+// survivor went, which a backward pass resolves in one step per record.
+SimplifiedMesh ProgressiveMesh::extract(size_t count) const
+{
+    count = std::min(count, collapses_.size());
+    const size_t n = vertices_.size();
+    std::vector<pxr::GfVec3f> positions(vertices_.begin(), vertices_.end());
+    std::vector<uint32_t> representative(n);
+    for (size_t v = 0; v < n; ++v) {
+        representative[v] = static_cast<uint32_t>(v);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        positions[collapses_[i].kept] = collapses_[i].position;
+    }
+    for (size_t i = count; i-- > 0;) {
+        const QemCollapse& c = collapses_[i];
+        representative[c.removed] = representative[c.kept];
+    }
+
+    SimplifiedMesh mesh;
+    std::vector<int> index(n, -1);
+    std::vector<uint32_t> kept;
+    kept.reserve(triangles_.size());
+    for (size_t f = 0; f < triangles_.size(); f += 3) {
+        const uint32_t a = representative[triangles_[f]];
+        const uint32_t b = representative[triangles_[f + 1]];
+        const uint32_t c = representative[triangles_[f + 2]];
+        if (a != b && b != c && c != a) {
+            kept.insert(kept.end(), { a, b, c });
+            index[a] = index[b] = index[c] = 0;
+        }
+    }
+    int used = 0;
+    for (size_t v = 0; v < n; ++v) {
+        if (index[v] >= 0) {
+            index[v] = used++;
+        }
+    }
+    mesh.vertices.reserve(used);
+    for (size_t v = 0; v < n; ++v) {
+        if (index[v] >= 0) {
+            mesh.vertices.push_back(positions[v]);
+        }
+    }
+    mesh.face_vertex_counts.assign(kept.size() / 3, 3);
+    mesh.face_vertex_indices.reserve(kept.size());
+    for (const uint32_t v : kept) {
+        mesh.face_vertex_indices.push_back(index[v]);
+    }
+    return mesh;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
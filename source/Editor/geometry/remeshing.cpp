@@ -0,0 +1,786 @@
+#include "GCore/Algorithms/remeshing.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "GCore/Algorithms/bvh.h"
+#include "GCore/Algorithms/curvature.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+constexpr uint32_t none = ~0u;
+// Edges longer than this times their target length are split, shorter than
+// the other are collapsed.
+constexpr float split_ratio = 4.0f / 3.0f;
+constexpr float collapse_ratio = 4.0f / 5.0f;
+
+// Halfedge h of face h / 3 starts at corner h and ends at the next one.
+uint32_t next(uint32_t h)
+{
+    return h % 3 == 2 ? h - 2 : h + 1;
+}
+
+uint32_t prev(uint32_t h)
+{
+    return h % 3 == 0 ? h + 2 : h - 1;
+}
+
+class Remesher {
+   public:
+    Remesher(
+        const MeshAdjacency& adjacency,
+        const pxr::VtArray<pxr::GfVec3f>& vertices,
+        const std::vector<float>& sizing);
+
+    void split_long_edges();
+    void collapse_short_edges();
+    void flip_edges();
+    // Resamples the target lengths from `sizing` on the input vertices
+    // unless it is empty.
+    void relax(
+        float lambda,
+        const MeshBVH& surface,
+        const std::vector<float>& sizing);
+    RemeshedMesh result() const;
+
+   private:
+    bool face_alive(uint32_t f) const
+    {
+        return corners_[3 * f] != none;
+    }
+
+    float length_squared(uint32_t h) const
+    {
+        return (positions_[corners_[next(h)]] - positions_[corners_[h]])
+            .GetLengthSq();
+    }
+
+    // Squared length of h over its target length, the mean of the targets
+    // at its ends.
+    float stretch(uint32_t h) const
+    {
+        const float target =
+            0.5f * (sizes_[corners_[h]] + sizes_[corners_[next(h)]]);
+        return length_squared(h) / (target * target);
+    }
+
+    void link(uint32_t a, uint32_t b)
+    {
+        if (a != none) {
+            twins_[a] = b;
+        }
+        if (b != none) {
+            twins_[b] = a;
+        }
+    }
+
+    // Calls fn(h) for the halfedges leaving v, counterclockwise. On the
+    // boundary they start with the one without a twin.
+    template<typename Fn>
+    void for_each_out(uint32_t v, const Fn& fn) const;
+    template<typename Fn>
+    void for_each_neighbor(uint32_t v, const Fn& fn) const;
+    // Points out_[v] at `candidate` when its face was removed, and on the
+    // boundary rotates it to the halfedge without a twin.
+    void fix_out(uint32_t v, uint32_t candidate);
+
+    void split(uint32_t h);
+    bool collapse(uint32_t h);
+    bool folds(
+        uint32_t v,
+        const pxr::GfVec3f& target,
+        uint32_t f,
+        uint32_t g) const;
+    bool flip(uint32_t h);
+
+    std::vector<pxr::GfVec3f> positions_;
+    // Target edge length at each vertex.
+    std::vector<float> sizes_;
+    std::vector<uint8_t> boundary_;
+    std::vector<int> valences_;
+    // An outgoing halfedge per vertex, `none` once the vertex is removed.
+    std::vector<uint32_t> out_;
+    // Three corners per face, the first `none` for removed faces.
+    std::vector<uint32_t> corners_;
+    // The opposite halfedge, `none` on the boundary.
+    std::vector<uint32_t> twins_;
+
+    // Scratch marks for the link condition, never cleared.
+    std::vector<uint64_t> marks_;
+    uint64_t mark_ = 0;
+};
+
+Remesher::Remesher(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const std::vector<float>& sizing)
+    : positions_(vertices.begin(), vertices.end()),
+      sizes_(sizing),
+      boundary_(adjacency.boundary_vertices()),
+      corners_(adjacency.corner_vertices())
+{
+    const size_t n = vertices.size();
+    const size_t halfedges = corners_.size();
+
+    // Halfedges sorted by their undirected edge pair up with their twins.
+    std::vector<std::pair<uint64_t, uint32_t>> edges(halfedges);
+    for (uint32_t h = 0; h < halfedges; ++h) {
+        const uint32_t a = corners_[h], b = corners_[next(h)];
+        if (a == b) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: degenerate face.");
+        }
+        edges[h] = { (uint64_t(std::min(a, b)) << 32) | std::max(a, b), h };
+    }
+    std::sort(edges.begin(), edges.end());
+    twins_.assign(halfedges, none);
+    for (size_t i = 0; i < halfedges;) {
+        size_t j = i + 1;
+        while (j < halfedges && edges[j].first == edges[i].first) {
+            ++j;
+        }
+        if (j - i > 2) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: an edge has more than two faces.");
+        }
+        if (j - i == 2) {
+            const uint32_t a = edges[i].second, b = edges[i + 1].second;
+            if (corners_[a] == corners_[b]) {
+                throw std::invalid_argument(
+                    "isotropic_remeshing: faces are not consistently "
+                    "oriented.");
+            }
+            link(a, b);
+        }
+        i = j;
+    }
+
+    out_.assign(n, none);
+    std::vector<int> degrees(n, 0);
+    for (uint32_t h = 0; h < halfedges; ++h) {
+        const uint32_t v = corners_[h];
+        ++degrees[v];
+        if (out_[v] == none || twins_[h] == none) {
+            out_[v] = h;
+        }
+    }
+    // A single fan around every vertex holds all of its halfedges.
+    valences_.assign(n, 0);
+    for (uint32_t v = 0; v < n; ++v) {
+        int fan = 0;
+        for_each_out(v, [&](uint32_t) { ++fan; });
+        if (fan != degrees[v]) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: the faces around a vertex do not form "
+                "a single fan.");
+        }
+        valences_[v] = fan + boundary_[v];
+    }
+    marks_.assign(n, 0);
+}
+
+template<typename Fn>
+void Remesher::for_each_out(uint32_t v, const Fn& fn) const
+{
+    const uint32_t first = out_[v];
+    if (first == none) {
+        return;
+    }
+    uint32_t h = first;
+    do {
+        fn(h);
+        h = twins_[prev(h)];
+    } while (h != none && h != first);
+}
+
+template<typename Fn>
+void Remesher::for_each_neighbor(uint32_t v, const Fn& fn) const
+{
+    uint32_t last = none;
+    for_each_out(v, [&](uint32_t h) {
+        fn(corners_[next(h)]);
+        last = h;
+    });
+    if (last != none && twins_[prev(last)] == none) {
+        fn(corners_[prev(last)]);
+    }
+}
+
+void Remesher::fix_out(uint32_t v, uint32_t candidate)
+{
+    uint32_t h = out_[v];
+    if (!face_alive(h / 3)) {
+        h = candidate;
+    }
+    if (boundary_[v]) {
+        while (twins_[h] != none) {
+            h = next(twins_[h]);
+        }
+    }
+    out_[v] = h;
+}
+
+// Splits halfedge h from a to b in face (a, b, c) and its twin in face
+// (b, a, d) at a new vertex m: the old faces become (a, m, c) and (m, a, d)
+// and the new ones (m, b, c) and (b, m, d).
+void Remesher::split(uint32_t h)
+{
+    const uint32_t n = next(h), p = prev(h), t = twins_[h];
+    const uint32_t a = corners_[h], b = corners_[n], c = corners_[p];
+    const uint32_t m = static_cast<uint32_t>(positions_.size());
+    positions_.push_back(0.5f * (positions_[a] + positions_[b]));
+    sizes_.push_back(0.5f * (sizes_[a] + sizes_[b]));
+    boundary_.push_back(t == none);
+    valences_.push_back(t == none ? 3 : 4);
+    marks_.push_back(0);
+
+    const uint32_t q = static_cast<uint32_t>(corners_.size());
+    corners_.insert(corners_.end(), { m, b, c });
+    twins_.insert(twins_.end(), { none, none, none });
+    const uint32_t bc = twins_[n];
+    corners_[n] = m;
+    link(q + 1, bc);
+    link(q + 2, n);
+    if (out_[b] == n) {
+        out_[b] = q + 1;
+    }
+    ++valences_[c];
+
+    if (t != none) {
+        const uint32_t tp = prev(t);
+        const uint32_t d = corners_[tp];
+        const uint32_t r = static_cast<uint32_t>(corners_.size());
+        corners_.insert(corners_.end(), { b, m, d });
+        twins_.insert(twins_.end(), { none, none, none });
+        const uint32_t bd = twins_[tp];
+        corners_[t] = m;
+        link(r, q);
+        link(r + 1, tp);
+        link(r + 2, bd);
+        if (out_[b] == t) {
+            out_[b] = r;
+        }
+        if (out_[d] == tp) {
+            out_[d] = r + 2;
+        }
+        ++valences_[d];
+    }
+    out_.push_back(q);
+}
+
+// Longest edge first: splitting short edges before the long ones around
+// them keeps adding edges to the opposite corners and can fan out a vertex
+// without end.
+void Remesher::split_long_edges()
+{
+    const float high = split_ratio * split_ratio;
+    std::vector<std::pair<float, uint32_t>> heap;
+    auto push = [&](uint32_t h) {
+        const float length = stretch(h);
+        if (length > high) {
+            heap.push_back({ length, h });
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+    for (uint32_t h = 0; h < corners_.size(); ++h) {
+        if (face_alive(h / 3) && (twins_[h] == none || h < twins_[h])) {
+            push(h);
+        }
+    }
+    // Halves and the new edges to the opposite corners can still be long.
+    // A split pushes every halfedge it shortens or moves, so entries with
+    // an old length are stale.
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        const auto [length, h] = heap.back();
+        heap.pop_back();
+        if (stretch(h) != length) {
+            continue;
+        }
+        const uint32_t t = twins_[h];
+        const uint32_t q = static_cast<uint32_t>(corners_.size());
+        split(h);
+        // The edge from b to c moved to the new face, and so did the one
+        // from d to b.
+        for (const uint32_t e : { h, q, q + 1, next(h) }) {
+            push(e);
+        }
+        if (t != none) {
+            push(prev(t));
+            push(q + 5);
+        }
+    }
+}
+
+// Whether moving v to `target` turns a face around it, other than f and g,
+// upside down.
+bool Remesher::folds(
+    uint32_t v,
+    const pxr::GfVec3f& target,
+    uint32_t f,
+    uint32_t g) const
+{
+    bool folded = false;
+    const pxr::GfVec3f& p = positions_[v];
+    for_each_out(v, [&](uint32_t h) {
+        if (folded || h / 3 == f || h / 3 == g) {
+            return;
+        }
+        const pxr::GfVec3f& b = positions_[corners_[next(h)]];
+        const pxr::GfVec3f& c = positions_[corners_[prev(h)]];
+        const pxr::GfVec3f before = pxr::GfCross(b - p, c - p);
+        const pxr::GfVec3f after = pxr::GfCross(b - target, c - target);
+        folded = pxr::GfDot(before, after) <= 0.0f;
+    });
+    return folded;
+}
+
+// Collapses the interior edge of h into its midpoint, or into its boundary
+// vertex. The removed vertex a has faces (a, b, vl) and (b, a, vr) along
+// the edge; its other faces move over to b.
+bool Remesher::collapse(uint32_t h)
+{
+    uint32_t t = twins_[h];
+    uint32_t a = corners_[h], b = corners_[t];
+    if (boundary_[a] && boundary_[b]) {
+        return false;
+    }
+    if (boundary_[a]) {
+        std::swap(h, t);
+        std::swap(a, b);
+    }
+    const uint32_t vl = corners_[prev(h)], vr = corners_[prev(t)];
+    for (const uint32_t v : { vl, vr }) {
+        if (valences_[v] <= (boundary_[v] ? 2 : 3)) {
+            return false;
+        }
+    }
+
+    // Link condition: vl and vr are the only common neighbors.
+    const uint64_t mark = ++mark_;
+    for_each_neighbor(a, [&](uint32_t w) { marks_[w] = mark; });
+    int common = 0;
+    for_each_neighbor(b, [&](uint32_t w) { common += marks_[w] == mark; });
+    if (common != 2) {
+        return false;
+    }
+
+    const pxr::GfVec3f target =
+        boundary_[b] ? positions_[b] : 0.5f * (positions_[a] + positions_[b]);
+    const float size =
+        boundary_[b] ? sizes_[b] : 0.5f * (sizes_[a] + sizes_[b]);
+    bool too_long = false;
+    for (const uint32_t v : { a, b }) {
+        for_each_neighbor(v, [&](uint32_t w) {
+            const float high = split_ratio * 0.5f * (size + sizes_[w]);
+            too_long = too_long ||
+                       (positions_[w] - target).GetLengthSq() > high * high;
+        });
+    }
+    if (too_long || folds(a, target, h / 3, t / 3) ||
+        folds(b, target, h / 3, t / 3)) {
+        return false;
+    }
+
+    const uint32_t b_vl = twins_[prev(h)], vl_b = twins_[next(h)];
+    const uint32_t vr_b = twins_[next(t)], b_vr = twins_[prev(t)];
+    for_each_out(a, [&](uint32_t e) { corners_[e] = b; });
+    link(vl_b, b_vl);
+    link(vr_b, b_vr);
+    corners_[3 * (h / 3)] = none;
+    corners_[3 * (t / 3)] = none;
+    positions_[b] = target;
+    sizes_[b] = size;
+    out_[a] = none;
+    valences_[b] += valences_[a] - 4;
+    --valences_[vl];
+    --valences_[vr];
+    fix_out(b, b_vl);
+    fix_out(vl, next(b_vl));
+    fix_out(vr, vr_b);
+    return true;
+}
+
+void Remesher::collapse_short_edges()
+{
+    const float low = collapse_ratio * collapse_ratio;
+    std::vector<uint32_t> work;
+    for (uint32_t h = 0; h < corners_.size(); ++h) {
+        if (face_alive(h / 3) && twins_[h] != none && h < twins_[h] &&
+            stretch(h) < low) {
+            work.push_back(h);
+        }
+    }
+    // Edges around the merged vertex are shorter than before when it moved
+    // to the midpoint.
+    while (!work.empty()) {
+        const uint32_t h = work.back();
+        work.pop_back();
+        if (!face_alive(h / 3) || twins_[h] == none || stretch(h) >= low) {
+            continue;
+        }
+        const uint32_t a = corners_[h], b = corners_[next(h)];
+        if (!collapse(h)) {
+            continue;
+        }
+        const uint32_t kept = out_[a] == none ? b : a;
+        for_each_out(kept, [&](uint32_t e) {
+            if (twins_[e] != none && stretch(e) < low) {
+                work.push_back(e);
+            }
+        });
+    }
+}
+
+// Flips the diagonal of faces (a, b, c) and (b, a, d) to c d when that
+// brings the four valences closer to 6, or 4 on the boundary, and the two
+// new faces face the same way as the old ones.
+bool Remesher::flip(uint32_t h)
+{
+    const uint32_t t = twins_[h];
+    const uint32_t hn = next(h), hp = prev(h), tn = next(t), tp = prev(t);
+    const uint32_t a = corners_[h], b = corners_[hn];
+    const uint32_t c = corners_[hp], d = corners_[tp];
+    if (c == d || valences_[a] <= (boundary_[a] ? 2 : 3) ||
+        valences_[b] <= (boundary_[b] ? 2 : 3)) {
+        return false;
+    }
+    auto deviation = [&](uint32_t v, int change) {
+        return std::abs(valences_[v] + change - (boundary_[v] ? 4 : 6));
+    };
+    const int before = deviation(a, 0) + deviation(b, 0) + deviation(c, 0) +
+                       deviation(d, 0);
+    const int after = deviation(a, -1) + deviation(b, -1) + deviation(c, 1) +
+                      deviation(d, 1);
+    if (after >= before) {
+        return false;
+    }
+    bool connected = false;
+    for_each_neighbor(c, [&](uint32_t w) { connected = connected || w == d; });
+    if (connected) {
+        return false;
+    }
+    const pxr::GfVec3f &pa = positions_[a], &pb = positions_[b];
+    const pxr::GfVec3f &pc = positions_[c], &pd = positions_[d];
+    const pxr::GfVec3f normal =
+        pxr::GfCross(pb - pa, pc - pa) + pxr::GfCross(pa - pb, pd - pb);
+    if (pxr::GfDot(pxr::GfCross(pd - pa, pc - pa), normal) <= 0.0f ||
+        pxr::GfDot(pxr::GfCross(pb - pd, pc - pd), normal) <= 0.0f) {
+        return false;
+    }
+
+    // The faces become (d, c, a) and (c, d, b).
+    const uint32_t bc = twins_[hn], ca = twins_[hp];
+    const uint32_t ad = twins_[tn], db = twins_[tp];
+    corners_[h] = d;
+    corners_[hn] = c;
+    corners_[hp] = a;
+    corners_[t] = c;
+    corners_[tn] = d;
+    corners_[tp] = b;
+    link(hn, ca);
+    link(hp, ad);
+    link(tn, db);
+    link(tp, bc);
+    if (out_[a] == h || out_[a] == tn) {
+        out_[a] = hp;
+    }
+    if (out_[b] == t || out_[b] == hn) {
+        out_[b] = tp;
+    }
+    if (out_[c] == hp) {
+        out_[c] = hn;
+    }
+    if (out_[d] == tp) {
+        out_[d] = tn;
+    }
+    --valences_[a];
+    --valences_[b];
+    ++valences_[c];
+    ++valences_[d];
+    return true;
+}
+
+void Remesher::flip_edges()
+{
+    // Edges are queued by their smaller halfedge, which a flip keeps.
+    std::vector<uint32_t> queue;
+    std::vector<uint8_t> queued(corners_.size(), 0);
+    auto push = [&](uint32_t h) {
+        const uint32_t t = twins_[h];
+        if (t == none) {
+            return;
+        }
+        const uint32_t e = std::min(h, t);
+        if (!queued[e]) {
+            queued[e] = 1;
+            queue.push_back(e);
+        }
+    };
+    for (uint32_t h = 0; h < corners_.size(); ++h) {
+        if (face_alive(h / 3)) {
+            push(h);
+        }
+    }
+    // Every flip lowers the total deviation, so the queue runs dry.
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const uint32_t h = queue[i];
+        queued[h] = 0;
+        if (!face_alive(h / 3) || !flip(h)) {
+            continue;
+        }
+        const uint32_t t = twins_[h];
+        for (const uint32_t e : { next(h), prev(h), next(t), prev(t) }) {
+            push(e);
+        }
+    }
+}
+
+// Jacobi steps towards the centroid of the neighbors weighted by their
+// areas, projected onto the tangent plane, then onto the input surface.
+// Boundary vertices stay.
+void Remesher::relax(
+    float lambda,
+    const MeshBVH& surface,
+    const std::vector<float>& sizing)
+{
+    const size_t n = positions_.size();
+    std::vector<float> areas(n, 0.0f);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                float area = 0.0f;
+                const pxr::GfVec3f& p = positions_[v];
+                for_each_out(static_cast<uint32_t>(v), [&](uint32_t h) {
+                    const pxr::GfVec3f& b = positions_[corners_[next(h)]];
+                    const pxr::GfVec3f& c = positions_[corners_[prev(h)]];
+                    area += pxr::GfCross(b - p, c - p).GetLength();
+                });
+                areas[v] = area / 6.0f;
+            }
+        },
+        grain_size);
+
+    std::vector<uint32_t> moved;
+    for (uint32_t v = 0; v < n; ++v) {
+        if (out_[v] != none && !boundary_[v]) {
+            moved.push_back(v);
+        }
+    }
+    std::vector<pxr::GfVec3f> targets(moved.size());
+    pxr::WorkParallelForN(
+        moved.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t v = moved[i];
+                const pxr::GfVec3f& p = positions_[v];
+                pxr::GfVec3f centroid(0.0f), normal(0.0f);
+                float weight = 0.0f;
+                for_each_out(v, [&](uint32_t h) {
+                    const pxr::GfVec3f& b = positions_[corners_[next(h)]];
+                    const pxr::GfVec3f& c = positions_[corners_[prev(h)]];
+                    const float area = areas[corners_[next(h)]];
+                    centroid += area * b;
+                    weight += area;
+                    normal += pxr::GfCross(b - p, c - p);
+                });
+                targets[i] = p;
+                const float length = normal.GetLength();
+                if (weight > 0.0f && length > 0.0f) {
+                    normal /= length;
+                    pxr::GfVec3f step = centroid / weight - p;
+                    step -= pxr::GfDot(step, normal) * normal;
+                    targets[i] += lambda * step;
+                }
+            }
+        },
+        grain_size);
+
+    std::vector<ClosestPoint> closest(moved.size());
+    surface.closest_points(targets.data(), targets.size(), closest.data());
+    for (size_t i = 0; i < moved.size(); ++i) {
+        const ClosestPoint& c = closest[i];
+        if (!c) {
+            positions_[moved[i]] = targets[i];
+            continue;
+        }
+        positions_[moved[i]] = c.point;
+        if (!sizing.empty()) {
+            const pxr::GfVec3i& corners = surface.triangle(c.triangle);
+            sizes_[moved[i]] = c.barycentric[0] * sizing[corners[0]] +
+                               c.barycentric[1] * sizing[corners[1]] +
+                               c.barycentric[2] * sizing[corners[2]];
+        }
+    }
+}
+
+RemeshedMesh Remesher::result() const
+{
+    RemeshedMesh mesh;
+    std::vector<int> index(positions_.size(), -1);
+    int count = 0;
+    for (uint32_t v = 0; v < positions_.size(); ++v) {
+        if (out_[v] != none) {
+            index[v] = count++;
+            mesh.vertices.push_back(positions_[v]);
+        }
+    }
+    for (size_t f = 0; f < corners_.size() / 3; ++f) {
+        if (face_alive(static_cast<uint32_t>(f))) {
+            for (size_t k = 0; k < 3; ++k) {
+                mesh.face_vertex_indices.push_back(index[corners_[3 * f + k]]);
+            }
+        }
+    }
+    mesh.face_vertex_counts.assign(mesh.face_vertex_indices.size() / 3, 3);
+    return mesh;
+}
+
+// Lowers the target lengths until they grow by at most `gradation` times
+// the length of any edge: a Dijkstra sweep outwards from the smallest.
+void limit_gradation(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    float gradation,
+    std::vector<float>& sizing)
+{
+    using Entry = std::pair<float, uint32_t>;
+    std::vector<Entry> heap(sizing.size());
+    for (uint32_t v = 0; v < sizing.size(); ++v) {
+        heap[v] = { sizing[v], v };
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<>());
+    const NeighborLists& faces = adjacency.vertex_faces();
+    const std::vector<uint32_t>& corners = adjacency.corner_vertices();
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        const auto [size, v] = heap.back();
+        heap.pop_back();
+        if (size > sizing[v]) {
+            continue;
+        }
+        for (const uint32_t* f = faces.begin(v); f != faces.end(v); ++f) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                const uint32_t w = corners[3 * *f + k];
+                const float bound =
+                    size + gradation * (vertices[w] - vertices[v]).GetLength();
+                if (bound < sizing[w]) {
+                    sizing[w] = bound;
+                    heap.push_back({ bound, w });
+                    std::push_heap(heap.begin(), heap.end(), std::greater<>());
+                }
+            }
+        }
+    }
+}
+}  // namespace
+
+pxr::VtArray<float> curvature_sizing(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const SizingOptions& options)
+{
+    if (!(options.min_length > 0.0f) ||
+        !(options.max_length >= options.min_length)) {
+        throw std::invalid_argument(
+            "curvature_sizing: the lengths must be positive and ordered.");
+    }
+    const MeshCurvature curvature =
+        compute_curvature(adjacency, vertices, false);
+    const float error = options.error;
+    pxr::VtArray<float> sizing(vertices.size());
+    pxr::WorkParallelForN(
+        vertices.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                const float k = std::max(
+                    std::abs(curvature.max[v]), std::abs(curvature.min[v]));
+                const float squared = 6.0f * error / k - 3.0f * error * error;
+                const float length = squared > 0.0f
+                                         ? std::sqrt(squared)
+                                         : options.min_length;
+                sizing[v] =
+                    std::clamp(length, options.min_length, options.max_length);
+            }
+        },
+        grain_size);
+    return sizing;
+}
+
+RemeshedMesh isotropic_remeshing(
+    const MeshAdjacency& adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const RemeshingOptions& options)
+{
+    if (vertices.size() != adjacency.vertex_count()) {
+        throw std::invalid_argument(
+            "isotropic_remeshing: vertex count does not match the "
+            "adjacency.");
+    }
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    for (size_t f = 0; f < adjacency.face_count(); ++f) {
+        if (offsets[f + 1] - offsets[f] != 3) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: only triangle meshes are supported.");
+        }
+    }
+    std::vector<float> sizing;
+    if (options.sizing.empty()) {
+        if (!(options.target_edge_length > 0.0f)) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: the target edge length must be "
+                "positive.");
+        }
+    }
+    else {
+        if (options.sizing.size() != vertices.size()) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: sizing count does not match the "
+                "vertices.");
+        }
+        sizing.assign(options.sizing.begin(), options.sizing.end());
+        for (const float size : sizing) {
+            if (!(size > 0.0f) || !std::isfinite(size)) {
+                throw std::invalid_argument(
+                    "isotropic_remeshing: target lengths must be positive.");
+            }
+        }
+        if (!(options.gradation >= 0.0f) ||
+            !std::isfinite(options.gradation)) {
+            throw std::invalid_argument(
+                "isotropic_remeshing: the gradation must be non-negative.");
+        }
+        limit_gradation(adjacency, vertices, options.gradation, sizing);
+    }
+
+    Remesher remesher(
+        adjacency,
+        vertices,
+        sizing.empty()
+            ? std::vector<float>(vertices.size(), options.target_edge_length)
+            : sizing);
+    pxr::VtArray<int> face_vertex_counts(adjacency.face_count(), 3);
+    const std::vector<uint32_t>& corners = adjacency.corner_vertices();
+    const pxr::VtArray<int> face_vertex_indices(corners.begin(), corners.end());
+    const MeshBVH surface(vertices, face_vertex_counts, face_vertex_indices);
+
+    for (int i = 0; i < options.iterations; ++i) {
+        remesher.split_long_edges();
+        remesher.collapse_short_edges();
+        remesher.flip_edges();
+        remesher.relax(options.lambda, surface, sizing);
+    }
+    return remesher.result();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
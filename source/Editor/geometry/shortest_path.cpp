@@ -0,0 +1,380 @@
+#include "GCore/Algorithms/shortest_path.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+constexpr uint32_t settled_slot = ~0u;
+constexpr uint32_t arity = 4;
+constexpr float infinity = std::numeric_limits<float>::infinity();
+
+float distance_between(const pxr::GfVec3f& a, const pxr::GfVec3f& b)
+{
+    return (a - b).GetLength();
+}
+}  // namespace
+
+EdgeGraph::EdgeGraph(
+    const pxr::VtArray<int>& face_vertex_counts,
+    const pxr::VtArray<int>& face_vertex_indices,
+    size_t vertex_count)
+{
+    size_t corner_count = 0;
+    for (int count : face_vertex_counts) {
+        if (count < 0) {
+            throw std::invalid_argument(
+                "EdgeGraph: negative face vertex count.");
+        }
+        corner_count += count;
+    }
+    if (corner_count != face_vertex_indices.size()) {
+        throw std::invalid_argument(
+            "EdgeGraph: face vertex counts do not match the indices.");
+    }
+    for (int v : face_vertex_indices) {
+        if (v < 0 || static_cast<size_t>(v) >= vertex_count) {
+            throw std::invalid_argument(
+                "EdgeGraph: face vertex index out of range.");
+        }
+    }
+
+    // Every face edge is listed at both ends, then the lists are sorted and
+    // edges shared by two faces collapse to one entry.
+    auto for_each_edge = [&](const auto& f) {
+        size_t first = 0;
+        for (int count : face_vertex_counts) {
+            for (int k = 0; k < count; ++k) {
+                const uint32_t a = face_vertex_indices[first + k];
+                const uint32_t b =
+                    face_vertex_indices[first + (k + 1) % count];
+                if (a != b) {
+                    f(a, b);
+                }
+            }
+            first += count;
+        }
+    };
+    neighbors_.offsets.assign(vertex_count + 1, 0);
+    for_each_edge([&](uint32_t a, uint32_t b) {
+        ++neighbors_.offsets[a + 1];
+        ++neighbors_.offsets[b + 1];
+    });
+    std::partial_sum(
+        neighbors_.offsets.begin(),
+        neighbors_.offsets.end(),
+        neighbors_.offsets.begin());
+    neighbors_.indices.resize(neighbors_.offsets.back());
+    std::vector<uint32_t> cursor(
+        neighbors_.offsets.begin(), neighbors_.offsets.end() - 1);
+    for_each_edge([&](uint32_t a, uint32_t b) {
+        neighbors_.indices[cursor[a]++] = b;
+        neighbors_.indices[cursor[b]++] = a;
+    });
+
+    pxr::WorkParallelForN(
+        vertex_count,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                auto first = neighbors_.indices.begin() + neighbors_.offsets[v];
+                auto last =
+                    neighbors_.indices.begin() + neighbors_.offsets[v + 1];
+                std::sort(first, last);
+                cursor[v] = static_cast<uint32_t>(
+                    std::unique(first, last) - neighbors_.indices.begin());
+            }
+        },
+        grain_size);
+    uint32_t write = 0;
+    for (size_t v = 0; v < vertex_count; ++v) {
+        const uint32_t begin = neighbors_.offsets[v];
+        neighbors_.offsets[v] = write;
+        for (uint32_t i = begin; i < cursor[v]; ++i) {
+            neighbors_.indices[write++] = neighbors_.indices[i];
+        }
+    }
+    neighbors_.offsets[vertex_count] = write;
+    neighbors_.indices.resize(write);
+    neighbors_.indices.shrink_to_fit();
+}
+
+std::shared_ptr<const EdgeGraph> EdgeGraph::update(
+    const std::shared_ptr<const EdgeGraph>& previous,
+    const MeshComponent& mesh)
+{
+    const uint64_t topology = mesh.topology_hash();
+    if (previous && previous->topology_hash_ == topology &&
+        previous->vertex_count() == mesh.get_vertices().size()) {
+        return previous;
+    }
+    auto graph = std::make_shared<EdgeGraph>(
+        mesh.get_face_vertex_counts(),
+        mesh.get_face_vertex_indices(),
+        mesh.get_vertices().size());
+    graph->topology_hash_ = topology;
+    return graph;
+}
+
+void ShortestPathSearch::Frontier::reset(size_t vertex_count)
+{
+    if (vertices.size() != vertex_count) {
+        vertices.assign(vertex_count, Vertex{});
+        current = 0;
+    }
+    heap.clear();
+    // Stamps only need clearing when the counter wraps around.
+    if (++current == 0) {
+        for (Vertex& vertex : vertices) {
+            vertex.stamp = 0;
+        }
+        current = 1;
+    }
+}
+
+bool ShortestPathSearch::Frontier::settled(uint32_t v) const
+{
+    return reached(v) && vertices[v].slot == settled_slot;
+}
+
+// Records a shorter tentative distance for v. The caller checks that v is
+// not settled and that g_value improves on the current one.
+void ShortestPathSearch::Frontier::relax(
+    uint32_t v,
+    float g_value,
+    float key,
+    uint32_t from)
+{
+    Vertex& vertex = vertices[v];
+    vertex.g = g_value;
+    vertex.parent = from;
+    if (vertex.stamp != current) {
+        vertex.stamp = current;
+        vertex.slot = static_cast<uint32_t>(heap.size());
+        heap.emplace_back(key, v);
+    }
+    else {
+        heap[vertex.slot].first = key;
+    }
+    sift_up(vertex.slot);
+}
+
+uint32_t ShortestPathSearch::Frontier::pop()
+{
+    const uint32_t top = heap.front().second;
+    vertices[top].slot = settled_slot;
+    const auto last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+        place(0, last);
+        sift_down(0);
+    }
+    return top;
+}
+
+void ShortestPathSearch::Frontier::place(
+    size_t i,
+    std::pair<float, uint32_t> entry)
+{
+    heap[i] = entry;
+    vertices[entry.second].slot = static_cast<uint32_t>(i);
+}
+
+void ShortestPathSearch::Frontier::sift_up(size_t i)
+{
+    const auto entry = heap[i];
+    while (i > 0) {
+        const size_t up = (i - 1) / arity;
+        if (!(entry.first < heap[up].first)) {
+            break;
+        }
+        place(i, heap[up]);
+        i = up;
+    }
+    place(i, entry);
+}
+
+void ShortestPathSearch::Frontier::sift_down(size_t i)
+{
+    const auto entry = heap[i];
+    const size_t size = heap.size();
+    while (true) {
+        const size_t first = arity * i + 1;
+        if (first >= size) {
+            break;
+        }
+        size_t best = first;
+        const size_t last = std::min(first + arity, size);
+        for (size_t c = first + 1; c < last; ++c) {
+            if (heap[c].first < heap[best].first) {
+                best = c;
+            }
+        }
+        if (!(heap[best].first < entry.first)) {
+            break;
+        }
+        place(i, heap[best]);
+        i = best;
+    }
+    place(i, entry);
+}
+
+bool ShortestPathSearch::find(
+    const EdgeGraph& graph,
+    const pxr::VtArray<pxr::GfVec3f>& positions,
+    uint32_t source,
+    uint32_t target,
+    std::vector<uint32_t>& path,
+    float& distance,
+    PathSearch method)
+{
+    const size_t vertex_count = graph.vertex_count();
+    if (positions.size() != vertex_count) {
+        throw std::invalid_argument(
+            "ShortestPathSearch: positions do not match the graph.");
+    }
+    if (source >= vertex_count || target >= vertex_count) {
+        throw std::invalid_argument(
+            "ShortestPathSearch: vertex index out of range.");
+    }
+    path.clear();
+    distance = 0.0f;
+    settled_ = 0;
+    if (source == target) {
+        path.push_back(source);
+        return true;
+    }
+
+    if (method == PathSearch::bidirectional) {
+        if (!find_bidirectional(
+                graph, positions.cdata(), source, target, distance)) {
+            return false;
+        }
+        for (uint32_t v = meet_from_; v != source; v = forward_.parent(v)) {
+            path.push_back(v);
+        }
+        path.push_back(source);
+        std::reverse(path.begin(), path.end());
+        for (uint32_t v = meet_to_; v != target; v = backward_.parent(v)) {
+            path.push_back(v);
+        }
+        path.push_back(target);
+        return true;
+    }
+
+    if (!find_one_way(
+            graph,
+            positions.cdata(),
+            source,
+            target,
+            method == PathSearch::a_star,
+            distance)) {
+        return false;
+    }
+    for (uint32_t v = target; v != source; v = forward_.parent(v)) {
+        path.push_back(v);
+    }
+    path.push_back(source);
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+bool ShortestPathSearch::find_one_way(
+    const EdgeGraph& graph,
+    const pxr::GfVec3f* positions,
+    uint32_t source,
+    uint32_t target,
+    bool guided,
+    float& distance)
+{
+    const NeighborLists& neighbors = graph.neighbors();
+    const pxr::GfVec3f goal = positions[target];
+    auto heuristic = [&](uint32_t v) {
+        return guided ? distance_between(positions[v], goal) : 0.0f;
+    };
+
+    Frontier& frontier = forward_;
+    frontier.reset(graph.vertex_count());
+    frontier.relax(source, 0.0f, heuristic(source), source);
+    while (!frontier.heap.empty()) {
+        const uint32_t u = frontier.pop();
+        ++settled_;
+        // The heuristic is consistent, so the target is final once popped.
+        if (u == target) {
+            distance = frontier.g(u);
+            return true;
+        }
+        const float g_u = frontier.g(u);
+        for (const uint32_t* w = neighbors.begin(u); w != neighbors.end(u);
+             ++w) {
+            if (frontier.settled(*w)) {
+                continue;
+            }
+            const float g_w =
+                g_u + distance_between(positions[u], positions[*w]);
+            if (!frontier.reached(*w) || g_w < frontier.g(*w)) {
+                frontier.relax(*w, g_w, g_w + heuristic(*w), u);
+            }
+        }
+    }
+    return false;
+}
+
+bool ShortestPathSearch::find_bidirectional(
+    const EdgeGraph& graph,
+    const pxr::GfVec3f* positions,
+    uint32_t source,
+    uint32_t target,
+    float& distance)
+{
+    const NeighborLists& neighbors = graph.neighbors();
+    forward_.reset(graph.vertex_count());
+    backward_.reset(graph.vertex_count());
+    forward_.relax(source, 0.0f, 0.0f, source);
+    backward_.relax(target, 0.0f, 0.0f, target);
+
+    float best = infinity;
+    while (!forward_.heap.empty() && !backward_.heap.empty()) {
+        // No path through an unsettled vertex can beat `best` any more.
+        if (forward_.heap.front().first + backward_.heap.front().first >=
+            best) {
+            break;
+        }
+        const bool is_forward =
+            forward_.heap.front().first <= backward_.heap.front().first;
+        Frontier& side = is_forward ? forward_ : backward_;
+        const Frontier& other = is_forward ? backward_ : forward_;
+
+        const uint32_t u = side.pop();
+        ++settled_;
+        const float g_u = side.g(u);
+        for (const uint32_t* w = neighbors.begin(u); w != neighbors.end(u);
+             ++w) {
+            const float g_w =
+                g_u + distance_between(positions[u], positions[*w]);
+            if (!side.settled(*w) &&
+                (!side.reached(*w) || g_w < side.g(*w))) {
+                side.relax(*w, g_w, g_w, u);
+            }
+            if (other.reached(*w) && g_w + other.g(*w) < best) {
+                best = g_w + other.g(*w);
+                meet_from_ = is_forward ? u : *w;
+                meet_to_ = is_forward ? *w : u;
+            }
+        }
+    }
+    if (best == infinity) {
+        return false;
+    }
+    distance = best;
+    return true;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
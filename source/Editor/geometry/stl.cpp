@@ -0,0 +1,422 @@
+#include "GCore/IO/stl.h"
+
+#include <pxr/base/work/loops.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/binary_stream.h"
+#include "GCore/IO/mapped_file.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+constexpr size_t header_size = 84;
+constexpr size_t record_size = 50;
+
+[[noreturn]] void fail(const std::string& message)
+{
+    throw std::runtime_error("STL: " + message);
+}
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Whitespace separated tokens of an ASCII STL file.
+class Tokens {
+   public:
+    Tokens(const char* begin, const char* end) : p_(begin), end_(end)
+    {
+    }
+
+    std::string_view next()
+    {
+        while (p_ < end_ && is_space(*p_)) {
+            ++p_;
+        }
+        const char* begin = p_;
+        while (p_ < end_ && !is_space(*p_)) {
+            ++p_;
+        }
+        return std::string_view(begin, p_ - begin);
+    }
+
+    float number()
+    {
+        const std::string_view token = next();
+        float value = 0;
+#if defined(__cpp_lib_to_chars) || defined(_MSC_VER)
+        const char* begin = token.data();
+        if (!token.empty() && token[0] == '+') {
+            ++begin;
+        }
+        const auto [ptr, ec] =
+            std::from_chars(begin, token.data() + token.size(), value);
+        if (ec != std::errc() || ptr != token.data() + token.size()) {
+            fail("bad number '" + std::string(token) + "'");
+        }
+#else
+        const std::string text(token);
+        char* ptr = nullptr;
+        value = std::strtof(text.c_str(), &ptr);
+        if (text.empty() || *ptr != '\0') {
+            fail("bad number '" + text + "'");
+        }
+#endif
+        return value;
+    }
+
+    void expect(std::string_view keyword)
+    {
+        const std::string_view token = next();
+        if (token != keyword) {
+            fail(
+                "expected '" + std::string(keyword) + "', found '" +
+                std::string(token) + "'");
+        }
+    }
+
+   private:
+    const char* p_;
+    const char* end_;
+};
+
+StlData parse_ascii(const char* data, size_t size)
+{
+    std::vector<pxr::GfVec3f> corners;
+    std::vector<pxr::GfVec3f> normals;
+    Tokens tokens(data, data + size);
+    tokens.expect("solid");
+    // The solid name runs to the end of the line and may be empty.
+    const char* newline =
+        static_cast<const char*>(std::memchr(data, '\n', size));
+    tokens = Tokens(newline ? newline + 1 : data + size, data + size);
+    while (true) {
+        const std::string_view token = tokens.next();
+        if (token == "endsolid" || token.empty()) {
+            break;
+        }
+        if (token != "facet") {
+            fail("expected 'facet', found '" + std::string(token) + "'");
+        }
+        tokens.expect("normal");
+        pxr::GfVec3f normal;
+        for (int k = 0; k < 3; ++k) {
+            normal[k] = tokens.number();
+        }
+        normals.push_back(normal);
+        tokens.expect("outer");
+        tokens.expect("loop");
+        for (int c = 0; c < 3; ++c) {
+            tokens.expect("vertex");
+            pxr::GfVec3f p;
+            for (int k = 0; k < 3; ++k) {
+                p[k] = tokens.number();
+            }
+            corners.push_back(p);
+        }
+        tokens.expect("endloop");
+        tokens.expect("endfacet");
+    }
+    StlData result;
+    result.corners.assign(corners.begin(), corners.end());
+    result.facet_normals.assign(normals.begin(), normals.end());
+    return result;
+}
+
+// Binary records are 12 little endian floats (normal and three corners) and
+// a 16 bit attribute, at fixed offsets from the header.
+StlData parse_binary(const char* data, size_t triangle_count)
+{
+    StlData result;
+    result.corners.resize(3 * triangle_count);
+    result.facet_normals.resize(triangle_count);
+    pxr::GfVec3f* corners = result.corners.data();
+    pxr::GfVec3f* normals = result.facet_normals.data();
+    pxr::WorkParallelForN(triangle_count, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            const char* record = data + header_size + t * record_size;
+            float values[12];
+            for (int k = 0; k < 12; ++k) {
+                values[k] = load_unaligned<float>(record + 4 * k);
+            }
+            normals[t] = pxr::GfVec3f(values[0], values[1], values[2]);
+            for (int c = 0; c < 3; ++c) {
+                corners[3 * t + c] = pxr::GfVec3f(
+                    values[3 + 3 * c], values[4 + 3 * c], values[5 + 3 * c]);
+            }
+        }
+    });
+    return result;
+}
+
+// Position key of a corner: the bit pattern of each coordinate for exact
+// welding, the grid cell otherwise.
+struct WeldKey {
+    int32_t cell[3];
+
+    bool operator==(const WeldKey& other) const
+    {
+        return cell[0] == other.cell[0] && cell[1] == other.cell[1] &&
+               cell[2] == other.cell[2];
+    }
+
+    uint64_t hash() const
+    {
+        uint64_t h = uint64_t(uint32_t(cell[0])) * 0x9e3779b97f4a7c15ull;
+        h ^= uint64_t(uint32_t(cell[1])) * 0xc2b2ae3d27d4eb4full;
+        h ^= uint64_t(uint32_t(cell[2])) * 0x165667b19e3779f9ull;
+        // Final avalanche so that both the low bits (table slot) and the high
+        // bits (partition) are well mixed.
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+struct WeldEntry {
+    WeldKey key;
+    uint32_t corner;
+};
+
+WeldKey weld_key(const pxr::GfVec3f& p, float tolerance)
+{
+    WeldKey key;
+    for (int k = 0; k < 3; ++k) {
+        if (tolerance > 0) {
+            const double cell = std::floor(double(p[k]) / tolerance);
+            if (!(std::abs(cell) < double(INT32_MAX))) {
+                throw std::invalid_argument(
+                    "weld_vertices: tolerance too small for the coordinates");
+            }
+            key.cell[k] = int32_t(cell);
+        }
+        else {
+            // Adding zero turns -0 into +0.
+            const float value = p[k] + 0.0f;
+            std::memcpy(&key.cell[k], &value, sizeof(float));
+        }
+    }
+    return key;
+}
+
+// Corners are distributed over this many partitions by the top bits of their
+// hash. Equal keys always share a partition, so the partitions are welded
+// independently.
+constexpr int partition_bits = 8;
+constexpr size_t partition_count = size_t(1) << partition_bits;
+
+size_t partition_of(uint64_t hash)
+{
+    return size_t(hash >> (64 - partition_bits));
+}
+
+}  // namespace
+
+StlData parse_stl(const char* data, size_t size)
+{
+    if (size >= header_size) {
+        const uint32_t count = load_unaligned<uint32_t>(data + 80);
+        // ASCII files start with "solid", but so do the headers of some
+        // binary writers, so the size decides.
+        if (header_size + size_t(count) * record_size == size) {
+            return parse_binary(data, count);
+        }
+    }
+    if (size >= 5 && std::string_view(data, 5) == "solid") {
+        return parse_ascii(data, size);
+    }
+    if (size >= header_size) {
+        const uint32_t count = load_unaligned<uint32_t>(data + 80);
+        // Tolerate trailing bytes after the last record.
+        if (header_size + size_t(count) * record_size <= size) {
+            return parse_binary(data, count);
+        }
+    }
+    fail("truncated or unrecognized file");
+}
+
+StlData read_stl(const std::filesystem::path& path)
+{
+    const MappedFile file(path);
+    return parse_stl(file.data(), file.size());
+}
+
+WeldResult weld_vertices(
+    const pxr::VtArray<pxr::GfVec3f>& corners,
+    float tolerance)
+{
+    const size_t n = corners.size();
+    if (n > size_t(INT32_MAX)) {
+        throw std::length_error("weld_vertices: too many corners");
+    }
+    const pxr::GfVec3f* points = corners.cdata();
+
+    // Stable parallel scatter of the keys into their partitions, in the
+    // manner of one radix sort pass: per block histograms, an exclusive scan
+    // in partition major order, then every block writes its own range.
+    const size_t block_size = 1 << 16;
+    const size_t block_count =
+        std::max<size_t>(1, (n + block_size - 1) / block_size);
+    std::vector<WeldKey> keys(n);
+    std::vector<uint32_t> histogram(block_count * partition_count, 0);
+    pxr::WorkParallelForN(
+        block_count,
+        [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                uint32_t* counts = histogram.data() + b * partition_count;
+                const size_t last = std::min(n, (b + 1) * block_size);
+                for (size_t i = b * block_size; i < last; ++i) {
+                    keys[i] = weld_key(points[i], tolerance);
+                    ++counts[partition_of(keys[i].hash())];
+                }
+            }
+        },
+        1);
+    std::vector<size_t> partition_begin(partition_count + 1, 0);
+    std::vector<size_t> block_offset(block_count * partition_count);
+    size_t offset = 0;
+    for (size_t p = 0; p < partition_count; ++p) {
+        partition_begin[p] = offset;
+        for (size_t b = 0; b < block_count; ++b) {
+            block_offset[b * partition_count + p] = offset;
+            offset += histogram[b * partition_count + p];
+        }
+    }
+    partition_begin[partition_count] = offset;
+    std::vector<WeldEntry> entries(n);
+    pxr::WorkParallelForN(
+        block_count,
+        [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t* next = block_offset.data() + b * partition_count;
+                const size_t last = std::min(n, (b + 1) * block_size);
+                for (size_t i = b * block_size; i < last; ++i) {
+                    const size_t p = partition_of(keys[i].hash());
+                    entries[next[p]++] = { keys[i], uint32_t(i) };
+                }
+            }
+        },
+        1);
+
+    // Every partition lists its corners in increasing order, so the first
+    // corner inserted for a key is the one with the lowest index and
+    // represents all corners with that key. The table holds positions within
+    // the partition, which keeps the probes in cache.
+    std::vector<uint32_t> representative(n);
+    pxr::WorkParallelForN(
+        partition_count,
+        [&](size_t begin, size_t end) {
+            std::vector<uint32_t> table;
+            for (size_t p = begin; p < end; ++p) {
+                const WeldEntry* part = entries.data() + partition_begin[p];
+                const size_t count =
+                    partition_begin[p + 1] - partition_begin[p];
+                size_t capacity = 16;
+                while (capacity < 2 * count) {
+                    capacity *= 2;
+                }
+                table.assign(capacity, UINT32_MAX);
+                for (size_t k = 0; k < count; ++k) {
+                    const WeldEntry& entry = part[k];
+                    size_t slot = entry.key.hash() & (capacity - 1);
+                    while (table[slot] != UINT32_MAX &&
+                           !(part[table[slot]].key == entry.key)) {
+                        slot = (slot + 1) & (capacity - 1);
+                    }
+                    if (table[slot] == UINT32_MAX) {
+                        table[slot] = uint32_t(k);
+                    }
+                    representative[entry.corner] = part[table[slot]].corner;
+                }
+            }
+        },
+        1);
+
+    std::vector<int> vertex_of(n, -1);
+    WeldResult result;
+    int vertex_count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (representative[i] == i) {
+            vertex_of[i] = vertex_count++;
+        }
+    }
+    result.vertices.resize(vertex_count);
+    result.indices.resize(n);
+    pxr::GfVec3f* vertices = result.vertices.data();
+    int* indices = result.indices.data();
+    pxr::WorkParallelForN(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            indices[i] = vertex_of[representative[i]];
+            if (representative[i] == i) {
+                vertices[vertex_of[i]] = points[i];
+            }
+        }
+    });
+    return result;
+}
+
+Geometry stl_to_geometry(const StlData& data, float tolerance)
+{
+    WeldResult welded = weld_vertices(data.corners, tolerance);
+    Geometry geometry;
+    auto mesh = std::make_shared<MeshComponent>(&geometry);
+    geometry.attach_component(mesh);
+    mesh->set_vertices(welded.vertices);
+    mesh->set_face_vertex_counts(
+        pxr::VtArray<int>(data.corners.size() / 3, 3));
+    mesh->set_face_vertex_indices(welded.indices);
+    return geometry;
+}
+
+void write_stl(const std::filesystem::path& path, const MeshComponent& mesh)
+{
+    const auto vertices = mesh.get_vertices();
+    const auto counts = mesh.get_face_vertex_counts();
+    const auto indices = mesh.get_face_vertex_indices();
+    size_t triangle_count = 0;
+    for (int count : counts) {
+        triangle_count += count >= 3 ? size_t(count - 2) : 0;
+    }
+    if (triangle_count > UINT32_MAX) {
+        throw std::length_error("write_stl: too many triangles");
+    }
+
+    BinaryWriter out(path);
+    char header[80] = "binary STL";
+    out.write_bytes(header, sizeof(header));
+    out.write(uint32_t(triangle_count));
+    size_t corner = 0;
+    for (int count : counts) {
+        for (int k = 1; k + 1 < count; ++k) {
+            const pxr::GfVec3f& a = vertices[indices[corner]];
+            const pxr::GfVec3f& b = vertices[indices[corner + k]];
+            const pxr::GfVec3f& c = vertices[indices[corner + k + 1]];
+            pxr::GfVec3f normal = pxr::GfCross(b - a, c - a);
+            const float length = normal.GetLength();
+            normal = length > 0 ? normal / length : pxr::GfVec3f(0);
+            for (const pxr::GfVec3f& v : { normal, a, b, c }) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    out.write(v[axis]);
+                }
+            }
+            out.write(uint16_t(0));
+        }
+        corner += count;
+    }
+    out.finish();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
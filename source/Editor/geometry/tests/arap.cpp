@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "GCore/Algorithms/arap.h"
+#include "GCore/Algorithms/tutte.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// n x n grid on [0, 1]^2 with a bump in z.
+TestMesh bumpy_grid(int n)
+{
+    return with_height(triangle_grid(n), [](float x, float y) {
+        return 0.2f * std::sin(3.0f * x + 2.0f * y);
+    });
+}
+
+// The grid rolled onto a cylinder of radius 1/2: curved, but isometric to
+// the plane.
+TestMesh cylinder_grid(int n)
+{
+    TestMesh grid = bumpy_grid(n);
+    for (auto& p : grid.vertices) {
+        const float x = p[0];
+        p = pxr::GfVec3f(
+            0.5f * std::sin(2.0f * x), p[1], 0.5f - 0.5f * std::cos(2.0f * x));
+    }
+    return grid;
+}
+}  // namespace
+
+TEST(ArapDeformation, RigidMotion)
+{
+    const int n = 15;
+    const TestMesh grid = bumpy_grid(n);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    // Two opposite sides of the grid.
+    std::vector<uint32_t> controls;
+    for (int j = 0; j < n; ++j) {
+        controls.push_back(j);
+        controls.push_back((n - 1) * n + j);
+    }
+    const ArapDeformation arap(adjacency, grid.vertices, controls);
+
+    auto check = [&](const Eigen::Matrix3d& rotation, int iterations) {
+        auto rigid = [&](const pxr::GfVec3f& p) {
+            const Eigen::Vector3d q =
+                rotation * Eigen::Vector3d(p[0], p[1], p[2]) +
+                Eigen::Vector3d(0.5, -1.0, 2.0);
+            return pxr::GfVec3f(q[0], q[1], q[2]);
+        };
+        std::vector<pxr::GfVec3f> targets;
+        for (uint32_t c : controls) {
+            targets.push_back(rigid(grid.vertices[c]));
+        }
+        ArapState state;
+        arap.deform(targets, state, iterations);
+        float error = 0.0f;
+        for (size_t v = 0; v < grid.vertices.size(); ++v) {
+            const pxr::GfVec3f offset =
+                state.positions[v] - rigid(grid.vertices[v]);
+            error = std::max(error, offset.GetLength());
+        }
+        return error;
+    };
+    // A translation is reached by the first global step.
+    EXPECT_LT(check(Eigen::Matrix3d::Identity(), 1), 1e-5f);
+    // Rotations need the local steps.
+    const Eigen::Matrix3d rotation =
+        Eigen::AngleAxisd(0.3, Eigen::Vector3d(1, 2, 3).normalized())
+            .toRotationMatrix();
+    EXPECT_GT(check(rotation, 1), 1e-2f);
+    EXPECT_LT(check(rotation, 300), 1e-3f);
+}
+
+TEST(ArapDeformation, ErrorsAndUpdate)
+{
+    const TestMesh grid = bumpy_grid(6);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    EXPECT_THROW(
+        ArapDeformation(adjacency, grid.vertices, {}), std::invalid_argument);
+    EXPECT_THROW(
+        ArapDeformation(adjacency, grid.vertices, { 36 }),
+        std::invalid_argument);
+    EXPECT_THROW(
+        ArapDeformation(adjacency, grid.vertices, { 3, 3 }),
+        std::invalid_argument);
+    ArapState state;
+    EXPECT_THROW(
+        ArapDeformation(adjacency, grid.vertices, { 3 }).deform({}, state),
+        std::invalid_argument);
+
+    Geometry geometry;
+    MeshComponent mesh(&geometry);
+    mesh.set_vertices(grid.vertices);
+    mesh.set_face_vertex_counts(grid.counts);
+    mesh.set_face_vertex_indices(grid.indices);
+    auto first = ArapDeformation::update(nullptr, mesh, { 0, 5 });
+    EXPECT_EQ(ArapDeformation::update(first, mesh, { 0, 5 }), first);
+    EXPECT_NE(ArapDeformation::update(first, mesh, { 0, 6 }), first);
+    auto moved = grid.vertices;
+    moved[7][2] = 0.1f;
+    mesh.set_vertices(moved);
+    EXPECT_NE(ArapDeformation::update(first, mesh, { 0, 5 }), first);
+}
+
+TEST(ArapDeformation, DISABLED_Benchmark)
+{
+    const int n = 317;
+    const TestMesh grid = bumpy_grid(n);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    std::vector<uint32_t> controls;
+    for (int j = 0; j < n; ++j) {
+        controls.push_back(j);
+        controls.push_back((n - 1) * n + j);
+    }
+    std::unique_ptr<ArapDeformation> arap;
+    const double setup_ms = time_ms([&] {
+        arap = std::make_unique<ArapDeformation>(
+            adjacency, grid.vertices, controls);
+    });
+
+    // A drag: the far side lifts a little further every frame.
+    std::vector<pxr::GfVec3f> targets(controls.size());
+    ArapState state;
+    const int frames = 10;
+    const double drag_ms = time_ms([&] {
+        for (int frame = 1; frame <= frames; ++frame) {
+            for (size_t k = 0; k < controls.size(); ++k) {
+                targets[k] = grid.vertices[controls[k]];
+                if (k % 2) {
+                    targets[k][2] += 0.03f * frame;
+                }
+            }
+            arap->deform(targets, state, 1);
+        }
+    });
+    std::cout << "arap " << grid.vertices.size() / 1e6
+              << "M vertices: factorization " << setup_ms << " ms, "
+              << drag_ms / frames << " ms per iteration"
+              << std::endl;
+}
+
+TEST(ArapParameterization, DevelopableSurface)
+{
+    const TestMesh grid = cylinder_grid(20);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    const TutteEmbedding tutte(adjacency, grid.vertices, {});
+    pxr::VtArray<pxr::GfVec2f> uv;
+    for (const auto& p : tutte.embed(grid.vertices)) {
+        uv.push_back(pxr::GfVec2f(p[0], p[1]));
+    }
+
+    const ArapParameterization arap(adjacency, grid.vertices);
+    EXPECT_EQ(arap.pinned().size(), 1u);
+    ArapParameterizationOptions options;
+    options.max_iterations = 1000;
+    options.tolerance = 1e-8;
+    const std::vector<double> energies = arap.solve(uv, options);
+    ASSERT_FALSE(energies.empty());
+    EXPECT_LT(energies.size(), 1000u);
+    // Down to the rounding of the float UVs.
+    for (size_t i = 1; i < energies.size(); ++i) {
+        EXPECT_LE(energies[i], energies[i - 1] + 1e-10);
+    }
+    EXPECT_LT(energies.back(), 1e-6);
+
+    // Unrolled without stretching every edge keeps its length.
+    double error = 0.0;
+    for (size_t k = 0; k < grid.indices.size(); k += 3) {
+        for (int i = 0; i < 3; ++i) {
+            const int a = grid.indices[k + i];
+            const int b = grid.indices[k + (i + 1) % 3];
+            const double length =
+                (grid.vertices[a] - grid.vertices[b]).GetLength();
+            error = std::max(
+                error,
+                std::abs((uv[a] - uv[b]).GetLength() - length) / length);
+        }
+    }
+    EXPECT_LT(error, 1e-3);
+}
+
+TEST(ArapParameterization, SimilarityFit)
+{
+    TestMesh grid = bumpy_grid(12);
+    pxr::VtArray<pxr::GfVec2f> uv;
+    for (auto& p : grid.vertices) {
+        p[2] = 0.0f;
+        uv.push_back(pxr::GfVec2f(2.0f * p[0], p[1]));
+    }
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    const ArapParameterization asap(
+        adjacency, grid.vertices, ArapFit::similarity);
+    ASSERT_EQ(asap.pinned().size(), 2u);
+    ArapParameterizationOptions options;
+    options.max_iterations = 1000;
+    options.tolerance = 1e-10;
+    const std::vector<double> energies = asap.solve(uv, options);
+    ASSERT_FALSE(energies.empty());
+    EXPECT_LT(energies.back(), 1e-8);
+
+    // The pinned corners (0, 0) and (1, 1) stay at (0, 0) and (2, 1), so
+    // the plane is mapped by z -> (3 - i) / 2 z.
+    double error = 0.0;
+    for (size_t v = 0; v < grid.vertices.size(); ++v) {
+        const double x = grid.vertices[v][0], y = grid.vertices[v][1];
+        const pxr::GfVec2f expected(0.5 * (3 * x + y), 0.5 * (3 * y - x));
+        error = std::max(error, double((uv[v] - expected).GetLength()));
+    }
+    EXPECT_LT(error, 1e-3);
+}
+
+TEST(ArapParameterization, ErrorsAndUpdate)
+{
+    const TestMesh grid = bumpy_grid(6);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    pxr::VtArray<pxr::GfVec2f> uv(5);
+    EXPECT_THROW(
+        ArapParameterization(adjacency, grid.vertices).solve(uv),
+        std::invalid_argument);
+    pxr::VtArray<int> quad_counts = { 4 }, quad_indices = { 0, 1, 7, 6 };
+    EXPECT_THROW(
+        ArapParameterization(
+            std::make_shared<MeshAdjacency>(quad_counts, quad_indices, 36),
+            grid.vertices),
+        std::invalid_argument);
+
+    Geometry geometry;
+    MeshComponent mesh(&geometry);
+    mesh.set_vertices(grid.vertices);
+    mesh.set_face_vertex_counts(grid.counts);
+    mesh.set_face_vertex_indices(grid.indices);
+    auto first = ArapParameterization::update(nullptr, mesh, ArapFit::rigid);
+    EXPECT_EQ(ArapParameterization::update(first, mesh, ArapFit::rigid), first);
+    EXPECT_NE(
+        ArapParameterization::update(first, mesh, ArapFit::similarity), first);
+    auto moved = grid.vertices;
+    moved[7][2] = 0.1f;
+    mesh.set_vertices(moved);
+    EXPECT_NE(ArapParameterization::update(first, mesh, ArapFit::rigid), first);
+}
+
+TEST(ArapParameterization, DISABLED_Benchmark)
+{
+    const TestMesh grid = cylinder_grid(317);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    pxr::VtArray<pxr::GfVec2f> uv;
+    const double tutte_ms = time_ms([&] {
+        const TutteEmbedding tutte(adjacency, grid.vertices, {});
+        for (const auto& p : tutte.embed(grid.vertices)) {
+            uv.push_back(pxr::GfVec2f(p[0], p[1]));
+        }
+    });
+    std::unique_ptr<ArapParameterization> arap;
+    const double setup_ms = time_ms([&] {
+        arap = std::make_unique<ArapParameterization>(
+            adjacency, grid.vertices);
+    });
+    ArapParameterizationOptions options;
+    options.tolerance = 1e-4;
+    std::vector<double> energies;
+    const double solve_ms =
+        time_ms([&] { energies = arap->solve(uv, options); });
+    std::cout << "arap parameterization " << grid.vertices.size() / 1e6
+              << "M vertices: tutte " << tutte_ms << " ms, setup "
+              << setup_ms << " ms, " << energies.size() << " iterations, "
+              << solve_ms / energies.size() << " ms per iteration, energy "
+              << energies.front() << " -> " << energies.back() << std::endl;
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "GCore/Algorithms/bilateral_filter.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// Triangulated n x n grid on [0, 1]^2. Interior vertices get noise along z,
+// scaled by `noise` times the grid spacing.
+TestMesh noisy_grid(int n, float noise, unsigned seed = 3)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, noise / (n - 1));
+    return with_height(
+        triangle_grid(n, 1.0f, Diagonals::uniform), [&](float x, float y) {
+            const bool border = x == 0 || y == 0 || x == 1 || y == 1;
+            return border ? 0.0f : dist(rng);
+        });
+}
+
+double rms_height(const pxr::VtArray<pxr::GfVec3f>& vertices)
+{
+    double sum = 0.0;
+    for (const auto& v : vertices) {
+        sum += double(v[2]) * v[2];
+    }
+    return std::sqrt(sum / vertices.size());
+}
+}  // namespace
+
+TEST(BilateralFilter, FlattensNoisyPlane)
+{
+    const int n = 40;
+    const TestMesh grid = noisy_grid(n, 0.2f);
+    const MeshAdjacency adjacency(grid.counts, grid.indices, n * n);
+
+    for (auto neighborhood :
+         { FaceNeighborhood::edge, FaceNeighborhood::vertex }) {
+        BilateralFilterSettings settings;
+        settings.neighborhood = neighborhood;
+        settings.sigma_s = 0.35f;
+        settings.normal_iterations = 10;
+        settings.vertex_iterations = 20;
+
+        const auto normals =
+            filter_face_normals(adjacency, grid.vertices, settings);
+        double mean_z = 0.0;
+        for (const auto& normal : normals) {
+            EXPECT_NEAR(normal.GetLength(), 1.0f, 1e-4f);
+            mean_z += std::abs(normal[2]);
+        }
+        EXPECT_GT(mean_z / normals.size(), 0.99);
+
+        const auto smoothed =
+            bilateral_normal_filter(adjacency, grid.vertices, settings);
+        ASSERT_EQ(smoothed.size(), grid.vertices.size());
+        EXPECT_LT(rms_height(smoothed), 0.25 * rms_height(grid.vertices));
+        // Boundary vertices are fixed.
+        EXPECT_EQ(smoothed[0], grid.vertices[0]);
+        EXPECT_EQ(smoothed[n - 1], grid.vertices[n - 1]);
+    }
+}
+
+TEST(BilateralFilter, KeepsSharpEdge)
+{
+    // A folded strip: two planes meeting at a right angle along x = 0.5.
+    const int n = 21;
+    TestMesh grid = noisy_grid(n, 0.0f);
+    for (auto& v : grid.vertices) {
+        if (v[0] > 0.5f) {
+            v = pxr::GfVec3f(0.5f, v[1], v[0] - 0.5f);
+        }
+    }
+    const MeshAdjacency adjacency(grid.counts, grid.indices, n * n);
+    BilateralFilterSettings settings;
+    settings.sigma_s = 0.2f;
+    settings.normal_iterations = 20;
+    const auto normals = filter_face_normals(adjacency, grid.vertices, settings);
+    // Faces next to the fold keep their own plane's normal.
+    size_t flat = 0, vertical = 0;
+    for (const auto& normal : normals) {
+        flat += std::abs(normal[2]) > 0.99f;
+        vertical += std::abs(normal[0]) > 0.99f;
+    }
+    EXPECT_EQ(flat + vertical, normals.size());
+}
+
+TEST(BilateralFilter, Errors)
+{
+    const TestMesh grid = noisy_grid(3, 0.0f);
+    const MeshAdjacency adjacency(grid.counts, grid.indices, 9);
+    BilateralFilterSettings settings;
+    settings.sigma_s = 0.0f;
+    EXPECT_THROW(
+        filter_face_normals(adjacency, grid.vertices, settings),
+        std::invalid_argument);
+    settings.sigma_s = 0.1f;
+    settings.multiple_sigma_c = -1.0f;
+    EXPECT_THROW(
+        bilateral_normal_filter(adjacency, grid.vertices, settings),
+        std::invalid_argument);
+}
+
+TEST(BilateralFilter, DISABLED_Benchmark)
+{
+    const int n = 1001;
+    const TestMesh grid = noisy_grid(n, 0.2f);
+    std::unique_ptr<MeshAdjacency> adjacency;
+    const double build_ms = time_ms([&] {
+        adjacency = std::make_unique<MeshAdjacency>(
+            grid.counts, grid.indices, grid.vertices.size());
+    });
+    const double faces = grid.counts.size();
+
+    for (auto neighborhood :
+         { FaceNeighborhood::edge, FaceNeighborhood::vertex }) {
+        // Build the vertex lists outside the timed section.
+        (void)adjacency->face_neighbors(neighborhood);
+        BilateralFilterSettings settings;
+        settings.neighborhood = neighborhood;
+        settings.normal_iterations = 0;
+        const double setup_ms = time_ms([&] {
+            filter_face_normals(*adjacency, grid.vertices, settings);
+        });
+        settings.normal_iterations = 10;
+        const double total_ms = time_ms([&] {
+            filter_face_normals(*adjacency, grid.vertices, settings);
+        });
+        const double per_iteration = (total_ms - setup_ms) / 10.0;
+        std::cout << "bilateral filter "
+                  << (neighborhood == FaceNeighborhood::edge ? "edge"
+                                                             : "vertex")
+                  << " " << faces / 1e6 << "M faces: adjacency " << build_ms
+                  << " ms, normal iteration " << per_iteration << " ms ("
+                  << faces / per_iteration / 1e3 << "M faces/s)" << std::endl;
+    }
+
+    pxr::VtArray<pxr::GfVec3f> normals(grid.counts.size());
+    const double vertex_ms = time_ms([&] {
+        fit_vertices_to_normals(*adjacency, grid.vertices, normals, 10, true);
+    });
+    std::cout << "bilateral filter vertex iteration " << vertex_ms / 10.0
+              << " ms" << std::endl;
+}
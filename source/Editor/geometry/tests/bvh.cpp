@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <random>
+
+#include "GCore/Algorithms/bvh.h"
+#include "GCore/IO/obj.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// Random triangle soup with some quads mixed in to cover fan triangulation.
+TestMesh random_mesh(size_t face_count, unsigned seed = 3)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+    TestMesh mesh;
+    for (size_t f = 0; f < face_count; ++f) {
+        const int n = f % 5 == 0 ? 4 : 3;
+        const pxr::GfVec3f center(position(rng), position(rng), position(rng));
+        mesh.counts.push_back(n);
+        for (int k = 0; k < n; ++k) {
+            mesh.indices.push_back(int(mesh.vertices.size()));
+            mesh.vertices.push_back(
+                center + pxr::GfVec3f(offset(rng), offset(rng), offset(rng)));
+        }
+    }
+    return mesh;
+}
+
+struct BruteForce {
+    std::vector<pxr::GfVec3f> a, b, c;
+
+    BruteForce(
+        const MeshBVH& bvh,
+        const pxr::VtArray<pxr::GfVec3f>& vertices)
+    {
+        for (uint32_t t = 0; t < bvh.triangle_count(); ++t) {
+            a.push_back(vertices[bvh.triangle(t)[0]]);
+            b.push_back(vertices[bvh.triangle(t)[1]]);
+            c.push_back(vertices[bvh.triangle(t)[2]]);
+        }
+    }
+
+    float ray(const pxr::GfVec3f& o, const pxr::GfVec3f& d) const
+    {
+        float best = std::numeric_limits<float>::infinity();
+        for (size_t t = 0; t < a.size(); ++t) {
+            const pxr::GfVec3f e1 = b[t] - a[t], e2 = c[t] - a[t];
+            const pxr::GfVec3f p = pxr::GfCross(d, e2);
+            const float det = pxr::GfDot(e1, p);
+            if (det == 0.0f) {
+                continue;
+            }
+            const pxr::GfVec3f s = o - a[t];
+            const float u = pxr::GfDot(s, p) / det;
+            const pxr::GfVec3f q = pxr::GfCross(s, e1);
+            const float v = pxr::GfDot(d, q) / det;
+            const float dist = pxr::GfDot(e2, q) / det;
+            if (u >= 0 && v >= 0 && u + v <= 1 && dist >= 0 && dist < best) {
+                best = dist;
+            }
+        }
+        return best;
+    }
+
+    // Distance to the closest triangle, sampled densely enough to bound the
+    // exact value from above.
+    float closest(const pxr::GfVec3f& query) const
+    {
+        float best = std::numeric_limits<float>::infinity();
+        for (size_t t = 0; t < a.size(); ++t) {
+            const int steps = 24;
+            for (int i = 0; i <= steps; ++i) {
+                for (int j = 0; i + j <= steps; ++j) {
+                    const float u = float(i) / steps, v = float(j) / steps;
+                    const pxr::GfVec3f p =
+                        a[t] + (b[t] - a[t]) * u + (c[t] - a[t]) * v;
+                    best = std::min(best, (p - query).GetLength());
+                }
+            }
+        }
+        return best;
+    }
+};
+}  // namespace
+
+TEST(MeshBVH, FanTriangulation)
+{
+    TestMesh mesh = random_mesh(50);
+    MeshBVH bvh(mesh.vertices, mesh.counts, mesh.indices);
+    EXPECT_EQ(bvh.triangle_count(), 40 * 1 + 10 * 2);
+    EXPECT_EQ(bvh.face_of_triangle(0), 0);
+    EXPECT_EQ(bvh.face_of_triangle(1), 0);
+    EXPECT_EQ(bvh.face_of_triangle(2), 1);
+}
+
+TEST(MeshBVH, RayMatchesBruteForce)
+{
+    TestMesh mesh = random_mesh(3000);
+    MeshBVH bvh(mesh.vertices, mesh.counts, mesh.indices);
+    BruteForce brute(bvh, mesh.vertices);
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> dist(-6.0f, 6.0f);
+    int hits = 0;
+    for (int i = 0; i < 500; ++i) {
+        const pxr::GfVec3f origin(dist(rng), dist(rng), dist(rng));
+        const pxr::GfVec3f direction =
+            (pxr::GfVec3f(dist(rng), dist(rng), dist(rng)) - origin)
+                .GetNormalized();
+        const RayHit hit = bvh.intersect_ray(origin, direction);
+        const float expected = brute.ray(origin, direction);
+        if (std::isinf(expected)) {
+            EXPECT_FALSE(hit);
+            continue;
+        }
+        ASSERT_TRUE(hit);
+        EXPECT_NEAR(hit.distance, expected, 1e-4f);
+        ++hits;
+    }
+    EXPECT_GT(hits, 0);
+}
+
+TEST(MeshBVH, ClosestPointMatchesBruteForce)
+{
+    TestMesh mesh = random_mesh(300);
+    MeshBVH bvh(mesh.vertices, mesh.counts, mesh.indices);
+    BruteForce brute(bvh, mesh.vertices);
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> dist(-7.0f, 7.0f);
+    for (int i = 0; i < 100; ++i) {
+        const pxr::GfVec3f query(dist(rng), dist(rng), dist(rng));
+        const ClosestPoint closest = bvh.closest_point(query);
+        ASSERT_TRUE(closest);
+        const float distance = std::sqrt(closest.distance_squared);
+        const float sampled = brute.closest(query);
+        EXPECT_LE(distance, sampled + 1e-5f);
+        // The sampling grid is within 1/24 of a ~1 unit triangle.
+        EXPECT_GE(distance, sampled - 0.06f);
+        EXPECT_NEAR((closest.point - query).GetLength(), distance, 1e-4f);
+    }
+
+    const ClosestPoint none =
+        bvh.closest_point(pxr::GfVec3f(100.0f, 0.0f, 0.0f), 1.0f);
+    EXPECT_FALSE(none);
+}
+
+TEST(MeshBVH, RadiusAndBoxQueries)
+{
+    TestMesh mesh = random_mesh(2000);
+    MeshBVH bvh(mesh.vertices, mesh.counts, mesh.indices);
+
+    const pxr::GfVec3f center(0.5f, -1.0f, 0.25f);
+    const float radius = 1.5f;
+    std::vector<uint32_t> found;
+    bvh.query_radius(center, radius, found);
+    std::sort(found.begin(), found.end());
+    EXPECT_TRUE(std::adjacent_find(found.begin(), found.end()) == found.end());
+    for (uint32_t t = 0; t < bvh.triangle_count(); ++t) {
+        // A single triangle tree gives the exact distance to one triangle.
+        pxr::VtArray<pxr::GfVec3f> corners(3);
+        for (int c = 0; c < 3; ++c) {
+            corners[c] = mesh.vertices[bvh.triangle(t)[c]];
+        }
+        const MeshBVH single(
+            corners, pxr::VtArray<int>(1, 3), pxr::VtArray<int>{ 0, 1, 2 });
+        const float d2 = single.closest_point(center).distance_squared;
+        EXPECT_EQ(
+            std::binary_search(found.begin(), found.end(), t),
+            d2 <= radius * radius)
+            << "triangle " << t;
+    }
+
+    BoundingBox box;
+    box.extend(pxr::GfVec3f(-1.0f, -1.0f, -1.0f));
+    box.extend(pxr::GfVec3f(2.0f, 0.5f, 1.0f));
+    found.clear();
+    bvh.query_box(box, found);
+    std::sort(found.begin(), found.end());
+    for (uint32_t t = 0; t < bvh.triangle_count(); ++t) {
+        BoundingBox triangle_box;
+        for (int c = 0; c < 3; ++c) {
+            triangle_box.extend(mesh.vertices[bvh.triangle(t)[c]]);
+        }
+        EXPECT_EQ(
+            std::binary_search(found.begin(), found.end(), t),
+            triangle_box.overlaps(box));
+    }
+}
+
+TEST(MeshBVH, RefitMatchesRebuild)
+{
+    TestMesh mesh = random_mesh(2000);
+    MeshBVH bvh(mesh.vertices, mesh.counts, mesh.indices);
+
+    for (auto& p : mesh.vertices) {
+        p = pxr::GfVec3f(p[0] * 1.5f + 0.3f, p[2], -p[1]);
+    }
+    bvh.refit(mesh.vertices);
+    MeshBVH rebuilt(mesh.vertices, mesh.counts, mesh.indices);
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+    for (int i = 0; i < 300; ++i) {
+        const pxr::GfVec3f origin(dist(rng), dist(rng), dist(rng));
+        const pxr::GfVec3f direction = -origin.GetNormalized();
+        const RayHit a = bvh.intersect_ray(origin, direction);
+        const RayHit b = rebuilt.intersect_ray(origin, direction);
+        EXPECT_EQ(bool(a), bool(b));
+        if (a && b) {
+            EXPECT_NEAR(a.distance, b.distance, 1e-5f);
+        }
+        EXPECT_NEAR(
+            bvh.closest_point(origin).distance_squared,
+            rebuilt.closest_point(origin).distance_squared,
+            1e-4f);
+    }
+}
+
+TEST(MeshBVH, DISABLED_Benchmark)
+{
+    for (const char* asset :
+         { "assignment9/bunny.obj",
+           "assignment8/horse.obj",
+           "assignment10/woody.obj" }) {
+        const auto path = find_asset(asset);
+        if (path.empty()) {
+            std::cout << "skipping " << asset << ", asset not found"
+                      << std::endl;
+            continue;
+        }
+        const ObjData mesh = read_obj(path);
+
+        std::unique_ptr<MeshBVH> bvh;
+        const double build_ms = time_ms([&] {
+            bvh = std::make_unique<MeshBVH>(
+                mesh.vertices,
+                mesh.face_vertex_counts,
+                mesh.face_vertex_indices);
+        });
+        const double refit_ms = time_ms([&] { bvh->refit(mesh.vertices); });
+
+        const BoundingBox bounds = bvh->bounds();
+        const pxr::GfVec3f center = (bounds.min + bounds.max) * 0.5f;
+        const float extent = (bounds.max - bounds.min).GetLength();
+
+        const size_t query_count = 1 << 16;
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        std::vector<pxr::GfVec3f> origins(query_count);
+        std::vector<pxr::GfVec3f> directions(query_count);
+        for (size_t i = 0; i < query_count; ++i) {
+            origins[i] = center + pxr::GfVec3f(dist(rng), dist(rng), dist(rng))
+                                      .GetNormalized() *
+                                      extent;
+            directions[i] = (center - origins[i]).GetNormalized();
+        }
+
+        std::vector<RayHit> hits(query_count);
+        const double ray_ms = time_ms([&] {
+            bvh->intersect_rays(
+                origins.data(), directions.data(), query_count, hits.data());
+        });
+        std::vector<ClosestPoint> closest(query_count);
+        const double closest_ms = time_ms([&] {
+            bvh->closest_points(origins.data(), query_count, closest.data());
+        });
+
+        // Brute force on a small sample, scaled to the full query count.
+        BruteForce brute(*bvh, mesh.vertices);
+        const size_t sample = 64;
+        const double brute_ms = time_ms([&] {
+            for (size_t i = 0; i < sample; ++i) {
+                const float expected = brute.ray(origins[i], directions[i]);
+                if (std::isinf(expected)) {
+                    EXPECT_FALSE(hits[i]);
+                }
+                else {
+                    EXPECT_NEAR(hits[i].distance, expected, 1e-4f * extent);
+                }
+            }
+        }) * double(query_count) / sample;
+
+        std::cout << asset << ": " << bvh->triangle_count() << " triangles, "
+                  << bvh->nodes().size() << " nodes, build " << build_ms
+                  << " ms, refit " << refit_ms << " ms; " << query_count
+                  << " rays " << ray_ms << " ms (brute force ~" << brute_ms
+                  << " ms), closest points " << closest_ms << " ms"
+                  << std::endl;
+    }
+}
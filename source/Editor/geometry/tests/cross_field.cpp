@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <memory>
+
+#include "GCore/Algorithms/cross_field.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+constexpr float pi = 3.14159265358979f;
+
+// n x n vertices on [0, 1]^2 rotated by `angle` around z, as quads or as
+// triangles along alternating diagonals.
+TestMesh grid(int n, bool quads, float angle = 0.0f)
+{
+    TestMesh mesh = quads ? quad_grid(n) : triangle_grid(n);
+    const float c = std::cos(angle), s = std::sin(angle);
+    for (auto& p : mesh.vertices) {
+        p = pxr::GfVec3f(c * p[0] - s * p[1], s * p[0] + c * p[1], 0.0f);
+    }
+    return mesh;
+}
+
+CrossField solve(const TestMesh& mesh, const CrossFieldOptions& options = {})
+{
+    return CrossField(
+        std::make_shared<MeshAdjacency>(
+            mesh.counts, mesh.indices, mesh.vertices.size()),
+        mesh.vertices,
+        options);
+}
+
+// Unit tangent directions, each the previous one turned by 2 pi / N around
+// the normal.
+void expect_frames(const FaceFrames& frames, size_t faces)
+{
+    const int n = frames.symmetry;
+    ASSERT_EQ(frames.centroids.size(), faces);
+    ASSERT_EQ(frames.normals.size(), faces);
+    ASSERT_EQ(frames.directions.size(), faces * n);
+    for (size_t f = 0; f < faces; ++f) {
+        const pxr::GfVec3f& normal = frames.normals[f];
+        for (int k = 0; k < n; ++k) {
+            const pxr::GfVec3f& d = frames.directions[f * n + k];
+            const pxr::GfVec3f& next = frames.directions[f * n + (k + 1) % n];
+            EXPECT_NEAR(d.GetLength(), 1.0f, 1e-5f);
+            EXPECT_NEAR(pxr::GfDot(d, normal), 0.0f, 1e-5f);
+            EXPECT_NEAR(pxr::GfDot(d, next), std::cos(2 * pi / n), 1e-5f);
+            EXPECT_GT(pxr::GfDot(pxr::GfCross(d, next), normal), -1e-5f);
+        }
+    }
+}
+
+// The first direction of each face to the power N, as angles in the XY
+// plane.
+std::vector<std::complex<float>> planar_powers(const FaceFrames& frames)
+{
+    std::vector<std::complex<float>> powers;
+    for (size_t i = 0; i < frames.directions.size(); i += frames.symmetry) {
+        const pxr::GfVec3f& d = frames.directions[i];
+        powers.push_back(std::pow(
+            std::complex<float>(d[0], d[1]), float(frames.symmetry)));
+    }
+    return powers;
+}
+}  // namespace
+
+TEST(CrossField, BoundaryAlignedOnSquares)
+{
+    // Both triangles and quads, with the square turned by 30 degrees.
+    for (const bool quads : { false, true }) {
+        const float angle = pi / 6;
+        const TestMesh mesh = grid(16, quads, angle);
+        const CrossField field = solve(mesh);
+        expect_frames(field.frames(), mesh.counts.size());
+        EXPECT_EQ(field.iterations(), 0);
+        const std::complex<float> expected = std::polar(1.0f, 4 * angle);
+        for (const auto& power : planar_powers(field.frames())) {
+            EXPECT_NEAR(std::abs(power - expected), 0.0f, 1e-3f);
+        }
+    }
+}
+
+TEST(CrossField, SmoothestField)
+{
+    // Constant on a plane, whatever its direction.
+    const TestMesh square = grid(12, false);
+    CrossFieldOptions options;
+    options.solve = CrossFieldSolve::smoothest;
+    const CrossField flat = solve(square, options);
+    const auto powers = planar_powers(flat.frames());
+    EXPECT_GT(flat.iterations(), 0);
+    for (const auto& power : powers) {
+        EXPECT_NEAR(std::abs(power - powers.front()), 0.0f, 1e-3f);
+    }
+
+    // A sphere has no constant field; closed meshes fall back to the
+    // smoothest field also when boundary alignment is asked for.
+    const TestMesh ball = sphere(48, 24, 1.0f);
+    const CrossField round = solve(ball);
+    expect_frames(round.frames(), ball.counts.size());
+    EXPECT_GT(round.iterations(), 0);
+    EXPECT_LT(round.iterations(), options.max_iterations);
+
+    // Symmetries other than 4.
+    options.symmetry = 6;
+    expect_frames(solve(ball, options).frames(), ball.counts.size());
+}
+
+TEST(CrossField, UpdateAndErrors)
+{
+    const TestMesh mesh = grid(6, true);
+    Geometry geometry;
+    MeshComponent component(&geometry);
+    component.set_vertices(mesh.vertices);
+    component.set_face_vertex_counts(mesh.counts);
+    component.set_face_vertex_indices(mesh.indices);
+
+    auto first = CrossField::update(nullptr, component);
+    EXPECT_EQ(CrossField::update(first, component), first);
+    CrossFieldOptions options;
+    options.solve = CrossFieldSolve::smoothest;
+    EXPECT_NE(CrossField::update(first, component, options), first);
+
+    auto moved = mesh.vertices;
+    moved[7][2] = 0.1f;
+    component.set_vertices(moved);
+    EXPECT_NE(CrossField::update(first, component), first);
+
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    auto fewer = mesh.vertices;
+    fewer.resize(fewer.size() - 1);
+    EXPECT_THROW(CrossField(adjacency, fewer), std::invalid_argument);
+    options.symmetry = 0;
+    EXPECT_THROW(
+        CrossField(adjacency, mesh.vertices, options), std::invalid_argument);
+}
+
+TEST(CrossField, DISABLED_Benchmark)
+{
+    const TestMesh mesh = grid(317, false);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    for (const CrossFieldSolve mode :
+         { CrossFieldSolve::boundary_aligned, CrossFieldSolve::smoothest }) {
+        CrossFieldOptions options;
+        options.solve = mode;
+        std::unique_ptr<CrossField> field;
+        const double ms = time_ms([&] {
+            field = std::make_unique<CrossField>(
+                adjacency, mesh.vertices, options);
+        });
+        std::cout << "cross field, "
+                  << (mode == CrossFieldSolve::smoothest ? "smoothest"
+                                                          : "boundary aligned")
+                  << ": " << mesh.counts.size() << " faces, " << ms << " ms, "
+                  << field->iterations() << " iterations" << std::endl;
+    }
+}
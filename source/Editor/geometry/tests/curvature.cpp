@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+
+#include "GCore/Algorithms/curvature.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+constexpr float pi = 3.14159265358979f;
+
+// Open cylinder of radius r around z, `around` x `along` vertices, with
+// outward facing triangles.
+TestMesh cylinder(int around, int along, float r)
+{
+    TestMesh mesh;
+    for (int j = 0; j < along; ++j) {
+        for (int i = 0; i < around; ++i) {
+            const float phi = 2 * pi * i / around;
+            mesh.vertices.push_back(pxr::GfVec3f(
+                r * std::cos(phi), r * std::sin(phi), float(j) / around));
+        }
+    }
+    for (int j = 0; j + 1 < along; ++j) {
+        for (int i = 0; i < around; ++i) {
+            const int a = j * around + i;
+            const int b = j * around + (i + 1) % around;
+            mesh.triangle(a, b, b + around);
+            mesh.triangle(a, b + around, a + around);
+        }
+    }
+    return mesh;
+}
+}  // namespace
+
+TEST(Curvature, Sphere)
+{
+    const float r = 2.0f;
+    const TestMesh mesh = sphere(96, 48, r);
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    const MeshCurvature curvature = compute_curvature(adjacency, mesh.vertices);
+
+    ASSERT_EQ(curvature.mean.size(), mesh.vertices.size());
+    for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+        EXPECT_NEAR(curvature.mean[v], 1 / r, 0.02f) << v;
+        EXPECT_NEAR(curvature.gaussian[v], 1 / (r * r), 0.02f) << v;
+        EXPECT_GE(curvature.max[v], curvature.min[v]);
+        EXPECT_NEAR(curvature.max_direction[v].GetLength(), 1.0f, 1e-4f);
+    }
+}
+
+TEST(Curvature, Cylinder)
+{
+    const int around = 64;
+    const TestMesh mesh = cylinder(around, 40, 1.0f);
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    const MeshCurvature curvature = compute_curvature(adjacency, mesh.vertices);
+
+    for (size_t v = around; v + around < mesh.vertices.size(); ++v) {
+        EXPECT_NEAR(curvature.mean[v], 0.5f, 0.01f);
+        EXPECT_NEAR(curvature.gaussian[v], 0.0f, 0.01f);
+        EXPECT_NEAR(curvature.max[v], 1.0f, 0.02f);
+        EXPECT_NEAR(curvature.min[v], 0.0f, 0.02f);
+        // Straight along the axis, curved around it.
+        EXPECT_GT(std::abs(curvature.min_direction[v][2]), 0.99f);
+        EXPECT_LT(std::abs(curvature.max_direction[v][2]), 0.1f);
+    }
+    // Boundary vertices measure the angle deficit against pi.
+    EXPECT_NEAR(curvature.gaussian[0], 0.0f, 0.01f);
+}
+
+TEST(Curvature, FlippedOrientationAndErrors)
+{
+    TestMesh mesh = sphere(32, 16, 1.0f);
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+    }
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    const MeshCurvature curvature =
+        compute_curvature(adjacency, mesh.vertices, false);
+    EXPECT_LT(curvature.mean[20], 0.0f);
+    EXPECT_GT(curvature.gaussian[20], 0.0f);
+    EXPECT_TRUE(curvature.max_direction.empty());
+
+    pxr::VtArray<pxr::GfVec3f> fewer = mesh.vertices;
+    fewer.resize(fewer.size() - 1);
+    EXPECT_THROW(compute_curvature(adjacency, fewer), std::invalid_argument);
+
+    pxr::VtArray<int> counts = { 4 };
+    pxr::VtArray<int> indices = { 0, 1, 2, 3 };
+    const MeshAdjacency quad(counts, indices, 4);
+    pxr::VtArray<pxr::GfVec3f> corners(4, pxr::GfVec3f(0.0f));
+    EXPECT_THROW(compute_curvature(quad, corners), std::invalid_argument);
+}
+
+TEST(Curvature, DISABLED_Benchmark)
+{
+    const TestMesh mesh = cylinder(1000, 1000, 1.0f);
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    for (bool directions : { false, true }) {
+        MeshCurvature curvature;
+        const double ms = time_ms([&] {
+            curvature = compute_curvature(adjacency, mesh.vertices, directions);
+        });
+        std::cout << "curvature " << mesh.vertices.size() / 1e6
+                  << "M vertices" << (directions ? " with directions" : "")
+                  << ": " << ms << " ms ("
+                  << mesh.vertices.size() / ms / 1e3 << "M vertices/s)"
+                  << std::endl;
+        EXPECT_NEAR(curvature.mean[500500], 0.5f, 0.01f);
+    }
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "GCore/Components/CurveComponent.h"
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/Components/PointsComponent.h"
+#include "GCore/Components/XformComponent.h"
+#include "GCore/IO/geometry_cache.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+std::shared_ptr<MeshComponent> grid_mesh(Geometry& geometry, int n)
+{
+    auto mesh = std::make_shared<MeshComponent>(&geometry);
+    geometry.attach_component(mesh);
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<float> height;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            vertices.push_back(pxr::GfVec3f(i, j, (i * j) % 7));
+            height.push_back(float((i * j) % 7));
+        }
+    }
+    pxr::VtArray<int> counts, indices;
+    for (int i = 0; i + 1 < n; ++i) {
+        for (int j = 0; j + 1 < n; ++j) {
+            const int a = i * n + j;
+            counts.push_back(4);
+            for (int v : { a, a + 1, a + n + 1, a + n }) {
+                indices.push_back(v);
+            }
+        }
+    }
+    mesh->set_vertices(vertices);
+    mesh->set_face_vertex_counts(counts);
+    mesh->set_face_vertex_indices(indices);
+    mesh->add_vertex_scalar_quantity("height", height);
+    return mesh;
+}
+}  // namespace
+
+TEST(GeometryCache, RoundTrip)
+{
+    Geometry geometry;
+    auto mesh = grid_mesh(geometry, 5);
+    mesh->set_texcoords_array(
+        pxr::VtArray<pxr::GfVec2f>(25, pxr::GfVec2f(0.5f, 0.25f)));
+    mesh->add_face_vector_quantity(
+        "flow", pxr::VtArray<pxr::GfVec3f>(16, pxr::GfVec3f(1, 0, 0)));
+    mesh->add_vertex_parameterization_quantity(
+        "uv", pxr::VtArray<pxr::GfVec2f>(25, pxr::GfVec2f(1, 2)));
+
+    auto points = std::make_shared<PointsComponent>(&geometry);
+    geometry.attach_component(points);
+    points->set_vertices({ pxr::GfVec3f(1, 2, 3), pxr::GfVec3f(4, 5, 6) });
+    points->set_width({ 0.5f, 0.25f });
+
+    auto curve = std::make_shared<CurveComponent>(&geometry);
+    geometry.attach_component(curve);
+    curve->set_vertices({ pxr::GfVec3f(0, 0, 0), pxr::GfVec3f(0, 1, 0) });
+    curve->set_vert_count({ 2 });
+    curve->set_periodic(true);
+
+    auto xform = std::make_shared<XformComponent>(&geometry);
+    geometry.attach_component(xform);
+    xform->translation.push_back(pxr::GfVec3f(1, 0, 0));
+    xform->scale.push_back(pxr::GfVec3f(2, 2, 2));
+    xform->rotation.push_back(pxr::GfVec3f(0, 90, 0));
+
+    // Without arrays, still restored.
+    geometry.attach_component(std::make_shared<MeshComponent>(&geometry));
+
+    const auto path = temp_path("gcore_round_trip.gcache");
+    write_geometry_cache(geometry, path);
+    EXPECT_EQ(std::filesystem::file_size(path) % 64, 0u);
+    const Geometry loaded = read_geometry_cache(path);
+    std::filesystem::remove(path);
+
+    ASSERT_EQ(loaded.get_components().size(), 5u);
+    auto mesh2 = loaded.get_component<MeshComponent>();
+    ASSERT_TRUE(mesh2);
+    EXPECT_EQ(mesh2->get_vertices(), mesh->get_vertices());
+    EXPECT_EQ(mesh2->get_face_vertex_counts(), mesh->get_face_vertex_counts());
+    EXPECT_EQ(
+        mesh2->get_face_vertex_indices(), mesh->get_face_vertex_indices());
+    EXPECT_EQ(mesh2->get_texcoords_array(), mesh->get_texcoords_array());
+    EXPECT_TRUE(mesh2->get_normals().empty());
+    EXPECT_EQ(
+        mesh2->get_vertex_scalar_quantity("height"),
+        mesh->get_vertex_scalar_quantity("height"));
+    EXPECT_EQ(
+        mesh2->get_face_vector_quantity("flow"),
+        mesh->get_face_vector_quantity("flow"));
+    EXPECT_EQ(
+        mesh2->get_vertex_parameterization_quantity("uv"),
+        mesh->get_vertex_parameterization_quantity("uv"));
+
+    auto points2 = loaded.get_component<PointsComponent>();
+    ASSERT_TRUE(points2);
+    EXPECT_EQ(points2->get_vertices(), points->get_vertices());
+    EXPECT_EQ(points2->get_width(), points->get_width());
+
+    auto curve2 = loaded.get_component<CurveComponent>();
+    ASSERT_TRUE(curve2);
+    EXPECT_EQ(curve2->get_vertices(), curve->get_vertices());
+    EXPECT_EQ(curve2->get_vert_count(), curve->get_vert_count());
+    EXPECT_TRUE(curve2->get_periodic());
+
+    auto xform2 = loaded.get_component<XformComponent>();
+    ASSERT_TRUE(xform2);
+    EXPECT_EQ(xform2->translation, xform->translation);
+    EXPECT_EQ(xform2->scale, xform->scale);
+    EXPECT_EQ(xform2->rotation, xform->rotation);
+
+    auto empty = loaded.get_component<MeshComponent>(1);
+    ASSERT_TRUE(empty);
+    EXPECT_TRUE(empty->get_vertices().empty());
+}
+
+TEST(GeometryCache, RejectsCorruptFiles)
+{
+    Geometry geometry;
+    grid_mesh(geometry, 4);
+    const auto path = temp_path("gcore_corrupt.gcache");
+    write_geometry_cache(geometry, path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), {});
+    }
+    auto write = [&](const std::string& content) {
+        std::ofstream out(path, std::ios::binary);
+        out.write(content.data(), content.size());
+    };
+
+    write(bytes.substr(0, bytes.size() - 64));
+    EXPECT_THROW(read_geometry_cache(path), std::runtime_error);
+
+    std::string bad_magic = bytes;
+    bad_magic[0] = 'X';
+    write(bad_magic);
+    EXPECT_THROW(read_geometry_cache(path), std::runtime_error);
+
+    // Point the first array entry past the end of the file.
+    std::string bad_offset = bytes;
+    GeometryCacheEntry entry;
+    const size_t second = sizeof(GeometryCacheHeader) + sizeof(entry);
+    std::memcpy(&entry, bad_offset.data() + second, sizeof(entry));
+    entry.data_offset = bytes.size() + 64;
+    std::memcpy(bad_offset.data() + second, &entry, sizeof(entry));
+    write(bad_offset);
+    EXPECT_THROW(read_geometry_cache(path), std::runtime_error);
+
+    write("");
+    EXPECT_THROW(read_geometry_cache(path), std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(read_geometry_cache(path), std::runtime_error);
+}
+
+TEST(GeometryCache, DISABLED_Benchmark)
+{
+    Geometry geometry;
+    grid_mesh(geometry, 1500);
+    const auto path = temp_path("gcore_benchmark.gcache");
+    const double write_ms =
+        time_ms([&] { write_geometry_cache(geometry, path); });
+    Geometry loaded;
+    const double read_ms =
+        time_ms([&] { loaded = read_geometry_cache(path); });
+    const auto bytes = std::filesystem::file_size(path);
+    std::cout << "geometry cache " << bytes / (1 << 20) << " MiB: write "
+              << write_ms << " ms, read " << read_ms << " ms" << std::endl;
+    EXPECT_EQ(
+        loaded.get_component<MeshComponent>()->get_face_vertex_indices(),
+        geometry.get_component<MeshComponent>()->get_face_vertex_indices());
+    loaded = Geometry();
+    std::filesystem::remove(path);
+}
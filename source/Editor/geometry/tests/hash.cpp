@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <random>
+#include <set>
+
+#include "GCore/Algorithms/hash.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+std::vector<uint8_t> random_bytes(size_t size, unsigned seed = 3)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+}  // namespace
+
+TEST(Hash, Deterministic)
+{
+    const auto bytes = random_bytes(3 * hash_chunk_size + 17);
+    EXPECT_EQ(
+        hash_bytes(bytes.data(), bytes.size()),
+        hash_bytes(bytes.data(), bytes.size()));
+    EXPECT_NE(
+        hash_bytes(bytes.data(), bytes.size(), 1),
+        hash_bytes(bytes.data(), bytes.size(), 2));
+}
+
+TEST(Hash, LengthAndPrefixSensitive)
+{
+    // Every prefix of a buffer that crosses the short, long and chunked paths
+    // must hash differently, including zero padding.
+    const auto bytes = random_bytes(600);
+    std::vector<uint8_t> zeros(600, 0);
+    std::set<uint64_t> seen = { hash_bytes(nullptr, 0) };
+    for (size_t size = 1; size <= bytes.size(); ++size) {
+        EXPECT_TRUE(seen.insert(hash_bytes(bytes.data(), size)).second);
+        EXPECT_TRUE(seen.insert(hash_bytes(zeros.data(), size)).second);
+    }
+}
+
+TEST(Hash, SingleBitFlips)
+{
+    auto bytes = random_bytes(2 * hash_chunk_size + 4099);
+    const uint64_t reference = hash_bytes(bytes.data(), bytes.size());
+    for (size_t pos : { size_t(0),
+                        size_t(63),
+                        size_t(64),
+                        size_t(1000),
+                        hash_chunk_size - 1,
+                        hash_chunk_size,
+                        bytes.size() - 1 }) {
+        bytes[pos] ^= 1;
+        EXPECT_NE(hash_bytes(bytes.data(), bytes.size()), reference) << pos;
+        bytes[pos] ^= 1;
+    }
+    EXPECT_EQ(hash_bytes(bytes.data(), bytes.size()), reference);
+}
+
+TEST(Hash, QuantityMapsAndCache)
+{
+    std::map<std::string, pxr::VtArray<float>> a;
+    a["u"] = pxr::VtArray<float>(10, 1.0f);
+    auto b = a;
+    EXPECT_EQ(hash_quantities(a), hash_quantities(b));
+    b["u"][3] = 2.0f;
+    EXPECT_NE(hash_quantities(a), hash_quantities(b));
+
+    int computed = 0;
+    CachedHash cache;
+    auto compute = [&] {
+        ++computed;
+        return hash_quantities(a);
+    };
+    EXPECT_EQ(cache.get(compute), cache.get(compute));
+    EXPECT_EQ(computed, 1);
+    cache.invalidate();
+    cache.get(compute);
+    EXPECT_EQ(computed, 2);
+}
+
+TEST(Hash, GeometryTopologyAndPositions)
+{
+    Geometry geometry = Geometry::CreateMesh();
+    auto mesh = geometry.get_component<MeshComponent>();
+    mesh->set_vertices({ pxr::GfVec3f(0, 0, 0),
+                         pxr::GfVec3f(1, 0, 0),
+                         pxr::GfVec3f(0, 1, 0) });
+    mesh->set_face_vertex_counts({ 3 });
+    mesh->set_face_vertex_indices({ 0, 1, 2 });
+
+    const Geometry copied = geometry;
+    EXPECT_EQ(copied.content_hash(), geometry.content_hash());
+
+    const uint64_t topology = geometry.topology_hash();
+    const uint64_t positions = geometry.positions_hash();
+    const uint64_t content = geometry.content_hash();
+
+    pxr::GfMatrix4d translate(1.0);
+    translate.SetTranslate(pxr::GfVec3d(0, 0, 1));
+    mesh->apply_transform(translate);
+    EXPECT_EQ(geometry.topology_hash(), topology);
+    EXPECT_NE(geometry.positions_hash(), positions);
+    EXPECT_NE(geometry.content_hash(), content);
+    EXPECT_EQ(copied.content_hash(), content);
+
+    const uint64_t moved_positions = geometry.positions_hash();
+    const uint64_t moved_content = geometry.content_hash();
+    mesh->add_vertex_scalar_quantity("u", pxr::VtArray<float>(3, 0.5f));
+    EXPECT_NE(geometry.content_hash(), moved_content);
+    EXPECT_EQ(geometry.positions_hash(), moved_positions);
+
+    mesh->set_face_vertex_indices({ 0, 2, 1 });
+    EXPECT_NE(geometry.topology_hash(), topology);
+}
+
+TEST(Hash, DISABLED_Throughput)
+{
+    const auto bytes = random_bytes(size_t(64) << 20);
+    uint64_t h = 0;
+    const double ms =
+        time_ms([&] { h = hash_bytes(bytes.data(), bytes.size()); });
+    std::cout << "hashed " << (bytes.size() >> 20) << " MiB in " << ms
+              << " ms (" << (bytes.size() >> 20) / ms / 1.024 << " GiB/s), "
+              << h << std::endl;
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+
+#include "GCore/Algorithms/heat_geodesic.h"
+#include "GCore/Algorithms/laplacian.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+TEST(Laplacian, CotangentAndMass)
+{
+    const TestMesh grid = triangle_grid(5);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    const auto stiffness = cotangent_laplacian(*adjacency, grid.vertices);
+    const auto mass = barycentric_mass(*adjacency, grid.vertices);
+
+    EXPECT_NEAR(mass.sum(), 1.0, 1e-6);
+    const Eigen::VectorXd ones = Eigen::VectorXd::Ones(25);
+    EXPECT_LT((stiffness * ones).norm(), 1e-6);
+    EXPECT_LT(
+        (Eigen::SparseMatrix<double>(stiffness.transpose()) - stiffness)
+            .norm(),
+        1e-9);
+    // Linear functions are harmonic at interior vertices.
+    Eigen::VectorXd x(25);
+    for (int v = 0; v < 25; ++v) {
+        x[v] = grid.vertices[v][0] + 2 * grid.vertices[v][1];
+    }
+    const Eigen::VectorXd laplace = stiffness * x;
+    EXPECT_NEAR(laplace[12], 0.0, 1e-6);
+    // Dirichlet energy of x + 2y over the unit square is 1 + 4.
+    EXPECT_NEAR(x.dot(stiffness * x), 5.0, 1e-6);
+}
+
+TEST(HeatGeodesic, PlaneDistance)
+{
+    const int n = 61;
+    const TestMesh grid = triangle_grid(n);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    const HeatGeodesic geodesic(adjacency, grid.vertices);
+
+    const uint32_t center = (n / 2) * n + n / 2;
+    const uint32_t corner = 0;
+    const auto sets = geodesic.distances({ { center }, {}, { corner } });
+    ASSERT_EQ(sets.size(), 3u);
+    EXPECT_TRUE(sets[1].empty());
+    EXPECT_EQ(sets[0][center], 0.0f);
+
+    double error = 0.0;
+    for (size_t v = 0; v < grid.vertices.size(); ++v) {
+        const float exact = (grid.vertices[v] - grid.vertices[center])
+                                .GetLength();
+        error = std::max(error, double(std::abs(sets[0][v] - exact)));
+    }
+    EXPECT_LT(error, 0.03);
+    EXPECT_NEAR(sets[2][n * n - 1], std::sqrt(2.0f), 0.05f);
+
+    // Batched columns match single solves, and a two source set is close
+    // to the smaller of the two single source fields.
+    const auto single = geodesic.distance({ corner });
+    const auto both = geodesic.distance({ center, corner });
+    for (size_t v = 0; v < grid.vertices.size(); ++v) {
+        EXPECT_NEAR(single[v], sets[2][v], 1e-5f);
+        EXPECT_NEAR(both[v], std::min(sets[0][v], sets[2][v]), 0.05f);
+    }
+
+    EXPECT_THROW(
+        (void)geodesic.distance({ uint32_t(n * n) }), std::invalid_argument);
+}
+
+TEST(HeatGeodesic, UpdateReusesFactorization)
+{
+    const TestMesh grid = triangle_grid(6);
+    Geometry geometry;
+    MeshComponent mesh(&geometry);
+    mesh.set_vertices(grid.vertices);
+    mesh.set_face_vertex_counts(grid.counts);
+    mesh.set_face_vertex_indices(grid.indices);
+
+    auto first = HeatGeodesic::update(nullptr, mesh);
+    EXPECT_EQ(HeatGeodesic::update(first, mesh), first);
+    EXPECT_NE(HeatGeodesic::update(first, mesh, 2.0), first);
+
+    auto moved = grid.vertices;
+    moved[7][2] = 0.1f;
+    mesh.set_vertices(moved);
+    EXPECT_NE(HeatGeodesic::update(first, mesh), first);
+}
+
+TEST(HeatGeodesic, DISABLED_Benchmark)
+{
+    const int n = 317;
+    const TestMesh grid = triangle_grid(n);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    std::unique_ptr<HeatGeodesic> geodesic;
+    const double setup_ms = time_ms([&] {
+        geodesic = std::make_unique<HeatGeodesic>(adjacency, grid.vertices);
+    });
+    const double one_ms = time_ms([&] { (void)geodesic->distance({ 0 }); });
+    const double four_ms = time_ms([&] {
+        (void)geodesic->distances({ { 0 }, { 300 }, { 50150 }, { 7 } });
+    });
+    std::cout << "heat geodesic " << grid.vertices.size() / 1e6
+              << "M vertices: factorization " << setup_ms << " ms, query "
+              << one_ms << " ms, 4 sets " << four_ms << " ms" << std::endl;
+}
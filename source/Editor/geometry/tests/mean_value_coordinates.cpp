@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <pxr/base/gf/vec2d.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "GCore/Algorithms/mean_value_coordinates.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// An L shaped, concave polygon.
+pxr::VtArray<pxr::GfVec2f> l_shape()
+{
+    return { { 0, 0 }, { 2, 0 }, { 2, 1 }, { 1, 1 }, { 1, 2 }, { 0, 2 } };
+}
+
+// Floater's formula with the signed angles from atan2, in double.
+std::vector<double> reference(
+    const pxr::VtArray<pxr::GfVec2f>& polygon,
+    const pxr::GfVec2f& p)
+{
+    const size_t n = polygon.size();
+    std::vector<double> r(n), alpha(n), w(n);
+    for (size_t i = 0; i < n; ++i) {
+        const pxr::GfVec2d a = pxr::GfVec2d(polygon[i]) - pxr::GfVec2d(p);
+        const pxr::GfVec2d b =
+            pxr::GfVec2d(polygon[(i + 1) % n]) - pxr::GfVec2d(p);
+        r[i] = a.GetLength();
+        alpha[i] = std::atan2(
+            a[0] * b[1] - a[1] * b[0], a[0] * b[0] + a[1] * b[1]);
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        w[i] = (std::tan(alpha[(i + n - 1) % n] / 2) + std::tan(alpha[i] / 2)) /
+               r[i];
+        sum += w[i];
+    }
+    for (double& wi : w) {
+        wi /= sum;
+    }
+    return w;
+}
+}  // namespace
+
+TEST(MeanValueCoordinates, MatchesReference)
+{
+    const auto polygon = l_shape();
+    const MeanValueCoordinates mvc(polygon);
+    ASSERT_EQ(mvc.size(), 6u);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> uniform(-0.5f, 2.5f);
+    pxr::VtArray<pxr::GfVec2f> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.push_back(pxr::GfVec2f(uniform(rng), uniform(rng)));
+    }
+    const MeanValueCoordinates::Weights weights = mvc.evaluate(points);
+    for (size_t p = 0; p < points.size(); ++p) {
+        const std::vector<double> expected = reference(polygon, points[p]);
+        pxr::GfVec2d sum(0.0);
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            EXPECT_NEAR(
+                weights(p, i), expected[i], 1e-3 * (1 + std::abs(expected[i])));
+            sum += double(weights(p, i)) * pxr::GfVec2d(polygon[i]);
+        }
+        // Linear precision, inside and outside.
+        EXPECT_NEAR(sum[0], points[p][0], 1e-3);
+        EXPECT_NEAR(sum[1], points[p][1], 1e-3);
+    }
+}
+
+TEST(MeanValueCoordinates, Boundary)
+{
+    const auto polygon = l_shape();
+    const MeanValueCoordinates mvc(polygon);
+    const pxr::VtArray<pxr::GfVec2f> points = {
+        { 1, 1 },     // Vertex 3.
+        { 1.5f, 0 },  // Edge 0-1, at 3/4.
+        { 0, 0.5f },  // Edge 5-0, at 3/4.
+    };
+    const MeanValueCoordinates::Weights weights = mvc.evaluate(points);
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_FLOAT_EQ(weights(0, i), i == 3 ? 1.0f : 0.0f);
+    }
+    EXPECT_NEAR(weights(1, 0), 0.25f, 1e-6f);
+    EXPECT_NEAR(weights(1, 1), 0.75f, 1e-6f);
+    EXPECT_NEAR(weights(2, 5), 0.25f, 1e-6f);
+    EXPECT_NEAR(weights(2, 0), 0.75f, 1e-6f);
+    EXPECT_NEAR(weights.row(1).sum(), 1.0f, 1e-6f);
+
+    EXPECT_THROW(
+        MeanValueCoordinates(pxr::VtArray<pxr::GfVec2f>(2)),
+        std::invalid_argument);
+}
+
+TEST(MeanValueCoordinates, CageDeformation)
+{
+    const auto polygon = l_shape();
+    const MeanValueCoordinates mvc(polygon);
+    // An affine map of the cage moves every point by the same map.
+    pxr::VtArray<pxr::GfVec2f> cage;
+    auto affine = [](const pxr::GfVec2f& p) {
+        return pxr::GfVec2f(
+            2.0f * p[0] - 0.5f * p[1] + 1.0f, 0.3f * p[0] + p[1] - 2.0f);
+    };
+    for (const auto& v : polygon) {
+        cage.push_back(affine(v));
+    }
+    const pxr::VtArray<pxr::GfVec2f> points = {
+        { 0.5f, 0.5f }, { 1.5f, 0.5f }, { 0.5f, 1.5f }, { 0.1f, 1.9f }
+    };
+    pxr::VtArray<pxr::GfVec2f> out(points.size());
+    mvc.interpolate(points.cdata(), points.size(), cage.cdata(), out.data());
+    for (size_t p = 0; p < points.size(); ++p) {
+        EXPECT_LT((out[p] - affine(points[p])).GetLength(), 1e-4f);
+    }
+}
+
+TEST(MeanValueCoordinates, DISABLED_Benchmark)
+{
+    pxr::VtArray<pxr::GfVec2f> polygon;
+    const int n = 10;
+    for (int i = 0; i < n; ++i) {
+        const float angle = 2.0f * float(M_PI) * i / n;
+        const float radius = i % 2 ? 0.6f : 1.0f;
+        polygon.push_back(
+            pxr::GfVec2f(radius * std::cos(angle), radius * std::sin(angle)));
+    }
+    const MeanValueCoordinates mvc(polygon);
+    const size_t count = 1 << 20;
+    pxr::VtArray<pxr::GfVec2f> points(count);
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    for (auto& p : points) {
+        p = pxr::GfVec2f(uniform(rng), uniform(rng));
+    }
+    std::vector<float> weights(count * n);
+    const double ms =
+        time_ms([&] { mvc.evaluate(points.cdata(), count, weights.data()); });
+    std::cout << "mean value coordinates: " << count << " points, " << n
+              << " vertices: " << ms << " ms" << std::endl;
+}
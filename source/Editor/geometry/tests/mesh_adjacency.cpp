@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "GCore/Algorithms/mesh_adjacency.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+TEST(MeshAdjacency, QuadGrid)
+{
+    const int n = 5;
+    const TestMesh grid = quad_grid(n);
+    const MeshAdjacency adjacency(grid.counts, grid.indices, n * n);
+
+    ASSERT_EQ(adjacency.vertex_count(), 25u);
+    ASSERT_EQ(adjacency.face_count(), 16u);
+    EXPECT_EQ(adjacency.face_offsets().back(), grid.indices.size());
+
+    const auto& vertex_faces = adjacency.vertex_faces();
+    EXPECT_EQ(vertex_faces.count(0), 1u);
+    EXPECT_EQ(vertex_faces.count(2), 2u);
+    EXPECT_EQ(vertex_faces.count(12), 4u);
+    EXPECT_EQ(
+        std::vector<uint32_t>(vertex_faces.begin(12), vertex_faces.end(12)),
+        (std::vector<uint32_t>{ 5, 6, 9, 10 }));
+
+    // Face 5 is interior: 4 edge neighbors, 8 vertex neighbors.
+    const auto& edge = adjacency.face_neighbors(FaceNeighborhood::edge);
+    EXPECT_EQ(
+        std::vector<uint32_t>(edge.begin(5), edge.end(5)),
+        (std::vector<uint32_t>{ 1, 4, 6, 9 }));
+    EXPECT_EQ(edge.count(0), 2u);
+    const auto& vertex = adjacency.face_neighbors(FaceNeighborhood::vertex);
+    EXPECT_EQ(vertex.count(5), 8u);
+    EXPECT_EQ(vertex.count(0), 3u);
+
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const bool on_border = i == 0 || j == 0 || i == n - 1 || j == n - 1;
+            EXPECT_EQ(adjacency.boundary_vertices()[i * n + j], on_border);
+        }
+    }
+}
+
+TEST(MeshAdjacency, RepeatedVertexAndErrors)
+{
+    // Degenerate face using vertex 0 twice.
+    const MeshAdjacency adjacency({ 3, 4 }, { 0, 1, 2, 0, 2, 3, 0 }, 4);
+    EXPECT_EQ(adjacency.vertex_faces().count(0), 2u);
+    EXPECT_EQ(adjacency.face_neighbors(FaceNeighborhood::edge).count(0), 1u);
+
+    EXPECT_THROW(MeshAdjacency({ 3 }, { 0, 1 }, 3), std::invalid_argument);
+    EXPECT_THROW(MeshAdjacency({ 3 }, { 0, 1, 3 }, 3), std::invalid_argument);
+}
+
+TEST(MeshAdjacency, UpdateReusesTopology)
+{
+    Geometry geometry;
+    MeshComponent mesh(&geometry);
+    TestMesh grid = quad_grid(4);
+    mesh.set_vertices(pxr::VtArray<pxr::GfVec3f>(16, pxr::GfVec3f(0.0f)));
+    mesh.set_face_vertex_counts(grid.counts);
+    mesh.set_face_vertex_indices(grid.indices);
+
+    auto first = MeshAdjacency::update(nullptr, mesh);
+    mesh.set_vertices(pxr::VtArray<pxr::GfVec3f>(16, pxr::GfVec3f(1.0f)));
+    EXPECT_EQ(MeshAdjacency::update(first, mesh), first);
+
+    grid.indices[0] = 15;
+    mesh.set_face_vertex_indices(grid.indices);
+    EXPECT_NE(MeshAdjacency::update(first, mesh), first);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <Eigen/IterativeLinearSolvers>
+#include <cmath>
+#include <vector>
+
+#include "GCore/Algorithms/multigrid.h"
+
+using namespace USTC_CG;
+
+namespace {
+// 5 point Laplacian on an n x n grid with Dirichlet boundary, plus an
+// optional upwind term that makes it a non-symmetric M-matrix.
+Eigen::SparseMatrix<double> grid_laplacian(int n, double upwind = 0.0)
+{
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const int v = i * n + j;
+            triplets.emplace_back(v, v, 4.0 + upwind);
+            if (i > 0) {
+                triplets.emplace_back(v, v - n, -1.0 - upwind);
+            }
+            if (i + 1 < n) {
+                triplets.emplace_back(v, v + n, -1.0);
+            }
+            if (j > 0) {
+                triplets.emplace_back(v, v - 1, -1.0);
+            }
+            if (j + 1 < n) {
+                triplets.emplace_back(v, v + 1, -1.0);
+            }
+        }
+    }
+    Eigen::SparseMatrix<double> matrix(n * n, n * n);
+    matrix.setFromTriplets(triplets.begin(), triplets.end());
+    return matrix;
+}
+}  // namespace
+
+TEST(AggregationMultigrid, ConjugateGradient)
+{
+    // The iteration count stays flat while the grid grows 16 times.
+    for (int n : { 100, 400 }) {
+        const Eigen::SparseMatrix<double> matrix = grid_laplacian(n);
+        const Eigen::VectorXd b = Eigen::VectorXd::Ones(n * n);
+        Eigen::ConjugateGradient<
+            Eigen::SparseMatrix<double>,
+            Eigen::Lower | Eigen::Upper,
+            AggregationMultigrid>
+            cg;
+        cg.setTolerance(1e-10);
+        cg.compute(matrix);
+        ASSERT_EQ(cg.info(), Eigen::Success);
+        EXPECT_GT(cg.preconditioner().levels(), 1u);
+        const Eigen::VectorXd x = cg.solve(b);
+        EXPECT_EQ(cg.info(), Eigen::Success);
+        EXPECT_LT(cg.iterations(), 40);
+        EXPECT_LT((matrix * x - b).norm(), 1e-8 * b.norm());
+    }
+}
+
+TEST(AggregationMultigrid, NonSymmetric)
+{
+    const int n = 200;
+    const Eigen::SparseMatrix<double> matrix = grid_laplacian(n, 0.5);
+    const Eigen::VectorXd b = Eigen::VectorXd::Ones(n * n);
+    Eigen::BiCGSTAB<Eigen::SparseMatrix<double>, AggregationMultigrid>
+        bicgstab;
+    bicgstab.setTolerance(1e-10);
+    bicgstab.compute(matrix);
+    const Eigen::VectorXd x = bicgstab.solve(b);
+    EXPECT_EQ(bicgstab.info(), Eigen::Success);
+    EXPECT_LT(bicgstab.iterations(), 40);
+    EXPECT_LT((matrix * x - b).norm(), 1e-8 * b.norm());
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "GCore/IO/obj.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+ObjData parse(const std::string& text)
+{
+    return parse_obj(text.data(), text.size());
+}
+
+// Reference loader in the style of the existing stream based readers.
+size_t stream_load(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    std::vector<std::vector<float>> vertices;
+    std::vector<std::vector<int>> faces;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string tag;
+        ss >> tag;
+        if (tag == "v") {
+            std::vector<float> v(3);
+            ss >> v[0] >> v[1] >> v[2];
+            vertices.push_back(v);
+        }
+        else if (tag == "f") {
+            std::vector<int> face;
+            std::string corner;
+            while (ss >> corner) {
+                face.push_back(std::stoi(corner) - 1);
+            }
+            faces.push_back(face);
+        }
+    }
+    return vertices.size() + faces.size();
+}
+}  // namespace
+
+TEST(Obj, PolygonsAndComments)
+{
+    const ObjData data = parse(
+        "# a quad and a triangle\n"
+        "o test\n"
+        "v 0 0 0\n"
+        "v 1.5 0 0\r\n"
+        "v 1 1 -2.5e-1\n"
+        "v 0 1 0 0.5 0.5 0.5\n"
+        "s off\n"
+        "f 1 2 3 4 # trailing comment\n"
+        "  f -4 -2 -1");
+    ASSERT_EQ(data.vertices.size(), 4u);
+    EXPECT_EQ(data.vertices[1], pxr::GfVec3f(1.5f, 0, 0));
+    EXPECT_EQ(data.vertices[2], pxr::GfVec3f(1, 1, -0.25f));
+    ASSERT_EQ(data.face_vertex_counts.size(), 2u);
+    EXPECT_EQ(data.face_vertex_counts[0], 4);
+    EXPECT_EQ(data.face_vertex_counts[1], 3);
+    const std::vector<int> expected = { 0, 1, 2, 3, 0, 2, 3 };
+    EXPECT_EQ(
+        std::vector<int>(
+            data.face_vertex_indices.begin(), data.face_vertex_indices.end()),
+        expected);
+    EXPECT_TRUE(data.texcoords.empty());
+    EXPECT_TRUE(data.normals.empty());
+}
+
+TEST(Obj, AttributeInterpolation)
+{
+    // Attribute indices equal to the position indices: per vertex.
+    const ObjData shared = parse(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 0 1\n"
+        "vn 0 0 1\nvn 0 0 1\nvn 0 0 1\n"
+        "f 1/1/1 2/2/2 3/3/3\n");
+    EXPECT_EQ(shared.texcoords.size(), 3u);
+    EXPECT_EQ(shared.normals.size(), 3u);
+    EXPECT_EQ(shared.texcoords[1], pxr::GfVec2f(1, 0));
+
+    // Seams: per face corner.
+    const ObjData seams = parse(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+        "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\nvt 0.5 0.5\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/2/1 3/3/1\n"
+        "f 2/5/1 4/4/1 3/3/1\n");
+    ASSERT_EQ(seams.texcoords.size(), 6u);
+    EXPECT_EQ(seams.texcoords[3], pxr::GfVec2f(0.5f, 0.5f));
+    ASSERT_EQ(seams.normals.size(), 6u);
+    EXPECT_EQ(seams.normals[5], pxr::GfVec3f(0, 0, 1));
+
+    // Normals without texture coordinates.
+    const ObjData normals_only = parse(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1\n");
+    EXPECT_TRUE(normals_only.texcoords.empty());
+    EXPECT_EQ(normals_only.normals.size(), 3u);
+
+    // One dimensional texture coordinates get v = 0.
+    const ObjData one_dimensional = parse(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.25\nvt 0.5 # u only\nvt 1\r\n"
+        "f 1/1 2/2 3/3\n");
+    ASSERT_EQ(one_dimensional.texcoords.size(), 3u);
+    EXPECT_EQ(one_dimensional.texcoords[0], pxr::GfVec2f(0.25f, 0.0f));
+    EXPECT_EQ(one_dimensional.texcoords[1], pxr::GfVec2f(0.5f, 0.0f));
+    EXPECT_EQ(one_dimensional.texcoords[2], pxr::GfVec2f(1.0f, 0.0f));
+}
+
+TEST(Obj, Errors)
+{
+    EXPECT_THROW(parse("v 0 0\nf 1 2 3\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nf 1 2 5\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nf 1 0 1\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nf 1 1\n"), std::runtime_error);
+    EXPECT_THROW(parse("v 0 0 0\nf 1 1 1x\n"), std::runtime_error);
+    EXPECT_NO_THROW(parse(""));
+}
+
+// Large enough to be split into many chunks, with relative indices that
+// point back across chunk boundaries.
+TEST(Obj, ChunkedParseMatchesContent)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    std::vector<pxr::GfVec3f> vertices;
+    std::vector<int> indices;
+    std::string text;
+    char buffer[128];
+    for (int block = 0; block < 200000; ++block) {
+        for (int k = 0; k < 4; ++k) {
+            pxr::GfVec3f v(dist(rng), dist(rng), dist(rng));
+            snprintf(
+                buffer,
+                sizeof(buffer),
+                "v %.9g %.9g %.9g\n",
+                v[0],
+                v[1],
+                v[2]);
+            text += buffer;
+            vertices.push_back(v);
+        }
+        const int n = int(vertices.size());
+        if (block % 2) {
+            text += "f -4 -3 -2 -1\n";
+        }
+        else {
+            snprintf(
+                buffer,
+                sizeof(buffer),
+                "f %d %d %d %d\n",
+                n - 3,
+                n - 2,
+                n - 1,
+                n);
+            text += buffer;
+        }
+        for (int k = 4; k > 0; --k) {
+            indices.push_back(n - k);
+        }
+    }
+    // Faces referring to vertices of earlier chunks.
+    text += "f 1 2 -1\n";
+    indices.insert(indices.end(), { 0, 1, int(vertices.size()) - 1 });
+
+    const ObjData data = parse(text);
+    ASSERT_EQ(data.vertices.size(), vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        ASSERT_EQ(data.vertices[i], vertices[i]) << i;
+    }
+    ASSERT_EQ(data.face_vertex_indices.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        ASSERT_EQ(data.face_vertex_indices[i], indices[i]) << i;
+    }
+}
+
+TEST(Obj, DISABLED_Benchmark)
+{
+    // Synthetic scan: a displaced grid with texture coordinates and normals.
+    const auto path =
+        std::filesystem::temp_directory_path() / "gcore_obj_benchmark.obj";
+    {
+        std::ofstream out(path);
+        const int n = 700;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                out << "v " << i * 0.01f << ' ' << j * 0.01f << ' '
+                    << 0.001f * ((i * 7 + j * 13) % 17) << '\n';
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                out << "vt " << float(i) / n << ' ' << float(j) / n << '\n';
+            }
+        }
+        out << "vn 0 0 1\n";
+        for (int i = 0; i + 1 < n; ++i) {
+            for (int j = 0; j + 1 < n; ++j) {
+                const int a = i * n + j + 1, b = a + 1, c = a + n, d = c + 1;
+                out << "f " << a << '/' << a << "/1 " << b << '/' << b
+                    << "/1 " << d << '/' << d << "/1 " << c << '/' << c
+                    << "/1\n";
+            }
+        }
+    }
+    const auto bytes = std::filesystem::file_size(path);
+
+    size_t reference = 0;
+    const double stream_ms = time_ms([&] { reference = stream_load(path); });
+    ObjData data;
+    const double mapped_ms = time_ms([&] { data = read_obj(path); });
+    std::filesystem::remove(path);
+
+    std::cout << "obj " << bytes / (1 << 20) << " MiB: stream reader "
+              << stream_ms << " ms, mapped parallel reader " << mapped_ms
+              << " ms" << std::endl;
+
+    EXPECT_EQ(
+        data.vertices.size() + data.face_vertex_counts.size(), reference);
+    EXPECT_EQ(data.texcoords.size(), data.vertices.size());
+    EXPECT_EQ(data.normals.size(), data.face_vertex_indices.size());
+}
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/binary_stream.h"
+#include "GCore/IO/ply.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+PlyData parse(const std::string& text)
+{
+    return parse_ply(text.data(), text.size());
+}
+
+// A grid of quads with every kind of attribute write_ply knows about.
+Geometry attributed_grid(int n)
+{
+    Geometry geometry = grid_geometry(n, GridFaces::quads);
+    auto mesh = geometry.get_component<MeshComponent>();
+    pxr::VtArray<pxr::GfVec3f> normals, colors;
+    pxr::VtArray<pxr::GfVec2f> texcoords;
+    pxr::VtArray<float> height;
+    const auto vertices = mesh->get_vertices();
+    for (int v = 0; v < n * n; ++v) {
+        const int i = v / n, j = v % n;
+        normals.push_back(pxr::GfVec3f(0, 0, 1));
+        texcoords.push_back(pxr::GfVec2f(float(i) / n, float(j) / n));
+        colors.push_back(pxr::GfVec3f(i % 2, j % 2, 1));
+        height.push_back(vertices[v][2]);
+    }
+    pxr::VtArray<float> area;
+    const auto indices = mesh->get_face_vertex_indices();
+    for (size_t f = 0; f < mesh->get_face_vertex_counts().size(); ++f) {
+        area.push_back(float(indices[4 * f]));
+    }
+    mesh->set_normals(normals);
+    mesh->set_texcoords_array(texcoords);
+    mesh->set_display_color(colors);
+    mesh->add_vertex_scalar_quantity("height", height);
+    mesh->add_face_scalar_quantity("face id", area);
+    return geometry;
+}
+
+void expect_round_trip(const MeshComponent& mesh, const PlyData& data)
+{
+    EXPECT_EQ(data.vertices, mesh.get_vertices());
+    EXPECT_EQ(data.face_vertex_counts, mesh.get_face_vertex_counts());
+    EXPECT_EQ(data.face_vertex_indices, mesh.get_face_vertex_indices());
+    EXPECT_EQ(data.normals, mesh.get_normals());
+    EXPECT_EQ(data.texcoords, mesh.get_texcoords_array());
+    EXPECT_EQ(data.colors, mesh.get_display_color());
+    ASSERT_EQ(data.vertex_scalars.count("height"), 1u);
+    EXPECT_EQ(
+        data.vertex_scalars.at("height"),
+        mesh.get_vertex_scalar_quantity("height"));
+    // Whitespace is not allowed in property names.
+    ASSERT_EQ(data.face_scalars.count("face_id"), 1u);
+    EXPECT_EQ(
+        data.face_scalars.at("face_id"),
+        mesh.get_face_scalar_quantity("face id"));
+}
+}  // namespace
+
+TEST(Ply, Ascii)
+{
+    const PlyData data = parse(
+        "ply\n"
+        "format ascii 1.0\n"
+        "comment made by hand\n"
+        "element vertex 4\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+        "property float quality\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "property int flags\n"
+        "element edge 1\n"
+        "property int vertex1\nproperty int vertex2\n"
+        "end_header\n"
+        "0 0 0 255 0 0 0.5\n"
+        "1 0 0 0 255 0 1\n"
+        "1 1 -2.5e-1 0 0 255 1.5\n"
+        "0 1 0 255 255 255 2\n"
+        "3 0 1 2 7\n"
+        "3 0 2 3 8\n"
+        "0 1\n");
+    ASSERT_EQ(data.vertices.size(), 4u);
+    EXPECT_EQ(data.vertices[2], pxr::GfVec3f(1, 1, -0.25f));
+    ASSERT_EQ(data.colors.size(), 4u);
+    EXPECT_EQ(data.colors[0], pxr::GfVec3f(1, 0, 0));
+    EXPECT_EQ(data.vertex_scalars.at("quality")[2], 1.5f);
+    const std::vector<int> expected = { 0, 1, 2, 0, 2, 3 };
+    EXPECT_EQ(
+        std::vector<int>(
+            data.face_vertex_indices.begin(), data.face_vertex_indices.end()),
+        expected);
+    EXPECT_EQ(data.face_scalars.at("flags")[1], 8.0f);
+    EXPECT_TRUE(data.normals.empty());
+    EXPECT_TRUE(data.texcoords.empty());
+}
+
+TEST(Ply, BigEndianWithListsInVertices)
+{
+    // Hand encoded big endian file whose vertex records contain a list, which
+    // takes the sequential path.
+    const auto path = temp_path("gcore_ply_big_endian.ply");
+    {
+        BinaryWriter out(path, false);
+        out.write_text(
+            "ply\nformat binary_big_endian 1.0\n"
+            "element vertex 3\n"
+            "property double x\nproperty double y\nproperty double z\n"
+            "property list uchar short ids\n"
+            "element face 1\n"
+            "property uchar tag\n"
+            "property list int uint vertex_indices\n"
+            "end_header\n");
+        for (int v = 0; v < 3; ++v) {
+            out.write(double(v));
+            out.write(double(v == 1));
+            out.write(double(-v));
+            out.write(uint8_t(v));
+            for (int k = 0; k < v; ++k) {
+                out.write(int16_t(k));
+            }
+        }
+        out.write(uint8_t(9));
+        out.write(int32_t(3));
+        for (uint32_t v : { 2u, 1u, 0u }) {
+            out.write(v);
+        }
+        out.finish();
+    }
+    const PlyData data = read_ply(path);
+    std::filesystem::remove(path);
+    ASSERT_EQ(data.vertices.size(), 3u);
+    EXPECT_EQ(data.vertices[1], pxr::GfVec3f(1, 1, -1));
+    EXPECT_EQ(data.vertices[2], pxr::GfVec3f(2, 0, -2));
+    ASSERT_EQ(data.face_vertex_indices.size(), 3u);
+    EXPECT_EQ(data.face_vertex_indices[0], 2);
+    EXPECT_EQ(data.face_scalars.at("tag")[0], 9.0f);
+}
+
+TEST(Ply, Errors)
+{
+    const std::string header =
+        "ply\nformat ascii 1.0\nelement vertex 3\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "element face 1\nproperty list uchar int vertex_indices\n"
+        "end_header\n";
+    const std::string vertices = "0 0 0\n1 0 0\n0 1 0\n";
+    EXPECT_NO_THROW(parse(header + vertices + "3 0 1 2\n"));
+    EXPECT_THROW(parse(header + vertices + "3 0 1 3\n"), std::runtime_error);
+    EXPECT_THROW(parse(header + vertices + "3 0 1\n"), std::runtime_error);
+    EXPECT_THROW(parse(header + vertices + "3 0 1 x\n"), std::runtime_error);
+    EXPECT_THROW(parse("ply\nformat ascii 1.0\n"), std::runtime_error);
+    EXPECT_THROW(parse("obj\n"), std::runtime_error);
+    EXPECT_THROW(
+        parse(
+            "ply\nformat binary_little_endian 1.0\nelement vertex 2\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "end_header\n0123456789"),
+        std::runtime_error);
+    // Counts far beyond the data are rejected before anything is allocated.
+    EXPECT_THROW(
+        parse(
+            "ply\nformat binary_little_endian 1.0\n"
+            "element vertex 4000000000000\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "end_header\n"),
+        std::runtime_error);
+    EXPECT_THROW(
+        parse(
+            "ply\nformat ascii 1.0\nelement vertex 4000000000000\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "end_header\n0 0 0\n"),
+        std::runtime_error);
+}
+
+TEST(Ply, RoundTrip)
+{
+    const Geometry geometry = attributed_grid(12);
+    const auto mesh = geometry.get_component<MeshComponent>();
+    for (PlyFormat format : { PlyFormat::ascii,
+                              PlyFormat::binary_little_endian,
+                              PlyFormat::binary_big_endian }) {
+        const auto path = temp_path("gcore_ply_round_trip.ply");
+        write_ply(path, *mesh, format);
+        const PlyData data = read_ply(path);
+        std::filesystem::remove(path);
+        expect_round_trip(*mesh, data);
+    }
+
+    // Faces with more than 255 corners need a wider count type.
+    Geometry polygon;
+    auto disk = std::make_shared<MeshComponent>(&polygon);
+    polygon.attach_component(disk);
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> indices;
+    for (int i = 0; i < 300; ++i) {
+        const float angle = i * 0.02f;
+        vertices.push_back(
+            pxr::GfVec3f(std::cos(angle), std::sin(angle), 0));
+        indices.push_back(i);
+    }
+    disk->set_vertices(vertices);
+    disk->set_face_vertex_counts(pxr::VtArray<int>(1, 300));
+    disk->set_face_vertex_indices(indices);
+    const auto path = temp_path("gcore_ply_polygon.ply");
+    write_ply(path, *disk);
+    const PlyData data = read_ply(path);
+    std::filesystem::remove(path);
+    EXPECT_EQ(data.face_vertex_indices, indices);
+}
+
+TEST(Ply, DISABLED_Benchmark)
+{
+    const Geometry geometry = attributed_grid(1000);
+    const auto mesh = geometry.get_component<MeshComponent>();
+    const auto path = temp_path("gcore_ply_benchmark.ply");
+    const double write_ms = time_ms([&] { write_ply(path, *mesh); });
+    const auto bytes = std::filesystem::file_size(path);
+    PlyData data;
+    const double read_ms = time_ms([&] { data = read_ply(path); });
+    std::filesystem::remove(path);
+
+    std::cout << "ply " << bytes / (1 << 20) << " MiB: write " << write_ms
+              << " ms, read " << read_ms << " ms" << std::endl;
+    EXPECT_EQ(data.vertices.size(), mesh->get_vertices().size());
+    EXPECT_EQ(data.face_vertex_indices, mesh->get_face_vertex_indices());
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <random>
+
+#include "GCore/Algorithms/point_index.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+pxr::VtArray<pxr::GfVec3f> random_points(size_t count, unsigned seed = 7)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    pxr::VtArray<pxr::GfVec3f> points(count);
+    for (auto& p : points) {
+        p = pxr::GfVec3f(dist(rng), dist(rng), dist(rng));
+    }
+    return points;
+}
+
+std::vector<std::pair<float, uint32_t>> brute_force(
+    const pxr::VtArray<pxr::GfVec3f>& points,
+    const pxr::GfVec3f& query)
+{
+    std::vector<std::pair<float, uint32_t>> result(points.size());
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        const pxr::GfVec3f d = points[i] - query;
+        result[i] = { pxr::GfDot(d, d), i };
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template<typename Index>
+void check_knn_and_radius(
+    const Index& index,
+    const pxr::VtArray<pxr::GfVec3f>& points)
+{
+    const auto queries = random_points(200, 99);
+    const uint32_t k = 12;
+    std::vector<uint32_t> indices(queries.size() * k);
+    std::vector<float> distances(queries.size() * k);
+    index.knn_batch(
+        queries.cdata(), queries.size(), k, indices.data(), distances.data());
+
+    const float radius = 0.2f;
+    const NeighborLists lists =
+        index.radius_batch(queries.cdata(), queries.size(), radius);
+    ASSERT_EQ(lists.size(), queries.size());
+
+    for (size_t q = 0; q < queries.size(); ++q) {
+        const auto expected = brute_force(points, queries[q]);
+        for (uint32_t j = 0; j < k; ++j) {
+            if (j < expected.size()) {
+                EXPECT_FLOAT_EQ(distances[q * k + j], expected[j].first);
+            }
+            else {
+                EXPECT_EQ(indices[q * k + j], invalid_point);
+            }
+        }
+        EXPECT_EQ(index.nearest(queries[q]), indices[q * k]);
+
+        std::vector<uint32_t> found(lists.begin(q), lists.end(q));
+        std::sort(found.begin(), found.end());
+        std::vector<uint32_t> inside;
+        for (const auto& [d2, i] : expected) {
+            if (d2 <= radius * radius) {
+                inside.push_back(i);
+            }
+        }
+        std::sort(inside.begin(), inside.end());
+        EXPECT_EQ(found, inside);
+    }
+}
+}  // namespace
+
+TEST(PointIndex, KDTreeMatchesBruteForce)
+{
+    for (size_t count :
+         { size_t(1), size_t(31), size_t(1000), size_t(50000) }) {
+        const auto points = random_points(count);
+        PointKDTree tree(points);
+        check_knn_and_radius(tree, points);
+    }
+}
+
+TEST(PointIndex, HashGridMatchesBruteForce)
+{
+    for (float cell : { 0.05f, 0.2f, 1.5f }) {
+        const auto points = random_points(20000);
+        PointHashGrid grid(points, cell);
+        check_knn_and_radius(grid, points);
+
+        size_t total = 0;
+        for (size_t c = 0; c < grid.cell_count(); ++c) {
+            const pxr::GfVec3i cell_key =
+                grid.cell_of(points[*grid.cell_begin(c)]);
+            for (auto it = grid.cell_begin(c); it != grid.cell_end(c); ++it) {
+                EXPECT_EQ(grid.cell_of(points[*it]), cell_key);
+            }
+            total += grid.cell_end(c) - grid.cell_begin(c);
+        }
+        EXPECT_EQ(total, points.size());
+    }
+}
+
+TEST(PointIndex, MissingNeighborsAndMaxDistance)
+{
+    const auto points = random_points(5);
+    PointKDTree tree(points);
+    PointHashGrid grid(points, 0.1f);
+
+    uint32_t indices[8];
+    float distances[8];
+    tree.knn(pxr::GfVec3f(0.0f), 8, indices, distances);
+    EXPECT_NE(indices[4], invalid_point);
+    EXPECT_EQ(indices[5], invalid_point);
+    EXPECT_TRUE(std::isinf(distances[7]));
+
+    grid.knn(pxr::GfVec3f(0.0f), 8, indices, distances);
+    EXPECT_NE(indices[4], invalid_point);
+    EXPECT_EQ(indices[5], invalid_point);
+
+    const pxr::GfVec3f far(10.0f, 0.0f, 0.0f);
+    EXPECT_EQ(tree.nearest(far, 1.0f), invalid_point);
+    EXPECT_EQ(grid.nearest(far, 1.0f), invalid_point);
+    EXPECT_NE(tree.nearest(far), invalid_point);
+    EXPECT_NE(grid.nearest(far), invalid_point);
+
+    PointKDTree empty(pxr::VtArray<pxr::GfVec3f>{});
+    EXPECT_EQ(empty.nearest(far), invalid_point);
+
+    // Far outside the grid, with fewer points than asked for, only the
+    // occupied cells are searched.
+    const pxr::GfVec3f very_far(1e4f, -1e4f, 1e4f);
+    grid.knn(very_far, 8, indices, distances);
+    EXPECT_NE(indices[4], invalid_point);
+    EXPECT_EQ(indices[5], invalid_point);
+    EXPECT_EQ(grid.nearest(very_far), indices[0]);
+
+    // k = 0 writes nothing and calls nothing.
+    indices[0] = 42;
+    tree.knn(pxr::GfVec3f(0.0f), 0, indices, distances);
+    tree.knn_batch(points.cdata(), points.size(), 0, indices, distances);
+    tree.knn_all(0, indices, distances);
+    grid.knn(pxr::GfVec3f(0.0f), 0, indices, distances);
+    EXPECT_EQ(indices[0], 42u);
+    bool called = false;
+    tree.for_each_knn(
+        0, [&](uint32_t, const uint32_t*, const float*) { called = true; });
+    EXPECT_FALSE(called);
+}
+
+TEST(PointIndex, DISABLED_Benchmark)
+{
+    const auto points = random_points(1 << 21);
+    const auto queries = random_points(1 << 18, 3);
+    const uint32_t k = 8;
+
+    std::unique_ptr<PointKDTree> tree;
+    const double tree_build_ms =
+        time_ms([&] { tree = std::make_unique<PointKDTree>(points); });
+    std::unique_ptr<PointHashGrid> grid;
+    // Cells about the size of the kNN radius.
+    const double grid_build_ms =
+        time_ms([&] { grid = std::make_unique<PointHashGrid>(points, 0.02f); });
+
+    std::vector<uint32_t> indices(queries.size() * k);
+    const double tree_knn_ms = time_ms([&] {
+        tree->knn_batch(queries.cdata(), queries.size(), k, indices.data());
+    });
+    std::vector<uint32_t> grid_indices(queries.size() * k);
+    const double grid_knn_ms = time_ms([&] {
+        grid->knn_batch(
+            queries.cdata(), queries.size(), k, grid_indices.data());
+    });
+    std::vector<uint32_t> self_indices(points.size() * k);
+    const double tree_knn_all_ms =
+        time_ms([&] { tree->knn_all(k, self_indices.data()); });
+    NeighborLists lists;
+    const double tree_radius_ms = time_ms([&] {
+        lists = tree->radius_batch(queries.cdata(), queries.size(), 0.01f);
+    });
+    const double grid_radius_ms = time_ms([&] {
+        lists = grid->radius_batch(queries.cdata(), queries.size(), 0.01f);
+    });
+
+    std::cout << points.size() << " points, " << queries.size()
+              << " queries: kd-tree build " << tree_build_ms << " ms, knn("
+              << k << ") " << tree_knn_ms << " ms, radius " << tree_radius_ms
+              << " ms; hash grid build " << grid_build_ms << " ms, knn "
+              << grid_knn_ms << " ms, radius " << grid_radius_ms
+              << " ms; kd-tree knn of all points " << tree_knn_all_ms << " ms"
+              << std::endl;
+
+    for (size_t q = 0; q < queries.size(); q += 4099) {
+        EXPECT_EQ(indices[q * k], grid_indices[q * k]);
+    }
+    for (size_t i = 0; i < points.size(); i += 4099) {
+        uint32_t expected[k];
+        tree->knn(points[i], k, expected);
+        for (uint32_t j = 0; j < k; ++j) {
+            EXPECT_EQ(self_indices[i * k + j], expected[j]);
+        }
+    }
+}
@@ -0,0 +1,251 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "GCore/Algorithms/qem.h"
+#include "GCore/IO/obj.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+constexpr float pi = 3.14159265358979f;
+
+// (n + 1) x (n + 1) vertices on [0, 1]^2 at height height(x, y).
+template<typename Height>
+TestMesh height_grid(int n, const Height& height)
+{
+    return with_height(triangle_grid(n + 1, 1.0f, Diagonals::uniform), height);
+}
+
+TestMesh grid(int n, float amplitude = 0.0f)
+{
+    return height_grid(n, [&](float x, float y) {
+        return amplitude * std::sin(4 * pi * x) * std::cos(3 * pi * y);
+    });
+}
+
+SimplifiedMesh simplify(const TestMesh& mesh, const QemOptions& options)
+{
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    return qem_simplify(adjacency, mesh.vertices, options);
+}
+
+size_t components(const SimplifiedMesh& mesh)
+{
+    std::vector<int> parent(mesh.vertices.size());
+    for (size_t v = 0; v < parent.size(); ++v) {
+        parent[v] = int(v);
+    }
+    auto find = [&](int v) {
+        while (parent[v] != v) {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    };
+    const auto& f = mesh.face_vertex_indices;
+    for (size_t i = 0; i < f.size(); i += 3) {
+        parent[find(f[i + 1])] = find(f[i]);
+        parent[find(f[i + 2])] = find(f[i]);
+    }
+    size_t count = 0;
+    for (size_t v = 0; v < parent.size(); ++v) {
+        count += find(int(v)) == int(v);
+    }
+    return count;
+}
+
+void expect_simplified_sphere(QemSchedule schedule)
+{
+    const TestMesh mesh = sphere(64, 32, 1.0f);
+    const size_t faces = mesh.counts.size();
+    QemOptions options;
+    options.ratio = 0.1f;
+    options.schedule = schedule;
+    const SimplifiedMesh result = simplify(mesh, options);
+
+    const size_t kept = result.face_vertex_counts.size();
+    EXPECT_LE(kept, size_t(std::ceil(0.1 * faces)));
+    EXPECT_GE(kept, size_t(std::ceil(0.1 * faces)) - 2);
+    ASSERT_EQ(result.face_vertex_indices.size(), 3 * kept);
+
+    expect_closed_manifold(result);
+    for (const auto& v : result.vertices) {
+        EXPECT_NEAR(v.GetLength(), 1.0f, 0.05f);
+    }
+}
+
+void expect_simplified_square(QemSchedule schedule)
+{
+    QemOptions options;
+    options.ratio = 0.02f;
+    options.schedule = schedule;
+    const SimplifiedMesh result = simplify(grid(40), options);
+    ASSERT_GT(result.face_vertex_counts.size(), 0u);
+    EXPECT_LE(
+        result.face_vertex_counts.size(), size_t(std::ceil(0.02 * 3200)));
+
+    // The boundary planes keep the square, the flip check keeps the faces
+    // from overlapping, so they still cover it exactly once.
+    expect_covers_unit_square(result, 1e-5);
+    for (const auto& v : result.vertices) {
+        EXPECT_EQ(v[2], 0.0f);
+    }
+}
+
+}  // namespace
+
+TEST(Qem, ClosedSurfaceStaysManifold)
+{
+    expect_simplified_sphere(QemSchedule::serial);
+}
+
+TEST(Qem, FlatPatchKeepsItsOutline)
+{
+    expect_simplified_square(QemSchedule::serial);
+}
+
+TEST(Qem, ParallelSchedule)
+{
+    expect_simplified_sphere(QemSchedule::parallel);
+    expect_simplified_square(QemSchedule::parallel);
+}
+
+TEST(Qem, NonEdgePairsJoinNearbyParts)
+{
+    // Two copies of a curved sheet 1e-4 apart: contracting the copies into
+    // each other is cheaper than any edge.
+    auto curved = [](float x, float y) { return 0.2f * (x * x + y * y); };
+    TestMesh mesh = height_grid(10, curved);
+    mesh.append(height_grid(10, [&](float x, float y) {
+        return 1e-4f + curved(x, y);
+    }));
+
+    const SimplifiedMesh apart = simplify(mesh, { 0.9f, 0.0f });
+    EXPECT_EQ(components(apart), 2u);
+    const SimplifiedMesh joined = simplify(mesh, { 0.9f, 0.01f });
+    EXPECT_EQ(components(joined), 1u);
+}
+
+void expect_same_mesh(const SimplifiedMesh& a, const SimplifiedMesh& b)
+{
+    ASSERT_EQ(a.vertices.size(), b.vertices.size());
+    for (size_t v = 0; v < a.vertices.size(); ++v) {
+        EXPECT_EQ(a.vertices[v], b.vertices[v]);
+    }
+    EXPECT_EQ(a.face_vertex_counts, b.face_vertex_counts);
+    EXPECT_EQ(a.face_vertex_indices, b.face_vertex_indices);
+}
+
+TEST(Qem, ProgressiveMesh)
+{
+    for (const QemSchedule schedule :
+         { QemSchedule::serial, QemSchedule::parallel }) {
+        const TestMesh mesh = sphere(32, 16, 1.0f);
+        const size_t faces = mesh.counts.size();
+        const MeshAdjacency adjacency(
+            mesh.counts, mesh.indices, mesh.vertices.size());
+        QemOptions options;
+        options.ratio = 0.1f;
+        options.schedule = schedule;
+        const ProgressiveMesh progressive(adjacency, mesh.vertices, options);
+        const std::vector<QemCollapse>& collapses = progressive.collapses();
+        ASSERT_FALSE(collapses.empty());
+
+        // Both ends of the sequence: the input and the simplified mesh.
+        expect_same_mesh(
+            progressive.extract(collapses.size()),
+            qem_simplify(adjacency, mesh.vertices, options));
+        const SimplifiedMesh input = progressive.extract(0);
+        EXPECT_EQ(input.vertices.size(), mesh.vertices.size());
+        EXPECT_EQ(input.face_vertex_indices, mesh.indices);
+
+        for (size_t i = 1; i < collapses.size(); ++i) {
+            EXPECT_LE(collapses[i].face_count, collapses[i - 1].face_count);
+            EXPECT_GE(collapses[i].error, collapses[i - 1].error);
+        }
+
+        // Every level in between is a closed surface with the face count
+        // its last record gives.
+        const size_t count = progressive.collapses_for_face_count(faces / 2);
+        ASSERT_GT(count, 0u);
+        EXPECT_LE(collapses[count - 1].face_count, faces / 2);
+        EXPECT_GT(collapses[count - 2].face_count, faces / 2);
+        const SimplifiedMesh half = progressive.extract(count);
+        EXPECT_EQ(
+            half.face_vertex_counts.size(), collapses[count - 1].face_count);
+        expect_closed_manifold(half);
+
+        EXPECT_EQ(progressive.collapses_for_face_count(faces), 0u);
+        EXPECT_EQ(progressive.collapses_for_face_count(0), collapses.size());
+        const float error = collapses[count - 1].error;
+        const size_t within = progressive.collapses_for_error(error);
+        EXPECT_GE(within, count);
+        EXPECT_TRUE(
+            within == collapses.size() || collapses[within].error > error);
+        EXPECT_EQ(progressive.collapses_for_error(-1.0f), 0u);
+    }
+}
+
+TEST(Qem, Errors)
+{
+    EXPECT_THROW(simplify(quad_grid(2), {}), std::invalid_argument);
+
+    const TestMesh triangles = grid(2);
+    const MeshAdjacency adjacency(
+        triangles.counts, triangles.indices, triangles.vertices.size());
+    EXPECT_THROW(
+        qem_simplify(adjacency, pxr::VtArray<pxr::GfVec3f>(3)),
+        std::invalid_argument);
+}
+
+TEST(Qem, DISABLED_Benchmark)
+{
+    const TestMesh mesh = grid(700, 0.05f);
+    SimplifiedMesh result;
+    const double ms =
+        time_ms([&] { result = simplify(mesh, { 0.01f, 0.0f }); });
+    std::cout << "qem: " << mesh.counts.size() << " -> "
+              << result.face_vertex_counts.size() << " faces: " << ms << " ms"
+              << std::endl;
+}
+
+TEST(Qem, DISABLED_ScheduleBenchmark)
+{
+    for (const char* asset :
+         { "assignment8/horse.obj", "assignment8/spot.obj" }) {
+        const auto path = find_asset(asset);
+        if (path.empty()) {
+            std::cout << "skipping " << asset << ", asset not found"
+                      << std::endl;
+            continue;
+        }
+        const ObjData input = read_obj(path);
+        const MeshAdjacency adjacency(
+            input.face_vertex_counts,
+            input.face_vertex_indices,
+            input.vertices.size());
+        for (const QemSchedule schedule :
+             { QemSchedule::serial, QemSchedule::parallel }) {
+            QemOptions options;
+            options.ratio = 0.1f;
+            options.schedule = schedule;
+            SimplifiedMesh result;
+            const double ms = time_ms([&] {
+                result = qem_simplify(adjacency, input.vertices, options);
+            });
+            const auto [mean, max] =
+                distance_error(input.vertices, result, true);
+            std::cout
+                << "qem " << asset << ", "
+                << (schedule == QemSchedule::serial ? "serial" : "parallel")
+                << ": " << input.face_vertex_counts.size() << " -> "
+                << result.face_vertex_counts.size() << " faces, " << ms
+                << " ms, mean error " << mean << ", max error " << max
+                << std::endl;
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "GCore/Algorithms/remeshing.h"
+#include "GCore/IO/obj.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// n x n cells on [0, 1]^2, two triangles per cell.
+TestMesh grid(int n)
+{
+    return triangle_grid(n + 1, 1.0f, Diagonals::uniform);
+}
+
+RemeshedMesh remesh(const TestMesh& mesh, const RemeshingOptions& options)
+{
+    const MeshAdjacency adjacency(
+        mesh.counts, mesh.indices, mesh.vertices.size());
+    return isotropic_remeshing(adjacency, mesh.vertices, options);
+}
+
+// Fraction of the edges within [low, high] times the target length.
+double fraction_within(
+    const RemeshedMesh& mesh,
+    float target,
+    float low,
+    float high)
+{
+    const auto edges = directed_edges(mesh);
+    size_t within = 0;
+    for (const auto& [edge, uses] : edges) {
+        const float length =
+            (mesh.vertices[edge.first] - mesh.vertices[edge.second])
+                .GetLength();
+        within += length >= low * target && length <= high * target;
+    }
+    return double(within) / edges.size();
+}
+
+}  // namespace
+
+TEST(Remeshing, ClosedSurfaceStaysManifold)
+{
+    const RemeshedMesh result =
+        remesh(sphere(48, 24, 1.0f), { 0.1f, 10, 1.0f });
+    ASSERT_GT(result.face_vertex_counts.size(), 0u);
+
+    expect_closed_manifold(result);
+    // The vertices stay on the sphere.
+    for (const auto& v : result.vertices) {
+        EXPECT_NEAR(v.GetLength(), 1.0f, 0.01f);
+    }
+    EXPECT_GT(fraction_within(result, 0.1f, 0.8f, 4.0f / 3.0f), 0.9);
+}
+
+TEST(Remeshing, FlatPatchKeepsItsOutline)
+{
+    const RemeshedMesh result = remesh(grid(4), { 0.05f, 5, 1.0f });
+    ASSERT_GT(result.face_vertex_counts.size(), 100u);
+
+    expect_covers_unit_square(result, 1e-4);
+    for (const auto& v : result.vertices) {
+        EXPECT_NEAR(v[2], 0.0f, 1e-6f);
+    }
+    EXPECT_GT(fraction_within(result, 0.05f, 0.8f, 4.0f / 3.0f), 0.9);
+}
+
+TEST(Remeshing, CurvatureSizing)
+{
+    const TestMesh ball = sphere(96, 48, 1.0f);
+    const MeshAdjacency adjacency(
+        ball.counts, ball.indices, ball.vertices.size());
+    SizingOptions options;
+    options.error = 1e-3f;
+    const pxr::VtArray<float> sizing =
+        curvature_sizing(adjacency, ball.vertices, options);
+    ASSERT_EQ(sizing.size(), ball.vertices.size());
+    const float expected = std::sqrt(6e-3f - 3e-6f);
+    for (size_t v = 1; v + 1 < sizing.size(); ++v) {
+        EXPECT_NEAR(sizing[v], expected, 0.1f * expected);
+    }
+
+    // No curvature, no limit but the largest length.
+    const TestMesh flat = grid(4);
+    const MeshAdjacency flat_adjacency(
+        flat.counts, flat.indices, flat.vertices.size());
+    for (const float size :
+         curvature_sizing(flat_adjacency, flat.vertices, options)) {
+        EXPECT_EQ(size, options.max_length);
+    }
+}
+
+TEST(Remeshing, AdaptiveFollowsTheSizing)
+{
+    // Targets from 0.05 at the south pole to 0.2 at the north pole.
+    const TestMesh ball = sphere(48, 24, 1.0f);
+    RemeshingOptions options;
+    for (const auto& v : ball.vertices) {
+        options.sizing.push_back(0.05f + 0.075f * (v[2] + 1.0f));
+    }
+    const RemeshedMesh result = remesh(ball, options);
+
+    double south = 0.0, north = 0.0;
+    int south_count = 0, north_count = 0;
+    for (const auto& [edge, uses] : directed_edges(result)) {
+        const pxr::GfVec3f a = result.vertices[edge.first];
+        const pxr::GfVec3f b = result.vertices[edge.second];
+        const float z = 0.5f * (a[2] + b[2]);
+        if (std::abs(z) > 0.8f) {
+            (z < 0 ? south : north) += (a - b).GetLength();
+            ++(z < 0 ? south_count : north_count);
+        }
+    }
+    ASSERT_GT(south_count, 0);
+    ASSERT_GT(north_count, 0);
+    EXPECT_NEAR(south / south_count, 0.05 + 0.075 * 0.1, 0.02);
+    EXPECT_NEAR(north / north_count, 0.05 + 0.075 * 1.9, 0.04);
+
+    // A single small target spreads further with a lower gradation.
+    std::fill(options.sizing.begin(), options.sizing.end(), 0.2f);
+    options.sizing[0] = 0.01f;
+    options.gradation = 1.0f;
+    const size_t steep = remesh(ball, options).face_vertex_counts.size();
+    options.gradation = 0.2f;
+    const size_t smooth = remesh(ball, options).face_vertex_counts.size();
+    EXPECT_GT(smooth, steep);
+}
+
+TEST(Remeshing, Errors)
+{
+    EXPECT_THROW(remesh(quad_grid(2), {}), std::invalid_argument);
+
+    // Three faces on one edge.
+    TestMesh fin;
+    fin.vertices = {
+        { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }
+    };
+    fin.triangle(0, 1, 2);
+    fin.triangle(1, 0, 3);
+    fin.triangle(0, 1, 4);
+    EXPECT_THROW(remesh(fin, {}), std::invalid_argument);
+
+    EXPECT_THROW(remesh(grid(2), { 0.0f }), std::invalid_argument);
+    RemeshingOptions sized;
+    sized.sizing = { 0.1f, 0.1f };
+    EXPECT_THROW(remesh(grid(2), sized), std::invalid_argument);
+    sized.sizing = { 0.1f, 0.1f, 0.1f, 0.1f };
+    sized.gradation = -1.0f;
+    EXPECT_THROW(remesh(grid(2), sized), std::invalid_argument);
+    sized.gradation = std::numeric_limits<float>::infinity();
+    EXPECT_THROW(remesh(grid(2), sized), std::invalid_argument);
+}
+
+TEST(Remeshing, DISABLED_Benchmark)
+{
+    const auto path = find_asset("assignment9/bunny.obj");
+    if (path.empty()) {
+        GTEST_SKIP() << "assignment9/bunny.obj not found";
+    }
+    const ObjData input = read_obj(path);
+    const MeshAdjacency adjacency(
+        input.face_vertex_counts,
+        input.face_vertex_indices,
+        input.vertices.size());
+    for (const float length : { 0.02f, 0.01f }) {
+        RemeshedMesh result;
+        const double ms = time_ms([&] {
+            result =
+                isotropic_remeshing(adjacency, input.vertices, { length, 10 });
+        });
+        std::cout << "isotropic remeshing, target " << length << ": "
+                  << input.face_vertex_counts.size() << " -> "
+                  << result.face_vertex_counts.size() << " faces, " << ms
+                  << " ms, "
+                  << 100 * fraction_within(result, length, 0.8f, 4.0f / 3.0f)
+                  << "% of the edges within bounds" << std::endl;
+    }
+
+    // Adaptive against uniform lengths at about the same largest distance
+    // from the input.
+    SizingOptions sizing;
+    sizing.error = 5e-4f;
+    sizing.min_length = 0.002f;
+    sizing.max_length = 0.1f;
+    RemeshingOptions adaptive;
+    adaptive.sizing = curvature_sizing(adjacency, input.vertices, sizing);
+    adaptive.gradation = 0.3f;
+    for (const RemeshingOptions& options :
+         { RemeshingOptions{ 0.01f }, adaptive }) {
+        RemeshedMesh result;
+        const double ms = time_ms([&] {
+            result = isotropic_remeshing(adjacency, input.vertices, options);
+        });
+        const auto [mean, max] = distance_error(input.vertices, result);
+        std::cout << "isotropic remeshing, "
+                  << (options.sizing.empty() ? "uniform" : "adaptive") << ": "
+                  << result.face_vertex_counts.size() << " faces, " << ms
+                  << " ms, mean error " << mean << ", max error " << max
+                  << std::endl;
+    }
+}
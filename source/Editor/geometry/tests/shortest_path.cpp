@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "GCore/Algorithms/shortest_path.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// n x n unit spaced grid, split along the (i, j) -> (i + 1, j + 1) diagonal.
+TestMesh unit_grid(int n)
+{
+    return triangle_grid(n, float(n - 1), Diagonals::uniform);
+}
+
+float path_length(
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const std::vector<uint32_t>& path)
+{
+    float length = 0.0f;
+    for (size_t i = 1; i < path.size(); ++i) {
+        length += (vertices[path[i]] - vertices[path[i - 1]]).GetLength();
+    }
+    return length;
+}
+}  // namespace
+
+TEST(ShortestPath, EdgeGraph)
+{
+    const TestMesh grid = unit_grid(3);
+    const EdgeGraph graph(grid.counts, grid.indices, 9);
+    const auto& neighbors = graph.neighbors();
+    // The center touches every other vertex but the two off its diagonal.
+    EXPECT_EQ(neighbors.count(4), 6u);
+    EXPECT_EQ(
+        std::vector<uint32_t>(neighbors.begin(0), neighbors.end(0)),
+        (std::vector<uint32_t>{ 1, 3, 4 }));
+    EXPECT_EQ(neighbors.count(2), 2u);
+
+    pxr::VtArray<int> bad = grid.indices;
+    bad[0] = 9;
+    EXPECT_THROW(EdgeGraph(grid.counts, bad, 9), std::invalid_argument);
+}
+
+TEST(ShortestPath, MethodsAgree)
+{
+    const int n = 30;
+    const TestMesh grid = unit_grid(n);
+    const EdgeGraph graph(grid.counts, grid.indices, n * n);
+    ShortestPathSearch search;
+    std::vector<uint32_t> path;
+    float distance = 0.0f;
+
+    // Corner to corner runs along the diagonal.
+    const uint32_t last = n * n - 1;
+    size_t settled[3];
+    int m = 0;
+    for (auto method : { PathSearch::dijkstra,
+                         PathSearch::a_star,
+                         PathSearch::bidirectional }) {
+        ASSERT_TRUE(search.find(
+            graph, grid.vertices, 0, last, path, distance, method));
+        EXPECT_NEAR(distance, (n - 1) * std::sqrt(2.0f), 1e-3f);
+        EXPECT_EQ(path.size(), size_t(n));
+        EXPECT_EQ(path.front(), 0u);
+        EXPECT_EQ(path.back(), last);
+        EXPECT_NEAR(path_length(grid.vertices, path), distance, 1e-3f);
+        settled[m++] = search.settled_count();
+    }
+    EXPECT_LT(settled[1], settled[0] / 4);
+    EXPECT_LT(settled[2], settled[0]);
+
+    // Random pairs on a perturbed grid, reusing the same search state.
+    TestMesh bumpy = grid;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+    for (auto& v : bumpy.vertices) {
+        v += pxr::GfVec3f(jitter(rng), jitter(rng), jitter(rng));
+    }
+    std::uniform_int_distribution<uint32_t> pick(0, n * n - 1);
+    for (int query = 0; query < 50; ++query) {
+        const uint32_t a = pick(rng);
+        const uint32_t b = pick(rng);
+        float reference = 0.0f;
+        ASSERT_TRUE(search.find(
+            graph,
+            bumpy.vertices,
+            a,
+            b,
+            path,
+            reference,
+            PathSearch::dijkstra));
+        for (auto method : { PathSearch::a_star, PathSearch::bidirectional }) {
+            ASSERT_TRUE(search.find(
+                graph, bumpy.vertices, a, b, path, distance, method));
+            EXPECT_NEAR(distance, reference, 1e-4f * (1 + reference));
+            EXPECT_NEAR(
+                path_length(bumpy.vertices, path),
+                distance,
+                1e-4f * (1 + reference));
+        }
+    }
+}
+
+TEST(ShortestPath, Unreachable)
+{
+    pxr::VtArray<int> counts = { 3, 3 };
+    pxr::VtArray<int> indices = { 0, 1, 2, 3, 4, 5 };
+    pxr::VtArray<pxr::GfVec3f> vertices(6, pxr::GfVec3f(0.0f));
+    for (int i = 0; i < 6; ++i) {
+        vertices[i] = pxr::GfVec3f(float(i), float(i % 3), 0.0f);
+    }
+    const EdgeGraph graph(counts, indices, 6);
+    ShortestPathSearch search;
+    std::vector<uint32_t> path;
+    float distance = 0.0f;
+    for (auto method : { PathSearch::dijkstra,
+                         PathSearch::a_star,
+                         PathSearch::bidirectional }) {
+        EXPECT_FALSE(
+            search.find(graph, vertices, 0, 4, path, distance, method));
+        EXPECT_TRUE(path.empty());
+    }
+    EXPECT_TRUE(search.find(graph, vertices, 2, 2, path, distance));
+    EXPECT_EQ(path, std::vector<uint32_t>{ 2 });
+    EXPECT_EQ(distance, 0.0f);
+    EXPECT_THROW(
+        search.find(graph, vertices, 0, 6, path, distance),
+        std::invalid_argument);
+}
+
+TEST(ShortestPath, DISABLED_Benchmark)
+{
+    const int n = 1415;
+    const TestMesh grid = unit_grid(n);
+    std::unique_ptr<EdgeGraph> graph;
+    const double graph_ms = time_ms([&] {
+        graph = std::make_unique<EdgeGraph>(
+            grid.counts, grid.indices, grid.vertices.size());
+    });
+    std::cout << "shortest path graph " << grid.vertices.size() / 1e6
+              << "M vertices: " << graph_ms << " ms" << std::endl;
+
+    ShortestPathSearch search;
+    std::vector<uint32_t> path;
+    float distance = 0.0f;
+    // Across the mesh, off the diagonal so that the path is not unique.
+    const uint32_t source = 10 * n + 5;
+    const uint32_t target = (n - 3) * n + n / 3;
+    for (auto method : { PathSearch::dijkstra,
+                         PathSearch::a_star,
+                         PathSearch::bidirectional }) {
+        for (int repeat = 0; repeat < 2; ++repeat) {
+            bool found = false;
+            const double ms = time_ms([&] {
+                found = search.find(
+                    *graph,
+                    grid.vertices,
+                    source,
+                    target,
+                    path,
+                    distance,
+                    method);
+            });
+            ASSERT_TRUE(found);
+            std::cout
+                << "shortest path "
+                << (method == PathSearch::dijkstra ? "dijkstra"
+                    : method == PathSearch::a_star ? "a*"
+                                                   : "bidirectional")
+                << (repeat ? " (reused)" : "") << ": " << ms << " ms, "
+                << search.settled_count() << " settled" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/stl.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+StlData parse(const std::string& text)
+{
+    return parse_stl(text.data(), text.size());
+}
+}  // namespace
+
+TEST(Stl, Ascii)
+{
+    const StlData data = parse(
+        "solid test\n"
+        "  facet normal 0 0 1\n"
+        "    outer loop\n"
+        "      vertex 0 0 0\n"
+        "      vertex 1 0 0\n"
+        "      vertex 0 1.5e0 0\n"
+        "    endloop\n"
+        "  endfacet\n"
+        "  facet normal 0 0 -1\n"
+        "    outer loop\n"
+        "      vertex 1 0 0\n"
+        "      vertex 0 0 0\n"
+        "      vertex 0 -1 0\n"
+        "    endloop\n"
+        "  endfacet\n"
+        "endsolid test\n");
+    ASSERT_EQ(data.corners.size(), 6u);
+    EXPECT_EQ(data.corners[2], pxr::GfVec3f(0, 1.5f, 0));
+    EXPECT_EQ(data.facet_normals[1], pxr::GfVec3f(0, 0, -1));
+
+    const WeldResult welded = weld_vertices(data.corners);
+    ASSERT_EQ(welded.vertices.size(), 4u);
+    const std::vector<int> expected = { 0, 1, 2, 1, 0, 3 };
+    EXPECT_EQ(
+        std::vector<int>(welded.indices.begin(), welded.indices.end()),
+        expected);
+
+    EXPECT_THROW(parse("solid x\nfacet normal 0 0\n"), std::runtime_error);
+    EXPECT_THROW(parse("solid x\nfacet outer\n"), std::runtime_error);
+    EXPECT_THROW(parse("not an stl"), std::runtime_error);
+}
+
+TEST(Stl, WeldTolerance)
+{
+    const pxr::VtArray<pxr::GfVec3f> corners = {
+        { 0, 0, 0 },    { 1, 0, 0 },         { 0, 1, 0 },
+        { -0.0f, 0, 0 }, { 1.0001f, 0, 0 }, { 0, 1, 0 },
+    };
+    // Exact: -0 and +0 are the same point, 1.0001 is not.
+    const WeldResult exact = weld_vertices(corners);
+    EXPECT_EQ(exact.vertices.size(), 4u);
+    EXPECT_EQ(exact.indices[3], 0);
+    EXPECT_EQ(exact.indices[5], 2);
+    EXPECT_EQ(exact.indices[4], 3);
+
+    const WeldResult snapped = weld_vertices(corners, 0.01f);
+    EXPECT_EQ(snapped.vertices.size(), 3u);
+    EXPECT_EQ(snapped.indices[4], 1);
+    EXPECT_EQ(snapped.vertices[1], pxr::GfVec3f(1, 0, 0));
+}
+
+TEST(Stl, BinaryRoundTrip)
+{
+    const Geometry geometry = grid_geometry(20, GridFaces::first_quad);
+    const auto mesh = geometry.get_component<MeshComponent>();
+    const auto path = temp_path("gcore_stl_round_trip.stl");
+    write_stl(path, *mesh);
+    const StlData data = read_stl(path);
+    std::filesystem::remove(path);
+
+    const auto vertices = mesh->get_vertices();
+    const auto indices = mesh->get_face_vertex_indices();
+    // One quad became two triangles.
+    ASSERT_EQ(data.corners.size(), indices.size() + 2);
+    for (const auto& normal : data.facet_normals) {
+        EXPECT_NEAR(normal.GetLength(), 1.0f, 1e-5f);
+    }
+
+    const Geometry welded = stl_to_geometry(data);
+    const auto result = welded.get_component<MeshComponent>();
+    // Every grid vertex is used, so welding recovers all of them.
+    EXPECT_EQ(result->get_vertices().size(), vertices.size());
+    const auto result_indices = result->get_face_vertex_indices();
+    const auto result_vertices = result->get_vertices();
+    for (size_t i = 0; i < data.corners.size(); ++i) {
+        EXPECT_EQ(result_vertices[result_indices[i]], data.corners[i]);
+    }
+}
+
+TEST(Stl, DISABLED_Benchmark)
+{
+    const Geometry geometry = grid_geometry(1000);
+    const auto mesh = geometry.get_component<MeshComponent>();
+    const auto path = temp_path("gcore_stl_benchmark.stl");
+    const double write_ms = time_ms([&] { write_stl(path, *mesh); });
+    const auto bytes = std::filesystem::file_size(path);
+    StlData data;
+    const double read_ms = time_ms([&] { data = read_stl(path); });
+    std::filesystem::remove(path);
+    WeldResult welded;
+    const double weld_ms =
+        time_ms([&] { welded = weld_vertices(data.corners); });
+
+    std::cout << "stl " << bytes / (1 << 20) << " MiB: write " << write_ms
+              << " ms, read " << read_ms << " ms, weld " << weld_ms << " ms"
+              << std::endl;
+    EXPECT_EQ(welded.vertices.size(), mesh->get_vertices().size());
+}
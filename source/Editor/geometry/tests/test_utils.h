@@ -0,0 +1,312 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "GCore/Algorithms/bvh.h"
+#include "GCore/Components/MeshOperand.h"
+
+// Helpers shared by the geometry tests. The benchmarks among the tests are
+// disabled by default; run them with --gtest_also_run_disabled_tests, e.g.
+// --gtest_filter=*Benchmark* --gtest_also_run_disabled_tests.
+
+// Wall time of f() in milliseconds.
+template<typename F>
+double time_ms(F&& f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// A mesh as the arrays of a MeshComponent.
+struct TestMesh {
+    pxr::VtArray<pxr::GfVec3f> vertices;
+    pxr::VtArray<int> counts;
+    pxr::VtArray<int> indices;
+
+    void face(std::initializer_list<int> corners)
+    {
+        counts.push_back(int(corners.size()));
+        for (int v : corners) {
+            indices.push_back(v);
+        }
+    }
+
+    void triangle(int a, int b, int c)
+    {
+        face({ a, b, c });
+    }
+
+    // Adds the vertices and faces of other, as a separate component.
+    void append(const TestMesh& other)
+    {
+        const int first = int(vertices.size());
+        for (const auto& p : other.vertices) {
+            vertices.push_back(p);
+        }
+        for (int count : other.counts) {
+            counts.push_back(count);
+        }
+        for (int v : other.indices) {
+            indices.push_back(first + v);
+        }
+    }
+};
+
+// How the cells of a grid are split into two triangles.
+enum class Diagonals {
+    // Along (i, j) -> (i + 1, j + 1) and (i + 1, j) -> (i, j + 1) in turn,
+    // so that the edge graph has no preferred direction.
+    alternating,
+    // Along (i, j) -> (i + 1, j + 1) everywhere.
+    uniform,
+};
+
+// n x n vertices on [0, size]^2 in the xy plane, vertex (i, j) at index
+// i * n + j and position (i, j) * size / (n - 1), with two counterclockwise
+// triangles per cell.
+inline TestMesh triangle_grid(
+    int n,
+    float size = 1.0f,
+    Diagonals diagonals = Diagonals::alternating)
+{
+    TestMesh mesh;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            mesh.vertices.push_back(pxr::GfVec3f(
+                size * float(i) / (n - 1), size * float(j) / (n - 1), 0.0f));
+        }
+    }
+    for (int i = 0; i + 1 < n; ++i) {
+        for (int j = 0; j + 1 < n; ++j) {
+            const int a = i * n + j, b = a + n, c = a + n + 1, d = a + 1;
+            if (diagonals == Diagonals::alternating && (i + j) % 2) {
+                mesh.triangle(a, b, d);
+                mesh.triangle(b, c, d);
+            }
+            else {
+                mesh.triangle(a, b, c);
+                mesh.triangle(a, c, d);
+            }
+        }
+    }
+    return mesh;
+}
+
+// The vertices of triangle_grid() with one counterclockwise quad per cell.
+inline TestMesh quad_grid(int n, float size = 1.0f)
+{
+    TestMesh mesh = triangle_grid(n, size);
+    mesh.counts.clear();
+    mesh.indices.clear();
+    for (int i = 0; i + 1 < n; ++i) {
+        for (int j = 0; j + 1 < n; ++j) {
+            const int a = i * n + j;
+            mesh.face({ a, a + n, a + n + 1, a + 1 });
+        }
+    }
+    return mesh;
+}
+
+// The mesh with every vertex moved to height z(x, y).
+template<typename Height>
+TestMesh with_height(TestMesh mesh, Height z)
+{
+    for (auto& p : mesh.vertices) {
+        p[2] = z(p[0], p[1]);
+    }
+    return mesh;
+}
+
+// Latitude-longitude sphere of radius r with outward facing triangles.
+// Vertex 0 is the south pole and the last one the north pole.
+inline TestMesh sphere(int around, int rings, float r)
+{
+    constexpr float pi = 3.14159265358979f;
+    TestMesh mesh;
+    mesh.vertices.push_back(pxr::GfVec3f(0, 0, -r));
+    for (int j = 1; j < rings; ++j) {
+        const float theta = pi * j / rings;
+        for (int i = 0; i < around; ++i) {
+            const float phi = 2 * pi * i / around;
+            mesh.vertices.push_back(
+                r * pxr::GfVec3f(
+                        std::sin(theta) * std::cos(phi),
+                        std::sin(theta) * std::sin(phi),
+                        -std::cos(theta)));
+        }
+    }
+    mesh.vertices.push_back(pxr::GfVec3f(0, 0, r));
+    const int north = int(mesh.vertices.size()) - 1;
+    auto ring = [&](int j, int i) { return 1 + (j - 1) * around + i % around; };
+    for (int i = 0; i < around; ++i) {
+        mesh.triangle(0, ring(1, i + 1), ring(1, i));
+        for (int j = 1; j + 1 < rings; ++j) {
+            mesh.triangle(ring(j, i), ring(j, i + 1), ring(j + 1, i + 1));
+            mesh.triangle(ring(j, i), ring(j + 1, i + 1), ring(j + 1, i));
+        }
+        mesh.triangle(ring(rings - 1, i), ring(rings - 1, i + 1), north);
+    }
+    return mesh;
+}
+
+// Uses of each directed edge of a triangle mesh with flat face arrays, such
+// as a SimplifiedMesh or a RemeshedMesh.
+template<typename Mesh>
+std::map<std::pair<int, int>, int> directed_edges(const Mesh& mesh)
+{
+    std::map<std::pair<int, int>, int> edges;
+    const auto& f = mesh.face_vertex_indices;
+    for (size_t i = 0; i < f.size(); i += 3) {
+        for (size_t k = 0; k < 3; ++k) {
+            ++edges[{ f[i + k], f[i + (k + 1) % 3] }];
+        }
+    }
+    return edges;
+}
+
+// Every edge of the triangle mesh has one face on each side, and the mesh
+// has Euler characteristic `euler`.
+template<typename Mesh>
+void expect_closed_manifold(const Mesh& mesh, int euler = 2)
+{
+    ASSERT_EQ(
+        mesh.face_vertex_indices.size(), 3 * mesh.face_vertex_counts.size());
+    const auto edges = directed_edges(mesh);
+    for (const auto& [edge, uses] : edges) {
+        EXPECT_EQ(uses, 1);
+        ASSERT_NE(edges.find({ edge.second, edge.first }), edges.end());
+    }
+    EXPECT_EQ(
+        int(mesh.vertices.size()) - int(edges.size() / 2) +
+            int(mesh.face_vertex_counts.size()),
+        euler);
+}
+
+// The triangles of the mesh all face +z and cover the unit square in the xy
+// plane exactly once, their area within `tolerance` of 1.
+template<typename Mesh>
+void expect_covers_unit_square(const Mesh& mesh, double tolerance)
+{
+    double area = 0.0;
+    const auto& f = mesh.face_vertex_indices;
+    for (size_t i = 0; i < f.size(); i += 3) {
+        const pxr::GfVec3f a = mesh.vertices[f[i]];
+        const pxr::GfVec3f b = mesh.vertices[f[i + 1]];
+        const pxr::GfVec3f c = mesh.vertices[f[i + 2]];
+        const pxr::GfVec3f n = pxr::GfCross(b - a, c - a);
+        EXPECT_GT(n[2], 0.0f);
+        area += 0.5 * n[2];
+    }
+    EXPECT_NEAR(area, 1.0, tolerance);
+    for (const auto& v : mesh.vertices) {
+        EXPECT_GE(v[0], -1e-6f);
+        EXPECT_LE(v[0], 1 + 1e-6f);
+        EXPECT_GE(v[1], -1e-6f);
+        EXPECT_LE(v[1], 1 + 1e-6f);
+    }
+}
+
+// Distances from `points` to the surface of the triangle mesh: mean and
+// maximum, divided by the diagonal of the mesh's bounding box when
+// `relative`.
+template<typename Mesh>
+std::pair<double, double> distance_error(
+    const pxr::VtArray<pxr::GfVec3f>& points,
+    const Mesh& mesh,
+    bool relative = false)
+{
+    const USTC_CG::MeshBVH bvh(
+        mesh.vertices, mesh.face_vertex_counts, mesh.face_vertex_indices);
+    std::vector<USTC_CG::ClosestPoint> closest(points.size());
+    bvh.closest_points(points.cdata(), points.size(), closest.data());
+    const USTC_CG::BoundingBox bounds = bvh.bounds();
+    const double scale =
+        relative ? (bounds.max - bounds.min).GetLength() : 1.0;
+    double sum = 0.0, max = 0.0;
+    for (const USTC_CG::ClosestPoint& c : closest) {
+        const double d = std::sqrt(double(c.distance_squared)) / scale;
+        sum += d;
+        max = std::max(max, d);
+    }
+    return { sum / closest.size(), max };
+}
+
+// The file at `relative` in the assignments directory, searched from the
+// working directory upwards; empty when there is none.
+inline std::filesystem::path find_asset(const std::string& relative)
+{
+    auto dir = std::filesystem::current_path();
+    while (true) {
+        auto candidate = dir / "assignments" / relative;
+        if (std::filesystem::exists(candidate)) {
+            return candidate;
+        }
+        if (!dir.has_parent_path() || dir.parent_path() == dir) {
+            return {};
+        }
+        dir = dir.parent_path();
+    }
+}
+
+// Which faces grid_geometry() builds.
+enum class GridFaces {
+    triangles,
+    // Triangles, but a quad in the first cell to cover fan triangulation.
+    first_quad,
+    quads,
+};
+
+// n x n vertices 0.1 apart with varying heights, as the mesh component of a
+// new geometry.
+inline USTC_CG::Geometry grid_geometry(
+    int n,
+    GridFaces faces = GridFaces::triangles)
+{
+    const float size = 0.1f * (n - 1);
+    TestMesh grid = faces == GridFaces::quads
+                        ? quad_grid(n, size)
+                        : triangle_grid(n, size, Diagonals::uniform);
+    if (faces == GridFaces::first_quad) {
+        TestMesh mixed;
+        mixed.vertices = grid.vertices;
+        mixed.face({ 0, n, n + 1, 1 });
+        for (size_t f = 2; f < grid.counts.size(); ++f) {
+            mixed.triangle(
+                grid.indices[3 * f],
+                grid.indices[3 * f + 1],
+                grid.indices[3 * f + 2]);
+        }
+        grid = mixed;
+    }
+    for (int v = 0; v < n * n; ++v) {
+        grid.vertices[v][2] = 0.01f * ((v / n * 7 + v % n * 13) % 17);
+    }
+    USTC_CG::Geometry geometry;
+    auto mesh = std::make_shared<USTC_CG::MeshComponent>(&geometry);
+    geometry.attach_component(mesh);
+    mesh->set_vertices(grid.vertices);
+    mesh->set_face_vertex_counts(grid.counts);
+    mesh->set_face_vertex_indices(grid.indices);
+    return geometry;
+}
+
+// A path in the system's temporary directory.
+inline std::filesystem::path temp_path(const char* name)
+{
+    return std::filesystem::temp_directory_path() / name;
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <random>
+
+#include "GCore/Algorithms/transform.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+pxr::VtArray<pxr::GfVec3f> random_points(size_t count, unsigned seed = 7)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    pxr::VtArray<pxr::GfVec3f> points(count);
+    for (auto& p : points) {
+        p = pxr::GfVec3f(dist(rng), dist(rng), dist(rng));
+    }
+    return points;
+}
+
+pxr::GfMatrix4d test_matrix()
+{
+    pxr::GfMatrix4d m(1.0);
+    m[0][0] = 0.8;
+    m[0][1] = 0.3;
+    m[0][2] = -0.2;
+    m[1][0] = -0.1;
+    m[1][1] = 1.7;
+    m[1][2] = 0.4;
+    m[2][0] = 0.5;
+    m[2][1] = -0.6;
+    m[2][2] = 2.5;
+    m[3][0] = 3.0;
+    m[3][1] = -4.0;
+    m[3][2] = 0.25;
+    return m;
+}
+}  // namespace
+
+TEST(Transform, PointsMatchGfTransform)
+{
+    const auto m = test_matrix();
+    // Odd size so both the SIMD body and the scalar tail are exercised.
+    for (size_t count :
+         { size_t(1), size_t(13), size_t(1027), size_t(100003) }) {
+        auto points = random_points(count);
+        auto expected = points;
+        for (auto& p : expected) {
+            p = pxr::GfVec3f(m.Transform(p));
+        }
+
+        transform_points(points, m);
+        for (size_t i = 0; i < count; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                EXPECT_NEAR(points[i][k], expected[i][k], 1e-5f);
+            }
+        }
+
+        auto points_f = random_points(count);
+        transform_points(points_f, pxr::GfMatrix4f(m));
+        for (size_t i = 0; i < count; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                EXPECT_NEAR(points_f[i][k], expected[i][k], 1e-3f);
+            }
+        }
+    }
+}
+
+TEST(Transform, ProjectiveFallsBackToHomogeneousDivide)
+{
+    auto m = test_matrix();
+    m[0][3] = 0.01;
+    m[3][3] = 2.0;
+
+    auto points = random_points(100);
+    auto expected = points;
+    for (auto& p : expected) {
+        p = pxr::GfVec3f(m.Transform(p));
+    }
+    transform_points(points, m);
+    for (size_t i = 0; i < points.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            EXPECT_NEAR(points[i][k], expected[i][k], 1e-4f);
+        }
+    }
+}
+
+TEST(Transform, NormalsStayPerpendicular)
+{
+    const auto m = test_matrix();
+    auto a = random_points(1001, 1);
+    auto b = random_points(1001, 2);
+
+    pxr::VtArray<pxr::GfVec3f> normals(a.size());
+    pxr::VtArray<pxr::GfVec3f> tangents(a.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        normals[i] = pxr::GfCross(a[i], b[i]).GetNormalized();
+        tangents[i] = a[i];
+    }
+
+    transform_normals(normals, m);
+    for (size_t i = 0; i < normals.size(); ++i) {
+        const pxr::GfVec3f t = pxr::GfVec3f(m.TransformDir(tangents[i]));
+        EXPECT_NEAR(normals[i].GetLength(), 1.0f, 1e-5f);
+        EXPECT_NEAR(pxr::GfDot(normals[i], t.GetNormalized()), 0.0f, 1e-4f);
+    }
+}
+
+TEST(Transform, DISABLED_Benchmark)
+{
+    const auto m = test_matrix();
+    const auto source = random_points(1 << 22);
+
+    auto reference = source;
+    const double loop_ms = time_ms([&] {
+        for (auto& vertex : reference) {
+            vertex = pxr::GfVec3f(m.Transform(vertex));
+        }
+    });
+
+    auto batched = source;
+    const double batched_ms = time_ms([&] { transform_points(batched, m); });
+
+    auto batched_f = source;
+    const pxr::GfMatrix4f mf(m);
+    const double batched_f_ms =
+        time_ms([&] { transform_points(batched_f, mf); });
+
+    std::cout << "transform " << source.size() << " points: per-vertex loop "
+              << loop_ms << " ms, batched double " << batched_ms
+              << " ms, batched float " << batched_f_ms << " ms" << std::endl;
+
+    for (size_t i = 0; i < source.size(); i += 997) {
+        for (int k = 0; k < 3; ++k) {
+            EXPECT_NEAR(batched[i][k], reference[i][k], 1e-5f);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "GCore/Algorithms/tutte.h"
+#include "GCore/Components/MeshOperand.h"
+#include "test_utils.h"
+
+using namespace USTC_CG;
+
+namespace {
+// n x n grid on [0, 1]^2 with a bump in z.
+TestMesh bumpy_grid(int n)
+{
+    return with_height(triangle_grid(n), [](float x, float y) {
+        return 2.0f * x * (1 - x) * y * (1 - y);
+    });
+}
+
+// Smallest signed area of the triangles in the XY plane.
+float min_signed_area(
+    const TestMesh& grid,
+    const pxr::VtArray<pxr::GfVec3f>& uv)
+{
+    float result = std::numeric_limits<float>::max();
+    for (size_t c = 0; c < grid.indices.size(); c += 3) {
+        const pxr::GfVec3f a = uv[grid.indices[c]];
+        const pxr::GfVec3f e1 = uv[grid.indices[c + 1]] - a;
+        const pxr::GfVec3f e2 = uv[grid.indices[c + 2]] - a;
+        result = std::min(result, e1[0] * e2[1] - e1[1] * e2[0]);
+    }
+    return result;
+}
+}  // namespace
+
+TEST(Tutte, BoundaryLoop)
+{
+    const int n = 6;
+    const TestMesh grid = bumpy_grid(n);
+    const MeshAdjacency adjacency(grid.counts, grid.indices, n * n);
+    const auto loop = boundary_loop(adjacency);
+    ASSERT_EQ(loop.size(), size_t(4 * (n - 1)));
+    // Counterclockwise like the faces: from (0, 0) towards (1, 0).
+    const auto start = std::find(loop.begin(), loop.end(), 0u);
+    ASSERT_NE(start, loop.end());
+    EXPECT_EQ(*(start + 1 == loop.end() ? loop.begin() : start + 1), 6u);
+
+    pxr::VtArray<int> counts = { 3, 3 }, indices = { 0, 1, 2, 0, 2, 1 };
+    EXPECT_TRUE(boundary_loop(MeshAdjacency(counts, indices, 3)).empty());
+}
+
+TEST(Tutte, DiskParameterization)
+{
+    const TestMesh grid = bumpy_grid(21);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    for (auto weights :
+         { LaplacianWeights::uniform, LaplacianWeights::mean_value }) {
+        TutteOptions options;
+        options.weights = weights;
+        const TutteEmbedding tutte(adjacency, grid.vertices, options);
+        const auto uv = tutte.embed(grid.vertices);
+        for (const auto& p : uv) {
+            EXPECT_LE(p[0] * p[0] + p[1] * p[1], 1.0f + 1e-5f);
+            EXPECT_EQ(p[2], 0.0f);
+        }
+        // Positive weights and a convex boundary give an embedding.
+        EXPECT_GT(min_signed_area(grid, uv), 0.0f);
+
+        options.max_factored_vertices = 0;
+        const TutteEmbedding iterative(adjacency, grid.vertices, options);
+        EXPECT_FALSE(iterative.factored());
+        const auto uv_iterative = iterative.embed(grid.vertices);
+        for (size_t v = 0; v < uv.size(); ++v) {
+            EXPECT_LT((uv[v] - uv_iterative[v]).GetLength(), 1e-5f);
+        }
+    }
+}
+
+TEST(Tutte, MinimalSurface)
+{
+    TestMesh grid = bumpy_grid(21);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    TutteOptions options;
+    options.boundary = TutteBoundary::fixed;
+
+    // The boundary is planar, so the harmonic surface is flat, and the
+    // cotangent and mean value weights reproduce a planar mesh exactly.
+    for (auto weights :
+         { LaplacianWeights::cotangent, LaplacianWeights::mean_value }) {
+        options.weights = weights;
+        auto flat = grid.vertices;
+        for (auto& p : flat) {
+            p[2] = 0.0f;
+        }
+        const auto surface =
+            TutteEmbedding(adjacency, flat, options).embed(grid.vertices);
+        for (size_t v = 0; v < flat.size(); ++v) {
+            EXPECT_LT((surface[v] - flat[v]).GetLength(), 1e-5f);
+        }
+    }
+
+    options.weights = LaplacianWeights::uniform;
+    const TutteEmbedding tutte(adjacency, grid.vertices, options);
+    const auto surface = tutte.embed(grid.vertices);
+    for (uint32_t v : tutte.boundary()) {
+        EXPECT_EQ(surface[v], grid.vertices[v]);
+    }
+    for (const auto& p : surface) {
+        EXPECT_NEAR(p[2], 0.0f, 1e-6f);
+    }
+
+    EXPECT_THROW(
+        (void)tutte.embed(pxr::VtArray<pxr::GfVec3f>(3)),
+        std::invalid_argument);
+}
+
+TEST(Tutte, UpdateReusesFactorization)
+{
+    const TestMesh grid = bumpy_grid(6);
+    Geometry geometry;
+    MeshComponent mesh(&geometry);
+    mesh.set_vertices(grid.vertices);
+    mesh.set_face_vertex_counts(grid.counts);
+    mesh.set_face_vertex_indices(grid.indices);
+
+    TutteOptions uniform, cotangent;
+    cotangent.weights = LaplacianWeights::cotangent;
+    auto first = TutteEmbedding::update(nullptr, mesh, uniform);
+    auto second = TutteEmbedding::update(nullptr, mesh, cotangent);
+    EXPECT_EQ(TutteEmbedding::update(first, mesh, uniform), first);
+    EXPECT_NE(TutteEmbedding::update(first, mesh, cotangent), first);
+
+    // Uniform weights ignore the positions.
+    auto moved = grid.vertices;
+    moved[7][2] = 0.1f;
+    mesh.set_vertices(moved);
+    EXPECT_EQ(TutteEmbedding::update(first, mesh, uniform), first);
+    EXPECT_NE(TutteEmbedding::update(second, mesh, cotangent), second);
+}
+
+TEST(Tutte, DISABLED_Benchmark)
+{
+    const int n = 1000;
+    const TestMesh grid = bumpy_grid(n);
+    auto adjacency = std::make_shared<MeshAdjacency>(
+        grid.counts, grid.indices, grid.vertices.size());
+    std::unique_ptr<TutteEmbedding> tutte;
+    const double setup_ms = time_ms([&] {
+        tutte = std::make_unique<TutteEmbedding>(adjacency, grid.vertices);
+    });
+    const double embed_ms =
+        time_ms([&] { (void)tutte->embed(grid.vertices); });
+    std::cout << "tutte " << grid.vertices.size() / 1e6 << "M vertices, "
+              << (tutte->factored() ? "factored" : "multigrid")
+              << ": setup " << setup_ms << " ms, embed " << embed_ms << " ms"
+              << std::endl;
+}
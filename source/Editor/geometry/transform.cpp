@@ -0,0 +1,559 @@
+#include "GCore/Algorithms/transform.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GCORE_TRANSFORM_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define GCORE_TARGET_AVX2
+#else
+#define GCORE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GCORE_TRANSFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+
+// Rows 0-2 hold the images of the x, y and z axes, row 3 the translation.
+template<typename T>
+struct AffineRows {
+    T m[4][3];
+};
+
+template<typename T, typename Matrix>
+AffineRows<T> affine_rows(const Matrix& matrix)
+{
+    AffineRows<T> rows;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            rows.m[i][j] = static_cast<T>(matrix[i][j]);
+        }
+    }
+    return rows;
+}
+
+template<typename Matrix>
+bool is_affine(const Matrix& matrix)
+{
+    return matrix[0][3] == 0 && matrix[1][3] == 0 && matrix[2][3] == 0 &&
+           matrix[3][3] == 1;
+}
+
+template<typename T>
+void transform_scalar(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<T>& a,
+    bool normalize)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const T x = points[i][0];
+        const T y = points[i][1];
+        const T z = points[i][2];
+        T rx = x * a.m[0][0] + y * a.m[1][0] + z * a.m[2][0] + a.m[3][0];
+        T ry = x * a.m[0][1] + y * a.m[1][1] + z * a.m[2][1] + a.m[3][1];
+        T rz = x * a.m[0][2] + y * a.m[1][2] + z * a.m[2][2] + a.m[3][2];
+        if (normalize) {
+            const T length = std::sqrt(rx * rx + ry * ry + rz * rz);
+            if (length > 0) {
+                rx /= length;
+                ry /= length;
+                rz /= length;
+            }
+        }
+        points[i] = pxr::GfVec3f(rx, ry, rz);
+    }
+}
+
+#if GCORE_TRANSFORM_AVX2
+
+bool cpu_has_avx2_fma()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+const bool has_avx2 = cpu_has_avx2_fma();
+
+// Loads 8 interleaved xyz points and splits them into x, y and z registers.
+GCORE_TARGET_AVX2 inline void
+load_soa(const float* p, __m256& x, __m256& y, __m256& z)
+{
+    __m256 m03 = _mm256_castps128_ps256(_mm_loadu_ps(p));
+    __m256 m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+    __m256 m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+    m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+    m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+    m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+    const __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+// Inverse of load_soa.
+GCORE_TARGET_AVX2 inline void
+store_soa(float* p, const __m256& x, const __m256& y, const __m256& z)
+{
+    const __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    const __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    _mm_storeu_ps(p, _mm256_castps256_ps128(r03));
+    _mm_storeu_ps(p + 4, _mm256_castps256_ps128(r14));
+    _mm_storeu_ps(p + 8, _mm256_castps256_ps128(r25));
+    _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r03, 1));
+    _mm_storeu_ps(p + 16, _mm256_extractf128_ps(r14, 1));
+    _mm_storeu_ps(p + 20, _mm256_extractf128_ps(r25, 1));
+}
+
+GCORE_TARGET_AVX2 size_t transform_avx2(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<float>& a,
+    bool normalize)
+{
+    __m256 m[4][3];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            m[i][j] = _mm256_set1_ps(a.m[i][j]);
+        }
+    }
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        float* p = points[i].data();
+        __m256 x, y, z;
+        load_soa(p, x, y, z);
+        __m256 rx = _mm256_fmadd_ps(
+            x,
+            m[0][0],
+            _mm256_fmadd_ps(y, m[1][0], _mm256_fmadd_ps(z, m[2][0], m[3][0])));
+        __m256 ry = _mm256_fmadd_ps(
+            x,
+            m[0][1],
+            _mm256_fmadd_ps(y, m[1][1], _mm256_fmadd_ps(z, m[2][1], m[3][1])));
+        __m256 rz = _mm256_fmadd_ps(
+            x,
+            m[0][2],
+            _mm256_fmadd_ps(y, m[1][2], _mm256_fmadd_ps(z, m[2][2], m[3][2])));
+        if (normalize) {
+            const __m256 len2 = _mm256_fmadd_ps(
+                rx, rx, _mm256_fmadd_ps(ry, ry, _mm256_mul_ps(rz, rz)));
+            const __m256 inv = _mm256_blendv_ps(
+                one,
+                _mm256_div_ps(one, _mm256_sqrt_ps(len2)),
+                _mm256_cmp_ps(len2, zero, _CMP_GT_OQ));
+            rx = _mm256_mul_ps(rx, inv);
+            ry = _mm256_mul_ps(ry, inv);
+            rz = _mm256_mul_ps(rz, inv);
+        }
+        store_soa(p, rx, ry, rz);
+    }
+    return i;
+}
+
+GCORE_TARGET_AVX2 inline __m256d
+fmadd3_pd(__m256d x, __m256d y, __m256d z, const __m256d* col)
+{
+    return _mm256_fmadd_pd(
+        x,
+        col[0],
+        _mm256_fmadd_pd(y, col[1], _mm256_fmadd_pd(z, col[2], col[3])));
+}
+
+GCORE_TARGET_AVX2 inline void transform_pd(
+    __m256d x,
+    __m256d y,
+    __m256d z,
+    const __m256d (*c)[4],
+    bool normalize,
+    __m256d out[3])
+{
+    out[0] = fmadd3_pd(x, y, z, c[0]);
+    out[1] = fmadd3_pd(x, y, z, c[1]);
+    out[2] = fmadd3_pd(x, y, z, c[2]);
+    if (normalize) {
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d len2 = _mm256_fmadd_pd(
+            out[0],
+            out[0],
+            _mm256_fmadd_pd(out[1], out[1], _mm256_mul_pd(out[2], out[2])));
+        const __m256d inv = _mm256_blendv_pd(
+            one,
+            _mm256_div_pd(one, _mm256_sqrt_pd(len2)),
+            _mm256_cmp_pd(len2, _mm256_setzero_pd(), _CMP_GT_OQ));
+        out[0] = _mm256_mul_pd(out[0], inv);
+        out[1] = _mm256_mul_pd(out[1], inv);
+        out[2] = _mm256_mul_pd(out[2], inv);
+    }
+}
+
+GCORE_TARGET_AVX2 size_t transform_avx2(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<double>& a,
+    bool normalize)
+{
+    // Column-major copy so each output channel reads four adjacent entries.
+    __m256d c[3][4];
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            c[j][i] = _mm256_set1_pd(a.m[i][j]);
+        }
+    }
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        float* p = points[i].data();
+        __m256 x, y, z;
+        load_soa(p, x, y, z);
+
+        __m256d lo[3], hi[3];
+        transform_pd(
+            _mm256_cvtps_pd(_mm256_castps256_ps128(x)),
+            _mm256_cvtps_pd(_mm256_castps256_ps128(y)),
+            _mm256_cvtps_pd(_mm256_castps256_ps128(z)),
+            c,
+            normalize,
+            lo);
+        transform_pd(
+            _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)),
+            _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)),
+            _mm256_cvtps_pd(_mm256_extractf128_ps(z, 1)),
+            c,
+            normalize,
+            hi);
+
+        __m256 r[3];
+        for (int k = 0; k < 3; ++k) {
+            r[k] = _mm256_insertf128_ps(
+                _mm256_castps128_ps256(_mm256_cvtpd_ps(lo[k])),
+                _mm256_cvtpd_ps(hi[k]),
+                1);
+        }
+        store_soa(p, r[0], r[1], r[2]);
+    }
+    return i;
+}
+
+template<typename T>
+size_t transform_simd(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<T>& a,
+    bool normalize)
+{
+    if (!has_avx2) {
+        return begin;
+    }
+    return transform_avx2(points, begin, end, a, normalize);
+}
+
+#elif GCORE_TRANSFORM_NEON
+
+inline float32x4_t normalize_scale(float32x4_t len2)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    return vbslq_f32(
+        vcgtq_f32(len2, vdupq_n_f32(0.0f)),
+        vdivq_f32(one, vsqrtq_f32(len2)),
+        one);
+}
+
+inline float64x2_t normalize_scale(float64x2_t len2)
+{
+    const float64x2_t one = vdupq_n_f64(1.0);
+    return vbslq_f64(
+        vcgtq_f64(len2, vdupq_n_f64(0.0)),
+        vdivq_f64(one, vsqrtq_f64(len2)),
+        one);
+}
+
+size_t transform_simd(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<float>& a,
+    bool normalize)
+{
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        float* p = points[i].data();
+        float32x4x3_t v = vld3q_f32(p);
+        float32x4x3_t r;
+        for (int k = 0; k < 3; ++k) {
+            float32x4_t acc = vdupq_n_f32(a.m[3][k]);
+            acc = vfmaq_n_f32(acc, v.val[0], a.m[0][k]);
+            acc = vfmaq_n_f32(acc, v.val[1], a.m[1][k]);
+            r.val[k] = vfmaq_n_f32(acc, v.val[2], a.m[2][k]);
+        }
+        if (normalize) {
+            float32x4_t len2 = vmulq_f32(r.val[0], r.val[0]);
+            len2 = vfmaq_f32(len2, r.val[1], r.val[1]);
+            len2 = vfmaq_f32(len2, r.val[2], r.val[2]);
+            const float32x4_t inv = normalize_scale(len2);
+            for (int k = 0; k < 3; ++k) {
+                r.val[k] = vmulq_f32(r.val[k], inv);
+            }
+        }
+        vst3q_f32(p, r);
+    }
+    return i;
+}
+
+size_t transform_simd(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<double>& a,
+    bool normalize)
+{
+    auto apply = [&](const float64x2_t in[3], float64x2_t out[3]) {
+        for (int k = 0; k < 3; ++k) {
+            float64x2_t acc = vdupq_n_f64(a.m[3][k]);
+            acc = vfmaq_n_f64(acc, in[0], a.m[0][k]);
+            acc = vfmaq_n_f64(acc, in[1], a.m[1][k]);
+            out[k] = vfmaq_n_f64(acc, in[2], a.m[2][k]);
+        }
+        if (normalize) {
+            float64x2_t len2 = vmulq_f64(out[0], out[0]);
+            len2 = vfmaq_f64(len2, out[1], out[1]);
+            len2 = vfmaq_f64(len2, out[2], out[2]);
+            const float64x2_t inv = normalize_scale(len2);
+            for (int k = 0; k < 3; ++k) {
+                out[k] = vmulq_f64(out[k], inv);
+            }
+        }
+    };
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        float* p = points[i].data();
+        const float32x4x3_t v = vld3q_f32(p);
+        float64x2_t lo_in[3], hi_in[3], lo[3], hi[3];
+        for (int k = 0; k < 3; ++k) {
+            lo_in[k] = vcvt_f64_f32(vget_low_f32(v.val[k]));
+            hi_in[k] = vcvt_high_f64_f32(v.val[k]);
+        }
+        apply(lo_in, lo);
+        apply(hi_in, hi);
+        float32x4x3_t r;
+        for (int k = 0; k < 3; ++k) {
+            r.val[k] = vcvt_high_f32_f64(vcvt_f32_f64(lo[k]), hi[k]);
+        }
+        vst3q_f32(p, r);
+    }
+    return i;
+}
+
+#else
+
+template<typename T>
+size_t transform_simd(
+    pxr::GfVec3f* points,
+    size_t begin,
+    size_t end,
+    const AffineRows<T>& a,
+    bool normalize)
+{
+    return begin;
+}
+
+#endif
+
+template<typename T>
+void transform_affine(
+    pxr::GfVec3f* points,
+    size_t count,
+    const AffineRows<T>& a,
+    bool normalize)
+{
+    auto kernel = [&](size_t begin, size_t end) {
+        const size_t tail = transform_simd(points, begin, end, a, normalize);
+        transform_scalar(points, tail, end, a, normalize);
+    };
+
+    if (count < transform_parallel_threshold) {
+        kernel(0, count);
+    }
+    else {
+        pxr::WorkParallelForN(count, kernel, 4096);
+    }
+}
+
+template<typename Matrix>
+void transform_projective(
+    pxr::GfVec3f* points,
+    size_t count,
+    const Matrix& transform)
+{
+    auto kernel = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            points[i] = pxr::GfVec3f(transform.Transform(points[i]));
+        }
+    };
+
+    if (count < transform_parallel_threshold) {
+        kernel(0, count);
+    }
+    else {
+        pxr::WorkParallelForN(count, kernel, 4096);
+    }
+}
+
+// The normal matrix is the inverse-transpose of the linear part A. With row
+// vectors n' = n * inverse(A)^T, and inverse(A)^T is the cofactor matrix of A
+// divided by det(A), whose rows are cross products of the rows of A.
+bool normal_rows(const pxr::GfMatrix4d& transform, AffineRows<double>& rows)
+{
+    const pxr::GfVec3d a0(transform[0][0], transform[0][1], transform[0][2]);
+    const pxr::GfVec3d a1(transform[1][0], transform[1][1], transform[1][2]);
+    const pxr::GfVec3d a2(transform[2][0], transform[2][1], transform[2][2]);
+
+    const pxr::GfVec3d c0 = pxr::GfCross(a1, a2);
+    const pxr::GfVec3d c1 = pxr::GfCross(a2, a0);
+    const pxr::GfVec3d c2 = pxr::GfCross(a0, a1);
+    const double det = pxr::GfDot(a0, c0);
+    if (det == 0.0 || !std::isfinite(det)) {
+        return false;
+    }
+
+    // The result is renormalized anyway, only the sign of det matters.
+    const double scale = det > 0.0 ? 1.0 : -1.0;
+    for (int j = 0; j < 3; ++j) {
+        rows.m[0][j] = c0[j] * scale;
+        rows.m[1][j] = c1[j] * scale;
+        rows.m[2][j] = c2[j] * scale;
+        rows.m[3][j] = 0.0;
+    }
+    return true;
+}
+
+}  // namespace
+
+void transform_points(
+    pxr::GfVec3f* points,
+    size_t count,
+    const pxr::GfMatrix4d& transform)
+{
+    if (!is_affine(transform)) {
+        transform_projective(points, count, transform);
+        return;
+    }
+    transform_affine(points, count, affine_rows<double>(transform), false);
+}
+
+void transform_points(
+    pxr::GfVec3f* points,
+    size_t count,
+    const pxr::GfMatrix4f& transform)
+{
+    if (!is_affine(transform)) {
+        transform_projective(points, count, transform);
+        return;
+    }
+    transform_affine(points, count, affine_rows<float>(transform), false);
+}
+
+void transform_points(
+    pxr::VtArray<pxr::GfVec3f>& points,
+    const pxr::GfMatrix4d& transform)
+{
+    if (!points.empty()) {
+        transform_points(points.data(), points.size(), transform);
+    }
+}
+
+void transform_points(
+    pxr::VtArray<pxr::GfVec3f>& points,
+    const pxr::GfMatrix4f& transform)
+{
+    if (!points.empty()) {
+        transform_points(points.data(), points.size(), transform);
+    }
+}
+
+void transform_normals(
+    pxr::GfVec3f* normals,
+    size_t count,
+    const pxr::GfMatrix4d& transform)
+{
+    AffineRows<double> rows;
+    if (normal_rows(transform, rows)) {
+        transform_affine(normals, count, rows, true);
+    }
+}
+
+void transform_normals(
+    pxr::GfVec3f* normals,
+    size_t count,
+    const pxr::GfMatrix4f& transform)
+{
+    AffineRows<double> rows;
+    if (!normal_rows(pxr::GfMatrix4d(transform), rows)) {
+        return;
+    }
+    AffineRows<float> rows_f;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            rows_f.m[i][j] = static_cast<float>(rows.m[i][j]);
+        }
+    }
+    transform_affine(normals, count, rows_f, true);
+}
+
+void transform_normals(
+    pxr::VtArray<pxr::GfVec3f>& normals,
+    const pxr::GfMatrix4d& transform)
+{
+    if (!normals.empty()) {
+        transform_normals(normals.data(), normals.size(), transform);
+    }
+}
+
+void transform_normals(
+    pxr::VtArray<pxr::GfVec3f>& normals,
+    const pxr::GfMatrix4f& transform)
+{
+    if (!normals.empty()) {
+        transform_normals(normals.data(), normals.size(), transform);
+    }
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,355 @@
+#include "GCore/Algorithms/tutte.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/work/loops.h>
+
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "GCore/Components/MeshOperand.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+constexpr size_t grain_size = 1024;
+constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+// Number of faces shared by the vertices a and b, counting up to two.
+int shared_faces(const NeighborLists& vertex_faces, uint32_t a, uint32_t b)
+{
+    const uint32_t* i = vertex_faces.begin(a);
+    const uint32_t* j = vertex_faces.begin(b);
+    int count = 0;
+    while (i != vertex_faces.end(a) && j != vertex_faces.end(b) && count < 2) {
+        if (*i < *j) {
+            ++i;
+        }
+        else if (*j < *i) {
+            ++j;
+        }
+        else {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+bool same_options(const TutteOptions& a, const TutteOptions& b)
+{
+    return a.weights == b.weights && a.boundary == b.boundary &&
+           a.max_factored_vertices == b.max_factored_vertices &&
+           a.tolerance == b.tolerance;
+}
+
+template<typename Solver>
+void factorize(Solver& solver, const Eigen::SparseMatrix<double>& matrix)
+{
+    solver.compute(matrix);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error("TutteEmbedding: factorization failed.");
+    }
+}
+}  // namespace
+
+std::vector<uint32_t> boundary_loop(const MeshAdjacency& adjacency)
+{
+    const size_t n = adjacency.vertex_count();
+    const NeighborLists& vertex_faces = adjacency.vertex_faces();
+    const std::vector<uint32_t>& offsets = adjacency.face_offsets();
+    const std::vector<uint32_t>& corners = adjacency.corner_vertices();
+    const std::vector<uint8_t>& on_boundary = adjacency.boundary_vertices();
+
+    // The vertex after v along the boundary edge leaving v.
+    std::vector<uint32_t> next(n, none);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                if (!on_boundary[v]) {
+                    continue;
+                }
+                for (const uint32_t* f = vertex_faces.begin(v);
+                     f != vertex_faces.end(v) && next[v] == none;
+                     ++f) {
+                    const uint32_t first = offsets[*f];
+                    const uint32_t m = offsets[*f + 1] - first;
+                    for (uint32_t k = 0; k < m; ++k) {
+                        if (corners[first + k] != v) {
+                            continue;
+                        }
+                        const uint32_t w = corners[first + (k + 1) % m];
+                        if (shared_faces(vertex_faces, v, w) < 2) {
+                            next[v] = w;
+                        }
+                        break;
+                    }
+                }
+            }
+        },
+        grain_size);
+
+    // Non-manifold vertices can leave open chains; only closed loops count.
+    std::vector<uint8_t> visited(n, 0);
+    std::vector<uint32_t> best, loop;
+    for (uint32_t start = 0; start < n; ++start) {
+        if (next[start] == none || visited[start]) {
+            continue;
+        }
+        loop.clear();
+        uint32_t v = start;
+        while (v != none && !visited[v]) {
+            visited[v] = 1;
+            loop.push_back(v);
+            v = next[v];
+        }
+        if (v == start && loop.size() > best.size()) {
+            best.swap(loop);
+        }
+    }
+    return best;
+}
+
+TutteEmbedding::TutteEmbedding(
+    std::shared_ptr<const MeshAdjacency> adjacency,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const TutteOptions& options)
+    : adjacency_(std::move(adjacency)),
+      options_(options)
+{
+    const RowMatrix laplacian =
+        weighted_laplacian(*adjacency_, vertices, options_.weights);
+    boundary_ = boundary_loop(*adjacency_);
+    if (boundary_.empty()) {
+        throw std::invalid_argument(
+            "TutteEmbedding: the mesh has no boundary.");
+    }
+
+    const size_t n = adjacency_->vertex_count();
+    const NeighborLists& vertex_faces = adjacency_->vertex_faces();
+    free_index_.assign(n, 0);
+    for (uint32_t v : boundary_) {
+        free_index_[v] = -1;
+    }
+    std::vector<uint32_t> free_vertices;
+    for (size_t v = 0; v < n; ++v) {
+        if (free_index_[v] == 0 && vertex_faces.count(v) > 0) {
+            free_index_[v] = static_cast<int>(free_vertices.size());
+            free_vertices.push_back(static_cast<uint32_t>(v));
+        }
+        else {
+            free_index_[v] = -1;
+        }
+    }
+    free_count_ = free_vertices.size();
+
+    // Split the free rows of L into the interior block and the couplings to
+    // the fixed vertices, sizing the rows in one parallel pass and filling
+    // them in a second. Free indices grow with the vertex index, so the
+    // rows stay sorted.
+    const int* outer = laplacian.outerIndexPtr();
+    const int* inner = laplacian.innerIndexPtr();
+    const double* values = laplacian.valuePtr();
+    std::vector<int> interior_outer(free_count_ + 1, 0);
+    std::vector<int> coupling_outer(free_count_ + 1, 0);
+    pxr::WorkParallelForN(
+        free_count_,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t v = free_vertices[i];
+                int free = 0;
+                for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                    free += free_index_[inner[k]] >= 0;
+                }
+                interior_outer[i + 1] = free;
+                coupling_outer[i + 1] = outer[v + 1] - outer[v] - free;
+            }
+        },
+        grain_size);
+    std::partial_sum(
+        interior_outer.begin(), interior_outer.end(), interior_outer.begin());
+    std::partial_sum(
+        coupling_outer.begin(), coupling_outer.end(), coupling_outer.begin());
+
+    RowMatrix interior(free_count_, free_count_);
+    interior.resizeNonZeros(interior_outer.back());
+    std::copy(
+        interior_outer.begin(),
+        interior_outer.end(),
+        interior.outerIndexPtr());
+    coupling_ = RowMatrix(free_count_, n);
+    coupling_.resizeNonZeros(coupling_outer.back());
+    std::copy(
+        coupling_outer.begin(),
+        coupling_outer.end(),
+        coupling_.outerIndexPtr());
+    pxr::WorkParallelForN(
+        free_count_,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t v = free_vertices[i];
+                int a = interior_outer[i], c = coupling_outer[i];
+                for (int k = outer[v]; k < outer[v + 1]; ++k) {
+                    const int j = free_index_[inner[k]];
+                    if (j >= 0) {
+                        interior.innerIndexPtr()[a] = j;
+                        interior.valuePtr()[a++] = values[k];
+                    }
+                    else {
+                        coupling_.innerIndexPtr()[c] = inner[k];
+                        coupling_.valuePtr()[c++] = values[k];
+                    }
+                }
+            }
+        },
+        grain_size);
+    interior_ = interior;
+
+    if (free_count_ == 0) {
+        return;
+    }
+    const bool symmetric = options_.weights != LaplacianWeights::mean_value;
+    if (factored()) {
+        if (symmetric) {
+            factorize(cholesky_, interior_);
+        }
+        else {
+            factorize(lu_, interior_);
+        }
+    }
+    else if (symmetric) {
+        cg_.setTolerance(options_.tolerance);
+        factorize(cg_, interior_);
+    }
+    else {
+        bicgstab_.setTolerance(options_.tolerance);
+        factorize(bicgstab_, interior_);
+    }
+}
+
+std::shared_ptr<const TutteEmbedding> TutteEmbedding::update(
+    const std::shared_ptr<const TutteEmbedding>& previous,
+    const MeshComponent& mesh,
+    const TutteOptions& options)
+{
+    auto adjacency = MeshAdjacency::update(
+        previous ? previous->adjacency_ : nullptr, mesh);
+    const uint64_t positions = options.weights == LaplacianWeights::uniform
+                                   ? 0
+                                   : mesh.positions_hash();
+    if (previous && previous->adjacency_ == adjacency &&
+        previous->positions_hash_ == positions &&
+        same_options(previous->options_, options)) {
+        return previous;
+    }
+    auto embedding = std::make_shared<TutteEmbedding>(
+        std::move(adjacency), mesh.get_vertices(), options);
+    embedding->positions_hash_ = positions;
+    return embedding;
+}
+
+pxr::VtArray<pxr::GfVec3f> TutteEmbedding::embed(
+    const pxr::VtArray<pxr::GfVec3f>& vertices) const
+{
+    const size_t n = free_index_.size();
+    if (vertices.size() != n) {
+        throw std::invalid_argument(
+            "TutteEmbedding: vertex count does not match the mesh.");
+    }
+    const bool circle = options_.boundary == TutteBoundary::circle;
+
+    // Positions of the fixed vertices, one row per vertex.
+    Eigen::MatrixXd fixed = Eigen::MatrixXd::Zero(n, 3);
+    if (circle) {
+        std::vector<double> arc(boundary_.size() + 1, 0.0);
+        for (size_t k = 0; k < boundary_.size(); ++k) {
+            const pxr::GfVec3d a(vertices[boundary_[k]]);
+            const pxr::GfVec3d b(
+                vertices[boundary_[(k + 1) % boundary_.size()]]);
+            arc[k + 1] = arc[k] + (b - a).GetLength();
+        }
+        const double total = arc.back();
+        for (size_t k = 0; k < boundary_.size(); ++k) {
+            const double t = total > 0.0 ? arc[k] / total
+                                         : double(k) / boundary_.size();
+            fixed(boundary_[k], 0) = std::cos(2.0 * M_PI * t);
+            fixed(boundary_[k], 1) = std::sin(2.0 * M_PI * t);
+        }
+    }
+    else {
+        for (size_t v = 0; v < n; ++v) {
+            if (free_index_[v] < 0) {
+                for (int d = 0; d < 3; ++d) {
+                    fixed(v, d) = vertices[v][d];
+                }
+            }
+        }
+    }
+
+    const Eigen::Index columns = circle ? 2 : 3;
+    const Eigen::MatrixXd rhs = -(coupling_ * fixed.leftCols(columns));
+    Eigen::MatrixXd solution(free_count_, columns);
+    if (free_count_ == 0) {
+        // Every vertex is fixed.
+    }
+    else if (factored()) {
+        if (options_.weights == LaplacianWeights::mean_value) {
+            solution = lu_.solve(rhs);
+        }
+        else {
+            solution = cholesky_.solve(rhs);
+        }
+    }
+    else {
+        // The input positions are a good start for a minimal surface; a
+        // disk parameterization starts from the center.
+        Eigen::MatrixXd guess = Eigen::MatrixXd::Zero(free_count_, columns);
+        if (!circle) {
+            for (size_t v = 0; v < n; ++v) {
+                if (free_index_[v] >= 0) {
+                    for (int d = 0; d < 3; ++d) {
+                        guess(free_index_[v], d) = vertices[v][d];
+                    }
+                }
+            }
+        }
+        for (Eigen::Index c = 0; c < columns; ++c) {
+            Eigen::ComputationInfo info;
+            if (options_.weights == LaplacianWeights::mean_value) {
+                solution.col(c) =
+                    bicgstab_.solveWithGuess(rhs.col(c), guess.col(c));
+                info = bicgstab_.info();
+            }
+            else {
+                solution.col(c) = cg_.solveWithGuess(rhs.col(c), guess.col(c));
+                info = cg_.info();
+            }
+            if (info != Eigen::Success) {
+                throw std::runtime_error(
+                    "TutteEmbedding: the iterative solver did not converge.");
+            }
+        }
+    }
+
+    pxr::VtArray<pxr::GfVec3f> result(n);
+    pxr::WorkParallelForN(
+        n,
+        [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                const int i = free_index_[v];
+                for (int d = 0; d < 3; ++d) {
+                    result[v][d] = static_cast<float>(
+                        i < 0 ? fixed(v, d)
+                        : d < columns ? solution(i, d)
+                                      : 0.0);
+                }
+            }
+        },
+        grain_size);
+    return result;
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -1,66 +1,20 @@
-#include <Eigen/Dense>
-#include <Eigen/Sparse>
-#include <Eigen/SparseLU>
-#include <algorithm>
-#include <cassert>
-#include <cmath>
+#include <array>
 #include <cstddef>
-#include <memory>
+#include <iostream>
 #include <vector>
 
-#include "Eigen/src/Core/Matrix.h"
+#include "GCore/Algorithms/arap.h"
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
 #include "geom_node_base.h"
-#include "nodes/core/def/node_def.hpp"
 
-typedef OpenMesh::PolyMesh_ArrayKernelT<> MyMesh;
-
-void arap_deformation(
-    std::shared_ptr<MyMesh> halfedge_mesh,
-    std::vector<size_t> indices,
-    std::vector<std::array<float, 3>> new_positions)
-{
-    // TODO: Implement ARAP Deformation Algorithm.
-
-    /* ------------- ARAP Deformation Implementation -----------
-     ** Implement ARAP mesh deformation to preserve local rigidity.
-     **
-     ** Steps:
-     ** 1. Initial Setup:
-     **    - Build cotangent‐weighted Laplacian L of the input mesh.
-     **    - Apply Dirichlet constraints: for each control index i, enforce
-     **      L(i,i)=1.
-     **
-     ** 2. Pre‐Factorization:
-     **    - Factorize L (e.g. with Eigen::SparseLU) once for fast solves.
-     **
-     ** 3. Initialization:
-     **    - Record original positions P0 (n×3).
-     **    - Initialize deformed positions P = P0.
-     **    - Enforce control points: for each t, P(indices[t]) =
-     **      new_positions[t].
-     **
-     ** 4. Iteration (Local–Global):
-     **    Local Phase:
-     **      For each vertex i ∉ control:
-     **        • Compute covariance Ci = Σ_{j∈N(i)} w_ij (P_i−P_j)(P0_i−P0_j)^T.
-     **        • SVD(Ci) → U,Σ,Vᵀ; set rotation R_i = U·Vᵀ.
-     **
-     **    Global Phase:
-     **      • Assemble RHS vectors bx,by,bz (size n):
-     **          – If i ∈ control, b*(i)=P(i,*).
-     **          – Else b*(i)=½ Σ_{j∈N(i)} w_ij·(R_i+R_j)·(P0_i−P0_j).
-     **      • Solve L·ux=bx, L·uy=by, L·uz=bz.
-     **      • Update free P_i = (ux_i,uy_i,uz_i); re‐enforce control points.
-     **
-     **    Repeat until max_iter or convergence.
-     **
-     ** 5. Finalization:
-     **    - Write P back into halfedge_mesh→point(vh) for all vertices.
-     **
-     */
-}
+struct ArapDeformationStorage {
+    // Factored for one rest shape and control set. While dragging only the
+    // targets change, so each execution reuses the factorization and
+    // continues from the previous pose.
+    std::shared_ptr<const USTC_CG::ArapDeformation> deformation;
+    USTC_CG::ArapState state;
+    static constexpr bool has_storage = false;
+};
 
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(arap_deformation)
@@ -74,6 +28,9 @@ NODE_DECLARATION_FUNCTION(arap_deformation)
     // Input-3: New positions for the control vertices
     b.add_input<std::vector<std::array<float, 3>>>("New Positions");
 
+    // Input-4: Local-global iterations per execution
+    b.add_input<int>("Iterations").default_val(2).min(1).max(20);
+
     // Output-1: Deformed mesh
     b.add_output<Geometry>("Output");
 }
@@ -85,6 +42,13 @@ NODE_EXECUTION_FUNCTION(arap_deformation)
     auto indices = params.get_input<std::vector<size_t>>("Indices");
     auto new_positions =
         params.get_input<std::vector<std::array<float, 3>>>("New Positions");
+    auto iterations = params.get_input<int>("Iterations");
+
+    auto mesh = input.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << "ARAP Deformation: Need Geometry Input." << std::endl;
+        return false;
+    }
 
     if (indices.empty() || new_positions.empty()) {
         std::cerr << "ARAP Deformation: Please set control points."
@@ -99,23 +63,48 @@ NODE_EXECUTION_FUNCTION(arap_deformation)
         return false;
     }
 
-    /* ----------------------------- Preprocess -------------------------------
-     ** Create a halfedge structure (using OpenMesh) for the input mesh. The
-     ** half-edge data structure is a widely used data structure in geometric
-     ** processing, offering convenient operations for traversing and modifying
-     ** mesh elements.
-     */
-
-    // Initialization
-    auto halfedge_mesh = operand_to_openmesh(&input);
+    std::vector<uint32_t> controls;
+    controls.reserve(indices.size());
+    for (size_t index : indices) {
+        if (index >= mesh->get_vertices().size()) {
+            std::cerr << "ARAP Deformation: Control index out of range."
+                      << std::endl;
+            return false;
+        }
+        controls.push_back(static_cast<uint32_t>(index));
+    }
+    std::vector<pxr::GfVec3f> targets;
+    targets.reserve(new_positions.size());
+    for (const auto& p : new_positions) {
+        targets.emplace_back(p[0], p[1], p[2]);
+    }
 
-    // ARAP deformation
-    arap_deformation(halfedge_mesh, indices, new_positions);
+    auto& storage = params.get_storage<ArapDeformationStorage&>();
+    try {
+        auto deformation =
+            ArapDeformation::update(storage.deformation, *mesh, controls);
+        if (deformation != storage.deformation) {
+            // A new rest shape or control set starts over from rest.
+            storage.deformation = std::move(deformation);
+            storage.state = {};
+        }
+        storage.deformation->deform(targets, storage.state, iterations);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ARAP Deformation: " << e.what() << std::endl;
+        storage.deformation.reset();
+        storage.state = {};
+        return false;
+    }
 
-    auto geometry = openmesh_to_operand(halfedge_mesh.get());
+    mesh->set_vertices(storage.state.positions);
+    // Normals of the input no longer match the surface.
+    if (!mesh->get_normals().empty()) {
+        mesh->set_normals({});
+    }
 
     // Set the output of the nodes
-    params.set_output("Output", std::move(*geometry));
+    params.set_output("Output", std::move(input));
     return true;
 }
 
@@ -1,39 +1,15 @@
-#include <Eigen/Dense>
-#include <Eigen/Sparse>
-#include <Eigen/SparseLU>
-#include <cmath>
-#include <memory>
+#include <iostream>
 
+#include "GCore/Algorithms/arap.h"
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
 #include "geom_node_base.h"
 
-typedef OpenMesh::PolyMesh_ArrayKernelT<> MyMesh;
-
-void arap(
-    std::shared_ptr<MyMesh> halfedge_mesh,
-    std::shared_ptr<MyMesh> iter_mesh)
-{
-    // TODO: Implement ARAP Parameterization Algorithm.
-
-    /* ------------- ARAP Parameterization Implementation -----------
-     ** Implement ARAP mesh parameterization to minimize local distortion.
-     **
-     ** Steps:
-     ** 1. Initial Setup: Use a HW4 parameterization result as initial setup.
-     **
-     ** 2. Local Phase: For each triangle, compute local orthogonal
-     *approximation
-     **    (Lt) by computing SVD of Jacobian(Jt) with fixed u.
-     **
-     ** 3. Global Phase: With Lt fixed, update parameter coordinates(u) by
-     *solving
-     **    a pre-factored global sparse linear system.
-     **
-     ** 4. Iteration: Repeat Steps 2 and 3 to refine parameterization.
-     **
-     */
-}
+struct ArapParameterizationStorage {
+    // Frames, weights and the factored Laplacian depend on the surface and
+    // the fit only, so new initial UVs or options reuse them.
+    std::shared_ptr<const USTC_CG::ArapParameterization> parameterization;
+    static constexpr bool has_storage = false;
+};
 
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(arap_parameterization)
@@ -41,47 +17,87 @@ NODE_DECLARATION_FUNCTION(arap_parameterization)
     // Input-1: Original 3D mesh with boundary
     b.add_input<Geometry>("Input");
 
-    // Input-2: An embedding result of the mesh. Use the XY coordinates of the
-    // embedding as the initialization of the ARAP algorithm
-    //
-    // Here we use **the result of Assignment 4** as the initialization
-    b.add_input<Geometry>("Initialization");
+    // Input-2: Flat UVs to start from, one per vertex, e.g. the "UV" output
+    // of the Tutte node. When empty the texture coordinates of the input
+    // are used.
+    b.add_input<pxr::VtArray<pxr::GfVec2f>>("Initialization");
+
+    // Input-3: Fit similarities (ASAP) instead of rotations (ARAP)
+    b.add_input<bool>("ASAP").default_val(false);
 
-    // Output-1: Like the result of Assignment 4, output the 2D embedding of the
-    // mesh
+    // Input-4: Iterations stop once one lowers the distortion energy by
+    // less than the tolerance (relative), or after the maximum count
+    b.add_input<int>("Max Iterations").default_val(100).min(1).max(1000);
+    b.add_input<float>("Tolerance").default_val(1e-5f).min(0.0f).max(0.01f);
+
+    // Output-1: The 2D embedding of the mesh, also as texture coordinates
     b.add_output<Geometry>("Output");
+
+    // Output-2: The UVs alone
+    b.add_output<pxr::VtArray<pxr::GfVec2f>>("UV");
+
+    // Output-3: Distortion energy after each iteration
+    b.add_output<pxr::VtArray<float>>("Energy");
 }
 
 NODE_EXECUTION_FUNCTION(arap_parameterization)
 {
     // Get the input from params
     auto input = params.get_input<Geometry>("Input");
-    auto iters = params.get_input<Geometry>("Initialization");
+    auto uv = params.get_input<pxr::VtArray<pxr::GfVec2f>>("Initialization");
 
     // Avoid processing the node when there is no input
-    if (!input.get_component<MeshComponent>() ||
-        !iters.get_component<MeshComponent>()) {
+    auto mesh = input.get_component<MeshComponent>();
+    if (!mesh) {
         std::cerr << "ARAP Parameterization: Need Geometry Input." << std::endl;
+        return false;
+    }
+    if (uv.empty()) {
+        uv = mesh->get_texcoords_array();
+    }
+    if (uv.size() != mesh->get_vertices().size()) {
+        std::cerr << "ARAP Parameterization: Need one initial UV per vertex, "
+                     "e.g. from a Tutte embedding."
+                  << std::endl;
+        return false;
     }
 
-    /* ----------------------------- Preprocess -------------------------------
-    ** Create a halfedge structure (using OpenMesh) for the input mesh. The
-    ** half-edge data structure is a widely used data structure in geometric
-    ** processing, offering convenient operations for traversing and modifying
-    ** mesh elements.
-    */
+    const ArapFit fit = params.get_input<bool>("ASAP") ? ArapFit::similarity
+                                                       : ArapFit::rigid;
+    ArapParameterizationOptions options;
+    options.max_iterations = params.get_input<int>("Max Iterations");
+    options.tolerance = params.get_input<float>("Tolerance");
 
-    // Initialization
-    auto halfedge_mesh = operand_to_openmesh(&input);
-    auto iter_mesh = operand_to_openmesh(&iters);
+    auto& storage = params.get_storage<ArapParameterizationStorage&>();
+    std::vector<double> energies;
+    try {
+        storage.parameterization = ArapParameterization::update(
+            storage.parameterization, *mesh, fit);
+        energies = storage.parameterization->solve(uv, options);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "ARAP Parameterization: " << e.what() << std::endl;
+        storage.parameterization.reset();
+        return false;
+    }
 
-    // ARAP parameterization
-    arap(halfedge_mesh, iter_mesh);
+    pxr::VtArray<pxr::GfVec3f> vertices(uv.size());
+    for (size_t i = 0; i < uv.size(); ++i) {
+        vertices[i] = pxr::GfVec3f(uv[i][0], uv[i][1], 0.0f);
+    }
+    mesh->set_vertices(vertices);
+    mesh->set_texcoords_array(uv);
+    // Normals of the input no longer match the surface.
+    if (!mesh->get_normals().empty()) {
+        mesh->set_normals({});
+    }
 
-    auto geometry = openmesh_to_operand(iter_mesh.get());
+    pxr::VtArray<float> energy(energies.begin(), energies.end());
 
     // Set the output of the nodes
-    params.set_output("Output", std::move(*geometry));
+    params.set_output("Output", std::move(input));
+    params.set_output("UV", std::move(uv));
+    params.set_output("Energy", std::move(energy));
     return true;
 }
 
@@ -1,75 +1,64 @@
+#include <iostream>
+#include <memory>
+
+#include "GCore/Algorithms/cross_field.h"
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
-#include "cross_field.h"
 #include "geom_node_base.h"
 #include "nodes/core/def/node_def.hpp"
 
+struct CrossFieldStorage {
+    // Reused while the mesh and the options do not change, so the field is
+    // only solved again when the input does.
+    std::shared_ptr<const USTC_CG::CrossField> field;
+    static constexpr bool has_storage = false;
+};
+
 NODE_DEF_OPEN_SCOPE
 
 NODE_DECLARATION_FUNCTION(cross_field)
 {
     // Input-1: Original 3D mesh
     b.add_input<Geometry>("Input");
-    // Output-1: Cross field
-    b.add_output<std::vector<std::vector<Eigen::Vector3d>>>("Cross Field");
+    // Input-2: Ignore the boundary and find the smoothest field instead of
+    // one perpendicular to the boundary
+    b.add_input<bool>("Smoothest").default_val(false);
+    // Input-3: Directions per face, 4 for a cross field
+    b.add_input<int>("Symmetry").default_val(4).min(1).max(8);
+    // Output-1: Cross field, the face frames read by the N-PolyVector field
+    // visualizer
+    b.add_output<FaceFrames>("Cross Field");
 }
 
 NODE_EXECUTION_FUNCTION(cross_field)
-{  // Get the input mesh
+{
+    // Get the input mesh
     auto input_mesh = params.get_input<Geometry>("Input");
+    auto mesh = input_mesh.get_component<MeshComponent>();
 
     // Avoid processing the node when there is no input
-    if (!input_mesh.get_component<MeshComponent>()) {
+    if (!mesh) {
         std::cerr << "Cross field: No input mesh provided." << std::endl;
         return false;
     }
 
-    /* ----------------------------- Preprocess
-     *-------------------------------
-     ** Create a halfedge structure (using OpenMesh) for the input mesh. The
-     ** half-edge data structure is a widely used data structure in
-     *geometric
-     ** processing, offering convenient operations for traversing and
-     *modifying
-     ** mesh elements.
-     */
-
-    // Initialization
-    auto openmesh = std::make_shared<EigenPolyMesh>();
-    auto topology = input_mesh.get_component<MeshComponent>();
+    CrossFieldOptions options;
+    options.solve = params.get_input<bool>("Smoothest")
+                        ? CrossFieldSolve::smoothest
+                        : CrossFieldSolve::boundary_aligned;
+    options.symmetry = params.get_input<int>("Symmetry");
 
-    for (const auto& vv : topology->get_vertices()) {
-        Eigen::Vector3d v(vv[0], vv[1], vv[2]);
-        openmesh->add_vertex(v);
+    auto& storage = params.get_storage<CrossFieldStorage&>();
+    try {
+        storage.field = CrossField::update(storage.field, *mesh, options);
     }
-
-    auto faceVertexIndices = topology->get_face_vertex_indices();
-    auto faceVertexCounts = topology->get_face_vertex_counts();
-
-    int vertexIndex = 0;
-    for (int i = 0; i < faceVertexCounts.size(); i++) {
-        // Create a vector of vertex handles for the face
-        std::vector<EigenPolyMesh::VertexHandle> face_vhandles;
-        for (int j = 0; j < faceVertexCounts[i]; j++) {
-            int index = faceVertexIndices[vertexIndex];
-            // Get the vertex handle from the index
-            EigenPolyMesh::VertexHandle vh = openmesh->vertex_handle(index);
-            // Add it to the vector
-            face_vhandles.push_back(vh);
-            vertexIndex++;
-        }
-        // Add the face to the mesh
-        openmesh->add_face(face_vhandles);
+    catch (const std::exception& e) {
+        std::cerr << "Cross field: " << e.what() << std::endl;
+        storage.field.reset();
+        return false;
     }
 
-    // Create the cross field
-    CrossField cross_field(*openmesh);
-    cross_field.generateBoundaryConstrain();
-    cross_field.generateCrossField();
-    auto cross_fields = cross_field.getCrossFields();
-
-    // Set the output
-    params.set_output("Cross Field", cross_fields);
+    // Set the output; the arrays are shared, not copied
+    params.set_output("Cross Field", storage.field->frames());
 
     return true;
 }
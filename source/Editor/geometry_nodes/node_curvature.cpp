@@ -1,31 +1,76 @@
 #include <pxr/base/vt/array.h>
 
-#include <vector>
+#include <iostream>
+#include <optional>
 
+#include "GCore/Algorithms/curvature.h"
 #include "GCore/Components/MeshOperand.h"
-#include "OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh"
 #include "geom_node_base.h"
 #include "nodes/core/def/node_def.hpp"
 
-typedef OpenMesh::TriMesh_ArrayKernelT<> MyMesh;
+struct CurvatureStorage {
+    // Reused while the topology does not change, so that deforming or
+    // re-evaluating a mesh only pays for the curvature sweep itself.
+    std::shared_ptr<const USTC_CG::MeshAdjacency> adjacency;
+    static constexpr bool has_storage = false;
+};
 
-void compute_mean_curvature(
-    const MyMesh& omesh,
-    pxr::VtArray<float>& mean_curvature)
+NODE_DEF_OPEN_SCOPE
+
+namespace {
+std::optional<MeshCurvature> curvature_of(
+    const Geometry& geometry,
+    CurvatureStorage& storage,
+    bool principal_directions,
+    const char* node_name)
+{
+    auto mesh = geometry.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << node_name << ": Need a mesh input." << std::endl;
+        return std::nullopt;
+    }
+    try {
+        storage.adjacency = MeshAdjacency::update(storage.adjacency, *mesh);
+        return compute_curvature(
+            *storage.adjacency, mesh->get_vertices(), principal_directions);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << node_name << ": " << e.what() << std::endl;
+        return std::nullopt;
+    }
+}
+}  // namespace
+
+NODE_DECLARATION_FUNCTION(curvature)
 {
-    // TODO: Implement the mean curvature computation
-    //  You need to fill in `mean_curvature`
+    b.add_input<Geometry>("Mesh");
+    b.add_output<pxr::VtArray<float>>("Mean Curvature");
+    b.add_output<pxr::VtArray<float>>("Gaussian Curvature");
+    b.add_output<pxr::VtArray<float>>("Max Curvature");
+    b.add_output<pxr::VtArray<float>>("Min Curvature");
+    b.add_output<pxr::VtVec3fArray>("Max Direction");
+    b.add_output<pxr::VtVec3fArray>("Min Direction");
 }
 
-void compute_gaussian_curvature(
-    const MyMesh& omesh,
-    pxr::VtArray<float>& gaussian_curvature)
+NODE_EXECUTION_FUNCTION(curvature)
 {
-    // TODO: Implement the Gaussian curvature computation
-    //  You need to fill in `gaussian_curvature`
+    auto geometry = params.get_input<Geometry>("Mesh");
+    auto& storage = params.get_storage<CurvatureStorage&>();
+    auto curvature = curvature_of(geometry, storage, true, "Curvature");
+    if (!curvature) {
+        return false;
+    }
+
+    params.set_output("Mean Curvature", std::move(curvature->mean));
+    params.set_output("Gaussian Curvature", std::move(curvature->gaussian));
+    params.set_output("Max Curvature", std::move(curvature->max));
+    params.set_output("Min Curvature", std::move(curvature->min));
+    params.set_output("Max Direction", std::move(curvature->max_direction));
+    params.set_output("Min Direction", std::move(curvature->min_direction));
+    return true;
 }
 
-NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_UI(curvature);
 
 NODE_DECLARATION_FUNCTION(mean_curvature)
 {
@@ -36,43 +81,14 @@ NODE_DECLARATION_FUNCTION(mean_curvature)
 NODE_EXECUTION_FUNCTION(mean_curvature)
 {
     auto geometry = params.get_input<Geometry>("Mesh");
-    auto mesh = geometry.get_component<MeshComponent>();
-    auto vertices = mesh->get_vertices();
-    auto face_vertex_indices = mesh->get_face_vertex_indices();
-    auto face_vertex_counts = mesh->get_face_vertex_counts();
-
-    // Convert the mesh to OpenMesh
-    MyMesh omesh;
-
-    // Add vertices
-    std::vector<OpenMesh::VertexHandle> vhandles;
-    vhandles.reserve(vertices.size());
-
-    for (auto vertex : vertices) {
-        omesh.add_vertex(OpenMesh::Vec3f(vertex[0], vertex[1], vertex[2]));
-    }
-
-    // Add faces
-    size_t start = 0;
-    for (int face_vertex_count : face_vertex_counts) {
-        std::vector<OpenMesh::VertexHandle> face;
-        face.reserve(face_vertex_count);
-        for (int j = 0; j < face_vertex_count; j++) {
-            face.push_back(
-                OpenMesh::VertexHandle(face_vertex_indices[start + j]));
-        }
-        omesh.add_face(face);
-        start += face_vertex_count;
+    auto& storage = params.get_storage<CurvatureStorage&>();
+    auto curvature =
+        curvature_of(geometry, storage, false, "Mean Curvature");
+    if (!curvature) {
+        return false;
     }
 
-    // Compute mean curvature
-    pxr::VtArray<float> mean_curvature;
-    mean_curvature.reserve(omesh.n_vertices());
-
-    compute_mean_curvature(omesh, mean_curvature);
-
-    params.set_output("Mean Curvature", mean_curvature);
-
+    params.set_output("Mean Curvature", std::move(curvature->mean));
     return true;
 }
 
@@ -87,43 +103,14 @@ NODE_DECLARATION_FUNCTION(gaussian_curvature)
 NODE_EXECUTION_FUNCTION(gaussian_curvature)
 {
     auto geometry = params.get_input<Geometry>("Mesh");
-    auto mesh = geometry.get_component<MeshComponent>();
-    auto vertices = mesh->get_vertices();
-    auto face_vertex_indices = mesh->get_face_vertex_indices();
-    auto face_vertex_counts = mesh->get_face_vertex_counts();
-
-    // Convert the mesh to OpenMesh
-    MyMesh omesh;
-
-    // Add vertices
-    std::vector<OpenMesh::VertexHandle> vhandles;
-    vhandles.reserve(vertices.size());
-
-    for (auto vertex : vertices) {
-        omesh.add_vertex(OpenMesh::Vec3f(vertex[0], vertex[1], vertex[2]));
-    }
-
-    // Add faces
-    size_t start = 0;
-    for (int face_vertex_count : face_vertex_counts) {
-        std::vector<OpenMesh::VertexHandle> face;
-        face.reserve(face_vertex_count);
-        for (int j = 0; j < face_vertex_count; j++) {
-            face.push_back(
-                OpenMesh::VertexHandle(face_vertex_indices[start + j]));
-        }
-        omesh.add_face(face);
-        start += face_vertex_count;
+    auto& storage = params.get_storage<CurvatureStorage&>();
+    auto curvature =
+        curvature_of(geometry, storage, false, "Gaussian Curvature");
+    if (!curvature) {
+        return false;
     }
 
-    // Compute Gaussian curvature
-    pxr::VtArray<float> gaussian_curvature;
-    gaussian_curvature.reserve(omesh.n_vertices());
-
-    compute_gaussian_curvature(omesh, gaussian_curvature);
-
-    params.set_output("Gaussian Curvature", gaussian_curvature);
-
+    params.set_output("Gaussian Curvature", std::move(curvature->gaussian));
     return true;
 }
 
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <string>
+
+#include "GCore/Algorithms/heat_geodesic.h"
+#include "GCore/Components/MeshOperand.h"
+#include "geom_node_base.h"
+
+struct HeatGeodesicStorage {
+    // The factorizations depend on the topology, the positions and the time
+    // scale only, so picking new sources costs a few triangular solves.
+    std::shared_ptr<const USTC_CG::HeatGeodesic> geodesic;
+    static constexpr bool has_storage = false;
+};
+
+NODE_DEF_OPEN_SCOPE
+
+NODE_DECLARATION_FUNCTION(heat_geodesic)
+{
+    b.add_input<Geometry>("Mesh");
+    b.add_input<pxr::VtArray<int>>("Sources");
+    // Optional set index of every source. Each set gets its own distance
+    // field; all sets are solved together.
+    b.add_input<pxr::VtArray<int>>("Source Sets");
+    b.add_input<float>("Time Scale").default_val(1).min(0.1).max(10);
+    b.add_input<std::string>("Quantity Name").default_val("geodesic distance");
+
+    b.add_output<Geometry>("Mesh");
+    b.add_output<pxr::VtArray<float>>("Distance");
+}
+
+NODE_EXECUTION_FUNCTION(heat_geodesic)
+{
+    auto geometry = params.get_input<Geometry>("Mesh");
+    auto mesh = geometry.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << "Heat Geodesic: Need a mesh input." << std::endl;
+        return false;
+    }
+    auto sources = params.get_input<pxr::VtArray<int>>("Sources");
+    auto source_sets = params.get_input<pxr::VtArray<int>>("Source Sets");
+    auto time_scale = params.get_input<float>("Time Scale");
+    auto name = params.get_input<std::string>("Quantity Name");
+    if (sources.empty()) {
+        std::cerr << "Heat Geodesic: Need at least one source." << std::endl;
+        return false;
+    }
+    if (!source_sets.empty() && source_sets.size() != sources.size()) {
+        std::cerr << "Heat Geodesic: Source Sets must give one set per source."
+                  << std::endl;
+        return false;
+    }
+
+    const size_t vertex_count = mesh->get_vertices().size();
+    std::vector<std::vector<uint32_t>> sets;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const int set = source_sets.empty() ? 0 : source_sets[i];
+        // Bounded so that one bad set index cannot allocate huge numbers
+        // of empty sets.
+        if (sources[i] < 0 || static_cast<size_t>(sources[i]) >= vertex_count ||
+            set < 0 || static_cast<size_t>(set) >= vertex_count) {
+            std::cerr << "Heat Geodesic: Source or set index out of range."
+                      << std::endl;
+            return false;
+        }
+        if (sets.size() <= static_cast<size_t>(set)) {
+            sets.resize(set + 1);
+        }
+        sets[set].push_back(static_cast<uint32_t>(sources[i]));
+    }
+    // Set 0 is the Distance output.
+    if (sets.front().empty()) {
+        std::cerr << "Heat Geodesic: Set 0 has no sources." << std::endl;
+        return false;
+    }
+
+    auto& storage = params.get_storage<HeatGeodesicStorage&>();
+    std::vector<pxr::VtArray<float>> distances;
+    try {
+        storage.geodesic =
+            HeatGeodesic::update(storage.geodesic, *mesh, time_scale);
+        distances = storage.geodesic->distances(sets);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Heat Geodesic: " << e.what() << std::endl;
+        storage.geodesic.reset();
+        return false;
+    }
+
+    for (size_t set = 0; set < distances.size(); ++set) {
+        if (!distances[set].empty()) {
+            mesh->add_vertex_scalar_quantity(
+                set == 0 ? name : name + " " + std::to_string(set),
+                distances[set]);
+        }
+    }
+
+    params.set_output("Distance", std::move(distances.front()));
+    params.set_output("Mesh", std::move(geometry));
+    return true;
+}
+
+NODE_DECLARATION_UI(heat_geodesic);
+
+NODE_DEF_CLOSE_SCOPE
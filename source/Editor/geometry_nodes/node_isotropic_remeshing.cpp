@@ -1,49 +1,20 @@
+#include <algorithm>
 #include <iostream>
-#include <unordered_set>
-#include <utility>
+#include <memory>
+#include <stdexcept>
+#include <string>
 
+#include "GCore/Algorithms/remeshing.h"
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
-#include "OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh"
 #include "geom_node_base.h"
 #include "nodes/core/def/node_def.hpp"
 
-typedef OpenMesh::TriMesh_ArrayKernelT<> MyMesh;
+struct IsotropicRemeshingStorage {
+    // Reused while the input topology does not change.
+    std::shared_ptr<const USTC_CG::MeshAdjacency> adjacency;
+    static constexpr bool has_storage = false;
+};
 
-void split_edges(std::shared_ptr<MyMesh> halfedge_mesh, float upper_bound)
-{
-    // TODO: split all edges at their midpoint that are longer then upper_bound
-}
-
-void collapse_edges(std::shared_ptr<MyMesh> halfedge_mesh, float lower_bound)
-{
-    // TODO: collapse all edges shorter than lower_bound into their midpoint
-}
-
-void flip_edges(std::shared_ptr<MyMesh> halfedge_mesh)
-{
-    // TODO: flip edges in order to minimize the deviation from valence 6
-    // (or 4 on boundaries)
-}
-
-void relocate_vertices(std::shared_ptr<MyMesh> halfedge_mesh, float lambda)
-{
-    // TODO: relocate vertices towards its gravity-weighted centroid
-}
-
-void isotropic_remeshing(
-    std::shared_ptr<MyMesh> halfedge_mesh,
-    float target_edge_length,
-    int num_iterations,
-    float lambda)
-{
-    for (int i = 0; i < num_iterations; ++i) {
-        split_edges(halfedge_mesh, target_edge_length * 4.0f / 3.0f);
-        collapse_edges(halfedge_mesh, target_edge_length * 4.0f / 5.0f);
-        flip_edges(halfedge_mesh);
-        relocate_vertices(halfedge_mesh, lambda);
-    }
-}
 NODE_DEF_OPEN_SCOPE
 NODE_DECLARATION_FUNCTION(isotropic_remeshing)
 {
@@ -62,6 +33,31 @@ NODE_DECLARATION_FUNCTION(isotropic_remeshing)
     // The input-4 is the lambda value for vertex relocation
     b.add_input<float>("Lambda").default_val(1.0f).min(0.0f).max(1.0f);
 
+    // The input-5 switches to target lengths that vary over the surface,
+    // with the target edge length as the largest one
+    b.add_input<bool>("Adaptive").default_val(false);
+
+    // The input-6 is the smallest adaptive length
+    b.add_input<float>("Min Edge Length")
+        .default_val(0.01f)
+        .min(0.0001f)
+        .max(10.0f);
+
+    // The input-7 is the distance to the input the curvature based lengths
+    // allow
+    b.add_input<float>("Approximation Error")
+        .default_val(0.001f)
+        .min(0.00001f)
+        .max(1.0f);
+
+    // The input-8 names a vertex scalar quantity used as the lengths instead
+    // of the curvature based ones, when not empty
+    b.add_input<std::string>("Sizing Quantity").default_val("");
+
+    // The input-9 bounds how fast the adaptive lengths grow along the
+    // surface
+    b.add_input<float>("Gradation").default_val(0.5f).min(0.0f).max(2.0f);
+
     // The output is a remeshed version of the input mesh
     b.add_output<Geometry>("Remeshed Mesh");
 }
@@ -77,7 +73,6 @@ NODE_EXECUTION_FUNCTION(isotropic_remeshing)
                   << std::endl;
         return false;
     }
-    auto halfedge_mesh = operand_to_openmesh_trimesh(&geometry);
 
     // Get the target edge length and number of iterations
     float target_edge_length = params.get_input<float>("Target Edge Length");
@@ -97,22 +92,52 @@ NODE_EXECUTION_FUNCTION(isotropic_remeshing)
         return false;
     }
 
-    halfedge_mesh->request_vertex_status();
-    halfedge_mesh->request_edge_status();
-    halfedge_mesh->request_face_status();
-    halfedge_mesh->request_halfedge_status();
-    halfedge_mesh->request_face_normals();
-    halfedge_mesh->request_vertex_normals();
-    halfedge_mesh->request_halfedge_normals();
+    RemeshingOptions options{ target_edge_length, num_iterations, lambda };
+    options.gradation = params.get_input<float>("Gradation");
+    const bool adaptive = params.get_input<bool>("Adaptive");
+    const auto quantity = params.get_input<std::string>("Sizing Quantity");
 
     // Isotropic remeshing
-    isotropic_remeshing(
-        halfedge_mesh, target_edge_length, num_iterations, lambda);
+    auto& storage = params.get_storage<IsotropicRemeshingStorage&>();
+    RemeshedMesh remeshed;
+    try {
+        storage.adjacency = MeshAdjacency::update(storage.adjacency, *mesh);
+        if (adaptive && !quantity.empty()) {
+            options.sizing = mesh->get_vertex_scalar_quantity(quantity);
+            if (options.sizing.empty()) {
+                throw std::invalid_argument(
+                    "no vertex scalar quantity named " + quantity);
+            }
+        }
+        else if (adaptive) {
+            SizingOptions sizing;
+            sizing.error = params.get_input<float>("Approximation Error");
+            sizing.min_length = std::min(
+                params.get_input<float>("Min Edge Length"),
+                target_edge_length);
+            sizing.max_length = target_edge_length;
+            options.sizing = curvature_sizing(
+                *storage.adjacency, mesh->get_vertices(), sizing);
+        }
+        remeshed = isotropic_remeshing(
+            *storage.adjacency, mesh->get_vertices(), options);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Isotropic Remeshing Node: " << e.what() << std::endl;
+        storage.adjacency.reset();
+        return false;
+    }
 
-    // Convert the remeshed halfedge mesh back to Geometry
-    auto remeshed_geometry = openmesh_to_operand_trimesh(halfedge_mesh.get());
+    // The vertex and face attributes of the input do not carry over to the
+    // new topology.
+    Geometry remeshed_geometry;
+    auto output = std::make_shared<MeshComponent>(&remeshed_geometry);
+    remeshed_geometry.attach_component(output);
+    output->set_vertices(remeshed.vertices);
+    output->set_face_vertex_counts(remeshed.face_vertex_counts);
+    output->set_face_vertex_indices(remeshed.face_vertex_indices);
     // Set the output of the node
-    params.set_output("Remeshed Mesh", std::move(*remeshed_geometry));
+    params.set_output("Remeshed Mesh", std::move(remeshed_geometry));
 
     return true;
 }
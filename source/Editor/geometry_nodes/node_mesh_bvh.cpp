@@ -0,0 +1,168 @@
+#include <cmath>
+#include <iostream>
+
+#include "GCore/Algorithms/bvh.h"
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/Components/PointsComponent.h"
+#include "geom_node_base.h"
+
+struct MeshBVHStorage {
+    // Kept across executions so an unchanged or deformed mesh coming from
+    // upstream reuses or refits the previous tree instead of rebuilding it.
+    USTC_CG::MeshBVHHandle bvh;
+    static constexpr bool has_storage = false;
+};
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(mesh_bvh)
+{
+    b.add_input<Geometry>("Mesh");
+    b.add_output<MeshBVHHandle>("Mesh BVH");
+}
+
+NODE_EXECUTION_FUNCTION(mesh_bvh)
+{
+    auto geometry = params.get_input<Geometry>("Mesh");
+    auto mesh = geometry.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << "Mesh BVH: Need a mesh input." << std::endl;
+        return false;
+    }
+
+    auto& storage = params.get_storage<MeshBVHStorage&>();
+    storage.bvh = MeshBVH::update(storage.bvh, *mesh);
+
+    params.set_output("Mesh BVH", storage.bvh);
+    return true;
+}
+
+NODE_DECLARATION_UI(mesh_bvh);
+
+NODE_DECLARATION_FUNCTION(mesh_bvh_closest_point)
+{
+    b.add_input<MeshBVHHandle>("Mesh BVH");
+    b.add_input<Geometry>("Query");
+    b.add_input<float>("Max Distance").min(0).max(10).default_val(10);
+
+    b.add_output<Geometry>("Projected");
+    b.add_output<pxr::VtArray<float>>("Distances");
+    b.add_output<pxr::VtArray<int>>("Faces");
+}
+
+NODE_EXECUTION_FUNCTION(mesh_bvh_closest_point)
+{
+    auto bvh = params.get_input<MeshBVHHandle>("Mesh BVH");
+    auto geometry = params.get_input<Geometry>("Query");
+    auto max_distance = params.get_input<float>("Max Distance");
+    if (!bvh) {
+        std::cerr << "Mesh BVH Closest Point: Need a Mesh BVH input."
+                  << std::endl;
+        return false;
+    }
+
+    auto mesh = geometry.get_component<MeshComponent>();
+    auto points = geometry.get_component<PointsComponent>();
+    pxr::VtArray<pxr::GfVec3f> queries;
+    if (mesh) {
+        queries = mesh->get_vertices();
+    }
+    else if (points) {
+        queries = points->get_vertices();
+    }
+    else {
+        std::cerr << "Mesh BVH Closest Point: Need a mesh or points query."
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<ClosestPoint> results(queries.size());
+    bvh->closest_points(
+        queries.cdata(), queries.size(), results.data(), max_distance);
+
+    // Queries farther than the max distance keep their position.
+    pxr::VtArray<pxr::GfVec3f> projected = queries;
+    pxr::VtArray<float> distances(queries.size());
+    pxr::VtArray<int> faces(queries.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            projected[i] = results[i].point;
+            distances[i] = std::sqrt(results[i].distance_squared);
+        }
+        else {
+            distances[i] = std::numeric_limits<float>::infinity();
+        }
+        faces[i] = results[i].face;
+    }
+
+    if (mesh) {
+        mesh->set_vertices(projected);
+    }
+    else {
+        points->set_vertices(projected);
+    }
+
+    params.set_output("Projected", std::move(geometry));
+    params.set_output("Distances", std::move(distances));
+    params.set_output("Faces", std::move(faces));
+    return true;
+}
+
+NODE_DECLARATION_UI(mesh_bvh_closest_point);
+
+NODE_DECLARATION_FUNCTION(mesh_bvh_ray_cast)
+{
+    b.add_input<MeshBVHHandle>("Mesh BVH");
+    b.add_input<pxr::VtVec3fArray>("Origins");
+    b.add_input<pxr::VtVec3fArray>("Directions");
+    b.add_input<float>("Max Distance").min(0).max(100).default_val(100);
+
+    b.add_output<pxr::VtVec3fArray>("Hit Positions");
+    b.add_output<pxr::VtArray<float>>("Distances");
+    b.add_output<pxr::VtArray<int>>("Faces");
+}
+
+NODE_EXECUTION_FUNCTION(mesh_bvh_ray_cast)
+{
+    auto bvh = params.get_input<MeshBVHHandle>("Mesh BVH");
+    auto origins = params.get_input<pxr::VtVec3fArray>("Origins");
+    auto directions = params.get_input<pxr::VtVec3fArray>("Directions");
+    auto max_distance = params.get_input<float>("Max Distance");
+    if (!bvh) {
+        std::cerr << "Mesh BVH Ray Cast: Need a Mesh BVH input." << std::endl;
+        return false;
+    }
+    if (origins.size() != directions.size()) {
+        std::cerr << "Mesh BVH Ray Cast: The size of origins and directions "
+                     "should be the same."
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<RayHit> hits(origins.size());
+    bvh->intersect_rays(
+        origins.cdata(),
+        directions.cdata(),
+        origins.size(),
+        hits.data(),
+        max_distance);
+
+    // Misses report the ray origin, an infinite distance and face -1.
+    pxr::VtVec3fArray positions(origins.size());
+    pxr::VtArray<float> distances(origins.size());
+    pxr::VtArray<int> faces(origins.size());
+    for (size_t i = 0; i < hits.size(); ++i) {
+        positions[i] =
+            hits[i] ? origins[i] + directions[i] * hits[i].distance
+                    : origins[i];
+        distances[i] = hits[i].distance;
+        faces[i] = hits[i].face;
+    }
+
+    params.set_output("Hit Positions", std::move(positions));
+    params.set_output("Distances", std::move(distances));
+    params.set_output("Faces", std::move(faces));
+    return true;
+}
+
+NODE_DECLARATION_UI(mesh_bvh_ray_cast);
+NODE_DEF_CLOSE_SCOPE
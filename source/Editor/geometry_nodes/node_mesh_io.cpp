@@ -0,0 +1,186 @@
+#include <filesystem>
+#include <iostream>
+
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/geometry_cache.h"
+#include "GCore/IO/ply.h"
+#include "GCore/IO/stl.h"
+#include "geom_node_base.h"
+#include "node_paths.h"
+
+NODE_DEF_OPEN_SCOPE
+
+NODE_DECLARATION_FUNCTION(import_ply)
+{
+    b.add_input<std::string>("Path").default_val("Default");
+    b.add_output<Geometry>("Geometry");
+}
+
+NODE_EXECUTION_FUNCTION(import_ply)
+{
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Import PLY: Invalid path." << std::endl;
+        return false;
+    }
+    PlyData data;
+    try {
+        data = read_ply(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Import PLY: " << e.what() << std::endl;
+        return false;
+    }
+    params.set_output("Geometry", ply_to_geometry(std::move(data)));
+    return true;
+}
+
+NODE_DECLARATION_UI(import_ply);
+
+NODE_DECLARATION_FUNCTION(export_ply)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<std::string>("Path").default_val("Default");
+    b.add_input<bool>("Binary").default_val(true);
+}
+
+NODE_EXECUTION_FUNCTION(export_ply)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    auto mesh = geometry.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << "Export PLY: Need Geometry Input." << std::endl;
+        return false;
+    }
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Export PLY: Invalid path." << std::endl;
+        return false;
+    }
+    const PlyFormat format = params.get_input<bool>("Binary")
+                                 ? PlyFormat::binary_little_endian
+                                 : PlyFormat::ascii;
+    try {
+        write_ply(path, *mesh, format);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Export PLY: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+NODE_DECLARATION_UI(export_ply);
+
+NODE_DECLARATION_FUNCTION(import_stl)
+{
+    b.add_input<std::string>("Path").default_val("Default");
+    // 0 merges only corners at exactly the same position.
+    b.add_input<float>("Weld Tolerance").min(0).max(0.1f).default_val(0);
+    b.add_output<Geometry>("Geometry");
+}
+
+NODE_EXECUTION_FUNCTION(import_stl)
+{
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Import STL: Invalid path." << std::endl;
+        return false;
+    }
+    const float tolerance = params.get_input<float>("Weld Tolerance");
+    try {
+        const StlData data = read_stl(path);
+        params.set_output("Geometry", stl_to_geometry(data, tolerance));
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Import STL: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+NODE_DECLARATION_UI(import_stl);
+
+NODE_DECLARATION_FUNCTION(export_stl)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<std::string>("Path").default_val("Default");
+}
+
+NODE_EXECUTION_FUNCTION(export_stl)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    auto mesh = geometry.get_component<MeshComponent>();
+    if (!mesh) {
+        std::cerr << "Export STL: Need Geometry Input." << std::endl;
+        return false;
+    }
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Export STL: Invalid path." << std::endl;
+        return false;
+    }
+    try {
+        write_stl(path, *mesh);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Export STL: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+NODE_DECLARATION_UI(export_stl);
+
+NODE_DECLARATION_FUNCTION(write_geometry_cache)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<std::string>("Path").default_val("Default");
+}
+
+NODE_EXECUTION_FUNCTION(write_geometry_cache)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Write Geometry Cache: Invalid path." << std::endl;
+        return false;
+    }
+    try {
+        geometry.save_cache(path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Write Geometry Cache: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+NODE_DECLARATION_UI(write_geometry_cache);
+
+NODE_DECLARATION_FUNCTION(read_geometry_cache)
+{
+    b.add_input<std::string>("Path").default_val("Default");
+    b.add_output<Geometry>("Geometry");
+}
+
+NODE_EXECUTION_FUNCTION(read_geometry_cache)
+{
+    const auto path = resolve_node_path(params.get_input<std::string>("Path"));
+    if (path.empty()) {
+        std::cerr << "Read Geometry Cache: Invalid path." << std::endl;
+        return false;
+    }
+    try {
+        params.set_output("Geometry", Geometry::load_cache(path));
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Read Geometry Cache: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+NODE_DECLARATION_UI(read_geometry_cache);
+
+NODE_DEF_CLOSE_SCOPE
@@ -0,0 +1,53 @@
+#pragma once
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+
+#include <climits>
+#endif
+
+namespace USTC_CG {
+
+// Directory of the running executable, which relative paths given to the
+// file nodes are resolved against. Throws std::runtime_error when it cannot
+// be determined.
+inline const std::filesystem::path& executable_directory()
+{
+    static const std::filesystem::path directory = [] {
+#ifdef _WIN32
+        char p[MAX_PATH];
+        GetModuleFileNameA(NULL, p, MAX_PATH);
+        return std::filesystem::path(p).parent_path();
+#else
+        char p[PATH_MAX];
+        ssize_t count = readlink("/proc/self/exe", p, PATH_MAX - 1);
+        if (count == -1) {
+            throw std::runtime_error("Failed to get executable path.");
+        }
+        p[count] = '\0';
+        return std::filesystem::path(p).parent_path();
+#endif
+    }();
+    return directory;
+}
+
+// `path` made absolute against executable_directory() and normalized, or an
+// empty path when `path` is empty.
+inline std::filesystem::path resolve_node_path(const std::string& path)
+{
+    if (path.empty()) {
+        return {};
+    }
+    std::filesystem::path abs_path(path);
+    if (!abs_path.is_absolute()) {
+        abs_path = executable_directory() / abs_path;
+    }
+    return abs_path.lexically_normal();
+}
+
+}  // namespace USTC_CG
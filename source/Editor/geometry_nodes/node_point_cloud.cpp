@@ -0,0 +1,248 @@
+#include <pxr/base/work/loops.h>
+
+#include <Eigen/Eigenvalues>
+#include <iostream>
+#include <memory>
+
+#include "GCore/Algorithms/point_index.h"
+#include "GCore/Components/MeshOperand.h"
+#include "GCore/Components/PointsComponent.h"
+#include "geom_node_base.h"
+
+// Every execution gets a fresh copy of the input geometry, so an index
+// cached on the component would be rebuilt each time; the nodes keep it in
+// their storage instead.
+struct PointCloudStorage {
+    std::shared_ptr<const USTC_CG::PointKDTree> tree;
+    static constexpr bool has_storage = false;
+};
+
+namespace {
+using namespace USTC_CG;
+
+// Point sets the nodes below work on: the vertices of a mesh or a point
+// cloud.
+struct PointSet {
+    pxr::VtArray<pxr::GfVec3f> positions;
+    pxr::VtArray<pxr::GfVec3f> colors;
+    uint64_t positions_hash = 0;
+};
+
+bool get_point_set(const Geometry& geometry, PointSet& set)
+{
+    if (auto mesh = geometry.get_component<MeshComponent>()) {
+        set.positions = mesh->get_vertices();
+        set.colors = mesh->get_display_color();
+        set.positions_hash = mesh->positions_hash();
+        return true;
+    }
+    if (auto points = geometry.get_component<PointsComponent>()) {
+        set.positions = points->get_vertices();
+        set.colors = points->get_display_color();
+        set.positions_hash = points->positions_hash();
+        return true;
+    }
+    return false;
+}
+
+const PointKDTree& kdtree(PointCloudStorage& storage, const PointSet& set)
+{
+    storage.tree =
+        PointKDTree::update(storage.tree, set.positions, set.positions_hash);
+    return *storage.tree;
+}
+}  // namespace
+
+NODE_DEF_OPEN_SCOPE
+NODE_DECLARATION_FUNCTION(estimate_normals)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<int>("Neighbors").min(3).max(64).default_val(16);
+    b.add_output<Geometry>("Geometry");
+    b.add_output<pxr::VtVec3fArray>("Normals");
+}
+
+NODE_EXECUTION_FUNCTION(estimate_normals)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    const int k = params.get_input<int>("Neighbors");
+
+    PointSet set;
+    if (!get_point_set(geometry, set)) {
+        std::cerr << "Estimate Normals: Need a mesh or points input."
+                  << std::endl;
+        return false;
+    }
+    const auto& positions = set.positions;
+    if (positions.empty()) {
+        return false;
+    }
+
+    pxr::GfVec3f centroid(0.0f);
+    for (const auto& p : positions) {
+        centroid += p;
+    }
+    centroid /= float(positions.size());
+
+    // Normal = eigenvector of the smallest eigenvalue of the neighborhood
+    // covariance, flipped to point away from the centroid of the cloud.
+    pxr::VtVec3fArray normals(positions.size());
+    auto& storage = params.get_storage<PointCloudStorage&>();
+    kdtree(storage, set).for_each_knn(
+        uint32_t(k),
+        [&](uint32_t point, const uint32_t* neighbors, const float*) {
+            Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+            int count = 0;
+            for (int j = 0; j < k && neighbors[j] != invalid_point; ++j) {
+                const auto& p = positions[neighbors[j]];
+                mean += Eigen::Vector3f(p[0], p[1], p[2]);
+                ++count;
+            }
+            mean /= float(count);
+
+            Eigen::Matrix3f covariance = Eigen::Matrix3f::Zero();
+            for (int j = 0; j < count; ++j) {
+                const auto& p = positions[neighbors[j]];
+                const Eigen::Vector3f d =
+                    Eigen::Vector3f(p[0], p[1], p[2]) - mean;
+                covariance += d * d.transpose();
+            }
+
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver;
+            solver.computeDirect(covariance);
+            const Eigen::Vector3f n = solver.eigenvectors().col(0);
+            pxr::GfVec3f normal(n[0], n[1], n[2]);
+            if (pxr::GfDot(normal, positions[point] - centroid) < 0) {
+                normal = -normal;
+            }
+            normals[point] = normal;
+        });
+
+    if (auto mesh = geometry.get_component<MeshComponent>()) {
+        mesh->set_normals(normals);
+    }
+
+    params.set_output("Geometry", std::move(geometry));
+    params.set_output("Normals", std::move(normals));
+    return true;
+}
+
+NODE_DECLARATION_UI(estimate_normals);
+
+NODE_DECLARATION_FUNCTION(voxel_downsample)
+{
+    b.add_input<Geometry>("Geometry");
+    b.add_input<float>("Voxel Size").min(0.001f).max(1).default_val(0.05f);
+    b.add_output<Geometry>("Points");
+}
+
+NODE_EXECUTION_FUNCTION(voxel_downsample)
+{
+    auto geometry = params.get_input<Geometry>("Geometry");
+    const float voxel_size = params.get_input<float>("Voxel Size");
+
+    PointSet set;
+    if (!get_point_set(geometry, set)) {
+        std::cerr << "Voxel Downsample: Need a mesh or points input."
+                  << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<PointHashGrid> grid;
+    try {
+        grid = std::make_unique<PointHashGrid>(set.positions, voxel_size);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Voxel Downsample: " << e.what() << std::endl;
+        return false;
+    }
+
+    // One point per occupied voxel at the centroid of its points, colors are
+    // averaged the same way.
+    const bool has_colors = set.colors.size() == set.positions.size();
+    pxr::VtArray<pxr::GfVec3f> positions(grid->cell_count());
+    pxr::VtArray<pxr::GfVec3f> colors(has_colors ? grid->cell_count() : 0);
+    pxr::WorkParallelForN(grid->cell_count(), [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            pxr::GfVec3f position(0.0f), color(0.0f);
+            for (auto it = grid->cell_begin(c); it != grid->cell_end(c); ++it) {
+                position += set.positions[*it];
+                if (has_colors) {
+                    color += set.colors[*it];
+                }
+            }
+            const float inv_count =
+                1.0f / float(grid->cell_end(c) - grid->cell_begin(c));
+            positions[c] = position * inv_count;
+            if (has_colors) {
+                colors[c] = color * inv_count;
+            }
+        }
+    });
+
+    Geometry output;
+    auto points = std::make_shared<PointsComponent>(&output);
+    output.attach_component(points);
+    points->set_vertices(positions);
+    if (has_colors) {
+        points->set_display_color(colors);
+    }
+    points->set_width(pxr::VtArray<float>(positions.size(), voxel_size * 0.5f));
+
+    params.set_output("Points", std::move(output));
+    return true;
+}
+
+NODE_DECLARATION_UI(voxel_downsample);
+
+NODE_DECLARATION_FUNCTION(transfer_nearest_vertex)
+{
+    b.add_input<Geometry>("Source");
+    b.add_input<Geometry>("Target");
+    b.add_output<Geometry>("Target");
+    b.add_output<pxr::VtArray<int>>("Nearest Indices");
+}
+
+NODE_EXECUTION_FUNCTION(transfer_nearest_vertex)
+{
+    auto source = params.get_input<Geometry>("Source");
+    auto target = params.get_input<Geometry>("Target");
+
+    PointSet from, to;
+    if (!get_point_set(source, from) || !get_point_set(target, to)) {
+        std::cerr << "Transfer Nearest Vertex: Need mesh or points inputs."
+                  << std::endl;
+        return false;
+    }
+    if (from.positions.empty()) {
+        return false;
+    }
+
+    std::vector<uint32_t> nearest(to.positions.size());
+    auto& storage = params.get_storage<PointCloudStorage&>();
+    kdtree(storage, from).nearest_batch(
+        to.positions.cdata(), to.positions.size(), nearest.data());
+
+    pxr::VtArray<int> indices(nearest.begin(), nearest.end());
+
+    // Display colors follow the nearest source vertex.
+    if (from.colors.size() == from.positions.size()) {
+        pxr::VtArray<pxr::GfVec3f> colors(to.positions.size());
+        for (size_t i = 0; i < nearest.size(); ++i) {
+            colors[i] = from.colors[nearest[i]];
+        }
+        if (auto mesh = target.get_component<MeshComponent>()) {
+            mesh->set_display_color(colors);
+        }
+        else {
+            target.get_component<PointsComponent>()->set_display_color(colors);
+        }
+    }
+
+    params.set_output("Target", std::move(target));
+    params.set_output("Nearest Indices", std::move(indices));
+    return true;
+}
+
+NODE_DECLARATION_UI(transfer_nearest_vertex);
+NODE_DEF_CLOSE_SCOPE
@@ -1,133 +1,148 @@
-#include <Eigen/Dense>
-#include <Eigen/Sparse>
-#include <Eigen/SparseLU>
-#include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
+#include "GCore/Algorithms/qem.h"
 #include "GCore/Components/MeshOperand.h"
-#include "GCore/util_openmesh_bind.h"
 #include "geom_node_base.h"
 #include "nodes/core/def/node_def.hpp"
 
-typedef OpenMesh::PolyMesh_ArrayKernelT<> MyMesh;
-
-void qem(
-    std::shared_ptr<MyMesh> halfedge_mesh,
-    float simplification_ratio,
-    float distance_threshold)
+struct QemStorage {
+    // Reused while the topology does not change, e.g. when only the ratio
+    // is being tuned.
+    std::shared_ptr<const USTC_CG::MeshAdjacency> adjacency;
+    static constexpr bool has_storage = false;
+};
+
+namespace {
+// The vertex and face attributes of the input do not carry over to the new
+// topology.
+USTC_CG::Geometry geometry_of(const USTC_CG::SimplifiedMesh& mesh)
 {
-    // TODO: Implement QEM mesh simplification algorithm.
-
-    /*
-     * QEM (Quadric Error Metrics) Mesh Simplification Algorithm
-     *
-     * 1. Compute the Q matrices for all the initial vertices.
-     *    - For each vertex, accumulate the quadric error matrices derived from
-     *      the planes of its adjacent faces.
-     *    - The quadric for a face is constructed from its plane equation.
-     *
-     * 2. Select all valid pairs.
-     *    - For each edge (v1, v2), consider the pair as valid for contraction.
-     *    - Optional: Consider non-edge vertex pairs based on distance
-     *      threshold.
-     *
-     * 3. Compute the optimal contraction target v_bar for each valid pair
-     *    (v1, v2).
-     *    - The optimal position minimizes the quadric error
-     *      v_bar^T (Q1 + Q2) v_bar.
-     *    - The cost of contracting the pair is the error at this optimal
-     *      position.
-     *
-     * 4. Place all the pairs in a heap keyed on cost with the minimum cost pair
-     *    at the top.
-     *    - Use a priority queue to efficiently extract the pair with the lowest
-     *      cost.
-     *
-     * 5. Iteratively remove the pair (v1, v2) of least cost from the heap,
-     *    contract this pair, and update the costs of all valid pairs involving
-     *    v1.
-     *    - After contraction, update the affected quadrics and heap entries.
-     *
-     * 6. Iterate until the number of faces in the mesh is less than
-     *    simplification ratio * number of faces in the original mesh.
-     *
-     * The initial Q matrices are computed by summing the outer products of the
-     * plane equations of all faces adjacent to each vertex.
-     */
-
-    // Placeholder. You need to implement the QEM algorithm here.
-    return;
+    USTC_CG::Geometry geometry;
+    auto output = std::make_shared<USTC_CG::MeshComponent>(&geometry);
+    geometry.attach_component(output);
+    output->set_vertices(mesh.vertices);
+    output->set_face_vertex_counts(mesh.face_vertex_counts);
+    output->set_face_vertex_indices(mesh.face_vertex_indices);
+    return geometry;
 }
+}  // namespace
 
 NODE_DEF_OPEN_SCOPE
 
 NODE_DECLARATION_FUNCTION(qem)
 {
-    // Input-1: Original 3D mesh
+    // Input-1: Original 3D triangle mesh
     b.add_input<Geometry>("Input");
     // Input-2: Mesh simplification ratio, AKA the ratio of the number of
-    // vertices in the simplified mesh to the number of vertices in the original
+    // faces in the simplified mesh to the number of faces in the original
     // mesh
     b.add_input<float>("Simplification Ratio")
         .default_val(0.5f)
         .min(0.0f)
         .max(1.0f);
-    // Input-3: Distance threshold for non-edge vertex pairs
+    // Input-3: Distance threshold for non-edge vertex pairs, which join
+    // separate parts of the mesh; 0 disables them
     b.add_input<float>("Non-edge Distance Threshold")
         .default_val(0.01f)
         .min(0.0f)
         .max(1.0f);
+    // Input-4: Contract in parallel rounds instead of one pair at a time,
+    // for large meshes on many cores
+    b.add_input<bool>("Parallel").default_val(false);
+    // Input-5: Also output every contraction, from which QEM LOD extracts
+    // any level between the input and the output
+    b.add_input<bool>("Record Progressive Mesh").default_val(false);
     // Output-1: Simplified mesh
     b.add_output<Geometry>("Output");
+    // Output-2: The progressive mesh, empty unless recorded
+    b.add_output<ProgressiveMeshHandle>("Progressive Mesh");
 }
 
 NODE_EXECUTION_FUNCTION(qem)
 {
     // Get the input mesh
     auto input_mesh = params.get_input<Geometry>("Input");
-    auto simplification_ratio = params.get_input<float>("Simplification Ratio");
-    auto distance_threshold =
-        params.get_input<float>("Non-edge Distance Threshold");
+    auto mesh = input_mesh.get_component<MeshComponent>();
 
     // Avoid processing the node when there is no input
-    if (!input_mesh.get_component<MeshComponent>()) {
+    if (!mesh) {
         std::cerr << "QEM: No input mesh provided." << std::endl;
         return false;
     }
 
-    /* ----------------------------- Preprocess
-     *-------------------------------
-     ** Create a halfedge structure (using OpenMesh) for the input mesh. The
-     ** half-edge data structure is a widely used data structure in
-     *geometric
-     ** processing, offering convenient operations for traversing and
-     *modifying
-     ** mesh elements.
-     */
-
-    // Initialization
-    auto halfedge_mesh = operand_to_openmesh(&input_mesh);
+    QemOptions options;
+    options.ratio = params.get_input<float>("Simplification Ratio");
+    options.distance_threshold =
+        params.get_input<float>("Non-edge Distance Threshold");
+    options.schedule = params.get_input<bool>("Parallel")
+                           ? QemSchedule::parallel
+                           : QemSchedule::serial;
+
+    auto& storage = params.get_storage<QemStorage&>();
+    SimplifiedMesh simplified;
+    ProgressiveMeshHandle progressive;
+    try {
+        storage.adjacency = MeshAdjacency::update(storage.adjacency, *mesh);
+        if (params.get_input<bool>("Record Progressive Mesh")) {
+            auto recorded = std::make_shared<ProgressiveMesh>(
+                *storage.adjacency, mesh->get_vertices(), options);
+            simplified = recorded->extract(recorded->collapses().size());
+            progressive = std::move(recorded);
+        }
+        else {
+            simplified = qem_simplify(
+                *storage.adjacency, mesh->get_vertices(), options);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "QEM: " << e.what() << std::endl;
+        storage.adjacency.reset();
+        return false;
+    }
 
-    halfedge_mesh->request_vertex_status();
-    halfedge_mesh->request_edge_status();
-    halfedge_mesh->request_face_status();
-    halfedge_mesh->request_halfedge_status();
+    // Set the output of the nodes
+    params.set_output("Output", geometry_of(simplified));
+    params.set_output("Progressive Mesh", std::move(progressive));
 
-    // QEM simplification
-    qem(halfedge_mesh, simplification_ratio, distance_threshold);
+    return true;
+}
 
-    // Convert the simplified mesh back to the operand
-    auto geometry = openmesh_to_operand(halfedge_mesh.get());
+NODE_DECLARATION_UI(qem);
 
-    auto mesh = geometry->get_component<MeshComponent>();
+NODE_DECLARATION_FUNCTION(qem_lod)
+{
+    // Input-1: Progressive mesh recorded by the QEM node
+    b.add_input<ProgressiveMeshHandle>("Progressive Mesh");
+    // Input-2: Largest number of faces of the level of detail
+    b.add_input<int>("Face Count").default_val(1000).min(0).max(1000000);
+    // Input-3: When positive, the coarsest level whose quadric error stays
+    // below it is taken instead
+    b.add_input<float>("Error Bound").default_val(0.0f).min(0.0f).max(1.0f);
+    // Output-1: The level of detail
+    b.add_output<Geometry>("Output");
+}
 
-    // Set the output of the nodes
-    params.set_output("Output", std::move(*geometry));
+NODE_EXECUTION_FUNCTION(qem_lod)
+{
+    auto progressive = params.get_input<ProgressiveMeshHandle>(
+        "Progressive Mesh");
+    if (!progressive) {
+        std::cerr << "QEM LOD: No progressive mesh provided." << std::endl;
+        return false;
+    }
 
+    const float error = params.get_input<float>("Error Bound");
+    const int faces = params.get_input<int>("Face Count");
+    const size_t count =
+        error > 0.0f
+            ? progressive->collapses_for_error(error)
+            : progressive->collapses_for_face_count(std::max(faces, 0));
+    params.set_output("Output", geometry_of(progressive->extract(count)));
     return true;
 }
 
-NODE_DECLARATION_UI(qem);
+NODE_DECLARATION_UI(qem_lod);
 
 NODE_DEF_CLOSE_SCOPE
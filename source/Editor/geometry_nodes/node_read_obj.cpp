@@ -7,7 +7,9 @@
 #include <iostream>
 
 #include "GCore/Components/MeshOperand.h"
+#include "GCore/IO/obj.h"
 #include "igl/readOBJ.h"
+#include "node_paths.h"
 #include "nodes/core/def/node_def.hpp"
 
 NODE_DEF_OPEN_SCOPE
@@ -36,7 +38,7 @@ NODE_EXECUTION_FUNCTION(read_obj_std)
     ssize_t count = readlink("/proc/self/exe", p, PATH_MAX);
     if (count != -1) {
         p[count] = '\0';
-        executable_path = std::filesystem::path(path).parent_path();
+        executable_path = std::filesystem::path(p).parent_path();
     }
     else {
         throw std::runtime_error("Failed to get executable path.");
@@ -106,7 +108,7 @@ NODE_EXECUTION_FUNCTION(read_obj_eigen)
     ssize_t count = readlink("/proc/self/exe", p, PATH_MAX);
     if (count != -1) {
         p[count] = '\0';
-        executable_path = std::filesystem::path(path).parent_path();
+        executable_path = std::filesystem::path(p).parent_path();
     }
     else {
         throw std::runtime_error("Failed to get executable path.");
@@ -177,7 +179,7 @@ NODE_EXECUTION_FUNCTION(read_obj_pxr)
     ssize_t count = readlink("/proc/self/exe", p, PATH_MAX);
     if (count != -1) {
         p[count] = '\0';
-        executable_path = std::filesystem::path(path).parent_path();
+        executable_path = std::filesystem::path(p).parent_path();
     }
     else {
         throw std::runtime_error("Failed to get executable path.");
@@ -284,4 +286,36 @@ NODE_EXECUTION_FUNCTION(read_obj_pxr)
 
 NODE_DECLARATION_UI(read_obj_pxr);
 
+NODE_DECLARATION_FUNCTION(import_obj)
+{
+    b.add_input<std::string>("Path").default_val("Default");
+    b.add_output<Geometry>("Geometry");
+}
+
+NODE_EXECUTION_FUNCTION(import_obj)
+{
+    const std::filesystem::path abs_path =
+        resolve_node_path(params.get_input<std::string>("Path"));
+    if (abs_path.empty()) {
+        std::cerr << "Import OBJ: Path is empty." << std::endl;
+        return false;
+    }
+
+    // Memory mapped and parsed in parallel straight into the flat arrays of
+    // a MeshComponent, without an intermediate mesh.
+    ObjData data;
+    try {
+        data = read_obj(abs_path);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Import OBJ: " << e.what() << std::endl;
+        return false;
+    }
+
+    params.set_output("Geometry", obj_to_geometry(std::move(data)));
+    return true;
+}
+
+NODE_DECLARATION_UI(import_obj);
+
 NODE_DEF_CLOSE_SCOPE
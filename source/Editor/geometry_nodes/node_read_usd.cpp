@@ -20,9 +20,11 @@
 #include "GCore/Components/SkelComponent.h"
 #include "GCore/Components/XformComponent.h"
 #include "geom_node_base.h"
+#include "node_paths.h"
 #include "pxr/usd/usdSkel/animation.h"
 #include "pxr/usd/usdSkel/bindingAPI.h"
 #include "pxr/usd/usdSkel/skeletonQuery.h"
+#include "stage/stage_cache.hpp"
 
 NODE_DEF_OPEN_SCOPE
 
@@ -50,38 +52,14 @@ NODE_EXECUTION_FUNCTION(read_usd)
         time = pxr::UsdTimeCode::Default();
     }
 
-    std::filesystem::path executable_path;
-
-#ifdef _WIN32
-    char p[MAX_PATH];
-    GetModuleFileNameA(NULL, p, MAX_PATH);
-    executable_path = std::filesystem::path(p).parent_path();
-#else
-    char p[PATH_MAX];
-    ssize_t count = readlink("/proc/self/exe", p, PATH_MAX);
-    if (count != -1) {
-        p[count] = '\0';
-        executable_path = std::filesystem::path(path).parent_path();
-    }
-    else {
-        throw std::runtime_error("Failed to get executable path.");
-    }
-#endif
-
-    std::filesystem::path abs_path;
-    if (!file_name.empty()) {
-        abs_path = std::filesystem::path(file_name);
-    }
-    else {
+    const std::filesystem::path abs_path = resolve_node_path(file_name);
+    if (abs_path.empty()) {
         log::error("Path is empty.");
         return false;
     }
-    if (!abs_path.is_absolute()) {
-        abs_path = executable_path / abs_path;
-    }
-    abs_path = abs_path.lexically_normal();
 
-    auto stage = pxr::UsdStage::Open(abs_path.string().c_str());
+    // Shared with the other nodes reading the same file.
+    auto stage = open_cached_stage(abs_path);
 
     if (stage) {
         // Here 'c_str' call is necessary since prim_path
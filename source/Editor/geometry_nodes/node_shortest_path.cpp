@@ -1,27 +1,20 @@
-#include <OpenMesh/Core/Mesh/TriMesh_ArrayKernelT.hh>
 #include <cstddef>
+#include <iostream>
+#include <list>
 #include <string>
 
+#include "GCore/Algorithms/shortest_path.h"
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/GOP.h"
 #include "nodes/core/def/node_def.hpp"
 
-typedef OpenMesh::TriMesh_ArrayKernelT<> MyMesh;
-
-// Return true if the shortest path exists, and fill in the shortest path
-// vertices and the distance. Otherwise, return false.
-bool find_shortest_path(
-    const MyMesh::VertexHandle& start_vertex_handle,
-    const MyMesh::VertexHandle& end_vertex_handle,
-    const MyMesh& omesh,
-    std::list<size_t>& shortest_path_vertex_indices,
-    float& distance)
-{
-    // TODO: Implement the shortest path algorithm
-    // You need to fill in `shortest_path_vertex_indices` and `distance`
-
-    return false;
-}
+struct ShortestPathStorage {
+    // Consecutive picks on the same mesh reuse the edge graph and the search
+    // state, so a pick only costs the search itself.
+    std::shared_ptr<const USTC_CG::EdgeGraph> graph;
+    USTC_CG::ShortestPathSearch search;
+    static constexpr bool has_storage = false;
+};
 
 NODE_DEF_OPEN_SCOPE
 
@@ -52,57 +45,47 @@ NODE_EXECUTION_FUNCTION(shortest_path)
 
     auto mesh = params.get_input<Geometry>("Picked Mesh")
                     .get_component<MeshComponent>();
-    auto vertices = mesh->get_vertices();
-    auto face_vertex_counts = mesh->get_face_vertex_counts();
-    auto face_vertex_indices = mesh->get_face_vertex_indices();
-
-    // Convert the mesh to OpenMesh
-    MyMesh omesh;
-
-    // Add vertices
-    std::vector<OpenMesh::VertexHandle> vhandles;
-    vhandles.reserve(vertices.size());
-
-    for (auto vertex : vertices) {
-        omesh.add_vertex(OpenMesh::Vec3f(vertex[0], vertex[1], vertex[2]));
-    }
-
-    // Add faces
-    size_t start = 0;
-    for (int face_vertex_count : face_vertex_counts) {
-        std::vector<OpenMesh::VertexHandle> face;
-        face.reserve(face_vertex_count);
-        for (int j = 0; j < face_vertex_count; j++) {
-            face.push_back(
-                OpenMesh::VertexHandle(face_vertex_indices[start + j]));
-        }
-        omesh.add_face(face);
-        start += face_vertex_count;
+    if (!mesh) {
+        std::cerr << "Shortest Path: Need a mesh input." << std::endl;
+        return false;
     }
-
+    auto vertices = mesh->get_vertices();
     auto start_vertex_index =
         params.get_input<size_t>("Picked Vertex [0] Index");
     auto end_vertex_index = params.get_input<size_t>("Picked Vertex [1] Index");
+    if (start_vertex_index >= vertices.size() ||
+        end_vertex_index >= vertices.size()) {
+        std::cerr << "Shortest Path: Picked vertex index out of range."
+                  << std::endl;
+        return false;
+    }
 
-    // Turn the vertex indices into OpenMesh vertex handles
-    OpenMesh::VertexHandle start_vertex_handle(start_vertex_index);
-    OpenMesh::VertexHandle end_vertex_handle(end_vertex_index);
-
-    // The indices of the vertices on the shortest path, including the start and
-    // end vertices
-    std::list<size_t> shortest_path_vertex_indices;
+    auto& storage = params.get_storage<ShortestPathStorage&>();
+    try {
+        storage.graph = EdgeGraph::update(storage.graph, *mesh);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << "Shortest Path: " << e.what() << std::endl;
+        storage.graph.reset();
+        return false;
+    }
 
+    // The indices of the vertices on the shortest path, including the start
+    // and end vertices
+    std::vector<uint32_t> path;
     // The distance of the shortest path
     float distance = 0.0f;
 
-    if (find_shortest_path(
-            start_vertex_handle,
-            end_vertex_handle,
-            omesh,
-            shortest_path_vertex_indices,
+    if (storage.search.find(
+            *storage.graph,
+            vertices,
+            static_cast<uint32_t>(start_vertex_index),
+            static_cast<uint32_t>(end_vertex_index),
+            path,
             distance)) {
         params.set_output(
-            "Shortest Path Vertex Indices", shortest_path_vertex_indices);
+            "Shortest Path Vertex Indices",
+            std::list<size_t>(path.begin(), path.end()));
         params.set_output("Shortest Path Distance", distance);
         return true;
     }
@@ -111,8 +94,6 @@ NODE_EXECUTION_FUNCTION(shortest_path)
         params.set_output("Shortest Path Distance", 0.0f);
         return false;
     }
-
-    return true;
 }
 
 NODE_DECLARATION_UI(shortest_path);
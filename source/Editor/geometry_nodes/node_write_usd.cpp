@@ -1,4 +1,6 @@
+#include <pxr/base/gf/interval.h>
 #include <pxr/base/tf/stringUtils.h>
+#include <pxr/usd/sdf/changeBlock.h>
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/basisCurves.h>
 #include <pxr/usd/usdGeom/mesh.h>
@@ -7,7 +9,9 @@
 #include <pxr/usd/usdShade/material.h>
 #include <pxr/usd/usdShade/materialBindingAPI.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "GCore/Components/CurveComponent.h"
 #include "GCore/Components/MaterialComponent.h"
@@ -38,6 +42,111 @@ bool legal(const std::string& string)
     return false;
 }
 
+// The prim is kept between executions and only attributes whose content
+// changed are authored again, so that Hydra resyncs the changed attributes
+// instead of the whole prim. Values are compared with what is authored: an
+// array read back shares its buffer, so arrays that come unchanged from the
+// node tree compare equal without looking at the elements.
+namespace {
+template<typename T>
+bool holds(
+    const pxr::UsdAttribute& attr,
+    const T& value,
+    pxr::UsdTimeCode time)
+{
+    // A value interpolated between other samples would change with the next
+    // sample, so only a sample at exactly this time counts.
+    if (!time.IsDefault()) {
+        std::vector<double> times;
+        if (!attr.GetTimeSamplesInInterval(
+                pxr::GfInterval(time.GetValue()), &times) ||
+            times.empty()) {
+            return false;
+        }
+    }
+    T current;
+    return attr.Get(&current, time) && current == value;
+}
+
+template<typename T>
+void set_value(
+    const pxr::UsdAttribute& attr,
+    const T& value,
+    pxr::UsdTimeCode time = pxr::UsdTimeCode::Default())
+{
+    // Samples left over from a simulation would hide the default value.
+    if (time.IsDefault() && attr.GetNumTimeSamples() > 0) {
+        attr.Clear();
+    }
+    else if (holds(attr, value, time)) {
+        return;
+    }
+    attr.Set(value, time);
+}
+
+void remove_attribute(pxr::UsdPrim& prim, const pxr::TfToken& name)
+{
+    if (prim.HasAttribute(name)) {
+        prim.RemoveProperty(name);
+    }
+}
+
+// Reuses the prim at path if it already has the right type, so that the
+// attributes authored on it survive. Must be called outside of an
+// SdfChangeBlock, since the prim is used right after being defined.
+template<typename Schema>
+Schema define_prim(const pxr::UsdStageRefPtr& stage, const pxr::SdfPath& path)
+{
+    auto prim = stage->GetPrimAtPath(path);
+    if (prim && !prim.IsA<Schema>()) {
+        stage->RemovePrim(path);
+    }
+    return Schema::Define(stage, path);
+}
+
+// Collects the primvars already on the prim when constructed, then removes
+// the ones that were not written again.
+class PrimvarWriter {
+   public:
+    explicit PrimvarWriter(const pxr::UsdGeomPrimvarsAPI& api) : api_(api)
+    {
+        for (const auto& primvar : api_.GetAuthoredPrimvars()) {
+            stale_[primvar.GetPrimvarName()] = primvar.GetAttr().GetName();
+        }
+    }
+
+    template<typename T>
+    void write(
+        const std::string& name,
+        const pxr::SdfValueTypeName& type,
+        const pxr::TfToken& interpolation,
+        const pxr::VtArray<T>& values,
+        pxr::UsdTimeCode time = pxr::UsdTimeCode::Default())
+    {
+        const pxr::TfToken token(name);
+        stale_.erase(token);
+        auto primvar = api_.CreatePrimvar(token, type);
+        if (primvar.GetInterpolation() != interpolation) {
+            primvar.SetInterpolation(interpolation);
+        }
+        set_value(primvar.GetAttr(), values, time);
+    }
+
+    void remove_stale()
+    {
+        auto prim = api_.GetPrim();
+        for (const auto& [primvar_name, attribute_name] : stale_) {
+            remove_attribute(prim, attribute_name);
+        }
+        stale_.clear();
+    }
+
+   private:
+    pxr::UsdGeomPrimvarsAPI api_;
+    std::map<pxr::TfToken, pxr::TfToken> stale_;
+};
+}  // namespace
+
 NODE_EXECUTION_FUNCTION(write_usd)
 {
     auto& global_payload = params.get_global_payload<GeomPayload&>();
@@ -53,189 +162,224 @@ NODE_EXECUTION_FUNCTION(write_usd)
     assert(!(points && mesh));
 
     pxr::UsdTimeCode time = global_payload.current_time;
+    // Positions, and the normals that follow them, become time samples
+    // while simulating; topology stays at the default time.
+    const pxr::UsdTimeCode points_time = global_payload.is_simulating
+                                             ? time
+                                             : pxr::UsdTimeCode::Default();
 
     auto stage = global_payload.stage;
     auto sdf_path = global_payload.prim_path;
 
-    stage->RemovePrim(sdf_path);
-
+    pxr::UsdGeomMesh usd_mesh;
+    pxr::UsdGeomPoints usdpoints;
+    pxr::UsdGeomBasisCurves usd_curve;
     if (mesh) {
-        pxr::UsdGeomMesh usdgeom = pxr::UsdGeomMesh::Define(stage, sdf_path);
-        if (usdgeom) {
+        usd_mesh = define_prim<pxr::UsdGeomMesh>(stage, sdf_path);
+    }
+    else if (points) {
+        usdpoints = define_prim<pxr::UsdGeomPoints>(stage, sdf_path);
+    }
+    else if (curve) {
+        usd_curve = define_prim<pxr::UsdGeomBasisCurves>(stage, sdf_path);
+    }
+    else {
+        stage->RemovePrim(sdf_path);
+        return true;
+    }
+    pxr::UsdPrim prim = stage->GetPrimAtPath(sdf_path);
+    if (!prim) {
+        return false;
+    }
+    PrimvarWriter primvars{ pxr::UsdGeomPrimvarsAPI(prim) };
+
+    {
+        // Only authoring from here on; the prim is not recomposed until the
+        // block closes.
+        pxr::SdfChangeBlock change_block;
+
+        if (mesh) {
 #if USE_USD_SCRATCH_BUFFER
-            copy_prim(mesh->get_usd_mesh().GetPrim(), usdgeom.GetPrim());
+            copy_prim(mesh->get_usd_mesh().GetPrim(), usd_mesh.GetPrim());
 #else
-            usdgeom.CreatePointsAttr().Set(mesh->get_vertices());
-            usdgeom.CreateFaceVertexCountsAttr().Set(
+            set_value(
+                usd_mesh.CreatePointsAttr(), mesh->get_vertices(), points_time);
+            set_value(
+                usd_mesh.CreateFaceVertexCountsAttr(),
                 mesh->get_face_vertex_counts());
-            usdgeom.CreateFaceVertexIndicesAttr().Set(
+            set_value(
+                usd_mesh.CreateFaceVertexIndicesAttr(),
                 mesh->get_face_vertex_indices());
-            usdgeom.CreateNormalsAttr().Set(mesh->get_normals());
+            set_value(
+                usd_mesh.CreateNormalsAttr(), mesh->get_normals(), points_time);
             if (!mesh->get_display_color().empty()) {
-                auto primVarAPI = pxr::UsdGeomPrimvarsAPI(usdgeom);
-                auto colorPrimvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken("displayColor"),
-                    pxr::SdfValueTypeNames->Color3fArray);
-                colorPrimvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                colorPrimvar.Set(mesh->get_display_color());
+                primvars.write(
+                    "displayColor",
+                    pxr::SdfValueTypeNames->Color3fArray,
+                    pxr::UsdGeomTokens->vertex,
+                    mesh->get_display_color());
             }
             if (!mesh->get_texcoords_array().empty()) {
-                auto primVarAPI = pxr::UsdGeomPrimvarsAPI(usdgeom);
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken("UVMap"),
-                    pxr::SdfValueTypeNames->TexCoord2fArray);
-                primvar.Set(mesh->get_texcoords_array());
-                if (mesh->get_texcoords_array().size() ==
-                    mesh->get_vertices().size()) {
-                    primvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                }
-                else {
-                    primvar.SetInterpolation(pxr::UsdGeomTokens->faceVarying);
-                }
+                primvars.write(
+                    "UVMap",
+                    pxr::SdfValueTypeNames->TexCoord2fArray,
+                    mesh->get_texcoords_array().size() ==
+                            mesh->get_vertices().size()
+                        ? pxr::UsdGeomTokens->vertex
+                        : pxr::UsdGeomTokens->faceVarying,
+                    mesh->get_texcoords_array());
             }
 
 #endif
-            usdgeom.CreateDoubleSidedAttr().Set(true);
+            set_value(usd_mesh.CreateDoubleSidedAttr(), true);
 
             // Store polyscope quantities
-            auto primVarAPI = pxr::UsdGeomPrimvarsAPI(usdgeom);
-
-            // It's invalid to use pxr::TfToken("some_prefix" + some_string)
-            // directly, so we need to create a new string first.
 
             for (const std::string& name :
                  mesh->get_vertex_scalar_quantity_names()) {
-                auto values = mesh->get_vertex_scalar_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:vertex:scalar:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->FloatArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:vertex:scalar:" + name,
+                    pxr::SdfValueTypeNames->FloatArray,
+                    pxr::UsdGeomTokens->vertex,
+                    mesh->get_vertex_scalar_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_face_scalar_quantity_names()) {
-                auto values = mesh->get_face_scalar_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:face:scalar:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->FloatArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->uniform);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:face:scalar:" + name,
+                    pxr::SdfValueTypeNames->FloatArray,
+                    pxr::UsdGeomTokens->uniform,
+                    mesh->get_face_scalar_quantity(name));
             }
 
-            for (std::string& name : mesh->get_vertex_color_quantity_names()) {
-                auto values = mesh->get_vertex_color_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:vertex:color:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->Color3fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                primvar.Set(values);
+            for (const std::string& name :
+                 mesh->get_vertex_color_quantity_names()) {
+                primvars.write(
+                    "polyscope:vertex:color:" + name,
+                    pxr::SdfValueTypeNames->Color3fArray,
+                    pxr::UsdGeomTokens->vertex,
+                    mesh->get_vertex_color_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_face_color_quantity_names()) {
-                auto values = mesh->get_face_color_quantity(name);
-                const std::string primvar_name = "polyscope:face:color:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->Color3fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->uniform);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:face:color:" + name,
+                    pxr::SdfValueTypeNames->Color3fArray,
+                    pxr::UsdGeomTokens->uniform,
+                    mesh->get_face_color_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_vertex_vector_quantity_names()) {
-                auto values = mesh->get_vertex_vector_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:vertex:vector:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->Vector3fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:vertex:vector:" + name,
+                    pxr::SdfValueTypeNames->Vector3fArray,
+                    pxr::UsdGeomTokens->vertex,
+                    mesh->get_vertex_vector_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_face_vector_quantity_names()) {
-                auto values = mesh->get_face_vector_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:face:vector:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->Vector3fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->uniform);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:face:vector:" + name,
+                    pxr::SdfValueTypeNames->Vector3fArray,
+                    pxr::UsdGeomTokens->uniform,
+                    mesh->get_face_vector_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_face_corner_parameterization_quantity_names()) {
-                auto values =
-                    mesh->get_face_corner_parameterization_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:face_corner:parameterization:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->TexCoord2fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->faceVarying);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:face_corner:parameterization:" + name,
+                    pxr::SdfValueTypeNames->TexCoord2fArray,
+                    pxr::UsdGeomTokens->faceVarying,
+                    mesh->get_face_corner_parameterization_quantity(name));
             }
 
             for (const std::string& name :
                  mesh->get_vertex_parameterization_quantity_names()) {
-                auto values = mesh->get_vertex_parameterization_quantity(name);
-                const std::string primvar_name =
-                    "polyscope:vertex:parameterization:" + name;
-                auto primvar = primVarAPI.CreatePrimvar(
-                    pxr::TfToken(primvar_name.c_str()),
-                    pxr::SdfValueTypeNames->TexCoord2fArray);
-                primvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-                primvar.Set(values);
+                primvars.write(
+                    "polyscope:vertex:parameterization:" + name,
+                    pxr::SdfValueTypeNames->TexCoord2fArray,
+                    pxr::UsdGeomTokens->vertex,
+                    mesh->get_vertex_parameterization_quantity(name));
             }
+#if !USE_USD_SCRATCH_BUFFER
+            primvars.remove_stale();
+#endif
         }
-    }
-    else if (points) {
-        pxr::UsdGeomPoints usdpoints =
-            pxr::UsdGeomPoints::Define(stage, sdf_path);
+        else if (points) {
+            set_value(
+                usdpoints.CreatePointsAttr(), points->get_vertices(), time);
 
-        usdpoints.CreatePointsAttr().Set(points->get_vertices(), time);
-
-        if (points->get_width().size() > 0) {
-            usdpoints.CreateWidthsAttr().Set(points->get_width(), time);
-        }
+            if (points->get_width().size() > 0) {
+                set_value(
+                    usdpoints.CreateWidthsAttr(), points->get_width(), time);
+            }
+            else {
+                remove_attribute(prim, pxr::UsdGeomTokens->widths);
+            }
 
-        auto PrimVarAPI = pxr::UsdGeomPrimvarsAPI(usdpoints);
-        if (points->get_display_color().size() > 0) {
-            pxr::UsdGeomPrimvar colorPrimvar = PrimVarAPI.CreatePrimvar(
-                pxr::TfToken("displayColor"),
-                pxr::SdfValueTypeNames->Color3fArray);
-            colorPrimvar.SetInterpolation(pxr::UsdGeomTokens->vertex);
-            colorPrimvar.Set(points->get_display_color(), time);
+            if (points->get_display_color().size() > 0) {
+                primvars.write(
+                    "displayColor",
+                    pxr::SdfValueTypeNames->Color3fArray,
+                    pxr::UsdGeomTokens->vertex,
+                    points->get_display_color(),
+                    time);
+            }
+            primvars.remove_stale();
         }
-    }
-    else if (curve) {
-        pxr::UsdGeomBasisCurves usd_curve =
-            pxr::UsdGeomBasisCurves::Define(stage, sdf_path);
-        if (usd_curve) {
+        else if (curve) {
 #if USE_USD_SCRATCH_BUFFER
             copy_prim(curve->get_usd_curve().GetPrim(), usd_curve.GetPrim());
 #else
-            usd_curve.CreatePointsAttr().Set(curve->get_vertices());
-            usd_curve.CreateWidthsAttr().Set(curve->get_width());
-            usd_curve.CreateCurveVertexCountsAttr().Set(
+            set_value(
+                usd_curve.CreatePointsAttr(),
+                curve->get_vertices(),
+                points_time);
+            set_value(usd_curve.CreateWidthsAttr(), curve->get_width());
+            set_value(
+                usd_curve.CreateCurveVertexCountsAttr(),
                 curve->get_vert_count());
-            usd_curve.CreateNormalsAttr().Set(curve->get_curve_normals());
-            usd_curve.CreateDisplayColorAttr().Set(curve->get_display_color());
-            usd_curve.CreateWrapAttr().Set(
+            set_value(
+                usd_curve.CreateNormalsAttr(),
+                curve->get_curve_normals(),
+                points_time);
+            set_value(
+                usd_curve.CreateDisplayColorAttr(),
+                curve->get_display_color());
+            set_value(
+                usd_curve.CreateWrapAttr(),
                 curve->get_periodic() ? pxr::UsdGeomTokens->periodic
                                       : pxr::UsdGeomTokens->nonperiodic);
 #endif
         }
+
+        auto xformable = pxr::UsdGeomXformable(prim);
+        auto xform_op = xformable.GetTransformOp();
+        if (!xform_op) {
+            xform_op = xformable.AddTransformOp();
+        }
+        auto xform_component = geometry.get_component<XformComponent>();
+        if (xform_component) {
+            // Transform
+            assert(
+                xform_component->translation.size() ==
+                xform_component->rotation.size());
+            set_value(
+                xform_op.GetAttr(), xform_component->get_transform(), time);
+        }
+        else {
+            set_value(xform_op.GetAttr(), pxr::GfMatrix4d(1), time);
+        }
+
+        set_value(
+            prim.CreateAttribute(
+                pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool),
+            global_payload.has_simulation);
     }
 
     // Material and Texture
@@ -325,45 +469,8 @@ NODE_EXECUTION_FUNCTION(write_usd)
         }
     }
 
-    auto xform_component = geometry.get_component<XformComponent>();
-    if (xform_component) {
-        auto usdgeom = pxr::UsdGeomXformable ::Get(stage, sdf_path);
-        // Transform
-        assert(
-            xform_component->translation.size() ==
-            xform_component->rotation.size());
-
-        pxr::GfMatrix4d final_transform = xform_component->get_transform();
-
-        auto xform_op = usdgeom.GetTransformOp();
-        if (!xform_op) {
-            xform_op = usdgeom.AddTransformOp();
-        }
-        xform_op.Set(final_transform, time);
-    }
-    else {
-        auto usdgeom = pxr::UsdGeomXformable ::Get(stage, sdf_path);
-        auto xform_op = usdgeom.GetTransformOp();
-        if (!xform_op) {
-            xform_op = usdgeom.AddTransformOp();
-        }
-        xform_op.Set(pxr::GfMatrix4d(1), time);
-    }
-
-    if (global_payload.has_simulation) {
-        pxr::UsdPrim prim = stage->GetPrimAtPath(sdf_path);
-        prim.CreateAttribute(
-                pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool)
-            .Set(true);
-    }
-    else {
-        pxr::UsdPrim prim = stage->GetPrimAtPath(sdf_path);
-        prim.CreateAttribute(
-                pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool)
-            .Set(false);
-    }
 
-    pxr::UsdGeomImageable(stage->GetPrimAtPath(sdf_path)).MakeVisible();
+    pxr::UsdGeomImageable(prim).MakeVisible();
     return true;
 }
 
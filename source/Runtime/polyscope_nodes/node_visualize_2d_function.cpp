@@ -4,6 +4,7 @@
 #include <Eigen/Core>
 #include <functional>
 
+#include "GCore/Algorithms/mean_value_coordinates.h"
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/GOP.h"
 #include "GCore/geom_payload.hpp"
@@ -20,6 +21,9 @@ NODE_DECLARATION_FUNCTION(visualize_2d_function)
     b.add_input<Geometry>("geometry");
     // 输入一个二维函数，返回一个标量
     b.add_input<std::function<float(float, float)>>("function");
+    // Mean value coordinates, evaluated for all points at once instead of
+    // the function; adds one quantity per coordinate
+    b.add_input<MeanValueCoordinatesHandle>("coordinates");
     // 三角形最大面积的倒数
     b.add_input<int>("fineness").min(2).max(5).default_val(5);
     b.add_output<Geometry>("geometry");
@@ -70,6 +74,14 @@ NODE_EXECUTION_FUNCTION(visualize_2d_function)
     // 获取输入的二维函数
     auto function =
         params.get_input<std::function<float(float, float)>>("function");
+    auto coordinates =
+        params.get_input<MeanValueCoordinatesHandle>("coordinates");
+    if (!function && !coordinates) {
+        std::cerr << "Visualize 2D Function Node: Need a function or "
+                     "coordinates."
+                  << std::endl;
+        return false;
+    }
 
     // 获取三角形最大面积的倒数
     auto fineness = params.get_input<int>("fineness");
@@ -128,13 +140,32 @@ NODE_EXECUTION_FUNCTION(visualize_2d_function)
     geometry_2.attach_component(mesh_2);
 
     // 添加顶点标量
-    pxr::VtArray<float> vertex_scalar(V2.rows());
-    for (int i = 0; i < V2.rows(); ++i) {
-        vertex_scalar[i] = function(V2(i, 0), V2(i, 1));
+    if (coordinates) {
+        // One batch for all vertices rather than a call per vertex.
+        pxr::VtArray<pxr::GfVec2f> points(V2.rows());
+        for (int i = 0; i < V2.rows(); ++i) {
+            points[i] = { V2(i, 0), V2(i, 1) };
+        }
+        const MeanValueCoordinates::Weights weights =
+            coordinates->evaluate(points);
+        for (Eigen::Index k = 0; k < weights.cols(); ++k) {
+            pxr::VtArray<float> vertex_scalar(V2.rows());
+            for (int i = 0; i < V2.rows(); ++i) {
+                vertex_scalar[i] = weights(i, k);
+            }
+            mesh_2->add_vertex_scalar_quantity(
+                "coordinate " + std::to_string(k), vertex_scalar);
+        }
     }
-    // surface_mesh->addVertexScalarQuantity("function", vertex_scalar);
+    else {
+        pxr::VtArray<float> vertex_scalar(V2.rows());
+        for (int i = 0; i < V2.rows(); ++i) {
+            vertex_scalar[i] = function(V2(i, 0), V2(i, 1));
+        }
+        // surface_mesh->addVertexScalarQuantity("function", vertex_scalar);
 
-    mesh_2->add_vertex_scalar_quantity("function", vertex_scalar);
+        mesh_2->add_vertex_scalar_quantity("function", vertex_scalar);
+    }
 
     params.set_output("geometry", geometry_2);
 
@@ -221,30 +252,36 @@ NODE_DECLARATION_UI(random_2d_polygon);
 
 NODE_DECLARATION_FUNCTION(function_decompose)
 {
-    b.add_input<std::function<std::vector<float>(float, float)>>("function");
+    b.add_input<MeanValueCoordinatesHandle>("function");
     b.add_input<int>("index").min(0).max(10).default_val(0);
     b.add_output<std::function<float(float, float)>>("function");
 }
 
 NODE_EXECUTION_FUNCTION(function_decompose)
 {
-    auto function =
-        params.get_input<std::function<std::vector<float>(float, float)>>(
-            "function");
+    auto coordinates = params.get_input<MeanValueCoordinatesHandle>("function");
     auto index = params.get_input<int>("index");
 
+    if (!coordinates) {
+        std::cerr << "Function Decompose Node: Need coordinates." << std::endl;
+        return false;
+    }
     // 获取函数的分量
-    auto function_component = function(0.0f, 0.0f);
-    if (index < 0 || index >= function_component.size()) {
+    if (index < 0 || index >= coordinates->size()) {
         std::cerr << "Index out of bounds for function decomposition."
                   << std::endl;
         return false;
     }
 
     // 创建新的函数，返回指定分量
-    auto new_function = [function, index](float x, float y) {
-        auto components = function(x, y);
-        return components[index];
+    // Point by point evaluation is slow; the coordinates input of
+    // visualize_2d_function takes all points at once.
+    auto new_function = [coordinates, index](float x, float y) {
+        thread_local std::vector<float> weights;
+        weights.resize(coordinates->size());
+        const pxr::GfVec2f point(x, y);
+        coordinates->evaluate(&point, 1, weights.data());
+        return weights[index];
     };
 
     // 设置输出
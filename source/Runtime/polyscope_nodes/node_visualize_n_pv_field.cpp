@@ -1,13 +1,10 @@
 
 #include <pxr/base/vt/array.h>
 
-#include <vector>
-
-#include "Eigen/Core"
+#include "GCore/Algorithms/cross_field.h"
 #include "GCore/Components/CurveComponent.h"
 #include "GCore/Components/MeshOperand.h"
 #include "GCore/GOP.h"
-#include "GCore/util_openmesh_bind.h"
 #include "nodes/core/def/node_def.hpp"
 #include "polyscope_widget/polyscope_renderer.h"
 
@@ -18,8 +15,7 @@ NODE_DECLARATION_FUNCTION(visualize_n_pv_field)
     // Input-1: Original 3D mesh
     b.add_input<Geometry>("Original Mesh");
     // Input-2: N-PolyVector field
-    b.add_input<std::vector<std::vector<Eigen::Vector3d>>>(
-        "N-PolyVector Field");
+    b.add_input<FaceFrames>("N-PolyVector Field");
     // Output-1: Node curve
     b.add_output<Geometry>("Output");
 }
@@ -28,9 +24,7 @@ NODE_EXECUTION_FUNCTION(visualize_n_pv_field)
 {
     // Get the input
     auto input_mesh = params.get_input<Geometry>("Original Mesh");
-    auto n_pv_field =
-        params.get_input<std::vector<std::vector<Eigen::Vector3d>>>(
-            "N-PolyVector Field");
+    auto n_pv_field = params.get_input<FaceFrames>("N-PolyVector Field");
 
     // Avoid processing the node when there is no input
     if (!input_mesh.get_component<MeshComponent>()) {
@@ -42,34 +36,27 @@ NODE_EXECUTION_FUNCTION(visualize_n_pv_field)
     auto mesh = input_mesh.get_component<MeshComponent>();
 
     // Check if the N-PolyVector field is valid
-    if (n_pv_field.empty() ||
-        n_pv_field.size() != mesh->get_face_vertex_counts().size()) {
+    const size_t face_count = n_pv_field.centroids.size();
+    if (face_count == 0 || n_pv_field.symmetry < 1 ||
+        face_count != mesh->get_face_vertex_counts().size() ||
+        n_pv_field.directions.size() != face_count * n_pv_field.symmetry) {
         std::cerr
             << "N-PolyVector field visualizer: Invalid N-PolyVector field."
             << std::endl;
         return false;
     }
 
-    pxr::VtArray<pxr::GfVec3f> vertices;
-    pxr::VtArray<int> vertex_counts;
-
-    auto halfedge_mesh = operand_to_openmesh(&input_mesh);
-
-    for (auto it = halfedge_mesh->faces_sbegin();
-         it != halfedge_mesh->faces_end();
-         it++) {
-        auto fh = *it;
-        auto centroid = halfedge_mesh->calc_face_centroid(fh);
-        auto frame_fields = n_pv_field[fh.idx()];
-        for (const auto& field : frame_fields) {
-            vertices.push_back({ static_cast<float>(centroid[0]),
-                                 static_cast<float>(centroid[1]),
-                                 static_cast<float>(centroid[2]) });
-            vertices.push_back({ static_cast<float>(centroid[0] + field[0]),
-                                 static_cast<float>(centroid[1] + field[1]),
-                                 static_cast<float>(centroid[2] + field[2]) });
-            vertex_counts.push_back(2);
-        }
+    // One segment from the face centroid along each direction, read
+    // straight from the frame arrays
+    const size_t segment_count = n_pv_field.directions.size();
+    pxr::VtArray<pxr::GfVec3f> vertices(2 * segment_count);
+    pxr::VtArray<int> vertex_counts(segment_count, 2);
+    const pxr::GfVec3f* centroids = n_pv_field.centroids.cdata();
+    const pxr::GfVec3f* directions = n_pv_field.directions.cdata();
+    for (size_t i = 0; i < segment_count; ++i) {
+        const pxr::GfVec3f& centroid = centroids[i / n_pv_field.symmetry];
+        vertices[2 * i] = centroid;
+        vertices[2 * i + 1] = centroid + directions[i];
     }
 
     // Create a new Geometry to hold the output
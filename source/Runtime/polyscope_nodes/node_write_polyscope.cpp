@@ -1,5 +1,8 @@
+#include <map>
 #include <memory>
+#include <set>
 
+#include "GCore/Algorithms/hash.h"
 #include "GCore/Components/CurveComponent.h"
 #include "GCore/Components/MaterialComponent.h"
 #include "GCore/Components/MeshOperand.h"
@@ -40,6 +43,100 @@ bool legal(const std::string& string)
     return false;
 }
 
+// What this node last handed to polyscope for each structure, so that
+// re-executing the tree only uploads what changed: positions alone when the
+// topology is the same, and only the quantities whose values changed.
+namespace {
+struct SentStructure {
+    polyscope::Structure* structure = nullptr;
+    uint64_t topology = 0;
+    uint64_t positions = 0;
+    std::map<std::string, uint64_t> quantities;
+};
+
+std::map<std::string, SentStructure> sent_structures;
+
+// Builds the mesh straight from the flat USD face arrays, without a nested
+// list of faces.
+polyscope::SurfaceMesh* register_surface_mesh(
+    const std::string& name,
+    const pxr::VtArray<pxr::GfVec3f>& vertices,
+    const pxr::VtArray<int>& face_vertex_counts,
+    const pxr::VtArray<int>& face_vertex_indices)
+{
+    static_assert(sizeof(pxr::GfVec3f) == sizeof(glm::vec3));
+    const auto* positions =
+        reinterpret_cast<const glm::vec3*>(vertices.cdata());
+    std::vector<uint32_t> face_starts(face_vertex_counts.size() + 1);
+    face_starts[0] = 0;
+    for (size_t i = 0; i < face_vertex_counts.size(); ++i) {
+        face_starts[i + 1] = face_starts[i] + face_vertex_counts[i];
+    }
+    auto* surface_mesh = new polyscope::SurfaceMesh(
+        name,
+        std::vector<glm::vec3>(positions, positions + vertices.size()),
+        std::vector<uint32_t>(
+            face_vertex_indices.begin(), face_vertex_indices.end()),
+        std::move(face_starts));
+    polyscope::registerStructure(surface_mesh);
+    return surface_mesh;
+}
+
+// Re-adds a quantity only when its values changed since the last execution,
+// and removes the quantities that are no longer produced.
+template<typename S>
+class QuantityUpdater {
+   public:
+    QuantityUpdater(S* structure, SentStructure& sent)
+        : structure_(structure),
+          sent_(sent)
+    {
+    }
+
+    template<typename T, typename F>
+    void update(
+        const std::string& name,
+        const pxr::VtArray<T>& values,
+        F&& add)
+    {
+        seen_.insert(name);
+        const uint64_t hash = hash_array(values);
+        auto sent = sent_.quantities.find(name);
+        if (sent != sent_.quantities.end() && sent->second == hash) {
+            return;
+        }
+        try {
+            add();
+            sent_.quantities[name] = hash;
+        }
+        catch (std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            failed_ = true;
+        }
+    }
+
+    bool finish()
+    {
+        for (auto it = sent_.quantities.begin();
+             it != sent_.quantities.end();) {
+            if (seen_.count(it->first)) {
+                ++it;
+                continue;
+            }
+            structure_->removeQuantity(it->first);
+            it = sent_.quantities.erase(it);
+        }
+        return !failed_;
+    }
+
+   private:
+    S* structure_;
+    SentStructure& sent_;
+    std::set<std::string> seen_;
+    bool failed_ = false;
+};
+}  // namespace
+
 // TODO: Test and add support for materials and textures
 // The current implementation has not been fully tested yet
 NODE_EXECUTION_FUNCTION(write_polyscope)
@@ -66,146 +163,103 @@ NODE_EXECUTION_FUNCTION(write_polyscope)
     auto sdf_path = global_payload.prim_path;
 
     polyscope::Structure* structure = nullptr;
+    const std::string structure_name = sdf_path.GetString();
+    auto& sent = sent_structures[structure_name];
 
     if (mesh) {
         auto vertices = mesh->get_vertices();
-        // faceVertexIndices是一个一维数组，每faceVertexCounts[i]个元素表示一个面
-        auto faceVertexCounts = mesh->get_face_vertex_counts();
-        auto faceVertexIndices = mesh->get_face_vertex_indices();
         auto display_color = mesh->get_display_color();
-        // 转换为nested array
-        std::vector<std::vector<size_t>> faceVertexIndicesNested;
-        faceVertexIndicesNested.resize(faceVertexCounts.size());
-        size_t start = 0;
-        for (int i = 0; i < faceVertexCounts.size(); i++) {
-            std::vector<size_t> face;
-            face.resize(faceVertexCounts[i]);
-            for (int j = 0; j < faceVertexCounts[i]; j++) {
-                face[j] = faceVertexIndices[start + j];
-            }
-            faceVertexIndicesNested[i] = std::move(face);
-            start += faceVertexCounts[i];
-        }
 
-        polyscope::SurfaceMesh* surface_mesh = polyscope::registerSurfaceMesh(
-            sdf_path.GetString(), vertices, faceVertexIndicesNested);
+        polyscope::SurfaceMesh* surface_mesh =
+            polyscope::hasSurfaceMesh(structure_name)
+                ? polyscope::getSurfaceMesh(structure_name)
+                : nullptr;
+        const uint64_t topology = mesh->topology_hash();
+        const uint64_t positions = mesh->positions_hash();
+        if (!surface_mesh || surface_mesh != sent.structure ||
+            sent.topology != topology ||
+            surface_mesh->nVertices() != vertices.size()) {
+            surface_mesh = register_surface_mesh(
+                structure_name,
+                vertices,
+                mesh->get_face_vertex_counts(),
+                mesh->get_face_vertex_indices());
+            sent = { surface_mesh, topology, positions, {} };
+        }
+        else if (sent.positions != positions) {
+            surface_mesh->updateVertexPositions(vertices);
+            sent.positions = positions;
+        }
 
+        QuantityUpdater quantities(surface_mesh, sent);
         if (display_color.size() > 0) {
-            try {
+            quantities.update("usd_color", display_color, [&] {
                 surface_mesh->addVertexColorQuantity("usd_color", display_color)
                     ->setEnabled(true);
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+            });
         }
 
-        auto vertex_scalar_quantity_names =
-            mesh->get_vertex_scalar_quantity_names();
-        auto face_scalar_quantity_names =
-            mesh->get_face_scalar_quantity_names();
-        auto vertex_color_quantity_names =
-            mesh->get_vertex_color_quantity_names();
-        auto face_color_quantity_names = mesh->get_face_color_quantity_names();
-        auto vertex_vector_quantity_names =
-            mesh->get_vertex_vector_quantity_names();
-        auto face_vector_quantity_names =
-            mesh->get_face_vector_quantity_names();
-        auto face_corner_parameterization_quantity_names =
-            mesh->get_face_corner_parameterization_quantity_names();
-        auto vertex_parameterization_quantity_names =
-            mesh->get_vertex_parameterization_quantity_names();
-
-        for (const auto& name : vertex_scalar_quantity_names) {
-            try {
-                surface_mesh->addVertexScalarQuantity(
-                    name, mesh->get_vertex_scalar_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_vertex_scalar_quantity_names()) {
+            auto values = mesh->get_vertex_scalar_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addVertexScalarQuantity(name, values);
+            });
         }
 
-        for (const auto& name : face_scalar_quantity_names) {
-            try {
-                surface_mesh->addFaceScalarQuantity(
-                    name, mesh->get_face_scalar_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_face_scalar_quantity_names()) {
+            auto values = mesh->get_face_scalar_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addFaceScalarQuantity(name, values);
+            });
         }
 
-        for (const auto& name : vertex_color_quantity_names) {
-            try {
-                surface_mesh->addVertexColorQuantity(
-                    name, mesh->get_vertex_color_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_vertex_color_quantity_names()) {
+            auto values = mesh->get_vertex_color_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addVertexColorQuantity(name, values);
+            });
         }
 
-        for (const auto& name : face_color_quantity_names) {
-            try {
-                surface_mesh->addFaceColorQuantity(
-                    name, mesh->get_face_color_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_face_color_quantity_names()) {
+            auto values = mesh->get_face_color_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addFaceColorQuantity(name, values);
+            });
         }
 
-        for (const auto& name : vertex_vector_quantity_names) {
-            try {
-                surface_mesh->addVertexVectorQuantity(
-                    name, mesh->get_vertex_vector_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_vertex_vector_quantity_names()) {
+            auto values = mesh->get_vertex_vector_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addVertexVectorQuantity(name, values);
+            });
         }
 
-        for (const auto& name : face_vector_quantity_names) {
-            try {
-                surface_mesh->addFaceVectorQuantity(
-                    name, mesh->get_face_vector_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name : mesh->get_face_vector_quantity_names()) {
+            auto values = mesh->get_face_vector_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addFaceVectorQuantity(name, values);
+            });
         }
 
-        for (const auto& name : face_corner_parameterization_quantity_names) {
-            try {
-                surface_mesh->addParameterizationQuantity(
-                    name,
-                    mesh->get_face_corner_parameterization_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name :
+             mesh->get_face_corner_parameterization_quantity_names()) {
+            auto values = mesh->get_face_corner_parameterization_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addParameterizationQuantity(name, values);
+            });
         }
 
-        for (const auto& name : vertex_parameterization_quantity_names) {
-            try {
-                surface_mesh->addVertexParameterizationQuantity(
-                    name, mesh->get_vertex_parameterization_quantity(name));
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+        for (const auto& name :
+             mesh->get_vertex_parameterization_quantity_names()) {
+            auto values = mesh->get_vertex_parameterization_quantity(name);
+            quantities.update(name, values, [&] {
+                surface_mesh->addVertexParameterizationQuantity(name, values);
+            });
         }
 
+        if (!quantities.finish()) {
+            return false;
+        }
         structure = surface_mesh;
     }
     else if (points) {
@@ -214,52 +268,77 @@ NODE_EXECUTION_FUNCTION(write_polyscope)
         auto width = points->get_width();
 
         polyscope::PointCloud* point_cloud =
-            polyscope::registerPointCloud(sdf_path.GetString(), vertices);
+            polyscope::hasPointCloud(structure_name)
+                ? polyscope::getPointCloud(structure_name)
+                : nullptr;
+        const uint64_t positions = points->positions_hash();
+        if (!point_cloud || point_cloud != sent.structure ||
+            point_cloud->nPoints() != vertices.size()) {
+            point_cloud =
+                polyscope::registerPointCloud(structure_name, vertices);
+            sent = { point_cloud, 0, positions, {} };
+        }
+        else if (sent.positions != positions) {
+            point_cloud->updatePointPositions(vertices);
+            sent.positions = positions;
+        }
 
+        QuantityUpdater quantities(point_cloud, sent);
         if (width.size() > 0) {
-            try {
+            quantities.update("width", width, [&] {
                 point_cloud->addScalarQuantity("width", width);
                 point_cloud->setPointRadiusQuantity("width");
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+            });
+        }
+        else if (sent.quantities.count("width")) {
+            point_cloud->clearPointRadiusQuantity();
         }
 
         if (display_color.size() > 0) {
-            try {
+            quantities.update("color", display_color, [&] {
                 point_cloud->addColorQuantity("color", display_color)
                     ->setEnabled(true);
-            }
-            catch (std::exception& e) {
-                std::cerr << e.what() << std::endl;
-                return false;
-            }
+            });
         }
 
+        if (!quantities.finish()) {
+            return false;
+        }
         structure = point_cloud;
     }
     else if (curve) {
         auto vertices = curve->get_vertices();
         // vert_count是一个一维数组，每个元素表示一个curve的点数，vertices中每vert_count[i]个元素表示一个curve
         auto vert_count = curve->get_vert_count();
-        auto width = curve->get_width();
-        auto display_color = curve->get_display_color();
-        // 转换为edge array
-        std::vector<std::array<size_t, 2>> edges;
-        edges.reserve(vertices.size());
-        size_t start = 0;
-        for (int i = 0; i < vert_count.size(); i++) {
-            for (int j = 0; j < vert_count[i] - 1; j++) {
-                edges.push_back({ start + j, start + j + 1 });
-            }
-            start += vert_count[i];
-        }
 
         polyscope::CurveNetwork* curve_network =
-            polyscope::registerCurveNetwork(
-                sdf_path.GetString(), vertices, edges);
+            polyscope::hasCurveNetwork(structure_name)
+                ? polyscope::getCurveNetwork(structure_name)
+                : nullptr;
+        const uint64_t topology = curve->topology_hash();
+        const uint64_t positions = curve->positions_hash();
+        if (!curve_network || curve_network != sent.structure ||
+            sent.topology != topology ||
+            curve_network->nNodes() != vertices.size()) {
+            // 转换为edge array
+            std::vector<std::array<size_t, 2>> edges;
+            edges.reserve(vertices.size());
+            size_t start = 0;
+            for (int i = 0; i < vert_count.size(); i++) {
+                for (int j = 0; j < vert_count[i] - 1; j++) {
+                    edges.push_back({ start + j, start + j + 1 });
+                }
+                start += vert_count[i];
+            }
+
+            curve_network = polyscope::registerCurveNetwork(
+                structure_name, vertices, edges);
+            sent = { curve_network, topology, positions, {} };
+        }
+        else if (sent.positions != positions) {
+            curve_network->updateNodePositions(vertices);
+            sent.positions = positions;
+        }
 
         structure = curve_network;
     }
@@ -56,7 +56,42 @@ class STAGE_API Stage {
         const std::string& path_string,
         const pxr::SdfPath& sdf_path);
 
+    // Starts baking the animatable prim at path: its node tree runs for
+    // frame_count frames of delta_time from start_time, and the frames are
+    // stored as value clips of frames_per_clip frames in directory, by
+    // default next to the stage file. The frames are simulated by
+    // step_bake(), so that the caller can keep drawing in between. Until
+    // clear_bake() is called, a baked prim plays back from the clips and its
+    // tree is no longer executed by tick().
+    bool begin_bake(
+        const pxr::SdfPath& path,
+        double start_time,
+        double delta_time,
+        size_t frame_count,
+        size_t frames_per_clip = 100,
+        const std::filesystem::path& directory = {});
+    // Simulates up to max_frames more frames of the bake in progress, and
+    // stores the clips after the last one. Returns false if the bake failed.
+    bool step_bake(size_t max_frames);
+    // Drops the bake in progress; the prim keeps running its tree.
+    void cancel_bake();
+    [[nodiscard]] bool is_baking() const;
+    // Fraction of the frames of the bake in progress simulated so far.
+    [[nodiscard]] float bake_progress() const;
+    // begin_bake() and all frames at once.
+    bool bake(
+        const pxr::SdfPath& path,
+        double start_time,
+        double delta_time,
+        size_t frame_count,
+        size_t frames_per_clip = 100,
+        const std::filesystem::path& directory = {});
+    void clear_bake(const pxr::SdfPath& path);
+
    private:
+    struct Bake;
+    bool finish_bake();
+
     pxr::UsdStageRefPtr stage;
     pxr::SdfPath create_editor_pending_path;
     pxr::UsdTimeCode current_time_code = pxr::UsdTimeCode::Default();
@@ -68,6 +103,7 @@ class STAGE_API Stage {
         animation::WithDynamicLogicPrim,
         pxr::SdfPath::Hash>
         animatable_prims;
+    std::unique_ptr<Bake> baking;
 };
 
 STAGE_API std::unique_ptr<Stage> create_global_stage();
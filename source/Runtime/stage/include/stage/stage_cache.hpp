@@ -0,0 +1,27 @@
+#pragma once
+#include <pxr/usd/usd/stage.h>
+
+#include <filesystem>
+
+#include "stage/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+// Process-wide cache of stages opened from files, shared by every node that
+// reads USD assets, so that several nodes reading the same file parse it
+// once.
+//
+// Stages are keyed on the canonical path of the file. When the modification
+// time or the size of the file changed since the stage was opened, its
+// layers are reloaded from disk before the stage is returned. At most
+// stage_cache_capacity stages are kept; the least recently used one is
+// dropped first.
+constexpr size_t stage_cache_capacity = 8;
+
+// Returns a null stage if the file cannot be opened.
+STAGE_API pxr::UsdStageRefPtr open_cached_stage(
+    const std::filesystem::path& path);
+
+STAGE_API void clear_stage_cache();
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
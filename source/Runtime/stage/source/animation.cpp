@@ -2,6 +2,7 @@
 
 #include "../../../Editor/geometry/include/GCore/geom_payload.hpp"
 #include "pxr/usd/usd/attribute.h"
+#include "pxr/usd/usd/clipsAPI.h"
 #include "pxr/usd/usdGeom/xform.h"
 USTC_CG_NAMESPACE_OPEN_SCOPE
 namespace animation {
@@ -65,7 +66,8 @@ WithDynamicLogicPrim& WithDynamicLogicPrim::operator=(
     return *this;
 }
 
-void WithDynamicLogicPrim::update(float delta_time) const
+void WithDynamicLogicPrim::update(float delta_time, pxr::UsdTimeCode time)
+    const
 {
     auto json_path = prim.GetAttribute(pxr::TfToken("node_json"));
     if (!json_path) {
@@ -88,6 +90,7 @@ void WithDynamicLogicPrim::update(float delta_time) const
 
     auto& payload = node_tree_executor->get_global_payload<GeomPayload&>();
     payload.delta_time = delta_time;
+    payload.current_time = time;
     payload.stage = prim.GetStage();
     payload.prim_path = prim.GetPath();
     payload.has_simulation = false;
@@ -101,6 +104,11 @@ void WithDynamicLogicPrim::update(float delta_time) const
     node_tree_executor->execute(node_tree.get());
 }
 
+void WithDynamicLogicPrim::reset()
+{
+    simulation_begun = false;
+}
+
 // Check whethe r important attributes have time samples
 bool WithDynamicLogicPrim::is_animatable(const pxr::UsdPrim& prim)
 {
@@ -113,6 +121,13 @@ bool WithDynamicLogicPrim::is_animatable(const pxr::UsdPrim& prim)
     animatable.Get(&is_animatable);
     return is_animatable;
 }
+
+bool WithDynamicLogicPrim::is_baked(const pxr::UsdPrim& prim)
+{
+    pxr::VtArray<pxr::SdfAssetPath> clip_assets;
+    return pxr::UsdClipsAPI(prim).GetClipAssetPaths(&clip_assets) &&
+           !clip_assets.empty();
+}
 }  // namespace animation
 
 USTC_CG_NAMESPACE_CLOSE_SCOPE
\ No newline at end of file
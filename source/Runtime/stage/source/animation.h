@@ -11,7 +11,8 @@ namespace animation {
 class WithDynamicLogic {
    public:
     virtual ~WithDynamicLogic() = default;
-    virtual void update(float delta_time) const = 0;
+    // Advances the logic by delta_time, to the stage time `time`.
+    virtual void update(float delta_time, pxr::UsdTimeCode time) const = 0;
 };
 
 class WithDynamicLogicPrim : public WithDynamicLogic {
@@ -22,8 +23,12 @@ class WithDynamicLogicPrim : public WithDynamicLogic {
     WithDynamicLogicPrim(const WithDynamicLogicPrim& prim);
     WithDynamicLogicPrim& operator=(const WithDynamicLogicPrim& prim);
 
-    void update(float delta_time) const override;
+    void update(float delta_time, pxr::UsdTimeCode time) const override;
+    // The next update() starts the simulation over.
+    void reset();
     static bool is_animatable(const pxr::UsdPrim& prim);
+    // Whether the prim plays back baked value clips.
+    static bool is_baked(const pxr::UsdPrim& prim);
 
    private:
     mutable bool simulation_begun = false;
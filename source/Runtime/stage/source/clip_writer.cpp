@@ -0,0 +1,209 @@
+#include "clip_writer.h"
+
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/usd/attribute.h>
+
+#include <algorithm>
+
+#include "Logger/Logger.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+namespace animation {
+
+// Frames captured ahead of the writer before push() waits.
+static constexpr size_t max_queued_frames = 64;
+
+ClipWriter::ClipWriter(
+    const pxr::SdfPath& prim_path,
+    const std::filesystem::path& directory,
+    const std::string& base,
+    size_t frames_per_clip)
+    : prim_path_(prim_path),
+      directory_(directory),
+      base_(base),
+      frames_per_clip_(std::max<size_t>(frames_per_clip, 1))
+{
+    thread_ = std::thread([this] { run(); });
+}
+
+ClipWriter::~ClipWriter()
+{
+    {
+        std::lock_guard lock(mutex_);
+        done_ = true;
+    }
+    ready_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ClipWriter::push(const pxr::UsdPrim& prim, double time)
+{
+    // The node tree and its trigger are not part of the animation.
+    static const pxr::TfToken node_json("node_json");
+    static const pxr::TfToken animatable("Animatable");
+
+    Frame frame{ time, {} };
+    for (const auto& attr : prim.GetAuthoredAttributes()) {
+        const pxr::TfToken& name = attr.GetName();
+        if (attr.GetVariability() != pxr::SdfVariabilityVarying ||
+            name == node_json || name == animatable) {
+            continue;
+        }
+        pxr::VtValue value;
+        if (attr.Get(&value, time)) {
+            frame.values.push_back(
+                { name, attr.GetTypeName(), std::move(value) });
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    drained_.wait(lock, [&] { return queue_.size() < max_queued_frames; });
+    queue_.push_back(std::move(frame));
+    lock.unlock();
+    ready_.notify_one();
+}
+
+bool ClipWriter::finish()
+{
+    {
+        std::lock_guard lock(mutex_);
+        done_ = true;
+    }
+    ready_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    // The manifest declares every attribute that any clip provides.
+    auto manifest = pxr::SdfLayer::CreateAnonymous(".usda");
+    auto prim_spec = pxr::SdfCreatePrimInLayer(manifest, prim_path_);
+    for (const auto& [name, type] : types_) {
+        pxr::SdfAttributeSpec::New(prim_spec, name, type);
+    }
+    manifest_ = base_ + ".manifest.usda";
+    const auto manifest_path = (directory_ / manifest_).string();
+    if (!manifest->Export(manifest_path)) {
+        log::error("Failed to write clip manifest %s.", manifest_path.c_str());
+        failed_ = true;
+    }
+    return !failed_;
+}
+
+void ClipWriter::discard()
+{
+    {
+        std::lock_guard lock(mutex_);
+        done_ = true;
+        discarded_ = true;
+        queue_.clear();
+    }
+    ready_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    for (const auto& clip : clips_) {
+        std::error_code error;
+        std::filesystem::remove(directory_ / clip.file, error);
+    }
+    clips_.clear();
+    types_.clear();
+}
+
+std::vector<pxr::TfToken> ClipWriter::attribute_names() const
+{
+    std::vector<pxr::TfToken> names;
+    for (const auto& [name, type] : types_) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+void ClipWriter::run()
+{
+    bool discarded = false;
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock lock(mutex_);
+            ready_.wait(lock, [&] { return done_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                discarded = discarded_;
+                break;
+            }
+            frame = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        drained_.notify_one();
+        write_frame(frame);
+    }
+    if (layer_ && !discarded) {
+        save_clip();
+    }
+}
+
+void ClipWriter::write_frame(Frame& frame)
+{
+    if (!layer_) {
+        layer_ = pxr::SdfLayer::CreateAnonymous(".usdc");
+        pxr::SdfCreatePrimInLayer(layer_, prim_path_);
+        clips_.push_back(
+            { pxr::TfStringPrintf(
+                  "%s.%04zu.usdc", base_.c_str(), clips_.size()),
+              frame.time,
+              frame.time });
+        held_.clear();
+    }
+
+    for (auto& [name, type, value] : frame.values) {
+        types_.emplace(name, type);
+        const pxr::SdfPath attr_path = prim_path_.AppendProperty(name);
+        auto held = held_.find(name);
+        if (held == held_.end()) {
+            if (!layer_->GetAttributeAtPath(attr_path)) {
+                pxr::SdfAttributeSpec::New(
+                    layer_->GetPrimAtPath(prim_path_), name, type);
+            }
+            layer_->SetTimeSample(attr_path, frame.time, value);
+            held_.emplace(name, Held{ std::move(value), frame.time, true });
+            continue;
+        }
+        if (held->second.value == value) {
+            held->second.time = frame.time;
+            held->second.written = false;
+            continue;
+        }
+        if (!held->second.written) {
+            layer_->SetTimeSample(
+                attr_path, held->second.time, held->second.value);
+        }
+        layer_->SetTimeSample(attr_path, frame.time, value);
+        held->second = Held{ std::move(value), frame.time, true };
+    }
+
+    clips_.back().end_time = frame.time;
+    if (++frame_in_clip_ == frames_per_clip_) {
+        save_clip();
+    }
+}
+
+bool ClipWriter::save_clip()
+{
+    const auto path = (directory_ / clips_.back().file).string();
+    const bool saved = layer_->Export(path);
+    if (!saved) {
+        log::error("Failed to write clip %s.", path.c_str());
+        failed_ = true;
+    }
+    layer_.Reset();
+    frame_in_clip_ = 0;
+    return saved;
+}
+
+}  // namespace animation
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,116 @@
+#pragma once
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/prim.h>
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stage/api.h"
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+namespace animation {
+
+// Streams the frames of a simulated prim into value clip layers, one layer
+// per frames_per_clip frames, on a background thread.
+//
+// push() snapshots the varying attributes of the prim on the calling thread.
+// Arrays are only referenced, not copied: the stage replaces them on the next
+// frame instead of modifying them. Inside a clip, a value that does not
+// change is written once, plus one sample right before it changes, so that
+// linear interpolation still holds it.
+class ClipWriter {
+   public:
+    struct Clip {
+        std::string file;
+        double start_time;
+        double end_time;
+    };
+
+    // Clip files are named <base>.<index>.usdc and the manifest
+    // <base>.manifest.usda, all in directory.
+    ClipWriter(
+        const pxr::SdfPath& prim_path,
+        const std::filesystem::path& directory,
+        const std::string& base,
+        size_t frames_per_clip);
+    ~ClipWriter();
+
+    ClipWriter(const ClipWriter&) = delete;
+    ClipWriter& operator=(const ClipWriter&) = delete;
+
+    // Captures the prim at time. Blocks while the writer is too far behind.
+    void push(const pxr::UsdPrim& prim, double time);
+
+    // Waits for the writer and saves the manifest. Returns false if any file
+    // could not be written.
+    bool finish();
+
+    // Stops the writer without saving the clip in progress, and deletes the
+    // clips it already wrote. Frames still queued are dropped.
+    void discard();
+
+    const std::vector<Clip>& clips() const
+    {
+        return clips_;
+    }
+    const std::string& manifest() const
+    {
+        return manifest_;
+    }
+    // Names of all attributes that went into the clips.
+    std::vector<pxr::TfToken> attribute_names() const;
+
+   private:
+    struct Value {
+        pxr::TfToken name;
+        pxr::SdfValueTypeName type;
+        pxr::VtValue value;
+    };
+    struct Frame {
+        double time;
+        std::vector<Value> values;
+    };
+    // Last value seen for an attribute in the current clip.
+    struct Held {
+        pxr::VtValue value;
+        double time;
+        bool written;
+    };
+
+    void run();
+    void write_frame(Frame& frame);
+    bool save_clip();
+
+    pxr::SdfPath prim_path_;
+    std::filesystem::path directory_;
+    std::string base_;
+    size_t frames_per_clip_;
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::condition_variable drained_;
+    std::deque<Frame> queue_;
+    bool done_ = false;
+    bool discarded_ = false;
+    std::thread thread_;
+
+    // Owned by the writer thread until finish().
+    pxr::SdfLayerRefPtr layer_;
+    size_t frame_in_clip_ = 0;
+    std::map<pxr::TfToken, Held> held_;
+    std::map<pxr::TfToken, pxr::SdfValueTypeName> types_;
+    std::vector<Clip> clips_;
+    std::string manifest_;
+    bool failed_ = false;
+};
+
+}  // namespace animation
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -1,6 +1,8 @@
 #include "stage/stage.hpp"
 
+#include <pxr/base/tf/stringUtils.h>
 #include <pxr/pxr.h>
+#include <pxr/usd/usd/clipsAPI.h>
 #include <pxr/usd/usd/payloads.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primRange.h>
@@ -11,10 +13,23 @@
 #include <pxr/usd/usdGeom/xform.h>
 
 #include "animation.h"
+#include "clip_writer.h"
 
 USTC_CG_NAMESPACE_OPEN_SCOPE
 #define SAVE_ALL_THE_TIME 0
 
+// A bake in progress, see begin_bake().
+struct Stage::Bake {
+    pxr::SdfPath path;
+    std::filesystem::path directory;
+    std::string asset_prefix;
+    double start_time;
+    double delta_time;
+    size_t frame_count;
+    size_t frame = 0;
+    std::unique_ptr<animation::ClipWriter> writer;
+};
+
 Stage::Stage()
 {
     std::string stage_path = "../../Assets/stage.usdc";
@@ -63,6 +78,7 @@ Stage::Stage()
 
 Stage::~Stage()
 {
+    cancel_bake();
     remove_prim(pxr::SdfPath("/scratch_buffer"));
     stage->Save();
     animatable_prims.clear();
@@ -70,20 +86,24 @@ Stage::~Stage()
 
 void Stage::tick(float ellapsed_time)
 {
-    auto current = current_time_code.GetValue();
-    current += ellapsed_time;
-    current_time_code = pxr::UsdTimeCode(current);
+    // The clock starts at 0 when no time was set.
+    const double current =
+        current_time_code.IsDefault() ? 0.0 : current_time_code.GetValue();
+    current_time_code = pxr::UsdTimeCode(current + ellapsed_time);
 
     // for each prim, if it is animatable, update it
     for (auto&& prim : stage->Traverse()) {
-        if (animation::WithDynamicLogicPrim::is_animatable(prim)) {
+        if (animation::WithDynamicLogicPrim::is_animatable(prim) &&
+            !animation::WithDynamicLogicPrim::is_baked(prim) &&
+            !(baking && baking->path == prim.GetPath())) {
             if (animatable_prims.find(prim.GetPath()) ==
                 animatable_prims.end()) {
                 animatable_prims[prim.GetPath()] =
                     std::move(animation::WithDynamicLogicPrim(prim));
             }
 
-            animatable_prims[prim.GetPath()].update(ellapsed_time);
+            animatable_prims[prim.GetPath()].update(
+                ellapsed_time, current_time_code);
         }
     }
 }
@@ -152,6 +172,9 @@ pxr::UsdGeomMesh Stage::create_mesh(const pxr::SdfPath& path) const
 
 void Stage::remove_prim(const pxr::SdfPath& path)
 {
+    if (baking && baking->path == path) {
+        cancel_bake();
+    }
     if (animatable_prims.find(path) != animatable_prims.end()) {
         animatable_prims.erase(path);
     }
@@ -246,6 +269,211 @@ void Stage::import_usd(
 #endif
 }
 
+bool Stage::begin_bake(
+    const pxr::SdfPath& path,
+    double start_time,
+    double delta_time,
+    size_t frame_count,
+    size_t frames_per_clip,
+    const std::filesystem::path& directory)
+{
+    cancel_bake();
+    auto prim = stage->GetPrimAtPath(path);
+    if (!prim || !animation::WithDynamicLogicPrim::is_animatable(prim)) {
+        log::error("Cannot bake %s: not an animatable prim.", path.GetText());
+        return false;
+    }
+    clear_bake(path);
+
+    auto bake = std::make_unique<Bake>();
+    bake->path = path;
+    bake->start_time = start_time;
+    bake->delta_time = delta_time;
+    bake->frame_count = frame_count;
+
+    // Clips next to the stage file are referred to with relative paths.
+    const std::string root_path = stage->GetRootLayer()->GetRealPath();
+    if (!directory.empty()) {
+        bake->directory = std::filesystem::absolute(directory);
+        bake->asset_prefix = bake->directory.generic_string() + "/";
+    }
+    else if (!root_path.empty()) {
+        const std::filesystem::path root(root_path);
+        const std::string folder = root.stem().string() + "_clips";
+        bake->directory = root.parent_path() / folder;
+        bake->asset_prefix = "./" + folder + "/";
+    }
+    else {
+        bake->directory =
+            std::filesystem::temp_directory_path() / "stage_clips";
+        bake->asset_prefix = bake->directory.generic_string() + "/";
+    }
+    std::error_code error;
+    std::filesystem::create_directories(bake->directory, error);
+    if (error) {
+        log::error("Cannot create %s.", bake->directory.string().c_str());
+        return false;
+    }
+
+    // Prim names are not unique on the stage, prim paths are.
+    const std::string base =
+        pxr::TfStringReplace(path.GetString().substr(1), "/", "_");
+    bake->writer = std::make_unique<animation::ClipWriter>(
+        path, bake->directory, base, frames_per_clip);
+
+    if (animatable_prims.find(path) == animatable_prims.end()) {
+        animatable_prims[path] = animation::WithDynamicLogicPrim(prim);
+    }
+    animatable_prims[path].reset();
+    baking = std::move(bake);
+    return true;
+}
+
+bool Stage::step_bake(size_t max_frames)
+{
+    if (!baking) {
+        return true;
+    }
+    auto prim = stage->GetPrimAtPath(baking->path);
+    if (!prim) {
+        log::error("Baked prim %s is gone.", baking->path.GetText());
+        cancel_bake();
+        return false;
+    }
+    auto& logic = animatable_prims[baking->path];
+    for (size_t i = 0; i < max_frames && baking->frame < baking->frame_count;
+         ++i, ++baking->frame) {
+        const double time =
+            baking->start_time + baking->frame * baking->delta_time;
+        logic.update(static_cast<float>(baking->delta_time), time);
+        baking->writer->push(prim, time);
+    }
+    if (baking->frame < baking->frame_count) {
+        return true;
+    }
+    return finish_bake();
+}
+
+void Stage::cancel_bake()
+{
+    if (!baking) {
+        return;
+    }
+    // The next tick starts the simulation over, and replaces the frames
+    // authored so far with default values.
+    auto logic = animatable_prims.find(baking->path);
+    if (logic != animatable_prims.end()) {
+        logic->second.reset();
+    }
+    // Clips of an unfinished bake are never referenced, so none are kept.
+    baking->writer->discard();
+    baking.reset();
+}
+
+bool Stage::is_baking() const
+{
+    return baking != nullptr;
+}
+
+float Stage::bake_progress() const
+{
+    if (!baking || baking->frame_count == 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(baking->frame) / baking->frame_count;
+}
+
+bool Stage::bake(
+    const pxr::SdfPath& path,
+    double start_time,
+    double delta_time,
+    size_t frame_count,
+    size_t frames_per_clip,
+    const std::filesystem::path& directory)
+{
+    if (!begin_bake(
+            path,
+            start_time,
+            delta_time,
+            frame_count,
+            frames_per_clip,
+            directory)) {
+        return false;
+    }
+    return step_bake(frame_count);
+}
+
+bool Stage::finish_bake()
+{
+    std::unique_ptr<Bake> bake = std::move(baking);
+    const pxr::SdfPath& path = bake->path;
+    auto& writer = *bake->writer;
+    const bool written = writer.finish();
+    animatable_prims[path].reset();
+    if (!written) {
+        return false;
+    }
+
+    // Layers kept from an earlier bake still hold the old frames.
+    std::vector<std::string> files{ writer.manifest() };
+    for (const auto& clip : writer.clips()) {
+        files.push_back(clip.file);
+    }
+    for (const auto& file : files) {
+        auto layer = pxr::SdfLayer::Find((bake->directory / file).string());
+        if (layer) {
+            layer->Reload();
+        }
+    }
+
+    // Values authored on the prim itself would be stronger than the clips.
+    auto prim = stage->GetPrimAtPath(path);
+    for (const auto& name : writer.attribute_names()) {
+        prim.GetAttribute(name).Clear();
+    }
+
+    pxr::VtArray<pxr::SdfAssetPath> assets;
+    pxr::VtVec2dArray active;
+    pxr::VtVec2dArray times;
+    for (size_t i = 0; i < writer.clips().size(); ++i) {
+        const auto& clip = writer.clips()[i];
+        assets.push_back(pxr::SdfAssetPath(bake->asset_prefix + clip.file));
+        active.push_back(pxr::GfVec2d(clip.start_time, i));
+        // Stage time is clip time.
+        times.push_back(pxr::GfVec2d(clip.start_time, clip.start_time));
+        if (clip.end_time != clip.start_time) {
+            times.push_back(pxr::GfVec2d(clip.end_time, clip.end_time));
+        }
+    }
+    pxr::UsdClipsAPI clips(prim);
+    clips.SetClipPrimPath(path.GetString());
+    clips.SetClipManifestAssetPath(
+        pxr::SdfAssetPath(bake->asset_prefix + writer.manifest()));
+    clips.SetClipAssetPaths(assets);
+    clips.SetClipTimes(times);
+    clips.SetClipActive(active);
+#if SAVE_ALL_THE_TIME
+    stage->Save();
+#endif
+    return true;
+}
+
+void Stage::clear_bake(const pxr::SdfPath& path)
+{
+    if (baking && baking->path == path) {
+        cancel_bake();
+    }
+    auto prim = stage->GetPrimAtPath(path);
+    if (!prim) {
+        return;
+    }
+    prim.ClearMetadata(pxr::UsdTokens->clips);
+    auto logic = animatable_prims.find(path);
+    if (logic != animatable_prims.end()) {
+        logic->second.reset();
+    }
+}
+
 std::unique_ptr<Stage> create_global_stage()
 {
     return std::make_unique<Stage>();
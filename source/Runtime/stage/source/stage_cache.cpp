@@ -0,0 +1,70 @@
+#include "stage/stage_cache.hpp"
+
+#include <list>
+#include <mutex>
+#include <string>
+
+USTC_CG_NAMESPACE_OPEN_SCOPE
+
+namespace {
+struct CachedStage {
+    std::string path;
+    std::filesystem::file_time_type write_time;
+    uintmax_t size;
+    pxr::UsdStageRefPtr stage;
+};
+
+std::mutex cache_mutex;
+// Most recently used first.
+std::list<CachedStage> cached_stages;
+}  // namespace
+
+pxr::UsdStageRefPtr open_cached_stage(const std::filesystem::path& path)
+{
+    std::error_code error;
+    const auto canonical = std::filesystem::canonical(path, error);
+    if (error) {
+        return nullptr;
+    }
+    const auto write_time = std::filesystem::last_write_time(canonical, error);
+    if (error) {
+        return nullptr;
+    }
+    const auto size = std::filesystem::file_size(canonical, error);
+    if (error) {
+        return nullptr;
+    }
+    const std::string key = canonical.string();
+
+    std::lock_guard lock(cache_mutex);
+    for (auto it = cached_stages.begin(); it != cached_stages.end(); ++it) {
+        if (it->path != key) {
+            continue;
+        }
+        cached_stages.splice(cached_stages.begin(), cached_stages, it);
+        if (it->write_time != write_time || it->size != size) {
+            it->stage->Reload();
+            it->write_time = write_time;
+            it->size = size;
+        }
+        return it->stage;
+    }
+
+    auto stage = pxr::UsdStage::Open(key);
+    if (!stage) {
+        return nullptr;
+    }
+    cached_stages.push_front({ key, write_time, size, stage });
+    if (cached_stages.size() > stage_cache_capacity) {
+        cached_stages.pop_back();
+    }
+    return stage;
+}
+
+void clear_stage_cache()
+{
+    std::lock_guard lock(cache_mutex);
+    cached_stages.clear();
+}
+
+USTC_CG_NAMESPACE_CLOSE_SCOPE
@@ -1,11 +1,36 @@
 #include <gtest/gtest.h>
 
+#include <filesystem>
 #include <stage/stage.hpp>
+#include <string>
+#include <vector>
 
+#include "nodes/system/node_system.hpp"
+#include "pxr/usd/usd/clipsAPI.h"
 #include "pxr/usd/usd/prim.h"
 
 using namespace USTC_CG;
 
+namespace {
+// A node tree that writes a grid to its prim.
+std::string grid_tree_json()
+{
+    auto system = create_dynamic_loading_system();
+    EXPECT_TRUE(system->load_configuration("geometry_nodes.json"));
+    NodeTree tree(system->node_tree_descriptor());
+    auto grid = tree.add_node("create_grid");
+    auto write = tree.add_node("write_usd");
+    EXPECT_TRUE(grid && write);
+    if (!grid || !write) {
+        return {};
+    }
+    tree.add_link(
+        grid->get_output_socket("Geometry"),
+        write->get_input_socket("Geometry"));
+    return tree.serialize();
+}
+}  // namespace
+
 TEST(Stage, CreateStage)
 {
     Stage stage;
@@ -14,4 +39,92 @@ TEST(Stage, CreateStage)
 
     auto content = stage.stage_content();
     ASSERT_FALSE(content.empty());
-}
\ No newline at end of file
+}
+
+TEST(Stage, SimulatedPointsAreTimeSampled)
+{
+    Stage stage;
+    const pxr::SdfPath path("/time_samples");
+    auto mesh = pxr::UsdGeomMesh::Define(stage.get_usd_stage(), path);
+    stage.save_string_to_usd(path, grid_tree_json());
+    auto animatable = mesh.GetPrim().CreateAttribute(
+        pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool);
+
+    // Without a simulation zone the tree turns Animatable off again; keep it
+    // on so that every tick runs the tree.
+    stage.set_current_time(pxr::UsdTimeCode(0.0));
+    for (int i = 0; i < 3; ++i) {
+        animatable.Set(true);
+        stage.tick(0.5f);
+    }
+
+    // The first tick starts the simulation and writes the default value,
+    // the others a sample at the stage time.
+    std::vector<double> times;
+    ASSERT_TRUE(mesh.GetPointsAttr().GetTimeSamples(&times));
+    EXPECT_EQ(times, (std::vector<double>{ 1.0, 1.5 }));
+    pxr::VtArray<pxr::GfVec3f> points;
+    EXPECT_TRUE(mesh.GetPointsAttr().Get(&points));
+    EXPECT_FALSE(points.empty());
+    EXPECT_EQ(mesh.GetFaceVertexCountsAttr().GetNumTimeSamples(), 0u);
+
+    stage.remove_prim(path);
+}
+
+TEST(Stage, BakeToClips)
+{
+    const auto directory =
+        std::filesystem::temp_directory_path() / "stage_bake_test";
+    std::filesystem::remove_all(directory);
+
+    Stage stage;
+    const pxr::SdfPath path("/baked");
+    auto mesh = pxr::UsdGeomMesh::Define(stage.get_usd_stage(), path);
+    stage.save_string_to_usd(path, grid_tree_json());
+    // The tree turns Animatable off again without a simulation zone.
+    auto animatable = mesh.GetPrim().CreateAttribute(
+        pxr::TfToken("Animatable"), pxr::SdfValueTypeNames->Bool);
+
+    // 5 frames in clips of 2, stepped one frame at a time.
+    animatable.Set(true);
+    ASSERT_TRUE(stage.begin_bake(path, 1.0, 0.5, 5, 2, directory));
+    EXPECT_TRUE(stage.is_baking());
+    EXPECT_TRUE(stage.step_bake(1));
+    EXPECT_FLOAT_EQ(stage.bake_progress(), 0.2f);
+    while (stage.is_baking()) {
+        ASSERT_TRUE(stage.step_bake(1));
+    }
+    for (const char* file :
+         { "baked.0000.usdc", "baked.0001.usdc", "baked.0002.usdc",
+           "baked.manifest.usda" }) {
+        EXPECT_TRUE(std::filesystem::exists(directory / file)) << file;
+    }
+
+    // The points now come from the clips, at every frame.
+    pxr::VtArray<pxr::SdfAssetPath> assets;
+    ASSERT_TRUE(pxr::UsdClipsAPI(mesh).GetClipAssetPaths(&assets));
+    EXPECT_EQ(assets.size(), 3u);
+    EXPECT_EQ(
+        mesh.GetPointsAttr().GetResolveInfo(1.0).GetSource(),
+        pxr::UsdResolveInfoSourceValueClips);
+    pxr::VtArray<pxr::GfVec3f> first, last;
+    ASSERT_TRUE(mesh.GetPointsAttr().Get(&first, 1.0));
+    ASSERT_TRUE(mesh.GetPointsAttr().Get(&last, 3.0));
+    EXPECT_FALSE(first.empty());
+    EXPECT_EQ(first, last);
+
+    // A canceled bake leaves the prim unbaked.
+    animatable.Set(true);
+    ASSERT_TRUE(stage.begin_bake(path, 1.0, 0.5, 5, 2, directory));
+    EXPECT_FALSE(mesh.GetPrim().HasMetadata(pxr::UsdTokens->clips));
+    stage.cancel_bake();
+    EXPECT_FALSE(stage.is_baking());
+
+    animatable.Set(true);
+    EXPECT_TRUE(stage.bake(path, 1.0, 0.5, 5, 2, directory));
+    stage.clear_bake(path);
+    EXPECT_FALSE(mesh.GetPrim().HasMetadata(pxr::UsdTokens->clips));
+
+    stage.remove_prim(path);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stage/stage_cache.hpp>
+
+#include "pxr/usd/usd/prim.h"
+
+using namespace USTC_CG;
+
+TEST(StageCache, OpensOnce)
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "stage_cache_test.usda";
+    {
+        std::ofstream out(path);
+        out << "#usda 1.0\ndef Mesh \"a\"\n{\n}\n";
+    }
+
+    auto stage = open_cached_stage(path);
+    ASSERT_TRUE(stage);
+    EXPECT_TRUE(stage->GetPrimAtPath(pxr::SdfPath("/a")));
+    EXPECT_EQ(open_cached_stage(path), stage);
+
+    // Same stage, reloaded from the changed file.
+    {
+        std::ofstream out(path);
+        out << "#usda 1.0\ndef Mesh \"a\"\n{\n}\ndef Mesh \"b\"\n{\n}\n";
+    }
+    auto reloaded = open_cached_stage(path);
+    EXPECT_EQ(reloaded, stage);
+    EXPECT_TRUE(reloaded->GetPrimAtPath(pxr::SdfPath("/b")));
+
+    clear_stage_cache();
+    std::filesystem::remove(path);
+    EXPECT_FALSE(open_cached_stage(path));
+}
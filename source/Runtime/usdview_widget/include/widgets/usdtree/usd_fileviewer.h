@@ -35,6 +35,7 @@ class USDVIEW_WIDGET_API UsdFileViewer : public IWidget {
 
     void remove_prim_logic();
     void show_right_click_menu();
+    void show_bake_progress();
     void DrawChild(const pxr::UsdPrim& prim, bool is_root = false);
 
     pxr::SdfPath selected;
@@ -2,6 +2,7 @@
 
 #include "widgets/usdtree/usd_fileviewer.h"
 
+#include <chrono>
 #include <future>
 #include <iostream>
 #include <vector>
@@ -361,6 +362,18 @@ void UsdFileViewer::show_right_click_menu()
             if (ImGui::MenuItem("Edit")) {
                 stage->create_editor_at_path(selected);
             }
+            if (ImGui::MenuItem("Bake Simulation")) {
+                // 1000 frames at 60 fps from the current time.
+                const auto time = stage->get_current_time();
+                stage->begin_bake(
+                    selected,
+                    time.IsDefault() ? 0.0 : time.GetValue(),
+                    1.0 / 60.0,
+                    1000);
+            }
+            if (ImGui::MenuItem("Clear Bake")) {
+                stage->clear_bake(selected);
+            }
 
             if (ImGui::MenuItem("Delete")) {
                 to_delete = selected;
@@ -372,6 +385,31 @@ void UsdFileViewer::show_right_click_menu()
     }
 }
 
+void UsdFileViewer::show_bake_progress()
+{
+    if (!stage->is_baking()) {
+        return;
+    }
+    // Frames are simulated until the time of a UI frame is used up, so that
+    // the window stays responsive.
+    const auto start = std::chrono::steady_clock::now();
+    while (stage->is_baking() &&
+           std::chrono::steady_clock::now() - start <
+               std::chrono::milliseconds(30)) {
+        stage->step_bake(1);
+    }
+    if (!stage->is_baking()) {
+        return;
+    }
+
+    ImGui::Begin("Baking", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::ProgressBar(stage->bake_progress(), ImVec2(300, 0));
+    if (ImGui::Button("Cancel")) {
+        stage->cancel_bake();
+    }
+    ImGui::End();
+}
+
 void UsdFileViewer::DrawChild(const pxr::UsdPrim& prim, bool is_root)
 {
     auto flags =
@@ -442,6 +480,7 @@ bool UsdFileViewer::BuildUI()
     EditValue();
     ImGui::End();
     remove_prim_logic();
+    show_bake_progress();
 
     return true;
 }